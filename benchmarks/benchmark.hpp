@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+// Prevents the compiler from optimizing away a computed value
+template<typename T>
+inline void doNotOptimize(T const& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+// Runs the function a given number of times and returns the average duration of one call in nanoseconds
+template<typename F>
+double measureNanosecondsPerOp(std::size_t iterations, F&& f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i < iterations; i++)
+    {
+        f();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / double(iterations);
+}
+
+inline void printResult(const char *name, double nsPerOp)
+{
+    printf("%-48s %10.2f ns/op\n", name, nsPerOp);
+}
+
+// Collects results of a benchmark program, so they can also be written as JSON and compared between releases
+class BenchmarkReport
+{
+public:
+    explicit BenchmarkReport(const char *benchmarkName)
+    : m_benchmarkName(benchmarkName)
+    {
+    }
+
+    // Prints the result like printResult() and keeps it for the report;
+    // baselineNsPerOp is the time of the same operation done without the library, if there is one
+    void add(const char *name, double nsPerOp, double baselineNsPerOp = 0.0)
+    {
+        if(baselineNsPerOp > 0.0)
+        {
+            printf("%-48s %10.2f ns/op %8.2fx\n", name, nsPerOp, nsPerOp / baselineNsPerOp);
+        }
+        else
+        {
+            printResult(name, nsPerOp);
+        }
+
+        m_entries.push_back(Entry { name, nsPerOp, baselineNsPerOp });
+    }
+
+    // Writes results to a file, or to the standard output if the path is "-"
+    bool writeJson(const char *path, const char *version) const
+    {
+        const bool isStdout = std::string(path) == "-";
+        FILE *file = isStdout ? stdout : fopen(path, "w");
+        if(!file)
+        {
+            return false;
+        }
+
+        fprintf(file, "{\n  \"benchmark\": \"%s\",\n  \"version\": \"%s\",\n  \"results\": [\n", m_benchmarkName.c_str(), version);
+        for(std::size_t i = 0; i < m_entries.size(); i++)
+        {
+            const Entry& entry = m_entries[i];
+            fprintf(file, "    { \"name\": \"%s\", \"ns_per_op\": %.3f", entry.name.c_str(), entry.nsPerOp);
+            if(entry.baselineNsPerOp > 0.0)
+            {
+                fprintf(file, ", \"baseline_ns_per_op\": %.3f, \"overhead_ratio\": %.3f", entry.baselineNsPerOp, entry.nsPerOp / entry.baselineNsPerOp);
+            }
+            fprintf(file, " }%s\n", i + 1 < m_entries.size() ? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+
+        if(!isStdout)
+        {
+            fclose(file);
+        }
+        return true;
+    }
+
+private:
+    struct Entry
+    {
+        std::string name;
+        double nsPerOp;
+        double baselineNsPerOp;
+    };
+
+    std::string m_benchmarkName;
+    std::vector<Entry> m_entries;
+};
@@ -0,0 +1,142 @@
+/**
+ * @file concurrent_statemachine.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark comparing ConcurrentStatemachine inbox with guarding the statemachine with a mutex
+ * @details
+ * Several producer threads keep requesting transitions of one statemachine.
+ * With a mutex every producer executes the transition itself while holding the lock,
+ * with ConcurrentStatemachine producers only post requests and a single owner thread executes them.
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/concurrent_statemachine.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+class BenchStatemachine : public Statemachine<> {};
+
+class StateIdle : public State<BenchStatemachine> {};
+class StateWalking : public State<BenchStatemachine> {};
+class StateRunning : public State<BenchStatemachine> {};
+
+
+const std::size_t REQUESTS_PER_PRODUCER = 200000;
+
+
+double runMutex(int producerCount)
+{
+    BenchStatemachine sm;
+    sm.initState<StateIdle>();
+    std::mutex mutex;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> producers;
+    for(int p = 0; p < producerCount; p++)
+    {
+        producers.emplace_back([&sm, &mutex] {
+            for(std::size_t i = 0; i < REQUESTS_PER_PRODUCER; i++)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if(i % 2 == 0)
+                {
+                    sm.gotoState<StateWalking>();
+                }
+                else
+                {
+                    sm.gotoState<StateRunning>();
+                }
+            }
+        });
+    }
+
+    for(std::thread& producer : producers)
+    {
+        producer.join();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / double(REQUESTS_PER_PRODUCER * producerCount);
+}
+
+double runInbox(int producerCount, double &postNs)
+{
+    ConcurrentStatemachine<BenchStatemachine> concurrent;
+    concurrent.getStatemachine().initState<StateIdle>();
+
+    std::atomic<std::int64_t> postNsTotal {0};
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> producers;
+    for(int p = 0; p < producerCount; p++)
+    {
+        producers.emplace_back([&concurrent, &postNsTotal] {
+            auto postStart = std::chrono::steady_clock::now();
+            for(std::size_t i = 0; i < REQUESTS_PER_PRODUCER; i++)
+            {
+                if(i % 2 == 0)
+                {
+                    concurrent.postGotoState<StateWalking>();
+                }
+                else
+                {
+                    concurrent.postGotoState<StateRunning>();
+                }
+            }
+            auto postEnd = std::chrono::steady_clock::now();
+            postNsTotal += std::chrono::duration_cast<std::chrono::nanoseconds>(postEnd - postStart).count();
+        });
+    }
+
+    // this thread is the owner
+    std::size_t processed = 0;
+    const std::size_t total = REQUESTS_PER_PRODUCER * producerCount;
+    while(processed < total)
+    {
+        processed += concurrent.waitAndProcessInbox(std::chrono::milliseconds(1));
+    }
+
+    for(std::thread& producer : producers)
+    {
+        producer.join();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    postNs = double(postNsTotal.load()) / double(total);
+    return std::chrono::duration<double, std::nano>(end - start).count() / double(total);
+}
+
+int main(int argc, char const *argv[])
+{
+    char name[128];
+
+    for(int producerCount : {1, 2, 4, 8})
+    {
+        snprintf(name, sizeof(name), "[mutex, %d producers] transition", producerCount);
+        printResult(name, runMutex(producerCount));
+
+        double postNs;
+        double transitionNs = runInbox(producerCount, postNs);
+        snprintf(name, sizeof(name), "[inbox, %d producers] transition", producerCount);
+        printResult(name, transitionNs);
+        snprintf(name, sizeof(name), "[inbox, %d producers] post (producer side)", producerCount);
+        printResult(name, postNs);
+    }
+
+    return 0;
+}
@@ -0,0 +1,426 @@
+/**
+ * @file core_transitions.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark of the core statemachine primitives against a hand-written switch based statemachine
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ * @details
+ * Covers initState, gotoState, pushState, popState, getCurrentState and isCurrentlyInState
+ * for different stack depths, state sizes and guard outcomes. Every case that has an equivalent in the switch
+ * based statemachine is printed with the ratio to it.
+ *
+ * Usage: CoreTransitionsBenchmark [--json <path>]
+ * With --json results are also written as JSON to the path, or to the standard output if the path is "-".
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+
+#include <cstring>
+#include <memory>
+
+#ifndef CHESTNUT_FSM_BENCHMARK_VERSION
+    #define CHESTNUT_FSM_BENCHMARK_VERSION "unknown"
+#endif
+
+using namespace chestnut::fsm;
+
+
+// ========================= switch based statemachine =========================
+
+// What a statemachine written by hand usually looks like: an enum, a switch for enter and leave actions
+// and, where states can be stacked, an array of enums.
+// The cases pass its address to doNotOptimize, so that the compiler can't fold the transitions away knowing all the states.
+
+enum class SwitchState : unsigned char
+{
+    NONE,
+    IDLE,
+    ACTIVE,
+    LOCKED,
+    OVERLAY_A,
+    OVERLAY_B
+};
+
+class SwitchStatemachine
+{
+public:
+    int callbackCount = 0;
+
+    bool initState(SwitchState state)
+    {
+        if(m_depth != 0)
+        {
+            return false;
+        }
+
+        m_stack[m_depth++] = state;
+        enter(state);
+        return true;
+    }
+
+    bool gotoState(SwitchState state)
+    {
+        if(m_stack[m_depth - 1] == state || !canEnter(state))
+        {
+            return false;
+        }
+
+        leave(m_stack[m_depth - 1]);
+        m_stack[m_depth - 1] = state;
+        enter(state);
+        return true;
+    }
+
+    bool pushState(SwitchState state)
+    {
+        if(m_depth == STACK_CAPACITY || !canEnter(state))
+        {
+            return false;
+        }
+
+        m_stack[m_depth++] = state;
+        enter(state);
+        return true;
+    }
+
+    bool popState()
+    {
+        if(m_depth <= 1)
+        {
+            return false;
+        }
+
+        leave(m_stack[--m_depth]);
+        enter(m_stack[m_depth - 1]);
+        return true;
+    }
+
+    SwitchState getCurrentState() const
+    {
+        return m_depth > 0 ? m_stack[m_depth - 1] : SwitchState::NONE;
+    }
+
+private:
+    static constexpr int STACK_CAPACITY = 128;
+
+    static bool canEnter(SwitchState state)
+    {
+        return state != SwitchState::LOCKED;
+    }
+
+    void enter(SwitchState state)
+    {
+        switch(state)
+        {
+        case SwitchState::IDLE:
+        case SwitchState::ACTIVE:
+        case SwitchState::OVERLAY_A:
+        case SwitchState::OVERLAY_B:
+            callbackCount++;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void leave(SwitchState state)
+    {
+        switch(state)
+        {
+        case SwitchState::IDLE:
+        case SwitchState::ACTIVE:
+        case SwitchState::OVERLAY_A:
+        case SwitchState::OVERLAY_B:
+            callbackCount++;
+            break;
+        default:
+            break;
+        }
+    }
+
+    SwitchState m_stack[STACK_CAPACITY] = {};
+    int m_depth = 0;
+};
+
+
+
+// ========================= Statemachine =========================
+
+class CoreStatemachine : public Statemachine<>
+{
+public:
+    int callbackCount = 0;
+};
+
+template<std::size_t Size>
+class SizedState : public State<CoreStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override { getParent().callbackCount++; }
+    void onLeaveState(StateTransition transition) override { getParent().callbackCount++; }
+
+private:
+    unsigned char m_payload[Size] = {};
+};
+
+class SmallIdle : public SizedState<8> {};
+class SmallActive : public SizedState<8> {};
+class LargeIdle : public SizedState<1024> {};
+class LargeActive : public SizedState<1024> {};
+class OverlayA : public SizedState<8> {};
+class OverlayB : public SizedState<8> {};
+
+// refuses entry after being constructed
+class RefusingState : public SizedState<8>
+{
+public:
+    bool canEnterState(StateTransition transition) const noexcept override { return false; }
+};
+
+// refuses entry before anything is constructed
+class RefusingStateType : public SizedState<8>
+{
+public:
+    static bool canEnterStateType(StateTransition transition) { return false; }
+};
+
+
+
+// ========================= StaticStatemachine =========================
+
+static int staticCallbackCount = 0;
+
+#define STATIC_STATE(name) \
+    struct name \
+    { \
+        void onEnterState(StateTransition transition) { staticCallbackCount++; } \
+        void onLeaveState(StateTransition transition) { staticCallbackCount++; } \
+    };
+
+STATIC_STATE(StaticIdle)
+STATIC_STATE(StaticActive)
+
+struct StaticRefusing
+{
+    static bool canEnterStateType(StateTransition transition) { return false; }
+};
+
+using CoreStaticStatemachine = StaticStatemachine<StaticIdle, StaticActive, StaticRefusing>;
+
+
+
+// ========================= cases =========================
+
+static const std::size_t iterations = 1000000;
+
+
+static void runInitCases(BenchmarkReport& report)
+{
+    double switchNs = measureNanosecondsPerOp(iterations, [] {
+        SwitchStatemachine sm;
+        doNotOptimize(&sm);
+        sm.initState(SwitchState::IDLE);
+        doNotOptimize(&sm);
+    });
+    report.add("[switch] construct + initState", switchNs);
+
+    report.add("[Statemachine] construct + initState", measureNanosecondsPerOp(iterations, [] {
+        CoreStatemachine sm;
+        sm.initState<SmallIdle>();
+        doNotOptimize(sm.callbackCount);
+    }), switchNs);
+
+    report.add("[StaticStatemachine] construct + initState", measureNanosecondsPerOp(iterations, [] {
+        CoreStaticStatemachine sm;
+        sm.initState<StaticIdle>();
+        doNotOptimize(sm);
+    }), switchNs);
+}
+
+template<class Idle, class Active>
+static void runGotoCase(BenchmarkReport& report, const char *name, double switchNs)
+{
+    CoreStatemachine sm;
+    sm.initState<Idle>();
+    // so that gotoState replaces the state instead of keeping the init state under it
+    sm.pushState<Active>();
+
+    report.add(name, measureNanosecondsPerOp(iterations, [&sm] {
+        sm.gotoState<Idle>();
+        sm.gotoState<Active>();
+    }) / 2.0, switchNs);
+}
+
+static void runGotoCases(BenchmarkReport& report)
+{
+    SwitchStatemachine switchSm;
+    switchSm.initState(SwitchState::IDLE);
+
+    double switchNs = measureNanosecondsPerOp(iterations, [&switchSm] {
+        switchSm.gotoState(SwitchState::ACTIVE);
+        doNotOptimize(&switchSm);
+        switchSm.gotoState(SwitchState::IDLE);
+        doNotOptimize(&switchSm);
+    }) / 2.0;
+    report.add("[switch] gotoState", switchNs);
+
+    runGotoCase<SmallIdle, SmallActive>(report, "[Statemachine] gotoState, 8 byte state", switchNs);
+    runGotoCase<LargeIdle, LargeActive>(report, "[Statemachine] gotoState, 1 KiB state", switchNs);
+
+    CoreStatemachine persistentSm;
+    persistentSm.setPersistentStates(true);
+    persistentSm.initState<SmallIdle>();
+    persistentSm.pushState<SmallActive>();
+    report.add("[Statemachine persistent] gotoState", measureNanosecondsPerOp(iterations, [&persistentSm] {
+        persistentSm.gotoState<SmallIdle>();
+        persistentSm.gotoState<SmallActive>();
+    }) / 2.0, switchNs);
+
+    CoreStaticStatemachine staticSm;
+    staticSm.initState<StaticIdle>();
+    report.add("[StaticStatemachine] gotoState", measureNanosecondsPerOp(iterations, [&staticSm] {
+        staticSm.gotoState<StaticActive>();
+        staticSm.gotoState<StaticIdle>();
+    }) / 2.0, switchNs);
+}
+
+static void runGuardCases(BenchmarkReport& report)
+{
+    SwitchStatemachine switchSm;
+    switchSm.initState(SwitchState::IDLE);
+
+    double switchNs = measureNanosecondsPerOp(iterations, [&switchSm] {
+        doNotOptimize(switchSm.gotoState(SwitchState::LOCKED));
+        doNotOptimize(&switchSm);
+    });
+    report.add("[switch] gotoState refused", switchNs);
+
+    CoreStatemachine sm;
+    sm.initState<SmallIdle>();
+
+    report.add("[Statemachine] gotoState refused by canEnterState", measureNanosecondsPerOp(iterations, [&sm] {
+        doNotOptimize(sm.gotoState<RefusingState>());
+    }), switchNs);
+
+    report.add("[Statemachine] gotoState refused by canEnterStateType", measureNanosecondsPerOp(iterations, [&sm] {
+        doNotOptimize(sm.gotoState<RefusingStateType>());
+    }), switchNs);
+
+    report.add("[Statemachine] gotoState to the current state", measureNanosecondsPerOp(iterations, [&sm] {
+        doNotOptimize(sm.gotoState<SmallIdle>());
+    }), switchNs);
+
+    CoreStaticStatemachine staticSm;
+    staticSm.initState<StaticIdle>();
+    report.add("[StaticStatemachine] gotoState refused", measureNanosecondsPerOp(iterations, [&staticSm] {
+        doNotOptimize(staticSm.gotoState<StaticRefusing>());
+    }), switchNs);
+}
+
+static void runStackCases(BenchmarkReport& report, std::size_t depth)
+{
+    char name[128];
+
+    SwitchStatemachine switchSm;
+    switchSm.initState(SwitchState::IDLE);
+    CoreStatemachine sm;
+    sm.initState<SmallIdle>();
+    for(std::size_t i = 1; i < depth; i++)
+    {
+        switchSm.pushState(i % 2 ? SwitchState::OVERLAY_A : SwitchState::OVERLAY_B);
+        if(i % 2)
+        {
+            sm.pushState<OverlayA>();
+        }
+        else
+        {
+            sm.pushState<OverlayB>();
+        }
+    }
+
+    double switchPushNs = measureNanosecondsPerOp(iterations, [&switchSm] {
+        switchSm.pushState(SwitchState::ACTIVE);
+        doNotOptimize(&switchSm);
+        switchSm.popState();
+        doNotOptimize(&switchSm);
+    }) / 2.0;
+    snprintf(name, sizeof(name), "[switch] pushState/popState, depth %zu", depth);
+    report.add(name, switchPushNs);
+
+    snprintf(name, sizeof(name), "[Statemachine] pushState/popState, depth %zu", depth);
+    report.add(name, measureNanosecondsPerOp(iterations, [&sm] {
+        sm.pushState<SmallActive>();
+        sm.popState();
+    }) / 2.0, switchPushNs);
+
+    double switchQueryNs = measureNanosecondsPerOp(iterations, [&switchSm] {
+        doNotOptimize(&switchSm);
+        doNotOptimize(switchSm.getCurrentState());
+    });
+    snprintf(name, sizeof(name), "[switch] getCurrentState, depth %zu", depth);
+    report.add(name, switchQueryNs);
+
+    snprintf(name, sizeof(name), "[Statemachine] getCurrentState, depth %zu", depth);
+    report.add(name, measureNanosecondsPerOp(iterations, [&sm] {
+        doNotOptimize(sm.getCurrentState());
+    }), switchQueryNs);
+
+    double switchCheckNs = measureNanosecondsPerOp(iterations, [&switchSm] {
+        doNotOptimize(&switchSm);
+        doNotOptimize(switchSm.getCurrentState() == SwitchState::IDLE);
+    });
+    snprintf(name, sizeof(name), "[switch] isCurrentlyInState, depth %zu", depth);
+    report.add(name, switchCheckNs);
+
+    snprintf(name, sizeof(name), "[Statemachine] isCurrentlyInState, depth %zu", depth);
+    report.add(name, measureNanosecondsPerOp(iterations, [&sm] {
+        doNotOptimize(sm.isCurrentlyInState<SmallIdle>());
+    }), switchCheckNs);
+}
+
+
+
+int main(int argc, char const *argv[])
+{
+    const char *jsonPath = nullptr;
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--json <path>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    BenchmarkReport report("CoreTransitionsBenchmark");
+
+    runInitCases(report);
+    printf("\n");
+    runGotoCases(report);
+    printf("\n");
+    runGuardCases(report);
+    for(std::size_t depth : { 1, 8, 64 })
+    {
+        printf("\n");
+        runStackCases(report, depth);
+    }
+
+    doNotOptimize(staticCallbackCount);
+
+    if(jsonPath && !report.writeJson(jsonPath, CHESTNUT_FSM_BENCHMARK_VERSION))
+    {
+        fprintf(stderr, "Could not write %s\n", jsonPath);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file executor.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark of Executor scaling with the number of workers and statemachines
+ * @details
+ * Every agent is a statemachine run by an ExecutorStatemachine. An agent takes a step by transitioning 
+ * to its next state and then posts itself its next step, until it takes all of them. 
+ * Steps of all agents are spread over the workers of one executor.
+ * The number of steps is the same for every agent count, so with enough agents the time per step 
+ * should go down roughly in proportion to the number of workers.
+ *
+ * By default agent counts go up to 100000, pass a larger maximum as the first argument (e.g. 1000000) to go further.
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/executor.hpp>
+#include <chestnut/fsm/executor_statemachine.hpp>
+
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+class AgentStatemachine : public Statemachine<> {};
+
+class StateIdle : public State<AgentStatemachine> {};
+class StateWalking : public State<AgentStatemachine> {};
+class StateRunning : public State<AgentStatemachine> {};
+
+typedef ExecutorStatemachine<AgentStatemachine> Agent;
+
+
+const std::size_t TOTAL_STEPS = 2000000;
+
+
+struct Step
+{
+    Agent *agent;
+    std::size_t remaining;
+
+    void operator()(AgentStatemachine& statemachine) const
+    {
+        if(remaining % 2 == 0)
+        {
+            statemachine.gotoState<StateWalking>();
+        }
+        else
+        {
+            statemachine.gotoState<StateRunning>();
+        }
+
+        if(remaining > 1)
+        {
+            agent->post(Step { agent, remaining - 1 });
+        }
+    }
+};
+
+double run(unsigned workerCount, std::size_t agentCount)
+{
+    Executor executor(workerCount);
+
+    std::vector<std::unique_ptr<Agent>> agents;
+    agents.reserve(agentCount);
+    for(std::size_t i = 0; i < agentCount; i++)
+    {
+        agents.emplace_back(new Agent(executor));
+        agents.back()->getStatemachine().setPersistentStates(true);
+        agents.back()->getStatemachine().initState<StateIdle>();
+    }
+
+    std::size_t stepsPerAgent = TOTAL_STEPS / agentCount;
+    if(stepsPerAgent == 0)
+    {
+        stepsPerAgent = 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(std::unique_ptr<Agent>& agent : agents)
+    {
+        agent->post(Step { agent.get(), stepsPerAgent });
+    }
+    executor.waitUntilIdle();
+
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / double(stepsPerAgent * agentCount);
+}
+
+int main(int argc, char const *argv[])
+{
+    std::size_t maxAgentCount = 100000;
+    if(argc > 1)
+    {
+        maxAgentCount = std::strtoull(argv[1], nullptr, 10);
+    }
+
+    unsigned hardwareThreads = std::thread::hardware_concurrency();
+    if(hardwareThreads == 0)
+    {
+        hardwareThreads = 1;
+    }
+
+    std::vector<unsigned> workerCounts;
+    for(unsigned workers = 1; workers < hardwareThreads; workers *= 2)
+    {
+        workerCounts.push_back(workers);
+    }
+    workerCounts.push_back(hardwareThreads);
+
+    char name[128];
+
+    for(std::size_t agentCount = 2; agentCount <= maxAgentCount; agentCount = agentCount < 1000 ? 1000 : agentCount * 10)
+    {
+        double singleWorkerNs = 0.0;
+
+        for(unsigned workers : workerCounts)
+        {
+            double ns = run(workers, agentCount);
+            if(workers == 1)
+            {
+                singleWorkerNs = ns;
+            }
+
+            snprintf(name, sizeof(name), "[%u workers, %zu agents] step", workers, agentCount);
+            printResult(name, ns);
+            printf("%-48s %10.2f x\n", "    speedup over 1 worker", singleWorkerNs / ns);
+        }
+    }
+
+    return 0;
+}
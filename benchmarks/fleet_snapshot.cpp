@@ -0,0 +1,130 @@
+/**
+ * @file fleet_snapshot.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark comparing a cold start of a StatemachineFleet, with initialization and warm-up transitions, to loading it from a snapshot file
+ * @details
+ * The snapshot is written to the current directory and removed afterwards. It's read right after being written,
+ * so loading measures a file that's in the page cache.
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/statemachine_fleet.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+struct AgentIdle
+{
+    float restTime = 0.f;
+};
+
+struct AgentWalking
+{
+    float targetX = 0.f;
+    float targetY = 0.f;
+    float speed = 1.f;
+};
+
+struct AgentWorking
+{
+    int progress = 0;
+    int workplaceId = 0;
+};
+
+struct AgentSleeping
+{
+    float wakeUpTime = 0.f;
+};
+
+using AgentFleet = StatemachineFleet<AgentIdle, AgentWalking, AgentWorking, AgentSleeping>;
+
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+int main(int argc, char const *argv[])
+{
+    const std::size_t agentCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const std::size_t warmUpTransitions = 16;
+    const char *path = "fleet_snapshot.bin";
+
+    AgentFleet fleet;
+
+    auto start = std::chrono::steady_clock::now();
+    fleet.reserve(agentCount);
+    std::uint32_t random = 12345;
+    for(std::size_t i = 0; i < agentCount; i++)
+    {
+        FleetHandle handle = fleet.create();
+        fleet.initState<AgentIdle>(handle);
+
+        for(std::size_t j = 0; j < warmUpTransitions; j++)
+        {
+            random = random * 1664525u + 1013904223u;
+            switch((random >> 16) % 4)
+            {
+            case 0: fleet.gotoState<AgentWalking>(handle); break;
+            case 1: fleet.pushState<AgentWorking>(handle); break;
+            case 2: fleet.gotoState<AgentSleeping>(handle); break;
+            default: fleet.popState(handle); break;
+            }
+        }
+
+        if(AgentWorking *working = fleet.getCurrentState<AgentWorking>(handle))
+        {
+            working->progress = (int)i;
+        }
+    }
+    const double coldStartSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    if(!fleet.writeSnapshotFile(path))
+    {
+        fprintf(stderr, "Failed to write %s\n", path);
+        return 1;
+    }
+    const double writeSeconds = secondsSince(start);
+
+    AgentFleet loaded;
+    start = std::chrono::steady_clock::now();
+    const bool isLoaded = loaded.bulkLoadSnapshotFile(path);
+    const double loadSeconds = secondsSince(start);
+
+    std::remove(path);
+
+    bool isValid = isLoaded && loaded.getSize() == fleet.getSize() && loaded.countPerState() == fleet.countPerState();
+    for(std::uint32_t i = 0; i < agentCount && isValid; i++)
+    {
+        const FleetHandle handle { i, 0 };
+        const AgentWorking *original = fleet.getCurrentState<AgentWorking>(handle);
+        const AgentWorking *restored = loaded.getCurrentState<AgentWorking>(handle);
+        isValid = loaded.getStateStackSize(handle) == fleet.getStateStackSize(handle)
+               && (original == nullptr) == (restored == nullptr) && (!original || original->progress == restored->progress);
+    }
+
+    if(!isValid)
+    {
+        fprintf(stderr, "Loaded fleet doesn't match the written one\n");
+        return 1;
+    }
+
+    printf("%zu agents, %zu warm-up transitions each\n", agentCount, warmUpTransitions);
+    printf("%-48s %10.2f ms\n", "cold start (init and warm-up)", coldStartSeconds * 1e3);
+    printf("%-48s %10.2f ms\n", "write snapshot file", writeSeconds * 1e3);
+    printf("%-48s %10.2f ms %8.2fx\n", "bulk load snapshot file", loadSeconds * 1e3, coldStartSeconds / loadSeconds);
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file hierarchical_statemachine.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark comparing HierarchicalStatemachine with a hierarchy emulated by push chains on the state stack of Statemachine
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+
+using namespace chestnut::fsm;
+
+
+// Hierarchy used in both cases:
+//
+// Alive
+// +-- Grounded
+// |   +-- Standing
+// |       +-- Idle
+// +-- Airborne
+//     +-- Jumping
+//         +-- Rising
+
+
+// ========================= Statemachine =========================
+
+class StackStatemachine : public Statemachine<>
+{
+public:
+    int callbackCount = 0;
+};
+
+#define STACK_STATE(name) \
+    class name : public State<StackStatemachine> \
+    { \
+    public: \
+        void onEnterState(StateTransition transition) override { getParent().callbackCount++; } \
+        void onLeaveState(StateTransition transition) override { getParent().callbackCount++; } \
+    };
+
+STACK_STATE(StackAlive)
+STACK_STATE(StackGrounded)
+STACK_STATE(StackStanding)
+STACK_STATE(StackIdle)
+STACK_STATE(StackAirborne)
+STACK_STATE(StackJumping)
+STACK_STATE(StackRising)
+
+
+
+// ========================= HierarchicalStatemachine =========================
+
+struct Alive;
+struct Grounded;
+struct Standing;
+struct Idle;
+struct Airborne;
+struct Jumping;
+struct Rising;
+
+using PlayerStatemachine = HierarchicalStatemachine<Alive, Grounded, Standing, Idle, Airborne, Jumping, Rising>;
+
+static int hierarchicalCallbackCount = 0;
+
+#define HIERARCHICAL_STATE(name, parent) \
+    struct name \
+    { \
+        typedef parent ParentState; \
+        void onEnterState(StateTransition transition) { hierarchicalCallbackCount++; } \
+        void onLeaveState(StateTransition transition) { hierarchicalCallbackCount++; } \
+    };
+
+struct Alive
+{
+    void onEnterState(StateTransition transition) { hierarchicalCallbackCount++; }
+    void onLeaveState(StateTransition transition) { hierarchicalCallbackCount++; }
+};
+
+HIERARCHICAL_STATE(Grounded, Alive)
+HIERARCHICAL_STATE(Standing, Grounded)
+HIERARCHICAL_STATE(Idle, Standing)
+HIERARCHICAL_STATE(Airborne, Alive)
+HIERARCHICAL_STATE(Jumping, Airborne)
+HIERARCHICAL_STATE(Rising, Jumping)
+
+
+
+int main(int argc, char const *argv[])
+{
+    const std::size_t iterations = 1000000;
+
+    // with a flat stack going to another branch means popping down to the common ancestor and pushing the other branch,
+    // every pop enters the state below again on the way
+    StackStatemachine stackSm;
+    stackSm.initState<StackAlive>();
+    stackSm.pushState<StackGrounded>();
+    stackSm.pushState<StackStanding>();
+    stackSm.pushState<StackIdle>();
+
+    double stackNs = measureNanosecondsPerOp(iterations, [&stackSm] {
+        stackSm.popState();
+        stackSm.popState();
+        stackSm.popState();
+        stackSm.pushState<StackAirborne>();
+        stackSm.pushState<StackJumping>();
+        stackSm.pushState<StackRising>();
+
+        stackSm.popState();
+        stackSm.popState();
+        stackSm.popState();
+        stackSm.pushState<StackGrounded>();
+        stackSm.pushState<StackStanding>();
+        stackSm.pushState<StackIdle>();
+    }) / 2.0;
+    printResult("[Statemachine push chain] Idle <-> Rising", stackNs);
+
+
+    PlayerStatemachine hierarchicalSm;
+    hierarchicalSm.initState<Idle>();
+
+    double hierarchicalNs = measureNanosecondsPerOp(iterations, [&hierarchicalSm] {
+        hierarchicalSm.gotoState<Rising>();
+        hierarchicalSm.gotoState<Idle>();
+    }) / 2.0;
+    printResult("[HierarchicalStatemachine] Idle <-> Rising", hierarchicalNs);
+
+    printf("\nspeedup: %.1fx\n", stackNs / hierarchicalNs);
+    printf("callbacks per transition: push chain %.1f, hierarchical %.1f\n",
+        double(stackSm.callbackCount) / double(2 * iterations), double(hierarchicalCallbackCount - 3) / double(2 * iterations));
+
+
+    // coming back to the branch that was left, to the innermost state it was in
+    double historyNs = measureNanosecondsPerOp(iterations, [&hierarchicalSm] {
+        hierarchicalSm.gotoState<DeepHistory<Airborne>>();
+        hierarchicalSm.gotoState<Idle>();
+    }) / 2.0;
+    printResult("[HierarchicalStatemachine] Idle <-> deep history", historyNs);
+
+    hierarchicalSm.setPersistentStates(true);
+    double persistentHistoryNs = measureNanosecondsPerOp(iterations, [&hierarchicalSm] {
+        hierarchicalSm.gotoState<DeepHistory<Airborne>>();
+        hierarchicalSm.gotoState<Idle>();
+    }) / 2.0;
+    printResult("[HierarchicalStatemachine] Idle <-> deep, persistent", persistentHistoryNs);
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file orthogonal_statemachine.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark comparing an OrthogonalStatemachine with regions against separate StaticStatemachines for each concern
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+
+#include <memory>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+// A door with three independent concerns: motion, lock and alarm.
+// Every state counts ticks, so that every region has work to do for every event.
+
+struct Tick {};
+
+static int tickCount = 0;
+
+
+// ========================= Statemachine =========================
+
+class TickExtension
+{
+public:
+    virtual void onTick() = 0;
+};
+
+class TickStatemachine : public Statemachine<TickExtension> {};
+
+#define HEAP_TICKING_STATE(name) \
+    class name : public State<TickStatemachine> \
+    { \
+    public: \
+        void onTick() override { tickCount++; } \
+    };
+
+HEAP_TICKING_STATE(HeapClosed)
+HEAP_TICKING_STATE(HeapLocked)
+HEAP_TICKING_STATE(HeapArmed)
+
+struct HeapDoor
+{
+    TickStatemachine motion;
+    TickStatemachine lock;
+    TickStatemachine alarm;
+};
+
+
+// ========================= StaticStatemachine and OrthogonalStatemachine =========================
+
+#define TICKING_STATE(name) \
+    struct name \
+    { \
+        void onEvent(const Tick& tick) { tickCount++; } \
+    };
+
+TICKING_STATE(Closed)
+TICKING_STATE(Open)
+TICKING_STATE(Unlocked)
+TICKING_STATE(Locked)
+TICKING_STATE(Disarmed)
+TICKING_STATE(Armed)
+
+
+using MotionStatemachine = StaticStatemachine<Closed, Open>;
+using LockStatemachine = StaticStatemachine<Unlocked, Locked>;
+using AlarmStatemachine = StaticStatemachine<Disarmed, Armed>;
+
+struct SeparateDoor
+{
+    MotionStatemachine motion;
+    LockStatemachine lock;
+    AlarmStatemachine alarm;
+};
+
+using OrthogonalDoor = OrthogonalStatemachine< Region<Closed, Open>, Region<Unlocked, Locked>, Region<Disarmed, Armed> >;
+
+
+
+int main(int argc, char const *argv[])
+{
+    const std::size_t doorCount = 10000;
+    const std::size_t iterations = 200;
+
+    // each door allocated on its own, like objects owning their statemachines usually are
+    std::vector< std::unique_ptr<HeapDoor> > heapDoors;
+    std::vector< std::unique_ptr<SeparateDoor> > separateDoors;
+    std::vector< std::unique_ptr<OrthogonalDoor> > orthogonalDoors;
+    for(std::size_t i = 0; i < doorCount; i++)
+    {
+        heapDoors.push_back( std::make_unique<HeapDoor>() );
+        heapDoors.back()->motion.initState<HeapClosed>();
+        heapDoors.back()->lock.initState<HeapLocked>();
+        heapDoors.back()->alarm.initState<HeapArmed>();
+
+        separateDoors.push_back( std::make_unique<SeparateDoor>() );
+        separateDoors.back()->motion.initState<Closed>();
+        separateDoors.back()->lock.initState<Locked>();
+        separateDoors.back()->alarm.initState<Armed>();
+
+        orthogonalDoors.push_back( std::make_unique<OrthogonalDoor>() );
+        orthogonalDoors.back()->initState<Closed>();
+        orthogonalDoors.back()->initState<Locked>();
+        orthogonalDoors.back()->initState<Armed>();
+    }
+
+    double heapNs = measureNanosecondsPerOp(iterations, [&heapDoors] {
+        for(auto& door : heapDoors)
+        {
+            door->motion.getCurrentState()->onTick();
+            door->lock.getCurrentState()->onTick();
+            door->alarm.getCurrentState()->onTick();
+        }
+    }) / double(doorCount);
+    printResult("[3 Statemachines] dispatch event", heapNs);
+
+    double separateNs = measureNanosecondsPerOp(iterations, [&separateDoors] {
+        for(auto& door : separateDoors)
+        {
+            door->motion.dispatchEvent(Tick{});
+            door->lock.dispatchEvent(Tick{});
+            door->alarm.dispatchEvent(Tick{});
+        }
+    }) / double(doorCount);
+    printResult("[3 StaticStatemachines] dispatch event", separateNs);
+
+    double orthogonalNs = measureNanosecondsPerOp(iterations, [&orthogonalDoors] {
+        for(auto& door : orthogonalDoors)
+        {
+            door->dispatchEvent(Tick{});
+        }
+    }) / double(doorCount);
+    printResult("[OrthogonalStatemachine] dispatch event", orthogonalNs);
+
+    double separateQueryNs = measureNanosecondsPerOp(iterations, [&separateDoors] {
+        std::size_t count = 0;
+        for(auto& door : separateDoors)
+        {
+            count += door->motion.isCurrentlyInState<Closed>() && door->lock.isCurrentlyInState<Locked>() && door->alarm.isCurrentlyInState<Armed>();
+        }
+        doNotOptimize(count);
+    }) / double(doorCount);
+    printResult("[3 StaticStatemachines] query configuration", separateQueryNs);
+
+    double orthogonalQueryNs = measureNanosecondsPerOp(iterations, [&orthogonalDoors] {
+        std::size_t count = 0;
+        for(auto& door : orthogonalDoors)
+        {
+            count += door->isCurrentlyInState<Closed>() && door->isCurrentlyInState<Locked>() && door->isCurrentlyInState<Armed>();
+        }
+        doNotOptimize(count);
+    }) / double(doorCount);
+    printResult("[OrthogonalStatemachine] query configuration", orthogonalQueryNs);
+
+    printf("\ndispatch speedup: %.1fx over Statemachines, %.1fx over StaticStatemachines\n", heapNs / orthogonalNs, separateNs / orthogonalNs);
+    printf("footprint: 3 Statemachines %zu bytes + 3 heap states, 3 StaticStatemachines %zu bytes, OrthogonalStatemachine %zu bytes\n",
+        sizeof(HeapDoor), sizeof(SeparateDoor), sizeof(OrthogonalDoor));
+
+    doNotOptimize(tickCount);
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file state_allocation.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark comparing state allocation policies on a steady transition cycle
+ * @details
+ * The global operator new is replaced in this translation unit, so every allocation that reaches the heap is counted.
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace chestnut::fsm;
+
+
+static std::atomic<std::size_t> heapAllocationCount {0};
+
+void *operator new(std::size_t size)
+{
+    heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    if(void *ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    throw std::bad_alloc();
+#else
+    std::abort();
+#endif
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+
+
+class BenchStatemachine : public Statemachine<> {};
+
+class StateIdle : public State<BenchStatemachine> {};
+
+class StateWalking : public State<BenchStatemachine>
+{
+    float speed[4] = {};
+};
+
+class StateRunning : public State<BenchStatemachine>
+{
+    double stamina[16] = {};
+};
+
+
+template<typename F>
+void runCase(const char *name, std::size_t iterations, F&& f)
+{
+    // warm-up, so that every state type had the chance to be allocated at least once
+    for(std::size_t i = 0; i < 1000; i++)
+    {
+        f();
+    }
+
+    std::size_t before = heapAllocationCount.load();
+    double ns = measureNanosecondsPerOp(iterations, f);
+    std::size_t after = heapAllocationCount.load();
+
+    printf("%-48s %10.2f ns/op %10.4f heap allocs/op\n", name, ns, double(after - before) / double(iterations));
+}
+
+void runAllCases(const char *allocatorName, bool persistentStates = false)
+{
+    const std::size_t iterations = 1000000;
+    char name[128];
+
+    BenchStatemachine sm;
+    sm.setPersistentStates(persistentStates);
+    sm.initState<StateIdle>();
+
+    snprintf(name, sizeof(name), "[%s] push/pop", allocatorName);
+    runCase(name, iterations, [&sm] {
+        sm.pushState<StateWalking>();
+        sm.popState();
+    });
+
+    sm.pushState<StateWalking>();
+    snprintf(name, sizeof(name), "[%s] goto/goto", allocatorName);
+    runCase(name, iterations, [&sm] {
+        sm.gotoState<StateRunning>();
+        sm.gotoState<StateWalking>();
+    });
+    sm.popState();
+}
+
+int main(int argc, char const *argv[])
+{
+    HeapStateAllocator heapAllocator;
+    setStateAllocator(&heapAllocator);
+    runAllCases("heap");
+
+    setStateAllocator(nullptr);
+    runAllCases("pool");
+
+    runAllCases("pool + persistent states", true);
+
+    StateAllocatorStats stats = getStateAllocator().getStats();
+    printf("\npool allocator stats (main thread): allocations=%zu deallocations=%zu heapAllocations=%zu heapDeallocations=%zu\n",
+        stats.allocations, stats.deallocations, stats.heapAllocations, stats.heapDeallocations);
+
+    return 0;
+}
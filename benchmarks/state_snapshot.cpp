@@ -0,0 +1,145 @@
+/**
+ * @file state_snapshot.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark of writing a fleet of statemachines into a snapshot and restoring it
+ * @details
+ * Every statemachine has 3 states on its stack and each state writes 16 bytes of data.
+ * Throughput is given in bytes of the snapshot per second.
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/snapshot.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+class BenchStatemachine : public Statemachine<> {};
+
+struct Payload
+{
+    std::uint64_t a;
+    std::uint64_t b;
+};
+
+template<int N>
+class BenchState : public State<BenchStatemachine>
+{
+public:
+    Payload payload = { N, 0 };
+
+protected:
+    void serializeState(SnapshotWriter& writer) const override
+    {
+        writer.write(payload);
+    }
+
+    void deserializeState(SnapshotReader& reader) override
+    {
+        reader.read(payload);
+    }
+};
+
+using StateIdle = BenchState<0>;
+using StateWalking = BenchState<1>;
+using StateRunning = BenchState<2>;
+
+
+typedef std::vector<std::unique_ptr<BenchStatemachine>> Fleet;
+
+static Fleet makeFleet(std::size_t size)
+{
+    Fleet fleet;
+    for(std::size_t i = 0; i < size; i++)
+    {
+        fleet.emplace_back(new BenchStatemachine());
+    }
+    return fleet;
+}
+
+static double megabytesPerSecond(std::size_t bytes, double seconds)
+{
+    return double(bytes) / seconds / 1e6;
+}
+
+
+int main(int argc, char const *argv[])
+{
+    const std::size_t fleetSize = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const int rounds = 5;
+
+    Fleet source = makeFleet(fleetSize);
+    for(std::size_t i = 0; i < fleetSize; i++)
+    {
+        source[i]->initState<StateIdle>();
+        source[i]->pushState<StateWalking>();
+        source[i]->pushState<StateRunning>();
+        source[i]->getCurrentState<StateRunning>()->payload.b = i;
+    }
+
+    double bestWriteSeconds = 1e9;
+    double bestRestoreSeconds = 1e9;
+    std::size_t snapshotSize = 0;
+    bool isValid = true;
+
+    for(int round = 0; round < rounds; round++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        SnapshotWriter writer;
+        writer.reserve(fleetSize * 3 * (sizeof(Payload) + 6));
+        for(const auto& machine : source)
+        {
+            writer.writeStatemachine(*machine);
+        }
+        auto end = std::chrono::steady_clock::now();
+        bestWriteSeconds = std::min(bestWriteSeconds, std::chrono::duration<double>(end - start).count());
+
+        const std::vector<unsigned char>& buffer = writer.getBuffer();
+        snapshotSize = buffer.size();
+
+        // statemachines are constructed up front, only restoring them is measured
+        Fleet restored = makeFleet(fleetSize);
+
+        start = std::chrono::steady_clock::now();
+        SnapshotReader reader(buffer.data(), buffer.size());
+        for(const auto& machine : restored)
+        {
+            isValid &= reader.restoreStatemachine<StateIdle, StateWalking, StateRunning>(*machine);
+        }
+        end = std::chrono::steady_clock::now();
+        bestRestoreSeconds = std::min(bestRestoreSeconds, std::chrono::duration<double>(end - start).count());
+
+        isValid &= reader.isAtEnd();
+        for(std::size_t i = 0; i < fleetSize && isValid; i++)
+        {
+            StateRunning *state = restored[i]->getCurrentState<StateRunning>();
+            isValid = restored[i]->getStateStackSize() == 3 && state && state->payload.a == 2 && state->payload.b == i;
+        }
+    }
+
+    if(!isValid)
+    {
+        fprintf(stderr, "Restored statemachines don't match the written ones\n");
+        return 1;
+    }
+
+    printf("%zu statemachines, %zu bytes of snapshot (%.1f bytes per statemachine)\n",
+        fleetSize, snapshotSize, double(snapshotSize) / double(fleetSize));
+    printf("%-48s %10.2f MB/s %8.2f ns/machine\n", "write snapshot",
+        megabytesPerSecond(snapshotSize, bestWriteSeconds), bestWriteSeconds * 1e9 / double(fleetSize));
+    printf("%-48s %10.2f MB/s %8.2f ns/machine\n", "restore snapshot",
+        megabytesPerSecond(snapshotSize, bestRestoreSeconds), bestRestoreSeconds * 1e9 / double(fleetSize));
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file state_stack.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark comparing the previous list based state stack with the contiguous StateStack
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+
+#include <list>
+#include <stack>
+
+using namespace chestnut::fsm;
+
+
+using ListStack = std::stack<StateBase *, std::list<StateBase *>>;
+using ContiguousStack = StateStack<StateBase *, CHESTNUT_FSM_STATE_STACK_INLINE_CAPACITY>;
+
+template<class Stack>
+void runCases(const char *stackName, std::size_t depth)
+{
+    const std::size_t iterations = 2000000;
+    char name[128];
+    StateBase *dummy = nullptr;
+
+    Stack stack;
+    for(std::size_t i = 0; i < depth; i++)
+    {
+        stack.push(dummy);
+    }
+
+    snprintf(name, sizeof(name), "[%s] push/pop at depth %zu", stackName, depth);
+    printResult(name, measureNanosecondsPerOp(iterations, [&] {
+        stack.push(dummy);
+        doNotOptimize(stack.top());
+        stack.pop();
+    }));
+
+    snprintf(name, sizeof(name), "[%s] top at depth %zu", stackName, depth);
+    printResult(name, measureNanosecondsPerOp(iterations, [&] {
+        doNotOptimize(stack.top());
+    }));
+}
+
+
+class BenchStatemachine : public Statemachine<> {};
+
+class StateIdle : public State<BenchStatemachine> {};
+
+class StateActive : public State<BenchStatemachine> {};
+
+
+int main(int argc, char const *argv[])
+{
+    for(std::size_t depth : {1, 4, 16})
+    {
+        runCases<ListStack>("std::stack<std::list>", depth);
+        runCases<ContiguousStack>("StateStack", depth);
+    }
+
+    BenchStatemachine sm;
+    sm.initState<StateIdle>();
+
+    printResult("[StatemachineBase] pushState/popState", measureNanosecondsPerOp(2000000, [&sm] {
+        sm.pushState<StateActive>();
+        sm.popState();
+    }));
+    printResult("[StatemachineBase] getCurrentState", measureNanosecondsPerOp(2000000, [&sm] {
+        doNotOptimize(sm.getCurrentState());
+    }));
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file statemachine_fleet.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark comparing bulk state queries on a StatemachineFleet and on an array of StaticStatemachines
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/statemachine_fleet.hpp>
+
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+// Agents with a bit of per-state data, as they would have in a game or a simulation
+
+struct AgentIdle
+{
+    float restTime = 0.f;
+};
+
+struct AgentWalking
+{
+    float targetX = 0.f;
+    float targetY = 0.f;
+    float speed = 1.f;
+};
+
+struct AgentWorking
+{
+    int progress = 0;
+    int workplaceId = 0;
+};
+
+struct AgentSleeping
+{
+    float wakeUpTime = 0.f;
+};
+
+using AgentStatemachine = StaticStatemachine<AgentIdle, AgentWalking, AgentWorking, AgentSleeping>;
+using AgentFleet = StatemachineFleet<AgentIdle, AgentWalking, AgentWorking, AgentSleeping>;
+
+
+
+int main(int argc, char const *argv[])
+{
+    const std::size_t agentCount = 1000000;
+    const std::size_t iterations = 100;
+
+    std::vector<AgentStatemachine> agents( agentCount );
+    AgentFleet fleet;
+    fleet.reserve( agentCount );
+    std::vector<FleetHandle> handles;
+
+    // the same pseudo-random spread of states in both
+    std::uint32_t random = 12345;
+    for(std::size_t i = 0; i < agentCount; i++)
+    {
+        random = random * 1664525u + 1013904223u;
+        FleetHandle handle = fleet.create();
+        handles.push_back( handle );
+
+        switch( ( random >> 16 ) % 4 )
+        {
+        case 0: agents[i].initState<AgentIdle>(); fleet.initState<AgentIdle>( handle ); break;
+        case 1: agents[i].initState<AgentWalking>(); fleet.initState<AgentWalking>( handle ); break;
+        case 2: agents[i].initState<AgentWorking>(); fleet.initState<AgentWorking>( handle ); break;
+        default: agents[i].initState<AgentSleeping>(); fleet.initState<AgentSleeping>( handle ); break;
+        }
+    }
+
+
+    double arrayCountNs = measureNanosecondsPerOp(iterations, [&agents] {
+        std::size_t count = 0;
+        for(const AgentStatemachine& agent : agents)
+        {
+            count += agent.isCurrentlyInState<AgentWorking>();
+        }
+        doNotOptimize(count);
+    }) / double(agentCount);
+    printResult("[StaticStatemachine array] count in state", arrayCountNs);
+
+    double fleetCountNs = measureNanosecondsPerOp(iterations, [&fleet] {
+        doNotOptimize( fleet.countInState<AgentWorking>() );
+    }) / double(agentCount);
+    printResult("[StatemachineFleet] count in state", fleetCountNs);
+
+    double arrayHistogramNs = measureNanosecondsPerOp(iterations, [&agents] {
+        std::size_t counts[5] = {};
+        for(const AgentStatemachine& agent : agents)
+        {
+            counts[ agent.getCurrentStateIndex() ]++;
+        }
+        doNotOptimize(counts);
+    }) / double(agentCount);
+    printResult("[StaticStatemachine array] count per state", arrayHistogramNs);
+
+    double fleetHistogramNs = measureNanosecondsPerOp(iterations, [&fleet] {
+        doNotOptimize( fleet.countPerState() );
+    }) / double(agentCount);
+    printResult("[StatemachineFleet] count per state", fleetHistogramNs);
+
+    double arrayVisitNs = measureNanosecondsPerOp(iterations, [&agents] {
+        for(AgentStatemachine& agent : agents)
+        {
+            if( AgentWorking *working = agent.getCurrentState<AgentWorking>() )
+            {
+                working->progress++;
+            }
+        }
+    }) / double(agentCount);
+    printResult("[StaticStatemachine array] update state data", arrayVisitNs);
+
+    double fleetVisitNs = measureNanosecondsPerOp(iterations, [&fleet] {
+        fleet.forEachInState<AgentWorking>( []( FleetHandle, AgentWorking& working ) {
+            working.progress++;
+        });
+    }) / double(agentCount);
+    printResult("[StatemachineFleet] update state data", fleetVisitNs);
+
+
+    std::size_t transitionIndex = 0;
+    double arrayTransitionNs = measureNanosecondsPerOp(agentCount, [&agents, &transitionIndex] {
+        AgentStatemachine& agent = agents[ transitionIndex++ ];
+        agent.gotoState<AgentWalking>();
+        agent.gotoState<AgentIdle>();
+    }) / 2.0;
+    printResult("[StaticStatemachine array] transition", arrayTransitionNs);
+
+    transitionIndex = 0;
+    double fleetTransitionNs = measureNanosecondsPerOp(agentCount, [&fleet, &handles, &transitionIndex] {
+        FleetHandle handle = handles[ transitionIndex++ ];
+        fleet.gotoState<AgentWalking>( handle );
+        fleet.gotoState<AgentIdle>( handle );
+    }) / 2.0;
+    printResult("[StatemachineFleet] transition", fleetTransitionNs);
+
+
+    printf("\ncount in state speedup: %.1fx\n", arrayCountNs / fleetCountNs);
+    printf("count per state speedup: %.1fx\n", arrayHistogramNs / fleetHistogramNs);
+    printf("footprint: StaticStatemachine %zu bytes per agent, StatemachineFleet %zu bytes per agent (index and stack) + state columns\n",
+        sizeof(AgentStatemachine), 2 + AgentFleet::STACK_CAPACITY + sizeof(std::uint32_t));
+
+    return 0;
+}
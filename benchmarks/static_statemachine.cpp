@@ -0,0 +1,122 @@
+/**
+ * @file static_statemachine.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark comparing StaticStatemachine with the heap based Statemachine on the same transition cycle
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+
+using namespace chestnut::fsm;
+
+
+// ========================= Statemachine =========================
+
+class DoorStatemachine : public Statemachine<>
+{
+public:
+    int enterCount = 0;
+};
+
+class DoorClosed : public State<DoorStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override { getParent().enterCount++; }
+};
+
+class DoorOpening : public State<DoorStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override { getParent().enterCount++; }
+};
+
+class DoorOpen : public State<DoorStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override { getParent().enterCount++; }
+};
+
+class DoorClosing : public State<DoorStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override { getParent().enterCount++; }
+};
+
+
+
+// ========================= StaticStatemachine =========================
+
+struct StaticDoorClosed;
+struct StaticDoorOpening;
+struct StaticDoorOpen;
+struct StaticDoorClosing;
+
+using StaticDoorStatemachine = StaticStatemachine<StaticDoorClosed, StaticDoorOpening, StaticDoorOpen, StaticDoorClosing>;
+
+// in the static statemachine state counts what the statemachine did above, so it's not part of the statemachine's size
+static int staticEnterCount = 0;
+
+struct StaticDoorClosed
+{
+    void onEnterState(StateTransition transition) { staticEnterCount++; }
+};
+
+struct StaticDoorOpening
+{
+    void onEnterState(StateTransition transition) { staticEnterCount++; }
+};
+
+struct StaticDoorOpen
+{
+    void onEnterState(StateTransition transition) { staticEnterCount++; }
+};
+
+struct StaticDoorClosing
+{
+    void onEnterState(StateTransition transition) { staticEnterCount++; }
+};
+
+
+
+int main(int argc, char const *argv[])
+{
+    const std::size_t iterations = 2000000;
+
+    DoorStatemachine door;
+    door.initState<DoorClosed>();
+
+    double dynamicNs = measureNanosecondsPerOp(iterations, [&door] {
+        door.pushState<DoorOpening>();
+        door.gotoState<DoorOpen>();
+        door.gotoState<DoorClosing>();
+        door.popState();
+    }) / 4.0;
+    printResult("[Statemachine] transition", dynamicNs);
+
+
+    StaticDoorStatemachine staticDoor;
+    staticDoor.initState<StaticDoorClosed>();
+
+    double staticNs = measureNanosecondsPerOp(iterations, [&staticDoor] {
+        staticDoor.gotoState<StaticDoorOpening>();
+        staticDoor.gotoState<StaticDoorOpen>();
+        staticDoor.gotoState<StaticDoorClosing>();
+        staticDoor.gotoState<StaticDoorClosed>();
+    }) / 4.0;
+    printResult("[StaticStatemachine] transition", staticNs);
+
+    printf("\nspeedup: %.1fx\n", dynamicNs / staticNs);
+    printf("footprint: Statemachine %zu bytes + %zu bytes per heap state, StaticStatemachine %zu bytes\n",
+        sizeof(DoorStatemachine), sizeof(DoorClosed), sizeof(StaticDoorStatemachine));
+
+    doNotOptimize(door.enterCount);
+    doNotOptimize(staticEnterCount);
+
+    return 0;
+}
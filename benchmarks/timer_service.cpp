@@ -0,0 +1,143 @@
+/**
+ * @file timer_service.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark of TimerService and timeout transitions of many statemachines driven by one thread
+ * @details
+ * Scheduling and cancelling a timer should cost the same no matter how many other timers are pending.
+ * The last part runs a population of statemachines, each of which keeps going back and forth between two states on timeouts.
+ * Time is simulated with advanceTicks(), so the results show only the cost of the timers and transitions.
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/timed_statemachine.hpp>
+
+#include <memory>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+class TimeoutStatemachine : public TimedStatemachine<> {};
+
+class StateIdle;
+class StateBusy;
+
+// delays are spread over many slots and levels of the wheel
+std::chrono::milliseconds delayFor(std::size_t i)
+{
+    return std::chrono::milliseconds(1 + (i * 7919) % 5000);
+}
+
+class StateIdle : public State<TimeoutStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override
+    {
+        getParent().gotoStateAfter<StateBusy>(delayFor(transitions++));
+    }
+
+    static std::size_t transitions;
+};
+std::size_t StateIdle::transitions = 0;
+
+class StateBusy : public State<TimeoutStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override
+    {
+        // a timeout that never fires, because the state is always left sooner
+        getParent().gotoStateAfter<StateIdle>(std::chrono::seconds(10));
+        getParent().gotoStateAfter<StateIdle>(delayFor(StateIdle::transitions++));
+    }
+};
+
+
+double runScheduleCancel(std::size_t pendingCount)
+{
+    TimerService timers(std::chrono::milliseconds(1), TimerService::ClockType::time_point());
+
+    for(std::size_t i = 0; i < pendingCount; i++)
+    {
+        timers.schedule(delayFor(i), [] {});
+    }
+
+    std::size_t i = 0;
+    return measureNanosecondsPerOp(1000000, [&timers, &i] {
+        TimerHandle handle = timers.schedule(delayFor(i++), [] {});
+        timers.cancel(handle);
+    });
+}
+
+double runExpire(std::size_t timerCount)
+{
+    TimerService timers(std::chrono::milliseconds(1), TimerService::ClockType::time_point());
+    std::size_t fired = 0;
+
+    for(std::size_t i = 0; i < timerCount; i++)
+    {
+        timers.schedule(delayFor(i), [&fired] { fired++; });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    timers.advanceTicks(5001);
+    auto end = std::chrono::steady_clock::now();
+
+    doNotOptimize(fired);
+    return std::chrono::duration<double, std::nano>(end - start).count() / double(fired);
+}
+
+double runMachines(std::size_t machineCount)
+{
+    TimerService timers(std::chrono::milliseconds(1), TimerService::ClockType::time_point());
+
+    std::vector<std::unique_ptr<TimeoutStatemachine>> machines;
+    for(std::size_t i = 0; i < machineCount; i++)
+    {
+        machines.emplace_back(new TimeoutStatemachine());
+        machines.back()->setPersistentStates(true);
+        machines.back()->setTimerService(&timers);
+        machines.back()->initState<StateIdle>();
+    }
+
+    // warm up, so that all states and timers are allocated
+    timers.advanceTicks(10000);
+
+    std::size_t transitionsBefore = StateIdle::transitions;
+    auto start = std::chrono::steady_clock::now();
+    timers.advanceTicks(20000);
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / double(StateIdle::transitions - transitionsBefore);
+}
+
+int main(int argc, char const *argv[])
+{
+    char name[128];
+
+    for(std::size_t count : {1000, 100000, 1000000})
+    {
+        snprintf(name, sizeof(name), "[%zu pending] schedule + cancel", count);
+        printResult(name, runScheduleCancel(count));
+    }
+
+    for(std::size_t count : {1000, 100000, 1000000})
+    {
+        snprintf(name, sizeof(name), "[%zu timers] expire, per timer", count);
+        printResult(name, runExpire(count));
+    }
+
+    for(std::size_t count : {1000, 100000})
+    {
+        snprintf(name, sizeof(name), "[%zu machines] timeout transition", count);
+        printResult(name, runMachines(count));
+    }
+
+    return 0;
+}
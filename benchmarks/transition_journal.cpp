@@ -0,0 +1,130 @@
+/**
+ * @file transition_journal.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark of transitions appended to a TransitionJournal with every durability setting, and of replaying the journal
+ * @details
+ * The journal is written to the current directory and removed afterwards.
+ * With JOURNAL_DURABILITY_SYNC several threads make transitions at once, to show how many records a single sync covers.
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/transition_journal.hpp>
+
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+class BenchStatemachine : public Statemachine<> {};
+
+class StateIdle : public State<BenchStatemachine> {};
+class StateWalking : public State<BenchStatemachine> {};
+class StateRunning : public State<BenchStatemachine> {};
+
+static const char *journalPath = "transition_journal.log";
+
+
+// Makes a cycle of 4 transitions per iteration, 2 gotos, a push and a pop
+static void runMachine(BenchStatemachine& machine, std::size_t iterations)
+{
+    for(std::size_t i = 0; i < iterations; i++)
+    {
+        machine.gotoState<StateWalking>();
+        machine.pushState<StateRunning>();
+        machine.popState();
+        machine.gotoState<StateIdle>();
+    }
+}
+
+static void runCase(const char *name, EJournalDurability durability, std::size_t threadCount, std::size_t iterations)
+{
+    std::remove(journalPath);
+
+    TransitionJournalConfig config;
+    config.durability = durability;
+
+    TransitionJournal journal;
+    if(!journal.open(journalPath, config))
+    {
+        fprintf(stderr, "Failed to open %s\n", journalPath);
+        std::exit(1);
+    }
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for(std::size_t t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&journal, t, iterations] {
+            BenchStatemachine machine;
+            machine.initState<StateIdle>();
+            TransitionJournalObserver observer(journal, t);
+            machine.attachObserver(observer);
+            runMachine(machine, iterations);
+            machine.detachObserver(observer);
+        });
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    journal.sync();
+    auto end = std::chrono::steady_clock::now();
+
+    const double transitions = double(journal.getLastSequence());
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count() / transitions;
+    printf("%-48s %10.2f ns/op %8.1f records/sync\n", name, ns, transitions / double(std::max<std::uint64_t>(1, journal.getSyncCount())));
+}
+
+
+int main(int argc, char const *argv[])
+{
+    const std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 250000;
+
+    BenchStatemachine machine;
+    machine.initState<StateIdle>();
+    double ns = measureNanosecondsPerOp(iterations, [&machine] { runMachine(machine, 1); }) / 4.0;
+    printResult("transition without journal", ns);
+
+    runCase("transition, JOURNAL_DURABILITY_NONE", JOURNAL_DURABILITY_NONE, 1, iterations);
+    runCase("transition, JOURNAL_DURABILITY_ASYNC", JOURNAL_DURABILITY_ASYNC, 1, iterations);
+    runCase("transition, JOURNAL_DURABILITY_SYNC, 1 thread", JOURNAL_DURABILITY_SYNC, 1, iterations / 250);
+    runCase("transition, JOURNAL_DURABILITY_SYNC, 8 threads", JOURNAL_DURABILITY_SYNC, 8, iterations / 250);
+
+    runCase("transition, JOURNAL_DURABILITY_ASYNC, 8 threads", JOURNAL_DURABILITY_ASYNC, 8, iterations / 8);
+
+    // the journal of the last case is replayed into statemachines standing for the ones from the threads
+    std::vector<std::unique_ptr<BenchStatemachine>> machines;
+    for(std::size_t t = 0; t < 8; t++)
+    {
+        machines.emplace_back(new BenchStatemachine());
+        machines.back()->initState<StateIdle>();
+    }
+
+    TransitionJournalReader reader;
+    auto start = std::chrono::steady_clock::now();
+    const std::int64_t replayedCount = reader.open(journalPath) ? reader.replay<StateIdle, StateWalking, StateRunning>(0, [&machines](std::uint64_t machineId) {
+        return machineId < machines.size() ? machines[machineId].get() : nullptr;
+    }) : -1;
+    auto end = std::chrono::steady_clock::now();
+
+    std::remove(journalPath);
+
+    if(replayedCount < 0)
+    {
+        fprintf(stderr, "Failed to replay the journal\n");
+        return 1;
+    }
+    printResult("replay of a record", std::chrono::duration<double, std::nano>(end - start).count() / double(replayedCount));
+
+    return 0;
+}
@@ -0,0 +1,367 @@
+/**
+ * @file transition_latency.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Harness measuring the latency distribution of single transitions, optionally with threads contending for the machine
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ * @details
+ * Runs a long random mix of gotoState, pushState and popState over states of different sizes and times every
+ * transition on its own with readTraceTimestamp(). Latencies go to a Histogram, from which p50, p90, p99, p999, max,
+ * standard deviation and jitter (p999 - p50) are reported in nanoseconds. The cost of reading the timestamp twice
+ * is reported separately and not subtracted.
+ *
+ * Background threads, if requested, keep allocating and freeing memory of random sizes and writing to shared
+ * cache lines, so transitions compete with them for the allocator, caches and the CPU.
+ *
+ * Usage: TransitionLatencyBenchmark [--transitions <count>] [--threads <count>] [--json <path>]
+ *                                   [--max-p99 <ns>] [--max-p999 <ns>]
+ * With --max-p99 or --max-p999 the program exits with 2 if the Statemachine case exceeds the limit, so it can gate a release.
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/histogram.hpp>
+#include <chestnut/fsm/transition_tracer.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifndef CHESTNUT_FSM_BENCHMARK_VERSION
+    #define CHESTNUT_FSM_BENCHMARK_VERSION "unknown"
+#endif
+
+using namespace chestnut::fsm;
+
+
+class LatencyStatemachine : public Statemachine<>
+{
+public:
+    int callbackCount = 0;
+};
+
+template<std::size_t Size>
+class SizedState : public State<LatencyStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override { getParent().callbackCount++; }
+    void onLeaveState(StateTransition transition) override { getParent().callbackCount++; }
+
+private:
+    unsigned char m_payload[Size] = {};
+};
+
+// sizes in different allocator size classes
+class TinyState : public SizedState<16> {};
+class SmallState : public SizedState<64> {};
+class MediumState : public SizedState<256> {};
+class LargeState : public SizedState<2048> {};
+
+
+static int staticCallbackCount = 0;
+
+#define STATIC_STATE(name) \
+    struct name \
+    { \
+        void onEnterState(StateTransition transition) { staticCallbackCount++; } \
+        void onLeaveState(StateTransition transition) { staticCallbackCount++; } \
+    };
+
+STATIC_STATE(StaticTiny)
+STATIC_STATE(StaticSmall)
+STATIC_STATE(StaticMedium)
+STATIC_STATE(StaticLarge)
+
+using LatencyStaticStatemachine = StaticStatemachine<StaticTiny, StaticSmall, StaticMedium, StaticLarge>;
+
+
+
+// Same sequence of operations for every run
+class Random
+{
+public:
+    std::uint32_t next()
+    {
+        m_state = m_state * 6364136223846793005ull + 1442695040888963407ull;
+        return (std::uint32_t)( m_state >> 33 );
+    }
+
+private:
+    std::uint64_t m_state = 0x2545F4914F6CDD1Dull;
+};
+
+
+struct LatencyResult
+{
+    const char *name;
+    Histogram histogram;
+    double sumOfSquares = 0.0;
+};
+
+struct LatencySummary
+{
+    double p50, p90, p99, p999, max, mean, stddev, jitter;
+};
+
+static LatencySummary summarize(const LatencyResult& result, double ticksPerNanosecond)
+{
+    const Histogram& h = result.histogram;
+    auto ns = [ticksPerNanosecond](double ticks) { return ticks / ticksPerNanosecond; };
+
+    LatencySummary summary;
+    summary.p50 = ns(double(h.getValueAtPercentile(50.0)));
+    summary.p90 = ns(double(h.getValueAtPercentile(90.0)));
+    summary.p99 = ns(double(h.getValueAtPercentile(99.0)));
+    summary.p999 = ns(double(h.getValueAtPercentile(99.9)));
+    summary.max = ns(double(h.getMax()));
+    summary.mean = ns(h.getMean());
+    const double count = double(h.getTotalCount());
+    const double variance = count > 0 ? result.sumOfSquares / count - h.getMean() * h.getMean() : 0.0;
+    summary.stddev = ns(std::sqrt(variance > 0.0 ? variance : 0.0));
+    summary.jitter = summary.p999 - summary.p50;
+    return summary;
+}
+
+// Times a single operation and records it
+template<typename F>
+inline void timeTransition(LatencyResult& result, F&& f)
+{
+    const std::uint64_t start = readTraceTimestamp();
+    f();
+    const std::uint64_t ticks = readTraceTimestamp() - start;
+
+    result.histogram.record(ticks);
+    result.sumOfSquares += double(ticks) * double(ticks);
+}
+
+
+template<typename F>
+static void gotoRandomState(Random& random, F&& gotoState)
+{
+    switch(random.next() % 4)
+    {
+    case 0: gotoState((TinyState *)nullptr); break;
+    case 1: gotoState((SmallState *)nullptr); break;
+    case 2: gotoState((MediumState *)nullptr); break;
+    default: gotoState((LargeState *)nullptr); break;
+    }
+}
+
+static void runStatemachine(LatencyResult& result, std::size_t transitionCount, bool isPersistent)
+{
+    const int maxDepth = 16;
+
+    Random random;
+    LatencyStatemachine sm;
+    sm.setPersistentStates(isPersistent);
+    sm.initState<TinyState>();
+
+    for(std::size_t i = 0; i < transitionCount; i++)
+    {
+        const std::uint32_t roll = random.next() % 8;
+        const int depth = sm.getStateStackSize();
+
+        if(roll < 2 && depth < maxDepth)
+        {
+            gotoRandomState(random, [&](auto *type) {
+                using StateType = std::remove_pointer_t<decltype(type)>;
+                timeTransition(result, [&sm] { sm.pushState<StateType>(); });
+            });
+        }
+        else if(roll < 4 && depth > 1)
+        {
+            timeTransition(result, [&sm] { sm.popState(); });
+        }
+        else
+        {
+            gotoRandomState(random, [&](auto *type) {
+                using StateType = std::remove_pointer_t<decltype(type)>;
+                timeTransition(result, [&sm] { sm.gotoState<StateType>(); });
+            });
+        }
+    }
+
+    doNotOptimize(sm.callbackCount);
+}
+
+static void runStaticStatemachine(LatencyResult& result, std::size_t transitionCount)
+{
+    Random random;
+    LatencyStaticStatemachine sm;
+    sm.initState<StaticTiny>();
+
+    for(std::size_t i = 0; i < transitionCount; i++)
+    {
+        switch(random.next() % 4)
+        {
+        case 0: timeTransition(result, [&sm] { sm.gotoState<StaticTiny>(); }); break;
+        case 1: timeTransition(result, [&sm] { sm.gotoState<StaticSmall>(); }); break;
+        case 2: timeTransition(result, [&sm] { sm.gotoState<StaticMedium>(); }); break;
+        default: timeTransition(result, [&sm] { sm.gotoState<StaticLarge>(); }); break;
+        }
+    }
+
+    doNotOptimize(staticCallbackCount);
+}
+
+static void runTimerOverhead(LatencyResult& result, std::size_t transitionCount)
+{
+    for(std::size_t i = 0; i < transitionCount; i++)
+    {
+        timeTransition(result, [] {});
+    }
+}
+
+
+// Keeps the allocator and shared cache lines busy until stopped
+static void contend(std::atomic<bool>& isRunning, std::atomic<std::uint64_t>& sharedCounter, unsigned seed)
+{
+    std::vector<void *> blocks(64, nullptr);
+    std::uint64_t state = seed;
+
+    while(isRunning.load(std::memory_order_relaxed))
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        void *&block = blocks[(state >> 33) % blocks.size()];
+        free(block);
+        block = malloc(16 + (state >> 40) % 4096);
+        sharedCounter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    for(void *block : blocks)
+    {
+        free(block);
+    }
+}
+
+
+static bool writeJson(const char *path, const std::vector<LatencyResult>& results, double ticksPerNanosecond, unsigned threadCount)
+{
+    const bool isStdout = std::strcmp(path, "-") == 0;
+    FILE *file = isStdout ? stdout : fopen(path, "w");
+    if(!file)
+    {
+        return false;
+    }
+
+    fprintf(file, "{\n  \"benchmark\": \"TransitionLatencyBenchmark\",\n  \"version\": \"%s\",\n  \"background_threads\": %u,\n  \"results\": [\n",
+        CHESTNUT_FSM_BENCHMARK_VERSION, threadCount);
+    for(std::size_t i = 0; i < results.size(); i++)
+    {
+        const LatencySummary s = summarize(results[i], ticksPerNanosecond);
+        fprintf(file, "    { \"name\": \"%s\", \"count\": %llu, \"p50_ns\": %.1f, \"p90_ns\": %.1f, \"p99_ns\": %.1f, \"p999_ns\": %.1f, "
+                      "\"max_ns\": %.1f, \"mean_ns\": %.2f, \"stddev_ns\": %.2f, \"jitter_ns\": %.1f }%s\n",
+            results[i].name, (unsigned long long)results[i].histogram.getTotalCount(),
+            s.p50, s.p90, s.p99, s.p999, s.max, s.mean, s.stddev, s.jitter, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    if(!isStdout)
+    {
+        fclose(file);
+    }
+    return true;
+}
+
+
+
+int main(int argc, char const *argv[])
+{
+    std::size_t transitionCount = 2000000;
+    unsigned threadCount = 0;
+    const char *jsonPath = nullptr;
+    double maxP99 = 0.0;
+    double maxP999 = 0.0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if(std::strcmp(argv[i], "--transitions") == 0 && hasValue)
+        {
+            transitionCount = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--threads") == 0 && hasValue)
+        {
+            threadCount = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--json") == 0 && hasValue)
+        {
+            jsonPath = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--max-p99") == 0 && hasValue)
+        {
+            maxP99 = std::strtod(argv[++i], nullptr);
+        }
+        else if(std::strcmp(argv[i], "--max-p999") == 0 && hasValue)
+        {
+            maxP999 = std::strtod(argv[++i], nullptr);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--transitions <count>] [--threads <count>] [--json <path>] [--max-p99 <ns>] [--max-p999 <ns>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::atomic<bool> isRunning { true };
+    std::atomic<std::uint64_t> sharedCounter { 0 };
+    std::vector<std::thread> threads;
+    for(unsigned i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back(contend, std::ref(isRunning), std::ref(sharedCounter), i + 1);
+    }
+
+    const std::uint64_t startTicks = readTraceTimestamp();
+    const auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<LatencyResult> results(4);
+    results[0].name = "timer overhead";
+    results[1].name = "Statemachine";
+    results[2].name = "Statemachine persistent";
+    results[3].name = "StaticStatemachine";
+
+    runTimerOverhead(results[0], transitionCount);
+    runStatemachine(results[1], transitionCount, false);
+    runStatemachine(results[2], transitionCount, true);
+    runStaticStatemachine(results[3], transitionCount);
+
+    const double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+    const double ticksPerNanosecond = double(readTraceTimestamp() - startTicks) / elapsedNs;
+
+    isRunning.store(false);
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    printf("%zu transitions per case, %u background threads, all times in ns\n\n", transitionCount, threadCount);
+    printf("%-26s %9s %9s %9s %9s %11s %9s %9s %9s\n", "case", "p50", "p90", "p99", "p999", "max", "mean", "stddev", "jitter");
+    for(const LatencyResult& result : results)
+    {
+        const LatencySummary s = summarize(result, ticksPerNanosecond);
+        printf("%-26s %9.1f %9.1f %9.1f %9.1f %11.1f %9.2f %9.2f %9.1f\n",
+            result.name, s.p50, s.p90, s.p99, s.p999, s.max, s.mean, s.stddev, s.jitter);
+    }
+
+    if(jsonPath && !writeJson(jsonPath, results, ticksPerNanosecond, threadCount))
+    {
+        fprintf(stderr, "Could not write %s\n", jsonPath);
+        return 1;
+    }
+
+    const LatencySummary gated = summarize(results[1], ticksPerNanosecond);
+    if((maxP99 > 0.0 && gated.p99 > maxP99) || (maxP999 > 0.0 && gated.p999 > maxP999))
+    {
+        fprintf(stderr, "Statemachine tail latency over the limit: p99 %.1f ns, p999 %.1f ns\n", gated.p99, gated.p999);
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file transition_metrics.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark measuring the cost of collecting dwell times and transition counts with TransitionMetrics
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ * @details
+ * Metrics are collected only in this program. The same transition cycle without metrics is measured by StaticStatemachineBenchmark.
+ */
+
+#define CHESTNUT_FSM_COLLECT_METRICS 1
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/transition_metrics.hpp>
+
+using namespace chestnut::fsm;
+
+
+class DoorStatemachine : public Statemachine<>
+{
+public:
+    int enterCount = 0;
+};
+
+class DoorClosed : public State<DoorStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override { getParent().enterCount++; }
+};
+
+class DoorOpening : public State<DoorStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override { getParent().enterCount++; }
+};
+
+class DoorOpen : public State<DoorStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override { getParent().enterCount++; }
+};
+
+class DoorClosing : public State<DoorStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override { getParent().enterCount++; }
+};
+
+
+
+int main(int argc, char const *argv[])
+{
+    const std::size_t iterations = 2000000;
+
+    DoorStatemachine door;
+    door.initState<DoorClosed>();
+
+    double metricsNs = measureNanosecondsPerOp(iterations, [&door] {
+        door.pushState<DoorOpening>();
+        door.gotoState<DoorOpen>();
+        door.gotoState<DoorClosing>();
+        door.popState();
+    }) / 4.0;
+    printResult("[Statemachine with metrics] transition", metricsNs);
+
+    MetricsSnapshot snapshot;
+    double snapshotNs = measureNanosecondsPerOp(100, [&snapshot] {
+        snapshot = TransitionMetrics::snapshot();
+    });
+    printResult("[TransitionMetrics] snapshot", snapshotNs);
+
+
+    printf("\n%-16s %12s %10s %10s %10s\n", "state", "count", "p50 ns", "p99 ns", "max ns");
+    for(const StateDwellMetrics& state : snapshot.states)
+    {
+        const Histogram& dwellTime = state.dwellTime;
+        printf("%-16s %12llu %10.1f %10.1f %10.1f\n", getStateTypeName(state.state), (unsigned long long)dwellTime.getTotalCount(),
+            double(dwellTime.getValueAtPercentile(50.0)) / snapshot.ticksPerNanosecond,
+            double(dwellTime.getValueAtPercentile(99.0)) / snapshot.ticksPerNanosecond,
+            double(dwellTime.getMax()) / snapshot.ticksPerNanosecond);
+    }
+
+    printf("\n");
+    for(const TransitionCountMetrics& transition : snapshot.transitions)
+    {
+        printf("%-16s -> %-16s %12llu\n",
+            transition.prevState != NULL_STATE ? getStateTypeName(transition.prevState) : "(init)",
+            transition.nextState != NULL_STATE ? getStateTypeName(transition.nextState) : "(destroy)",
+            (unsigned long long)transition.count);
+    }
+
+    doNotOptimize(door.enterCount);
+
+    return 0;
+}
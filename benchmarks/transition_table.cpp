@@ -0,0 +1,94 @@
+/**
+ * @file transition_table.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark of event dispatch through a TransitionTable compared to imperative transitions from state methods
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+
+#include <utility>
+
+using namespace chestnut::fsm;
+
+
+constexpr int RING_SIZE = 16;
+
+struct EventNext {};
+// event that is only handled by the last state in the ring
+struct EventReset {};
+
+class RingStateExtension
+{
+public:
+    virtual void next() = 0;
+};
+
+class RingStatemachine : public Statemachine<RingStateExtension>
+{
+
+};
+
+template< int I >
+class RingState : public State<RingStatemachine>
+{
+public:
+    void next() override
+    {
+        getParent().gotoState< RingState< (I + 1) % RING_SIZE > >();
+    }
+};
+
+
+template< typename Sequence >
+struct RingTableBuilder;
+
+template< int ...Is >
+struct RingTableBuilder< std::integer_sequence<int, Is...> >
+{
+    typedef TransitionTable<
+        TransitionRow< RingState<Is>, EventNext, RingState< (Is + 1) % RING_SIZE > >...,
+        TransitionRow< RingState<RING_SIZE - 1>, EventReset, RingState<0> >
+    > Type;
+};
+
+typedef RingTableBuilder< std::make_integer_sequence<int, RING_SIZE> >::Type RingTable;
+
+
+
+int main(int argc, char const *argv[])
+{
+    const std::size_t iterations = 2000000;
+
+    RingStatemachine imperative;
+    imperative.initState< RingState<0> >();
+
+    printResult( "[virtual method + gotoState] next", measureNanosecondsPerOp( iterations, [&imperative] {
+        imperative.getCurrentState()->next();
+    }));
+
+
+    RingStatemachine declarative;
+    declarative.initState< RingState<0> >();
+
+    printResult( "[processEvent] next", measureNanosecondsPerOp( iterations, [&declarative] {
+        declarative.processEvent<RingTable>( EventNext{} );
+    }));
+
+    // most of the time there's no row for the current state, so nothing happens
+    printResult( "[processEvent] unhandled in most states", measureNanosecondsPerOp( iterations, [&declarative] {
+        declarative.processEvent<RingTable>( EventReset{} );
+        declarative.processEvent<RingTable>( EventNext{} );
+    }) / 2.0 );
+
+    doNotOptimize( imperative.getCurrentStateType() );
+    doNotOptimize( declarative.getCurrentStateType() );
+
+    return 0;
+}
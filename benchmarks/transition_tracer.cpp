@@ -0,0 +1,109 @@
+/**
+ * @file transition_tracer.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Benchmark measuring the cost of recording transitions with TransitionTracer
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ * @details
+ * Tracing is enabled only in this program. The same transition cycle without tracing is measured by StaticStatemachineBenchmark.
+ */
+
+#define CHESTNUT_FSM_TRACE_TRANSITIONS 1
+
+#include "benchmark.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/transition_tracer.hpp>
+
+#include <atomic>
+#include <thread>
+
+using namespace chestnut::fsm;
+
+
+struct Closed {};
+struct Opening {};
+struct Open {};
+struct Closing {};
+
+using DoorStatemachine = StaticStatemachine<Closed, Opening, Open, Closing>;
+
+
+
+int main(int argc, char const *argv[])
+{
+    const std::size_t iterations = 1000000;
+    const std::size_t drainInterval = TransitionTraceBuffer::CAPACITY / 8;
+
+    std::size_t drainedCount = 0;
+    auto countRecord = [&drainedCount]( const TransitionRecord& record ) {
+        drainedCount++;
+        doNotOptimize(record);
+    };
+
+    StateTransition transition;
+    transition.type = STATE_TRANSITION_GOTO;
+    transition.prevState = stateIdOf<Closed>();
+    transition.nextState = stateIdOf<Opening>();
+
+    std::size_t recordCount = 0;
+    double recordNs = measureNanosecondsPerOp(iterations, [&] {
+        TransitionTracer::record(&transition, transition);
+        if(++recordCount % drainInterval == 0)
+        {
+            TransitionTracer::drain(countRecord);
+        }
+    });
+    printResult("[TransitionTracer] record", recordNs);
+
+
+    DoorStatemachine sm;
+    sm.initState<Closed>();
+    TransitionTracer::drain(countRecord);
+
+    std::size_t cycleCount = 0;
+    double tracedNs = measureNanosecondsPerOp(iterations, [&] {
+        sm.gotoState<Opening>();
+        sm.gotoState<Open>();
+        sm.gotoState<Closing>();
+        sm.gotoState<Closed>();
+        if(++cycleCount % ( drainInterval / 4 ) == 0)
+        {
+            TransitionTracer::drain(countRecord);
+        }
+    }) / 4.0;
+    printResult("[StaticStatemachine traced] gotoState", tracedNs);
+
+
+    // a reader thread draining all the time while the statemachine keeps transitioning
+    std::atomic<bool> isRunning { true };
+    std::size_t concurrentDrainedCount = 0;
+    std::thread reader([&isRunning, &concurrentDrainedCount] {
+        while(isRunning.load(std::memory_order_relaxed))
+        {
+            concurrentDrainedCount += TransitionTracer::drain([](const TransitionRecord& record) { doNotOptimize(record); });
+            std::this_thread::yield();
+        }
+    });
+
+    const std::uint64_t droppedBefore = TransitionTracer::getDroppedCount();
+    double concurrentNs = measureNanosecondsPerOp(iterations, [&sm] {
+        sm.gotoState<Opening>();
+        sm.gotoState<Open>();
+        sm.gotoState<Closing>();
+        sm.gotoState<Closed>();
+    }) / 4.0;
+    printResult("[StaticStatemachine traced] gotoState, reader", concurrentNs);
+
+    isRunning.store(false);
+    reader.join();
+    concurrentDrainedCount += TransitionTracer::drain([](const TransitionRecord& record) { doNotOptimize(record); });
+
+    printf("\nrecords drained: %zu, by a concurrent reader: %zu, dropped while it was reading: %llu\n",
+        drainedCount, concurrentDrainedCount, (unsigned long long)( TransitionTracer::getDroppedCount() - droppedBefore ));
+
+    return 0;
+}
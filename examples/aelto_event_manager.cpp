@@ -32,12 +32,20 @@
 
 int main(int argc, char const *argv[])
 {
+    TimerService timers( std::chrono::milliseconds(10) );
+
     CRandomEncounters master;
     RER_EventsManager manager(master);
+    manager.setTimerService(&timers);
 
-    // this goes on a never ending loop
     manager.start();
 
+    // this goes on a never ending loop, states wait for their delays on the timer service
+    while(true) {
+        Sleep(10);
+        timers.advance( TimerService::ClockType::now() );
+    }
+
     return 0;
 }
 
@@ -2,7 +2,7 @@
 
 #include <vector>
 
-#include <chestnut/fsm/statemachine.hpp>
+#include <chestnut/fsm/timed_statemachine.hpp>
 using namespace chestnut::fsm;
 
 #include "doubles.hpp"
@@ -10,7 +10,7 @@ using namespace chestnut::fsm;
 class RER_EventsManagerStateStarting;
 
 
-class RER_EventsManager : public Statemachine<>
+class RER_EventsManager : public TimedStatemachine<>
 {
 public:
 	std::vector<RER_EventsListener> listeners;
@@ -24,6 +24,10 @@ public:
 	RER_EventsManager(CRandomEncounters master) {
 		this->master = master;
 
+		// states of this manager keep transitioning between each other from inside onEnterState forever
+		// in run-to-completion mode these transitions are queued instead of nested, so the call stack doesn't grow
+		this->setRunToCompletion(true);
+
 		this->addListener(RER_EventsListener());
 		this->addListener(RER_EventsListener());
 		this->addListener(RER_EventsListener());
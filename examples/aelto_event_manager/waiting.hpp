@@ -19,9 +19,8 @@ public:
     void Waiting_main() {
 		LogChannel("modRandomEncounters", "RER_EventsManager - Waiting_main()");
 
-		Sleep(getParent().delay);
-
-		getParent().gotoState<RER_EventsManagerStateListeningForEvents>();
+		// instead of blocking in Sleep(delay), the timer service of the manager fires the transition later
+		getParent().gotoStateAfter<RER_EventsManagerStateListeningForEvents>( std::chrono::duration<float,std::milli>(getParent().delay) );
     }
 
 
@@ -16,7 +16,7 @@
 // ================= 0. (Optional) For convenience include fsm.hpp and do a 'using' on namespace ====================
 
 // 0.1
-// fsm.hpp includes all other headers mentioned below
+// fsm.hpp includes all other headers mentioned below, except for the extension headers like timed_statemachine.hpp
 #include <chestnut/fsm/fsm.hpp>
 // 0.2
 // Writing this long two-part namespace every time can be annoying :) 
@@ -65,12 +65,20 @@ class CDoorStateClosed; // forward declaration because of usage in CDoorStatemac
 
 // ...If you decided to use a state extension class, in the template parameter of chestnut::fsm::Statemachine
 // input this type. Otherwise you can just write chestnut::fsm::Statemachine<> for a basic setup
-class CDoorStatemachine : public Statemachine<DoorStateExtension>
+//
+// (Optional) Door opens and closes by itself after some time, so the statemachine is wrapped in chestnut::fsm::TimedStatemachine,
+// which adds delayed transitions (see point 2.7.). It's an extension, so it has to be included explicitly
+
+#include <chestnut/fsm/timed_statemachine.hpp>
+
+class CDoorStatemachine : public TimedStatemachine< Statemachine<DoorStateExtension> >
 {
 public:
     // 1.4. (Optional) 
     // You can make your statemachine able to be used across threads in an async manner
     // The base Statemachine type does not support multithreading, so you'll have to set up the necessary precautions yourself
+    // Alternatively wrap the statemachine in chestnut::fsm::ConcurrentStatemachine, so that other threads can post transition requests 
+    // without locking anything and a single thread executes them
     mutable std::mutex doorMutex;
 
 
@@ -215,13 +223,11 @@ public:
 	{
 		std::cout << "The door is openning...\n";
 
-		// spawn a thread that'll wait 2 seconds and then transition to next state
-		std::thread( [this] {
-			std::this_thread::sleep_for( std::chrono::seconds(2) );
-			// we're in a different thread, we have to lock the parent
-			std::lock_guard<std::mutex> lock( getParent().doorMutex );
-			getParent().gotoState<CDoorStateOpen>();
-		}).detach();
+		// 2.7. (Optional)
+		// Schedule a transition to happen after some time instead of spawning a thread that sleeps
+		// It's executed by the thread that drives the statemachine's TimerService (see point 3.2.) 
+		// and cancelled automatically if this state is left before that
+		getParent().gotoStateAfter<CDoorStateOpen>( std::chrono::seconds(2) );
 	}
 
     void onLeaveState( StateTransition transition ) override
@@ -296,12 +302,7 @@ public:
 	{
 		std::cout << "The door is closing...\n";
 
-		std::thread( [this] {
-			std::this_thread::sleep_for( std::chrono::seconds(2) );
-			// we're in a different thread, we have to lock the parent
-			std::lock_guard<std::mutex> lock( getParent().doorMutex );
-			getParent().popState();
-		}).detach();
+		getParent().popStateAfter( std::chrono::seconds(2) );
 	}
 
     void onLeaveState( StateTransition transition ) override
@@ -331,23 +332,31 @@ public:
 
 // ===================== 3. Use your statemachine object =====================
 
-const char *doorStateTypeToString( std::type_index type )
+// 3.1. (Optional)
+// Every state type gets its own integer identifier, which you can obtain with stateIdOf()
+// getCurrentStateType() returns such identifier for the current state, so you can compare it with these of known states
+const char *doorStateTypeToString( StateId type )
 {
-    if( type == typeid(CDoorStateOpen ) )
+    if( type == stateIdOf<CDoorStateOpen>() )
         return "Open";
-    if( type == typeid(CDoorStateOpening ) )
+    if( type == stateIdOf<CDoorStateOpening>() )
         return "Opening";
-    if( type == typeid(CDoorStateClosed ) )
+    if( type == stateIdOf<CDoorStateClosed>() )
         return "Closed";
-    if( type == typeid(CDoorStateClosing ) )
+    if( type == stateIdOf<CDoorStateClosing>() )
         return "Closing";
     return "";
 }
 
 int main(int argc, char const *argv[])
 {
+    // 3.2. (Optional)
+    // Delayed transitions need a TimerService. One service can be shared by any number of statemachines.
+    // Timers fire when the thread using the statemachines calls advance(), so no other threads are involved
+    TimerService timers( std::chrono::milliseconds(10) );
 
     CDoorStatemachine door;
+    door.setTimerService( &timers );
 
     auto printDoorState = [&door] {
         std::cout << "Door state: " << doorStateTypeToString( door.getCurrentStateType() ) << "; state stack size: " << door.getStateStackSize() << "\n";
@@ -365,6 +374,7 @@ int main(int argc, char const *argv[])
         while( door.isCurrentlyInState<CDoorStateOpening>() )
         {
             std::this_thread::sleep_for( std::chrono::milliseconds(100) ); // we'll keep waiting small intervals until the door fully opens
+            timers.advance( TimerService::ClockType::now() );
         }
 
         printDoorState();
@@ -376,6 +386,7 @@ int main(int argc, char const *argv[])
             while( door.isCurrentlyInState<CDoorStateClosing>() )
             {
                 std::this_thread::sleep_for( std::chrono::milliseconds(100) );
+                timers.advance( TimerService::ClockType::now() );
             }
 
             printDoorState();
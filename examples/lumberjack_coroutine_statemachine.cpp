@@ -0,0 +1,119 @@
+/**
+ * @example lumberjack_coroutine_statemachine.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief The lumberjack simulation ported to coroutine states and a single thread
+ * @details
+ * The same simulation as in lumberjack_statemachine.cpp, but instead of launching a thread for each lumberjack 
+ * their states are CoroutineStates which co_await delays rather than sleeping. 
+ * One thread advances the TimerService shared by all lumberjacks and it resumes the states whose wait is over,
+ * so the simulation could run any number of lumberjacks without adding threads. Requires C++20.
+ * @version 3.0.0
+ * @date 2026-10-16
+ * 
+ * @copyright MIT License (c) 2021-2022
+ * 
+ * @include lumberjack_coroutine_statemachine/lumberjack.hpp
+ * lumberjack.hpp
+ * @include lumberjack_coroutine_statemachine/lumberjack_states/searching.hpp
+ * searching.hpp
+ * @include lumberjack_coroutine_statemachine/lumberjack_states/harvesting.hpp
+ * harvesting.hpp
+ * @include lumberjack_coroutine_statemachine/lumberjack_states/collecting.hpp
+ * collecting.hpp
+ * @include lumberjack_coroutine_statemachine/lumberjack_states/finished.hpp
+ * finished.hpp
+ */
+
+#include "lumberjack_coroutine_statemachine/lumberjack.hpp"
+#include "lumberjack_coroutine_statemachine/lumberjack_states/finished.hpp"
+#include "lumberjack_coroutine_statemachine/lumberjack_states/searching.hpp"
+#include "lumberjack_coroutine_statemachine/lumberjack_states/harvesting.hpp"
+#include "lumberjack_coroutine_statemachine/lumberjack_states/collecting.hpp"
+
+#include <thread>
+
+int main()
+{
+    Forest forest({
+        // trees positions and wood counts
+        {{1.f, 5.f}, 4},
+        {{5.f, 8.f}, 3},
+        {{-6.f, 1.f}, 2},
+        {{0.f, -10.f}, 6},
+    });
+
+    chestnut::fsm::TimerService timers(std::chrono::milliseconds(10));
+
+    Lumberjack lumberjack1(1, &forest, &timers, 1.f, 1.f, 4);
+    lumberjack1.setPosition({0.f, 0.f});
+    lumberjack1.setCollectionPoint({0.f, 0.f});
+    Lumberjack lumberjack2(2, &forest, &timers, 1.5f, 0.6f, 6);
+    lumberjack2.setPosition({5.f, 6.f});
+    lumberjack2.setCollectionPoint({5.f, 0.f});
+
+    lumberjack1.startWork();
+    lumberjack2.startWork();
+
+    // this is the only thread, it just keeps the time going
+    while(lumberjack1.isWorking() || lumberjack2.isWorking())
+    {
+        std::this_thread::sleep_for(timers.getTickDuration());
+        timers.advance(chestnut::fsm::TimerService::ClockType::now());
+    }
+
+    return 0;
+}
+
+/* CONSOLE OUTPUT
+Lumberjack 1 started working
+Lumberjack 1 started searching for a tree to chop
+Lumberjack 1 started walking to tree at (1.000000, 5.000000)
+Lumberjack 2 started working
+Lumberjack 2 started searching for a tree to chop
+Lumberjack 2 started walking to tree at (5.000000, 8.000000)
+Lumberjack 2 walked to tree at (5.000000, 8.000000)
+Lumberjack 2 started harvesting a tree at (5.000000, 8.000000)
+Lumberjack 1 walked to tree at (1.000000, 5.000000)
+Lumberjack 1 started harvesting a tree at (1.000000, 5.000000)
+Lumberjack 2 finished harvesting a tree at (5.000000, 8.000000)
+Lumberjack 2 started searching for a tree to chop
+Lumberjack 2 started walking to tree at (1.000000, 5.000000)
+Lumberjack 1 has to drop the wood at the collection point (0.000000, 0.000000)
+Lumberjack 1 started walking to the collection point
+Lumberjack 2 decided to try change the target tree
+Lumberjack 2 started walking to tree at (-6.000000, 1.000000)
+Lumberjack 1 dropped the collected wood
+Lumberjack 1 started searching for a tree to chop
+Lumberjack 1 started walking to tree at (-6.000000, 1.000000)
+Lumberjack 1 walked to tree at (-6.000000, 1.000000)
+Lumberjack 1 started harvesting a tree at (-6.000000, 1.000000)
+Lumberjack 2 walked to tree at (-6.000000, 1.000000)
+Lumberjack 2 started harvesting a tree at (-6.000000, 1.000000)
+Lumberjack 1 finished harvesting a tree at (-6.000000, 1.000000)
+Lumberjack 1 started searching for a tree to chop
+Lumberjack 1 started walking to tree at (0.000000, -10.000000)
+Lumberjack 2 finished harvesting a tree at (-6.000000, 1.000000)
+Lumberjack 2 started searching for a tree to chop
+Lumberjack 2 started walking to tree at (0.000000, -10.000000)
+Lumberjack 2 walked to tree at (0.000000, -10.000000)
+Lumberjack 2 started harvesting a tree at (0.000000, -10.000000)
+Lumberjack 1 walked to tree at (0.000000, -10.000000)
+Lumberjack 1 started harvesting a tree at (0.000000, -10.000000)
+Lumberjack 1 has to drop the wood at the collection point (0.000000, 0.000000)
+Lumberjack 1 started walking to the collection point
+Lumberjack 2 has to drop the wood at the collection point (5.000000, 0.000000)
+Lumberjack 2 started walking to the collection point
+Lumberjack 1 dropped the collected wood
+Lumberjack 1 started searching for a tree to chop
+Lumberjack 1 started walking to tree at (0.000000, -10.000000)
+Lumberjack 2 dropped the collected wood
+Lumberjack 2 started searching for a tree to chop
+Lumberjack 2 started walking to tree at (0.000000, -10.000000)
+Lumberjack 1 walked to tree at (0.000000, -10.000000)
+Lumberjack 1 started harvesting a tree at (0.000000, -10.000000)
+Lumberjack 1 finished harvesting a tree at (0.000000, -10.000000)
+Lumberjack 1 started searching for a tree to chop
+Lumberjack 1 finished their work
+Lumberjack 2 decided to try change the target tree
+Lumberjack 2 finished their work
+*/
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../lumberjack_statemachine/vec2.hpp"
+#include "../lumberjack_statemachine/forest.hpp"
+
+#include <chestnut/fsm/timed_statemachine.hpp>
+
+
+// forward declarations
+class LumberjackStateFinished;
+class LumberjackStateSearching;
+class LumberjackStateHarvesting;
+class LumberjackStateCollecting;
+
+class Lumberjack : public chestnut::fsm::TimedStatemachine<>
+{
+    // making state classes friends so they have access to private members
+    friend LumberjackStateFinished;
+    friend LumberjackStateSearching;
+    friend LumberjackStateHarvesting;
+    friend LumberjackStateCollecting;
+
+private:
+    int id;
+    Forest *forest;
+
+    float walkingSpeed;
+    float harvestingSpeed;
+    int woodCapacity;
+
+    vec2 collectionPoint;
+    vec2 position;
+    int woodCount;
+
+public:
+    // speed in units per second
+    // all lumberjacks share one timer service, which wakes up their states when they're done waiting
+    Lumberjack(int id, Forest *forest, chestnut::fsm::TimerService *timers, float harvestingSpeed, float walkingSpeed, int woodCapacity)
+    : id(id), forest(forest), walkingSpeed(walkingSpeed), harvestingSpeed(harvestingSpeed), woodCapacity(woodCapacity), woodCount(0)
+    {
+        setRunToCompletion(true);
+        setTimerService(timers);
+        initState<LumberjackStateFinished>();
+    }
+
+    Lumberjack& setPosition(vec2 pos)
+    {
+        this->position = pos;
+        return *this;
+    }
+
+    Lumberjack& setCollectionPoint(vec2 pos)
+    {
+        this->collectionPoint = pos;
+        return *this;
+    }
+
+    void startWork()
+    {
+        printf("Lumberjack %d started working\n", id);
+        pushState<LumberjackStateSearching>();
+    }
+
+    bool isWorking() const
+    {
+        return getStateStackSize() > 1 && !isCurrentlyInState<LumberjackStateFinished>();
+    }
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../lumberjack.hpp"
+
+#include <chestnut/fsm/coroutine_state.hpp>
+
+
+class LumberjackStateCollecting : public chestnut::fsm::CoroutineState<Lumberjack>
+{
+public:
+    chestnut::fsm::StateTask body(chestnut::fsm::StateTransition /*transition*/) override
+    {
+        printf("Lumberjack %d started walking to the collection point\n", getParent().id);
+
+        vec2 dirVec = (getParent().collectionPoint - getParent().position).normalized();
+        float dist = (getParent().collectionPoint - getParent().position).length();
+
+        do
+        {
+            co_await awaitDelay(std::chrono::milliseconds(int(getParent().walkingSpeed * 1000)));
+            getParent().position += dirVec * std::min(getParent().walkingSpeed, dist);
+            dist = (getParent().collectionPoint - getParent().position).length();
+
+        } while (dist >= 0.1f);
+
+        getParent().position = getParent().collectionPoint;
+        getParent().woodCount = 0;
+        printf("Lumberjack %d dropped the collected wood\n", getParent().id);
+
+        // back to the searching state below, which continues its loop
+        co_await awaitPopState();
+    }
+};
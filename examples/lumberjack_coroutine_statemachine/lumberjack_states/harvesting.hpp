@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../lumberjack.hpp"
+
+#include <chestnut/fsm/coroutine_state.hpp>
+
+
+class LumberjackStateHarvesting : public chestnut::fsm::CoroutineState<Lumberjack>
+{
+private:
+    Tree *harvestedTree;
+
+public:
+    LumberjackStateHarvesting(Tree *tree)
+        : harvestedTree(tree)
+    {
+
+    }
+
+    chestnut::fsm::StateTask body(chestnut::fsm::StateTransition /*transition*/) override
+    {
+        printf("Lumberjack %d started harvesting a tree at (%f, %f)\n", getParent().id, harvestedTree->position.x, harvestedTree->position.y);
+
+        while(harvestedTree->woodCount > 0)
+        {
+            co_await awaitDelay(std::chrono::milliseconds(int(getParent().harvestingSpeed * 1000)));
+
+            if(harvestedTree->woodCount > 0 && getParent().woodCount < getParent().woodCapacity)
+            {
+                harvestedTree->woodCount--;
+                getParent().woodCount++;
+            }
+            if(getParent().woodCount >= getParent().woodCapacity)
+            {
+                break;
+            }
+        }
+
+        if(getParent().woodCount >= getParent().woodCapacity)
+        {
+            printf("Lumberjack %d has to drop the wood at the collection point (%f, %f)\n", getParent().id, getParent().collectionPoint.x, getParent().collectionPoint.y);
+            co_await awaitGotoState<LumberjackStateCollecting>();
+        }
+        else
+        {
+            printf("Lumberjack %d finished harvesting a tree at (%f, %f)\n", getParent().id, harvestedTree->position.x, harvestedTree->position.y);
+            co_await awaitPopState();
+        }
+    }
+};
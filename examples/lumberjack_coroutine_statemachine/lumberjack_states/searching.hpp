@@ -0,0 +1,87 @@
+#pragma once
+
+#include "../lumberjack.hpp"
+
+#include <chestnut/fsm/coroutine_state.hpp>
+
+#include <limits>
+
+class LumberjackStateSearching : public chestnut::fsm::CoroutineState<Lumberjack>
+{
+public:
+    chestnut::fsm::StateTask body(chestnut::fsm::StateTransition /*transition*/) override
+    {
+        // the lumberjack comes back here every time they're done harvesting or collecting
+        while(true)
+        {
+            printf("Lumberjack %d started searching for a tree to chop\n", getParent().id);
+            Tree *tree = pickClosestAvailableTree();
+
+            while(true)
+            {
+                if(!tree)
+                {
+                    printf("Lumberjack %d finished their work\n", getParent().id);
+                    co_await awaitGotoState<LumberjackStateFinished>();
+                    co_return;
+                }
+
+                printf("Lumberjack %d started walking to tree at (%f, %f)\n", getParent().id, tree->position.x, tree->position.y);
+
+                vec2 dirVec = (tree->position - getParent().position).normalized();
+                float dist = (tree->position - getParent().position).length();
+                bool shouldChangeTree = false;
+
+                do
+                {
+                    // unlike sleep_for this doesn't block the thread, other lumberjacks keep working in the meantime
+                    co_await awaitDelay(std::chrono::milliseconds(int(getParent().walkingSpeed * 1000)));
+
+                    if(tree->woodCount == 0)
+                    {
+                        shouldChangeTree = true;
+                        break;
+                    }
+
+                    getParent().position += dirVec * std::min(getParent().walkingSpeed, dist);
+                    dist = (tree->position - getParent().position).length();
+
+                } while (dist >= 0.1f);
+
+                // tree was harvested while the lumberjack was walking
+                if(shouldChangeTree)
+                {
+                    printf("Lumberjack %d decided to try change the target tree\n", getParent().id);
+                    tree = pickClosestAvailableTree();
+                }
+                else
+                {
+                    break;
+                }
+            }
+
+            printf("Lumberjack %d walked to tree at (%f, %f)\n", getParent().id, tree->position.x, tree->position.y);
+            getParent().position = tree->position;
+
+            // resumes once harvesting (and possibly collecting) is over
+            co_await awaitPushState<LumberjackStateHarvesting>(tree);
+        }
+    }
+
+    Tree *pickClosestAvailableTree() const
+    {
+        Tree *tree = nullptr;
+        float closest = std::numeric_limits<float>::max();
+        for(auto available: getParent().forest->getAvailableTrees())
+        {
+            float dist = (available->position - getParent().position).length();
+            if(dist < closest)
+            {
+                closest = dist;
+                tree = available;
+            }
+        }
+
+        return tree;
+    }
+};
@@ -37,6 +37,8 @@ public:
     Lumberjack(int id, Forest *forest, float harvestingSpeed, float walkingSpeed, int woodCapacity)
     : id(id), forest(forest), harvestingSpeed(harvestingSpeed), walkingSpeed(walkingSpeed), woodCapacity(woodCapacity), woodCount(0)
     {
+        // states transition from inside onEnterState, queue these transitions instead of nesting them
+        setRunToCompletion(true);
         initState<LumberjackStateFinished>();
     }
 
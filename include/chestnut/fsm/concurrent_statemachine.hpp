@@ -0,0 +1,187 @@
+/**
+ * @file concurrent_statemachine.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with the ConcurrentStatemachine wrapper
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_CONCURRENT_STATEMACHINE_H__
+#define __CHESTNUT_STATEMACHINE_CONCURRENT_STATEMACHINE_H__
+
+#include "statemachine_base.hpp"
+#include "mpsc_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Wrapper that lets any thread request transitions of a statemachine owned by a single thread
+ *
+ * @details
+ * Statemachines are not thread-safe. Instead of guarding one with a mutex, wrap it in ConcurrentStatemachine.
+ * Other threads then post transition requests and events to its inbox, which is a lock-free queue (see MpscQueue),
+ * so posting never blocks on other producers nor on the owner. The owner thread executes them in the order they were posted
+ * by calling processInbox() or waitAndProcessInbox(), each of which drains a whole batch of requests at once.
+ *
+ * The wrapped statemachine is accessible with getStatemachine(), but only from the owner thread. States, running on the owner thread,
+ * can still call state change methods of their parent directly.
+ *
+ * Arguments of posted requests are copied, so states constructed this way shouldn't expect to bind to non-const references.
+ *
+ * @tparam StatemachineType type of the wrapped statemachine, a child of StatemachineBase
+ */
+template< class StatemachineType >
+class ConcurrentStatemachine
+{
+    static_assert( std::is_base_of<StatemachineBase, StatemachineType>::value, "StatemachineType has to be a child of StatemachineBase!" );
+
+public:
+    /**
+     * @brief Type of a request function executed on the owner thread
+     */
+    typedef std::function< void( StatemachineType& ) > RequestType;
+
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param args arguments forwarded to the constructor of the statemachine
+     */
+    template< typename ...Args >
+    explicit ConcurrentStatemachine( Args&& ...args );
+
+    /**
+     * @brief Destructor; requests that were not processed are discarded
+     */
+    ~ConcurrentStatemachine() = default;
+
+    ConcurrentStatemachine( const ConcurrentStatemachine& ) = delete;
+    ConcurrentStatemachine& operator=( const ConcurrentStatemachine& ) = delete;
+
+
+    /**
+     * @brief Get the wrapped statemachine. Only the owner thread can use it
+     *
+     * @return statemachine reference
+     */
+    StatemachineType& getStatemachine() noexcept;
+    /**
+     * @brief Get the wrapped statemachine. Only the owner thread can use it
+     *
+     * @return statemachine reference
+     */
+    const StatemachineType& getStatemachine() const noexcept;
+
+
+    /**
+     * @brief Post a function to be executed with the statemachine on the owner thread. Can be called from any thread
+     *
+     * @param request function taking StatemachineType&
+     */
+    template< typename F >
+    void post( F&& request );
+
+    /**
+     * @brief Post a gotoState request. Can be called from any thread
+     *
+     * @see StatemachineBase::gotoState()
+     */
+    template< class StateType, typename ...Args >
+    void postGotoState( Args&& ...args );
+
+    /**
+     * @brief Post a pushState request. Can be called from any thread
+     *
+     * @see StatemachineBase::pushState()
+     */
+    template< class StateType, typename ...Args >
+    void postPushState( Args&& ...args );
+
+    /**
+     * @brief Post a popState request. Can be called from any thread
+     *
+     * @see StatemachineBase::popState()
+     */
+    void postPopState();
+
+    /**
+     * @brief Post an event to be handled according to a transition table. Can be called from any thread
+     *
+     * @see StatemachineBase::processEvent()
+     */
+    template< class Table, class EventType >
+    void postEvent( EventType&& event );
+
+
+    /**
+     * @brief Execute posted requests. Only the owner thread can call this
+     *
+     * @param maxRequests maximal number of requests to execute in this batch
+     * @return number of executed requests
+     *
+     * @details
+     * Requests posted while the batch is being executed are also picked up, up to maxRequests.
+     * If a request throws, the exception propagates and the remaining requests stay in the inbox.
+     */
+    std::size_t processInbox( std::size_t maxRequests = std::numeric_limits<std::size_t>::max() );
+
+    /**
+     * @brief Wait until a request is posted or timeout passes, then execute posted requests. Only the owner thread can call this
+     *
+     * @param timeout maximal time to wait for requests if there are none
+     * @param maxRequests maximal number of requests to execute in this batch
+     * @return number of executed requests
+     *
+     * @details
+     * Producers don't touch any mutex unless the owner is actually asleep in this method - then the first producer
+     * to post a request takes the owner's mutex briefly to wake it up.
+     */
+    template< class Rep, class Period >
+    std::size_t waitAndProcessInbox( const std::chrono::duration<Rep, Period>& timeout, std::size_t maxRequests = std::numeric_limits<std::size_t>::max() );
+
+    /**
+     * @brief Return whether there are no posted requests waiting to be executed. Only the owner thread can call this
+     */
+    bool isInboxEmpty() const noexcept;
+
+
+private:
+    /**
+     * @brief Wake the owner thread up if it's waiting for requests
+     */
+    void notifyOwner();
+
+
+private:
+    StatemachineType m_statemachine;
+
+    MpscQueue< RequestType > m_inbox;
+
+    /**
+     * @brief Set by the owner before it goes to sleep in waitAndProcessInbox(), cleared by the producer that wakes it up
+     */
+    std::atomic<bool> m_isOwnerWaiting;
+    std::mutex m_wakeupMutex;
+    std::condition_variable m_wakeupCondition;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "concurrent_statemachine.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_CONCURRENT_STATEMACHINE_H__
@@ -0,0 +1,135 @@
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace chestnut::fsm
+{
+
+template<class StatemachineType>
+template<typename ...Args>
+inline ConcurrentStatemachine<StatemachineType>::ConcurrentStatemachine( Args&& ...args )
+: m_statemachine( std::forward<Args>(args)... )
+{
+    m_isOwnerWaiting.store( false, std::memory_order_relaxed );
+}
+
+template<class StatemachineType>
+inline StatemachineType& ConcurrentStatemachine<StatemachineType>::getStatemachine() noexcept
+{
+    return m_statemachine;
+}
+
+template<class StatemachineType>
+inline const StatemachineType& ConcurrentStatemachine<StatemachineType>::getStatemachine() const noexcept
+{
+    return m_statemachine;
+}
+
+template<class StatemachineType>
+template<typename F>
+inline void ConcurrentStatemachine<StatemachineType>::post( F&& request )
+{
+    m_inbox.emplace( std::forward<F>( request ) );
+    notifyOwner();
+}
+
+template<class StatemachineType>
+template<class StateType, typename ...Args>
+inline void ConcurrentStatemachine<StatemachineType>::postGotoState( Args&& ...args )
+{
+    post( [argsTuple = std::make_tuple( std::forward<Args>(args)... )]( StatemachineType& statemachine ) mutable {
+        std::apply( [&statemachine]( auto&& ...argsUnpacked ) {
+            statemachine.template gotoState<StateType>( std::forward<decltype(argsUnpacked)>(argsUnpacked)... );
+        }, std::move( argsTuple ) );
+    });
+}
+
+template<class StatemachineType>
+template<class StateType, typename ...Args>
+inline void ConcurrentStatemachine<StatemachineType>::postPushState( Args&& ...args )
+{
+    post( [argsTuple = std::make_tuple( std::forward<Args>(args)... )]( StatemachineType& statemachine ) mutable {
+        std::apply( [&statemachine]( auto&& ...argsUnpacked ) {
+            statemachine.template pushState<StateType>( std::forward<decltype(argsUnpacked)>(argsUnpacked)... );
+        }, std::move( argsTuple ) );
+    });
+}
+
+template<class StatemachineType>
+inline void ConcurrentStatemachine<StatemachineType>::postPopState()
+{
+    post( []( StatemachineType& statemachine ) {
+        statemachine.popState();
+    });
+}
+
+template<class StatemachineType>
+template<class Table, class EventType>
+inline void ConcurrentStatemachine<StatemachineType>::postEvent( EventType&& event )
+{
+    // checked here as well, so that the error points at the call rather than into the posted request
+    static_assert( Table::template handlesEvent< typename std::decay<EventType>::type >, "EventType is not handled by any transition in the table!" );
+
+    post( [event = std::forward<EventType>( event )]( StatemachineType& statemachine ) {
+        statemachine.template processEvent<Table>( event );
+    });
+}
+
+template<class StatemachineType>
+inline std::size_t ConcurrentStatemachine<StatemachineType>::processInbox( std::size_t maxRequests )
+{
+    std::size_t processed = 0;
+    RequestType request;
+
+    while( processed < maxRequests && m_inbox.tryPop( request ) )
+    {
+        processed++;
+        request( m_statemachine );
+    }
+
+    return processed;
+}
+
+template<class StatemachineType>
+template<class Rep, class Period>
+inline std::size_t ConcurrentStatemachine<StatemachineType>::waitAndProcessInbox( const std::chrono::duration<Rep, Period>& timeout, std::size_t maxRequests )
+{
+    if( m_inbox.isEmpty() )
+    {
+        std::unique_lock<std::mutex> lock( m_wakeupMutex );
+
+        // the flag is set before checking the inbox again and producers check it after posting,
+        // so either the owner sees the new request or the producer sees the owner is going to sleep
+        m_isOwnerWaiting.store( true, std::memory_order_seq_cst );
+
+        if( m_inbox.isEmpty() )
+        {
+            m_wakeupCondition.wait_for( lock, timeout, [this] {
+                return !m_isOwnerWaiting.load( std::memory_order_seq_cst );
+            });
+        }
+
+        m_isOwnerWaiting.store( false, std::memory_order_relaxed );
+    }
+
+    return processInbox( maxRequests );
+}
+
+template<class StatemachineType>
+inline bool ConcurrentStatemachine<StatemachineType>::isInboxEmpty() const noexcept
+{
+    return m_inbox.isEmpty();
+}
+
+template<class StatemachineType>
+inline void ConcurrentStatemachine<StatemachineType>::notifyOwner()
+{
+    // only the producer that clears the flag wakes the owner, others don't even look at the mutex
+    if( m_isOwnerWaiting.load( std::memory_order_seq_cst ) && m_isOwnerWaiting.exchange( false, std::memory_order_seq_cst ) )
+    {
+        std::lock_guard<std::mutex> lock( m_wakeupMutex );
+        m_wakeupCondition.notify_one();
+    }
+}
+
+} // namespace chestnut::fsm
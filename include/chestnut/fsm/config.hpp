@@ -0,0 +1,128 @@
+/**
+ * @file config.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with compile time configuration of the library
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ * @details
+ * Every macro here can be defined by the user before including any of the library headers
+ * (or preferably globally by the build system) to override its default value.
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_CONFIG_H__
+#define __CHESTNUT_STATEMACHINE_CONFIG_H__
+
+/**
+ * @brief Number of states the statemachine's state stack can hold without allocating any memory
+ *
+ * @details
+ * If the stack grows beyond that, its content is moved to the heap.
+ */
+#ifndef CHESTNUT_FSM_STATE_STACK_INLINE_CAPACITY
+    #define CHESTNUT_FSM_STATE_STACK_INLINE_CAPACITY 8
+#endif
+
+/**
+ * @brief Whether the library should use exceptions; detected from the compiler unless defined by the user
+ * 
+ * @details
+ * With exceptions the statemachine wraps exceptions thrown by onEnterState and onLeaveState into 
+ * OnEnterStateException and OnLeaveStateException. Without them (e.g. when building with -fno-exceptions)
+ * states report failures with StateBase::failTransition() and the statemachine only returns a TransitionResult.
+ * Define it as 0 to get the latter also in builds with exceptions enabled.
+ */
+#ifndef CHESTNUT_FSM_HAS_EXCEPTIONS
+    #if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+        #define CHESTNUT_FSM_HAS_EXCEPTIONS 1
+    #else
+        #define CHESTNUT_FSM_HAS_EXCEPTIONS 0
+    #endif
+#endif
+
+/**
+ * @brief Whether C++20 coroutines are available; detected from the compiler unless defined by the user
+ * 
+ * @details
+ * CoroutineState is only available when this is 1. The rest of the library requires just C++17.
+ */
+#ifndef CHESTNUT_FSM_HAS_COROUTINES
+    #if defined(__cpp_impl_coroutine) && defined(__has_include)
+        #if __has_include(<coroutine>)
+            #define CHESTNUT_FSM_HAS_COROUTINES 1
+        #else
+            #define CHESTNUT_FSM_HAS_COROUTINES 0
+        #endif
+    #else
+        #define CHESTNUT_FSM_HAS_COROUTINES 0
+    #endif
+#endif
+
+/**
+ * @brief Whether POSIX memory mapping of files is available; detected from the system headers unless defined by the user
+ *
+ * @details
+ * Fleet snapshot and journal files are then mapped instead of being read into a buffer first.
+ * StatemachineFleet::bulkLoadSnapshotFile() copies all of the data out of the file either way.
+ */
+#ifndef CHESTNUT_FSM_HAS_MMAP
+    #if defined(__has_include)
+        #if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+            #define CHESTNUT_FSM_HAS_MMAP 1
+        #else
+            #define CHESTNUT_FSM_HAS_MMAP 0
+        #endif
+    #else
+        #define CHESTNUT_FSM_HAS_MMAP 0
+    #endif
+#endif
+
+/**
+ * @brief Whether statemachines record their transitions with TransitionTracer; off by default
+ *
+ * @details
+ * When 0, tracing calls in statemachines compile to nothing. TransitionTracer itself is available either way.
+ */
+#ifndef CHESTNUT_FSM_TRACE_TRANSITIONS
+    #define CHESTNUT_FSM_TRACE_TRANSITIONS 0
+#endif
+
+/**
+ * @brief Record a transition of a statemachine if CHESTNUT_FSM_TRACE_TRANSITIONS is 1, otherwise do nothing
+ *
+ * @details
+ * Defined here, so that statemachines only include transition_tracer.hpp when tracing is on.
+ */
+#if CHESTNUT_FSM_TRACE_TRANSITIONS
+    #define CHESTNUT_FSM_TRACE_TRANSITION( machine, transition ) ::chestnut::fsm::TransitionTracer::record( (const void *)( machine ), ( transition ) )
+#else
+    #define CHESTNUT_FSM_TRACE_TRANSITION( machine, transition ) ( (void)0 )
+#endif
+
+/**
+ * @brief Number of transition records each thread's trace buffer can hold before new ones are dropped; has to be a power of 2
+ */
+#ifndef CHESTNUT_FSM_TRACE_BUFFER_CAPACITY
+    #define CHESTNUT_FSM_TRACE_BUFFER_CAPACITY 4096
+#endif
+
+/**
+ * @brief Whether Statemachine collects dwell times and transition counts with TransitionMetrics; off by default
+ *
+ * @details
+ * When 0, statemachines don't reference TransitionMetrics at all. TransitionMetrics itself is available either way.
+ */
+#ifndef CHESTNUT_FSM_COLLECT_METRICS
+    #define CHESTNUT_FSM_COLLECT_METRICS 0
+#endif
+
+/**
+ * @brief Largest state identifier TransitionMetrics keeps data for; transitions of states with bigger identifiers are only counted as dropped
+ */
+#ifndef CHESTNUT_FSM_METRICS_MAX_STATE_ID
+    #define CHESTNUT_FSM_METRICS_MAX_STATE_ID 255
+#endif
+
+#endif // __CHESTNUT_STATEMACHINE_CONFIG_H__
@@ -0,0 +1,313 @@
+/**
+ * @file coroutine_state.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with CoroutineState, a state whose behaviour is written as a C++20 coroutine
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_COROUTINE_STATE_H__
+#define __CHESTNUT_STATEMACHINE_COROUTINE_STATE_H__
+
+#include "config.hpp"
+
+#if !CHESTNUT_FSM_HAS_COROUTINES
+    #error "CoroutineState requires C++20 coroutines"
+#endif
+
+#include "state.hpp"
+#include "timer_service.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <functional>
+#include <memory>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Coroutine type returned by CoroutineState::body()
+ *
+ * @details
+ * Owns the coroutine frame. The coroutine starts suspended and is driven by the state it belongs to.
+ */
+class StateTask
+{
+public:
+    struct promise_type
+    {
+        StateTask get_return_object() noexcept;
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        /**
+         * @brief Rethrows the exception out of resume(), so the statemachine can handle it like one thrown by onEnterState
+         */
+        void unhandled_exception();
+    };
+
+
+public:
+    StateTask() noexcept;
+    StateTask( StateTask&& other ) noexcept;
+    StateTask& operator=( StateTask&& other ) noexcept;
+    ~StateTask();
+
+    StateTask( const StateTask& ) = delete;
+    StateTask& operator=( const StateTask& ) = delete;
+
+    /**
+     * @brief Return whether the task holds a coroutine that has not finished yet
+     */
+    bool isSuspended() const noexcept;
+
+    /**
+     * @brief Resume the coroutine until it suspends again or finishes
+     */
+    void resume();
+
+
+private:
+    explicit StateTask( std::coroutine_handle<promise_type> handle ) noexcept;
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+
+
+namespace detail
+{
+    /**
+     * @brief Variable with a unique address for every event type, used to identify them without RTTI
+     */
+    template< class EventType >
+    inline const char eventTypeKey = 0;
+
+} // namespace detail
+
+
+
+/**
+ * @brief State which instead of onEnterState has a body written as a coroutine
+ *
+ * @details
+ * The body starts when the state is entered. It can suspend itself by co_await-ing:
+ * - awaitDelay() - resumes after the given time, measured by the TimerService of the statemachine,
+ * - awaitEvent<EventType>() - resumes once sendEvent() is called with an event of that type, which is returned,
+ * - awaitPushState<StateType>() - pushes a child state and resumes once it's popped,
+ * - awaitGotoState<StateType>() and awaitPopState() - transitions that leave this state.
+ *
+ * While suspended, the body takes no thread - an agent that spends most of its time walking or waiting costs only its coroutine frame,
+ * so a single thread driving the TimerService can run any number of them.
+ *
+ * Transitions requested by the body are executed only after the body is suspended and the transition in progress, if any, is over
+ * (see StatemachineBase::callAfterTransition()), so the body never runs nested in another transition, not even in the onEnterState
+ * which started it, and never calls into a state that is being deleted. The body shouldn't call state change methods of the statemachine directly.
+ * Transition awaitables return false if the statemachine refused the transition, in run-to-completion mode too.
+ * If a state is pushed on top of this one before the requested transition is executed, the transition is considered refused
+ * and the body resumes once the state is back on top of the stack.
+ *
+ * When the state is left for good (i.e. not just covered by a pushed state), the body is destroyed wherever it's suspended.
+ * If a delay expires while the state is covered, the body resumes once the state is back on top of the stack.
+ *
+ * Subclasses overriding onEnterState or onLeaveState have to call them in CoroutineState too.
+ *
+ * @tparam StatemachineType type of the statemachine; has to be a TimedStatemachine to use awaitDelay()
+ *
+ * @see StateTask, TimerService, TimedStatemachine::setTimerService()
+ */
+template< class StatemachineType >
+class CoroutineState : public State< StatemachineType >
+{
+public:
+    /**
+     * @brief Awaitable returned by awaitDelay()
+     */
+    struct DelayAwaiter
+    {
+        CoroutineState *state;
+        TimerService::ClockType::duration delay;
+
+        bool await_ready() const noexcept;
+        // not noexcept, scheduling the timer allocates; an exception is rethrown from the coroutine body
+        void await_suspend( std::coroutine_handle<> );
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief Awaitable returned by awaitEvent()
+     */
+    template< class EventType >
+    struct EventAwaiter
+    {
+        CoroutineState *state;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend( std::coroutine_handle<> ) noexcept;
+        EventType await_resume() const;
+    };
+
+    /**
+     * @brief Awaitable returned by awaitGotoState(), awaitPushState() and awaitPopState()
+     */
+    struct TransitionAwaiter
+    {
+        CoroutineState *state;
+        std::function<bool()> request;
+        bool isChildState;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend( std::coroutine_handle<> ) noexcept;
+        bool await_resume() const noexcept;
+    };
+
+
+public:
+    CoroutineState() noexcept;
+
+    /**
+     * @brief Destructor; cancels the pending delay and destroys the body
+     */
+    ~CoroutineState();
+
+    /**
+     * @brief Starts the body, or resumes it if a child state it waited for was popped
+     */
+    void onEnterState( StateTransition transition ) override;
+
+    /**
+     * @brief Destroys the body, unless a state is only pushed on top of this one
+     */
+    void onLeaveState( StateTransition transition ) override;
+
+    /**
+     * @brief Deliver an event to the body
+     *
+     * @param event event object
+     * @return whether the body was waiting for an event of this type and has been resumed with it
+     *
+     * @details
+     * The body may transition to another state before this returns, the state object must not be used afterwards then.
+     * Typically called from a method of the state extension, which the statemachine forwards to its current state.
+     */
+    template< class EventType >
+    bool sendEvent( const EventType& event );
+
+    /**
+     * @brief Return whether the body is suspended, waiting for something
+     */
+    bool isBodySuspended() const noexcept;
+
+
+protected:
+    /**
+     * @brief The coroutine executed when the state is entered
+     *
+     * @param transition transition through which the state was entered
+     */
+    virtual StateTask body( StateTransition transition ) = 0;
+
+    /**
+     * @brief Suspend the body for the given time
+     *
+     * @details
+     * Requires a TimerService set in the statemachine (see TimedStatemachine), without one the body isn't suspended at all.
+     */
+    template< class Rep, class Period >
+    DelayAwaiter awaitDelay( const std::chrono::duration<Rep, Period>& delay ) noexcept;
+
+    /**
+     * @brief Suspend the body until an event of a given type is delivered with sendEvent()
+     *
+     * @return copy of the event
+     */
+    template< class EventType >
+    EventAwaiter<EventType> awaitEvent() noexcept;
+
+    /**
+     * @brief Suspend the body and go to another state
+     *
+     * @return false if the transition was refused, otherwise the body never resumes
+     *
+     * @see StatemachineBase::gotoState()
+     */
+    template< class StateType, typename ...Args >
+    TransitionAwaiter awaitGotoState( Args&& ...args );
+
+    /**
+     * @brief Suspend the body, push a child state and resume once it's popped
+     *
+     * @return whether the child state was pushed
+     *
+     * @see StatemachineBase::pushState()
+     */
+    template< class StateType, typename ...Args >
+    TransitionAwaiter awaitPushState( Args&& ...args );
+
+    /**
+     * @brief Suspend the body and pop this state
+     *
+     * @return false if the transition was refused, otherwise the body never resumes
+     *
+     * @see StatemachineBase::popState()
+     */
+    TransitionAwaiter awaitPopState();
+
+
+private:
+    enum EAwaiting
+    {
+        AWAITING_NOTHING,
+        AWAITING_DELAY,
+        AWAITING_EVENT,
+        AWAITING_CHILD_STATE,
+        AWAITING_TRANSITION
+    };
+
+    /**
+     * @brief Resume the body and then have the statemachine execute the transition it requested, if any
+     *
+     * @details
+     * If the statemachine is idle and the transition succeeds, this state may already be deleted when this returns.
+     */
+    void resumeBody();
+
+    /**
+     * @brief Execute the transition requested by the body and resume the body if it was refused
+     */
+    void executePendingTransition();
+
+    void onDelayElapsed();
+    void cancelDelay() noexcept;
+
+
+private:
+    StateTask m_body;
+    EAwaiting m_awaiting;
+    bool m_isActive;
+    bool m_isRunningBody;
+
+    TimerService *m_delayTimerService;
+    TimerHandle m_delayTimer;
+    bool m_isDelayElapsed;
+
+    const char *m_awaitedEventKey;
+    const void *m_receivedEvent;
+
+    std::function<bool()> m_pendingTransition;
+    bool m_transitionResult;
+    // expires when the state is left for good, so the statemachine can tell a requested transition is no longer wanted
+    std::shared_ptr< CoroutineState * > m_self;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "coroutine_state.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_COROUTINE_STATE_H__
@@ -0,0 +1,355 @@
+#include <cassert>
+#include <cstdlib>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace chestnut::fsm
+{
+
+inline StateTask StateTask::promise_type::get_return_object() noexcept
+{
+    return StateTask( std::coroutine_handle<promise_type>::from_promise( *this ) );
+}
+
+inline void StateTask::promise_type::unhandled_exception()
+{
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    throw;
+#else
+    std::abort();
+#endif
+}
+
+inline StateTask::StateTask() noexcept
+: m_handle( nullptr )
+{
+
+}
+
+inline StateTask::StateTask( std::coroutine_handle<promise_type> handle ) noexcept
+: m_handle( handle )
+{
+
+}
+
+inline StateTask::StateTask( StateTask&& other ) noexcept
+: m_handle( other.m_handle )
+{
+    other.m_handle = nullptr;
+}
+
+inline StateTask& StateTask::operator=( StateTask&& other ) noexcept
+{
+    if( this != &other )
+    {
+        if( m_handle )
+        {
+            m_handle.destroy();
+        }
+
+        m_handle = other.m_handle;
+        other.m_handle = nullptr;
+    }
+
+    return *this;
+}
+
+inline StateTask::~StateTask()
+{
+    if( m_handle )
+    {
+        m_handle.destroy();
+    }
+}
+
+inline bool StateTask::isSuspended() const noexcept
+{
+    return m_handle && !m_handle.done();
+}
+
+inline void StateTask::resume()
+{
+    assert( isSuspended() );
+    m_handle.resume();
+}
+
+
+
+
+template<class StatemachineType>
+inline bool CoroutineState<StatemachineType>::DelayAwaiter::await_ready() const noexcept
+{
+    assert( state->getParent().getTimerService() && "Timer service was not set!" );
+    return !state->getParent().getTimerService();
+}
+
+template<class StatemachineType>
+inline void CoroutineState<StatemachineType>::DelayAwaiter::await_suspend( std::coroutine_handle<> )
+{
+    TimerService *timerService = state->getParent().getTimerService();
+
+    // scheduled first, so that if it throws the state isn't left awaiting a delay that will never elapse
+    CoroutineState *awaitingState = state;
+    const TimerHandle timer = timerService->schedule( delay, [awaitingState]() {
+        awaitingState->onDelayElapsed();
+    });
+
+    state->m_awaiting = AWAITING_DELAY;
+    state->m_isDelayElapsed = false;
+    state->m_delayTimerService = timerService;
+    state->m_delayTimer = timer;
+}
+
+template<class StatemachineType>
+template<class EventType>
+inline void CoroutineState<StatemachineType>::EventAwaiter<EventType>::await_suspend( std::coroutine_handle<> ) noexcept
+{
+    state->m_awaiting = AWAITING_EVENT;
+    state->m_awaitedEventKey = &detail::eventTypeKey<EventType>;
+}
+
+template<class StatemachineType>
+template<class EventType>
+inline EventType CoroutineState<StatemachineType>::EventAwaiter<EventType>::await_resume() const
+{
+    return *static_cast<const EventType *>( state->m_receivedEvent );
+}
+
+template<class StatemachineType>
+inline void CoroutineState<StatemachineType>::TransitionAwaiter::await_suspend( std::coroutine_handle<> ) noexcept
+{
+    state->m_awaiting = isChildState ? AWAITING_CHILD_STATE : AWAITING_TRANSITION;
+    state->m_transitionResult = true;
+    state->m_pendingTransition = std::move( request );
+}
+
+template<class StatemachineType>
+inline bool CoroutineState<StatemachineType>::TransitionAwaiter::await_resume() const noexcept
+{
+    return state->m_transitionResult;
+}
+
+
+
+
+template<class StatemachineType>
+inline CoroutineState<StatemachineType>::CoroutineState() noexcept
+{
+    m_awaiting = AWAITING_NOTHING;
+    m_isActive = false;
+    m_isRunningBody = false;
+    m_delayTimerService = nullptr;
+    m_isDelayElapsed = false;
+    m_awaitedEventKey = nullptr;
+    m_receivedEvent = nullptr;
+    m_transitionResult = false;
+}
+
+template<class StatemachineType>
+inline CoroutineState<StatemachineType>::~CoroutineState()
+{
+    cancelDelay();
+}
+
+template<class StatemachineType>
+inline void CoroutineState<StatemachineType>::onEnterState( StateTransition transition ) 
+{
+    m_isActive = true;
+
+    // coming back from a child state - continue where the body left off
+    if( transition.type == STATE_TRANSITION_POP && m_body.isSuspended() )
+    {
+        if( m_awaiting == AWAITING_CHILD_STATE || ( m_awaiting == AWAITING_DELAY && m_isDelayElapsed ) )
+        {
+            m_awaiting = AWAITING_NOTHING;
+            resumeBody();
+        }
+        return;
+    }
+
+    cancelDelay();
+    m_awaiting = AWAITING_NOTHING;
+    m_body = body( transition );
+    resumeBody();
+}
+
+template<class StatemachineType>
+inline void CoroutineState<StatemachineType>::onLeaveState( StateTransition transition ) 
+{
+    assert( !m_isRunningBody && "The body of a CoroutineState should request transitions only by co_await-ing them!" );
+
+    m_isActive = false;
+
+    if( transition.type != STATE_TRANSITION_PUSH )
+    {
+        cancelDelay();
+        m_awaiting = AWAITING_NOTHING;
+        m_pendingTransition = nullptr;
+        m_self = nullptr;
+        m_body = StateTask();
+    }
+}
+
+template<class StatemachineType>
+template<class EventType>
+inline bool CoroutineState<StatemachineType>::sendEvent( const EventType& event ) 
+{
+    if( !m_isActive || m_awaiting != AWAITING_EVENT || m_awaitedEventKey != &detail::eventTypeKey<EventType> )
+    {
+        return false;
+    }
+
+    m_awaiting = AWAITING_NOTHING;
+    m_receivedEvent = &event;
+    resumeBody();
+
+    return true;
+}
+
+template<class StatemachineType>
+inline bool CoroutineState<StatemachineType>::isBodySuspended() const noexcept
+{
+    return m_body.isSuspended();
+}
+
+template<class StatemachineType>
+template<class Rep, class Period>
+inline typename CoroutineState<StatemachineType>::DelayAwaiter CoroutineState<StatemachineType>::awaitDelay( const std::chrono::duration<Rep, Period>& delay ) noexcept
+{
+    return DelayAwaiter { this, std::chrono::ceil<TimerService::ClockType::duration>( delay ) };
+}
+
+template<class StatemachineType>
+template<class EventType>
+inline typename CoroutineState<StatemachineType>::template EventAwaiter<EventType> CoroutineState<StatemachineType>::awaitEvent() noexcept
+{
+    return EventAwaiter<EventType> { this };
+}
+
+template<class StatemachineType>
+template<class StateType, typename ...Args>
+inline typename CoroutineState<StatemachineType>::TransitionAwaiter CoroutineState<StatemachineType>::awaitGotoState( Args&& ...args ) 
+{
+    StatemachineType *statemachine = &this->getParent();
+
+    return TransitionAwaiter { this, [statemachine, argsTuple = std::make_tuple( std::forward<Args>(args)... )]() mutable {
+        return std::apply( [statemachine]( auto&& ...argsUnpacked ) {
+            return statemachine->template gotoState<StateType>( std::forward<decltype(argsUnpacked)>(argsUnpacked)... );
+        }, std::move( argsTuple ) );
+    }, false };
+}
+
+template<class StatemachineType>
+template<class StateType, typename ...Args>
+inline typename CoroutineState<StatemachineType>::TransitionAwaiter CoroutineState<StatemachineType>::awaitPushState( Args&& ...args ) 
+{
+    StatemachineType *statemachine = &this->getParent();
+
+    return TransitionAwaiter { this, [statemachine, argsTuple = std::make_tuple( std::forward<Args>(args)... )]() mutable {
+        return std::apply( [statemachine]( auto&& ...argsUnpacked ) {
+            return statemachine->template pushState<StateType>( std::forward<decltype(argsUnpacked)>(argsUnpacked)... );
+        }, std::move( argsTuple ) );
+    }, true };
+}
+
+template<class StatemachineType>
+inline typename CoroutineState<StatemachineType>::TransitionAwaiter CoroutineState<StatemachineType>::awaitPopState() 
+{
+    StatemachineType *statemachine = &this->getParent();
+
+    return TransitionAwaiter { this, [statemachine]() {
+        return statemachine->popState();
+    }, false };
+}
+
+template<class StatemachineType>
+inline void CoroutineState<StatemachineType>::resumeBody() 
+{
+    // keeps the flag right even if the body throws
+    struct RunningGuard
+    {
+        bool& isRunning;
+
+        RunningGuard( bool& isRunning ) : isRunning( isRunning ) { isRunning = true; }
+        ~RunningGuard() { isRunning = false; }
+    };
+
+    {
+        RunningGuard guard( m_isRunningBody );
+        m_body.resume();
+    }
+
+    if( !m_pendingTransition )
+    {
+        return;
+    }
+
+    if( !m_self )
+    {
+        m_self = std::make_shared< CoroutineState * >( this );
+    }
+
+    // executed once the transition in progress is over, so that it isn't nested in it and its actual result is known;
+    // by then the transitions queued before it may have left this state for good, in which case there's nothing to do
+    std::weak_ptr< CoroutineState * > self = m_self;
+    this->getParent().callAfterTransition( [self]() {
+        if( std::shared_ptr< CoroutineState * > state = self.lock() )
+        {
+            ( *state )->executePendingTransition();
+        }
+    });
+}
+
+template<class StatemachineType>
+inline void CoroutineState<StatemachineType>::executePendingTransition() 
+{
+    std::function<bool()> request = std::move( m_pendingTransition );
+    m_pendingTransition = nullptr;
+
+    // a state was pushed on top of this one in the meantime - the body learns the transition was refused once it's back on top
+    if( !m_isActive )
+    {
+        m_awaiting = AWAITING_CHILD_STATE;
+        m_transitionResult = false;
+        return;
+    }
+
+    // after a successful transition this state may be gone, so it can't be touched anymore
+    if( request() )
+    {
+        return;
+    }
+
+    // refused transition - let the body decide what to do next
+    m_awaiting = AWAITING_NOTHING;
+    m_transitionResult = false;
+    resumeBody();
+}
+
+template<class StatemachineType>
+inline void CoroutineState<StatemachineType>::onDelayElapsed() 
+{
+    m_delayTimer = TimerHandle();
+    m_isDelayElapsed = true;
+
+    // if a state was pushed on top of this one, the body waits until it's popped
+    if( m_isActive )
+    {
+        m_awaiting = AWAITING_NOTHING;
+        resumeBody();
+    }
+}
+
+template<class StatemachineType>
+inline void CoroutineState<StatemachineType>::cancelDelay() noexcept
+{
+    if( m_delayTimerService && m_delayTimer.isValid() )
+    {
+        m_delayTimerService->cancel( m_delayTimer );
+    }
+
+    m_delayTimer = TimerHandle();
+}
+
+} // namespace chestnut::fsm
@@ -13,8 +13,11 @@
 #ifndef __CHESTNUT_STATEMACHINE_EXCEPTIONS_H__
 #define __CHESTNUT_STATEMACHINE_EXCEPTIONS_H__
 
+#include "config.hpp"
 #include "state_transition.hpp"
 
+#include <cstdio>
+#include <cstdlib>
 #include <exception>
 #include <string>
 
@@ -69,6 +72,16 @@ struct OnLeaveStateException : StateChangeException
     OnLeaveStateException( StateTransition transition, const char *msg ) throw();
 };
 
+
+namespace detail
+{
+    /**
+     * @brief Throw BadParentAccessException or abort the program if exceptions are disabled
+     */
+    [[noreturn]] void raiseBadParentAccess();
+
+} // namespace detail
+
 } // namespace chestnut::fsm
 
 
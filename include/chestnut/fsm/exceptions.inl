@@ -31,4 +31,19 @@ inline OnLeaveStateException::OnLeaveStateException( StateTransition transition,
     message = "Exception was thrown when leaving a state: " + message;
 }
 
+
+namespace detail
+{
+    inline void raiseBadParentAccess()
+    {
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+        throw BadParentAccessException( "State parent access violation!" );
+#else
+        fprintf( stderr, "State parent access violation!\n" );
+        std::abort();
+#endif
+    }
+
+} // namespace detail
+
 } // namespace chestnut::fsm
@@ -0,0 +1,189 @@
+/**
+ * @file executor.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with the work-stealing Executor driving many statemachines on a fixed pool of threads
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_EXECUTOR_H__
+#define __CHESTNUT_STATEMACHINE_EXECUTOR_H__
+
+#include "work_stealing_deque.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Unit of work run by an Executor
+ *
+ * @details
+ * Tasks are not owned by the executor. The same task object can be scheduled again once it has started running,
+ * which is how ExecutorStatemachine keeps itself going.
+ */
+class ExecutorTask
+{
+public:
+    /**
+     * @brief Do the work; called by a worker thread of the executor
+     */
+    virtual void runTask() = 0;
+
+protected:
+    ~ExecutorTask() = default;
+};
+
+
+/**
+ * @brief Fixed pool of worker threads running tasks, balanced with work stealing
+ *
+ * @details
+ * Every worker has its own deque of tasks (see WorkStealingDeque). Tasks scheduled by a worker - e.g. a statemachine
+ * posting a request to another statemachine - go to the worker's own deque, where they stay warm in its cache.
+ * Tasks scheduled by other threads go to a shared injection queue, from which idle workers take them in batches.
+ * A worker that runs out of tasks steals the oldest ones from other workers, so the load spreads by itself
+ * and workers don't contend on any shared structure as long as they have work of their own.
+ * Idle workers spin briefly and then sleep until new tasks are scheduled.
+ *
+ * Statemachines are run through ExecutorStatemachine, which makes sure one statemachine never runs on two workers at once.
+ *
+ * @see ExecutorStatemachine
+ */
+class Executor
+{
+public:
+    /**
+     * @brief Capacity of a worker's own deque; tasks that don't fit go to the injection queue
+     */
+    static constexpr std::size_t LOCAL_QUEUE_CAPACITY = 4096;
+    /**
+     * @brief Maximal number of tasks a worker takes from the injection queue at once
+     */
+    static constexpr std::size_t INJECTION_BATCH_SIZE = 32;
+
+
+public:
+    /**
+     * @brief Constructor; starts the worker threads
+     *
+     * @param workerCount number of worker threads or 0 to use one per hardware thread
+     */
+    explicit Executor( unsigned workerCount = 0 );
+
+    /**
+     * @brief Destructor; runs all scheduled tasks, then stops the worker threads
+     *
+     * @details
+     * Waits like waitUntilIdle() - also for tasks scheduled by the tasks being run - so no queued work,
+     * e.g. a transition posted to an ExecutorStatemachine, is lost. Tasks that keep rescheduling themselves
+     * without end have to be stopped first. Can't be called from a worker thread.
+     */
+    ~Executor();
+
+    Executor( const Executor& ) = delete;
+    Executor& operator=( const Executor& ) = delete;
+
+
+    /**
+     * @brief Schedule a task to be run by one of the workers. Can be called from any thread
+     *
+     * @param task task object, it has to stay alive until it's run
+     */
+    void schedule( ExecutorTask *task );
+
+    /**
+     * @brief Block until there are no tasks scheduled or running
+     *
+     * @details
+     * Can't be called from a worker thread.
+     */
+    void waitUntilIdle();
+
+    /**
+     * @brief Get the number of worker threads
+     */
+    unsigned getWorkerCount() const noexcept;
+
+
+private:
+    struct Worker
+    {
+        WorkStealingDeque< ExecutorTask > deque;
+        std::thread thread;
+        std::uint64_t randomState;
+
+        Worker();
+    };
+
+    struct WorkerContext
+    {
+        Executor *executor;
+        Worker *worker;
+    };
+
+    /**
+     * @brief Executor and worker the calling thread belongs to, if it's a worker thread
+     */
+    static WorkerContext& currentWorkerContext() noexcept;
+
+    void runWorker( Worker *worker );
+
+    /**
+     * @brief Take a task from the worker's own deque, the injection queue or another worker
+     *
+     * @return task or nullptr if none was found
+     */
+    ExecutorTask *findTask( Worker *worker );
+
+    ExecutorTask *takeFromInjectionQueue( Worker *worker );
+    ExecutorTask *steal( Worker *worker );
+
+
+private:
+    std::vector< std::unique_ptr<Worker> > m_workers;
+
+    std::mutex m_injectionMutex;
+    std::deque< ExecutorTask * > m_injectionQueue;
+    /**
+     * @brief Size of the injection queue, so workers don't have to lock it to see it's empty
+     */
+    std::atomic<std::size_t> m_injectionQueueSize;
+
+    /**
+     * @brief Number of tasks waiting in any of the queues
+     */
+    std::atomic<std::size_t> m_queuedTaskCount;
+    /**
+     * @brief Number of tasks waiting or running
+     */
+    std::atomic<std::size_t> m_unfinishedTaskCount;
+
+    std::atomic<bool> m_isStopping;
+    std::atomic<unsigned> m_sleepingWorkerCount;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
+
+    std::mutex m_idleMutex;
+    std::condition_variable m_idleCondition;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "executor.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_EXECUTOR_H__
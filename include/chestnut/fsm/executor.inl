@@ -0,0 +1,229 @@
+#include <cassert>
+
+namespace chestnut::fsm
+{
+
+inline Executor::Worker::Worker()
+: deque( LOCAL_QUEUE_CAPACITY ), randomState( 0 )
+{
+
+}
+
+inline Executor::Executor( unsigned workerCount )
+{
+    if( workerCount == 0 )
+    {
+        workerCount = std::thread::hardware_concurrency();
+        if( workerCount == 0 )
+        {
+            workerCount = 1;
+        }
+    }
+
+    m_injectionQueueSize.store( 0, std::memory_order_relaxed );
+    m_queuedTaskCount.store( 0, std::memory_order_relaxed );
+    m_unfinishedTaskCount.store( 0, std::memory_order_relaxed );
+    m_isStopping.store( false, std::memory_order_relaxed );
+    m_sleepingWorkerCount.store( 0, std::memory_order_relaxed );
+
+    // all workers have to exist before any of them starts stealing
+    for( unsigned i = 0; i < workerCount; i++ )
+    {
+        m_workers.emplace_back( new Worker() );
+        m_workers.back()->randomState = 0x9E3779B97F4A7C15ull * ( i + 1 );
+    }
+
+    for( std::unique_ptr<Worker>& worker : m_workers )
+    {
+        Worker *workerPtr = worker.get();
+        worker->thread = std::thread( [this, workerPtr] {
+            runWorker( workerPtr );
+        });
+    }
+}
+
+inline Executor::~Executor()
+{
+    // tasks are not owned by the executor, so they can't be just dropped - their owners may be waiting for them to run
+    waitUntilIdle();
+
+    m_isStopping.store( true, std::memory_order_seq_cst );
+
+    {
+        std::lock_guard<std::mutex> lock( m_sleepMutex );
+        m_sleepCondition.notify_all();
+    }
+
+    for( std::unique_ptr<Worker>& worker : m_workers )
+    {
+        worker->thread.join();
+    }
+}
+
+inline void Executor::schedule( ExecutorTask *task )
+{
+    // counted before the task can be taken, so that the counters never go below zero
+    m_unfinishedTaskCount.fetch_add( 1, std::memory_order_relaxed );
+    m_queuedTaskCount.fetch_add( 1, std::memory_order_seq_cst );
+
+    WorkerContext& context = currentWorkerContext();
+    if( context.executor != this || !context.worker->deque.push( task ) )
+    {
+        std::lock_guard<std::mutex> lock( m_injectionMutex );
+        m_injectionQueue.push_back( task );
+        m_injectionQueueSize.fetch_add( 1, std::memory_order_release );
+    }
+
+    // a worker going to sleep checks the task count after it's counted itself as sleeping, so one of them sees the other
+    if( m_sleepingWorkerCount.load( std::memory_order_seq_cst ) > 0 )
+    {
+        std::lock_guard<std::mutex> lock( m_sleepMutex );
+        m_sleepCondition.notify_one();
+    }
+}
+
+inline void Executor::waitUntilIdle() 
+{
+    assert( currentWorkerContext().executor != this && "Worker thread can't wait for its own executor!" );
+
+    std::unique_lock<std::mutex> lock( m_idleMutex );
+    m_idleCondition.wait( lock, [this] {
+        return m_unfinishedTaskCount.load( std::memory_order_acquire ) == 0;
+    });
+}
+
+inline unsigned Executor::getWorkerCount() const noexcept
+{
+    return static_cast<unsigned>( m_workers.size() );
+}
+
+inline Executor::WorkerContext& Executor::currentWorkerContext() noexcept
+{
+    thread_local WorkerContext context { nullptr, nullptr };
+    return context;
+}
+
+inline void Executor::runWorker( Worker *worker ) 
+{
+    WorkerContext& context = currentWorkerContext();
+    context.executor = this;
+    context.worker = worker;
+
+    // rounds without finding a task after which the worker goes to sleep
+    const int maxIdleRounds = 64;
+    int idleRounds = 0;
+
+    while( !m_isStopping.load( std::memory_order_relaxed ) )
+    {
+        ExecutorTask *task = findTask( worker );
+
+        if( task )
+        {
+            idleRounds = 0;
+            m_queuedTaskCount.fetch_sub( 1, std::memory_order_relaxed );
+
+            task->runTask();
+
+            if( m_unfinishedTaskCount.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+            {
+                std::lock_guard<std::mutex> lock( m_idleMutex );
+                m_idleCondition.notify_all();
+            }
+        }
+        else if( ++idleRounds < maxIdleRounds )
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock( m_sleepMutex );
+            m_sleepingWorkerCount.fetch_add( 1, std::memory_order_seq_cst );
+            m_sleepCondition.wait( lock, [this] {
+                return m_queuedTaskCount.load( std::memory_order_seq_cst ) > 0 || m_isStopping.load( std::memory_order_relaxed );
+            });
+            m_sleepingWorkerCount.fetch_sub( 1, std::memory_order_relaxed );
+            idleRounds = 0;
+        }
+    }
+
+    context.executor = nullptr;
+    context.worker = nullptr;
+}
+
+inline ExecutorTask *Executor::findTask( Worker *worker ) 
+{
+    ExecutorTask *task = worker->deque.pop();
+    if( task )
+    {
+        return task;
+    }
+
+    if( m_injectionQueueSize.load( std::memory_order_acquire ) > 0 )
+    {
+        task = takeFromInjectionQueue( worker );
+        if( task )
+        {
+            return task;
+        }
+    }
+
+    return steal( worker );
+}
+
+inline ExecutorTask *Executor::takeFromInjectionQueue( Worker *worker ) 
+{
+    std::lock_guard<std::mutex> lock( m_injectionMutex );
+
+    if( m_injectionQueue.empty() )
+    {
+        return nullptr;
+    }
+
+    ExecutorTask *task = m_injectionQueue.front();
+    m_injectionQueue.pop_front();
+    std::size_t taken = 1;
+
+    // take a few more into the own deque, where other workers can steal them without the lock
+    while( taken < INJECTION_BATCH_SIZE && !m_injectionQueue.empty() && worker->deque.push( m_injectionQueue.front() ) )
+    {
+        m_injectionQueue.pop_front();
+        taken++;
+    }
+
+    m_injectionQueueSize.fetch_sub( taken, std::memory_order_relaxed );
+    return task;
+}
+
+inline ExecutorTask *Executor::steal( Worker *worker ) 
+{
+    const std::size_t workerCount = m_workers.size();
+    if( workerCount < 2 )
+    {
+        return nullptr;
+    }
+
+    // xorshift, so that workers don't all go after the same victim
+    worker->randomState ^= worker->randomState << 13;
+    worker->randomState ^= worker->randomState >> 7;
+    worker->randomState ^= worker->randomState << 17;
+
+    std::size_t start = static_cast<std::size_t>( worker->randomState % workerCount );
+    for( std::size_t i = 0; i < workerCount; i++ )
+    {
+        Worker *victim = m_workers[ ( start + i ) % workerCount ].get();
+        if( victim == worker )
+        {
+            continue;
+        }
+
+        ExecutorTask *task = victim->deque.steal();
+        if( task )
+        {
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+} // namespace chestnut::fsm
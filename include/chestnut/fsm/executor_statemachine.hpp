@@ -0,0 +1,161 @@
+/**
+ * @file executor_statemachine.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with the ExecutorStatemachine wrapper
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_EXECUTOR_STATEMACHINE_H__
+#define __CHESTNUT_STATEMACHINE_EXECUTOR_STATEMACHINE_H__
+
+#include "statemachine_base.hpp"
+#include "executor.hpp"
+#include "mpsc_queue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Wrapper that runs a statemachine on the worker threads of an Executor
+ *
+ * @details
+ * Like ConcurrentStatemachine, any thread can post transition requests and events to the statemachine's lock-free inbox.
+ * Instead of a dedicated owner thread, posting a request to an idle statemachine schedules it on the executor,
+ * and whichever worker picks it up executes its requests. The statemachine stays scheduled until its inbox is drained,
+ * so a statemachine never runs on two workers at once and its requests are executed in order, while any number
+ * of statemachines share a fixed number of threads. State code doesn't change - states still call their parent's methods directly.
+ *
+ * Requests should not throw, an exception escaping a request ends the worker thread with std::terminate().
+ *
+ * The wrapper can't be destroyed while it still has requests to process, see Executor::waitUntilIdle().
+ *
+ * @tparam StatemachineType type of the wrapped statemachine, a child of StatemachineBase
+ */
+template< class StatemachineType >
+class ExecutorStatemachine : public ExecutorTask
+{
+    static_assert( std::is_base_of<StatemachineBase, StatemachineType>::value, "StatemachineType has to be a child of StatemachineBase!" );
+
+public:
+    /**
+     * @brief Type of a request function executed on a worker thread
+     */
+    typedef std::function< void( StatemachineType& ) > RequestType;
+
+    /**
+     * @brief Maximal number of requests executed before the statemachine lets other tasks run
+     */
+    static constexpr std::size_t BATCH_SIZE = 64;
+
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param executor executor that should run the statemachine
+     * @param args arguments forwarded to the constructor of the statemachine
+     */
+    template< typename ...Args >
+    explicit ExecutorStatemachine( Executor& executor, Args&& ...args );
+
+    /**
+     * @brief Destructor; the statemachine can't have requests left to process
+     */
+    ~ExecutorStatemachine();
+
+    ExecutorStatemachine( const ExecutorStatemachine& ) = delete;
+    ExecutorStatemachine& operator=( const ExecutorStatemachine& ) = delete;
+
+
+    /**
+     * @brief Get the wrapped statemachine. It can be used only from posted requests or while it has none to process
+     *
+     * @return statemachine reference
+     */
+    StatemachineType& getStatemachine() noexcept;
+    /**
+     * @brief Get the wrapped statemachine. It can be used only from posted requests or while it has none to process
+     *
+     * @return statemachine reference
+     */
+    const StatemachineType& getStatemachine() const noexcept;
+
+
+    /**
+     * @brief Post a function to be executed with the statemachine on a worker thread. Can be called from any thread
+     *
+     * @param request function taking StatemachineType&
+     */
+    template< typename F >
+    void post( F&& request );
+
+    /**
+     * @brief Post a gotoState request. Can be called from any thread
+     *
+     * @see StatemachineBase::gotoState()
+     */
+    template< class StateType, typename ...Args >
+    void postGotoState( Args&& ...args );
+
+    /**
+     * @brief Post a pushState request. Can be called from any thread
+     *
+     * @see StatemachineBase::pushState()
+     */
+    template< class StateType, typename ...Args >
+    void postPushState( Args&& ...args );
+
+    /**
+     * @brief Post a popState request. Can be called from any thread
+     *
+     * @see StatemachineBase::popState()
+     */
+    void postPopState();
+
+    /**
+     * @brief Post an event to be handled according to a transition table. Can be called from any thread
+     *
+     * @see StatemachineBase::processEvent()
+     */
+    template< class Table, class EventType >
+    void postEvent( EventType&& event );
+
+    /**
+     * @brief Get the number of requests that were posted, but not executed yet
+     */
+    std::size_t getPendingRequestCount() const noexcept;
+
+
+    /**
+     * @brief Execute a batch of posted requests; called by the executor
+     */
+    void runTask() override;
+
+
+private:
+    Executor& m_executor;
+    StatemachineType m_statemachine;
+
+    MpscQueue< RequestType > m_inbox;
+    /**
+     * @brief Number of requests posted and not executed yet; the request that raises it from 0 schedules the statemachine
+     * and it stays scheduled until the count drops back to 0
+     */
+    std::atomic<std::size_t> m_pendingRequestCount;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "executor_statemachine.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_EXECUTOR_STATEMACHINE_H__
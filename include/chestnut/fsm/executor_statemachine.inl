@@ -0,0 +1,120 @@
+#include <cassert>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace chestnut::fsm
+{
+
+template<class StatemachineType>
+template<typename ...Args>
+inline ExecutorStatemachine<StatemachineType>::ExecutorStatemachine( Executor& executor, Args&& ...args )
+: m_executor( executor ), m_statemachine( std::forward<Args>(args)... )
+{
+    m_pendingRequestCount.store( 0, std::memory_order_relaxed );
+}
+
+template<class StatemachineType>
+inline ExecutorStatemachine<StatemachineType>::~ExecutorStatemachine()
+{
+    // the executor would run a destroyed task otherwise
+    assert( m_pendingRequestCount.load( std::memory_order_acquire ) == 0 && "ExecutorStatemachine destroyed with requests left, wait for the executor to be idle first!" );
+}
+
+template<class StatemachineType>
+inline StatemachineType& ExecutorStatemachine<StatemachineType>::getStatemachine() noexcept
+{
+    return m_statemachine;
+}
+
+template<class StatemachineType>
+inline const StatemachineType& ExecutorStatemachine<StatemachineType>::getStatemachine() const noexcept
+{
+    return m_statemachine;
+}
+
+template<class StatemachineType>
+template<typename F>
+inline void ExecutorStatemachine<StatemachineType>::post( F&& request )
+{
+    // counted before it's linked, so that a running task never pops more requests than it sees counted;
+    // only the request that finds the statemachine idle schedules it, so it's never scheduled twice
+    const bool isIdle = m_pendingRequestCount.fetch_add( 1, std::memory_order_acq_rel ) == 0;
+    m_inbox.emplace( std::forward<F>( request ) );
+
+    if( isIdle )
+    {
+        m_executor.schedule( this );
+    }
+}
+
+template<class StatemachineType>
+template<class StateType, typename ...Args>
+inline void ExecutorStatemachine<StatemachineType>::postGotoState( Args&& ...args )
+{
+    post( [argsTuple = std::make_tuple( std::forward<Args>(args)... )]( StatemachineType& statemachine ) mutable {
+        std::apply( [&statemachine]( auto&& ...argsUnpacked ) {
+            statemachine.template gotoState<StateType>( std::forward<decltype(argsUnpacked)>(argsUnpacked)... );
+        }, std::move( argsTuple ) );
+    });
+}
+
+template<class StatemachineType>
+template<class StateType, typename ...Args>
+inline void ExecutorStatemachine<StatemachineType>::postPushState( Args&& ...args )
+{
+    post( [argsTuple = std::make_tuple( std::forward<Args>(args)... )]( StatemachineType& statemachine ) mutable {
+        std::apply( [&statemachine]( auto&& ...argsUnpacked ) {
+            statemachine.template pushState<StateType>( std::forward<decltype(argsUnpacked)>(argsUnpacked)... );
+        }, std::move( argsTuple ) );
+    });
+}
+
+template<class StatemachineType>
+inline void ExecutorStatemachine<StatemachineType>::postPopState()
+{
+    post( []( StatemachineType& statemachine ) {
+        statemachine.popState();
+    });
+}
+
+template<class StatemachineType>
+template<class Table, class EventType>
+inline void ExecutorStatemachine<StatemachineType>::postEvent( EventType&& event )
+{
+    // checked here as well, so that the error points at the call rather than into the posted request
+    static_assert( Table::template handlesEvent< typename std::decay<EventType>::type >, "EventType is not handled by any transition in the table!" );
+
+    post( [event = std::forward<EventType>( event )]( StatemachineType& statemachine ) {
+        statemachine.template processEvent<Table>( event );
+    });
+}
+
+template<class StatemachineType>
+inline std::size_t ExecutorStatemachine<StatemachineType>::getPendingRequestCount() const noexcept
+{
+    return m_pendingRequestCount.load( std::memory_order_acquire );
+}
+
+template<class StatemachineType>
+inline void ExecutorStatemachine<StatemachineType>::runTask()
+{
+    std::size_t processed = 0;
+    RequestType request;
+
+    // a request can already be counted while its producer is still linking it into the inbox, 
+    // then it's not popped now, but the count keeps the statemachine scheduled
+    while( processed < BATCH_SIZE && m_inbox.tryPop( request ) )
+    {
+        processed++;
+        request( m_statemachine );
+    }
+
+    // release hands the statemachine over to the worker that runs it next
+    if( m_pendingRequestCount.fetch_sub( processed, std::memory_order_acq_rel ) != processed )
+    {
+        m_executor.schedule( this );
+    }
+}
+
+} // namespace chestnut::fsm
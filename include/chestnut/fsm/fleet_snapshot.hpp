@@ -0,0 +1,144 @@
+/**
+ * @file fleet_snapshot.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with the layout of StatemachineFleet snapshot files and a read-only file mapping used to load them
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_FLEET_SNAPSHOT_H__
+#define __CHESTNUT_STATEMACHINE_FLEET_SNAPSHOT_H__
+
+#include "config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Header at the start of a StatemachineFleet snapshot file
+ *
+ * @details
+ * The header is followed by the state table - for every state type of the fleet, in order, its size, alignment and name
+ * (each of them as std::uint32_t, the name without a terminator) - and then by sections with arrays of the fleet,
+ * each starting at an offset aligned to FLEET_SNAPSHOT_SECTION_ALIGNMENT:
+ * current states, stack depths, state stacks, generations, free indices and for every state type an array of its objects,
+ * one per slot, zeroed in slots where the state is not on the stack.
+ *
+ * All numbers are in the byte order of the machine that wrote the file, which is checked with byteOrderMark.
+ *
+ * @see StatemachineFleet::writeSnapshotFile(), StatemachineFleet::bulkLoadSnapshotFile()
+ */
+struct FleetSnapshotHeader
+{
+    /** "CFFL" */
+    char magic[4];
+    /** FLEET_SNAPSHOT_FORMAT_VERSION */
+    std::uint16_t formatVersion;
+    /** sizeof(FleetSnapshotHeader) */
+    std::uint16_t headerSize;
+    /** FLEET_SNAPSHOT_BYTE_ORDER_MARK */
+    std::uint32_t byteOrderMark;
+    /** Number of state types of the fleet */
+    std::uint32_t stateCount;
+    /** Number of statemachine slots, including free ones */
+    std::uint64_t slotCount;
+    /** Number of free slots */
+    std::uint64_t freeCount;
+    /** Size of the state table in bytes */
+    std::uint64_t stateTableSize;
+    /** Size of the whole file in bytes */
+    std::uint64_t fileSize;
+};
+
+static_assert( sizeof(FleetSnapshotHeader) == 48, "FleetSnapshotHeader must not have padding!" );
+
+constexpr char FLEET_SNAPSHOT_MAGIC[4] = { 'C', 'F', 'F', 'L' };
+constexpr std::uint16_t FLEET_SNAPSHOT_FORMAT_VERSION = 1;
+constexpr std::uint32_t FLEET_SNAPSHOT_BYTE_ORDER_MARK = 0x01020304;
+/**
+ * @brief Alignment of sections in the file; a whole cache line, so every array starts on its own
+ */
+constexpr std::size_t FLEET_SNAPSHOT_SECTION_ALIGNMENT = 64;
+
+
+namespace detail
+{
+    /**
+     * @brief Offsets of sections of a fleet snapshot file
+     */
+    struct FleetSnapshotLayout
+    {
+        std::uint64_t currentStatesOffset;
+        std::uint64_t stackDepthsOffset;
+        std::uint64_t stacksOffset;
+        std::uint64_t generationsOffset;
+        std::uint64_t freeIndicesOffset;
+        /** Offset of the array of every state type, in the order of state types */
+        std::vector< std::uint64_t > columnOffsets;
+        std::uint64_t fileSize;
+    };
+
+    /**
+     * @brief Compute where sections of a snapshot with given contents are placed
+     *
+     * @param stateTableSize size of the state table
+     * @param slotCount number of statemachine slots
+     * @param freeCount number of free slots
+     * @param stateSizes sizes of state types, there have to be as many of them as state types
+     * @param stateCount number of state types, which is also the capacity of every state stack
+     */
+    FleetSnapshotLayout computeFleetSnapshotLayout( std::uint64_t stateTableSize, std::uint64_t slotCount, std::uint64_t freeCount,
+                                                    const std::size_t *stateSizes, std::size_t stateCount );
+
+    /**
+     * @brief Read-only view of a whole file
+     *
+     * @details
+     * The file is mapped into memory if CHESTNUT_FSM_HAS_MMAP is 1, so only the pages that are actually read get loaded.
+     * Otherwise it's read into a buffer.
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile() noexcept;
+        ~MappedFile();
+
+        MappedFile( const MappedFile& ) = delete;
+        MappedFile& operator=( const MappedFile& ) = delete;
+
+        /**
+         * @brief Open the file, closing the one opened before
+         *
+         * @return whether the file could be opened and read
+         */
+        bool open( const char *path );
+
+        void close() noexcept;
+
+        const unsigned char *getData() const noexcept;
+        std::size_t getSize() const noexcept;
+
+    private:
+        const unsigned char *m_data;
+        std::size_t m_size;
+#if !CHESTNUT_FSM_HAS_MMAP
+        std::vector< unsigned char > m_buffer;
+#endif
+    };
+
+} // namespace detail
+
+} // namespace chestnut::fsm
+
+
+#include "fleet_snapshot.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_FLEET_SNAPSHOT_H__
@@ -0,0 +1,153 @@
+#include <cstdio>
+
+#if CHESTNUT_FSM_HAS_MMAP
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace chestnut::fsm
+{
+
+namespace detail
+{
+    inline std::uint64_t alignFleetSnapshotOffset( std::uint64_t offset ) noexcept
+    {
+        return ( offset + FLEET_SNAPSHOT_SECTION_ALIGNMENT - 1 ) / FLEET_SNAPSHOT_SECTION_ALIGNMENT * FLEET_SNAPSHOT_SECTION_ALIGNMENT;
+    }
+
+    inline FleetSnapshotLayout computeFleetSnapshotLayout( std::uint64_t stateTableSize, std::uint64_t slotCount, std::uint64_t freeCount,
+                                                           const std::size_t *stateSizes, std::size_t stateCount )
+    {
+        FleetSnapshotLayout layout;
+
+        layout.currentStatesOffset = alignFleetSnapshotOffset( sizeof(FleetSnapshotHeader) + stateTableSize );
+        layout.stackDepthsOffset = alignFleetSnapshotOffset( layout.currentStatesOffset + slotCount );
+        layout.stacksOffset = alignFleetSnapshotOffset( layout.stackDepthsOffset + slotCount );
+        layout.generationsOffset = alignFleetSnapshotOffset( layout.stacksOffset + slotCount * stateCount );
+        layout.freeIndicesOffset = alignFleetSnapshotOffset( layout.generationsOffset + slotCount * sizeof(std::uint32_t) );
+
+        std::uint64_t end = layout.freeIndicesOffset + freeCount * sizeof(std::uint32_t);
+        layout.columnOffsets.resize( stateCount );
+        for( std::size_t i = 0; i < stateCount; i++ )
+        {
+            layout.columnOffsets[i] = alignFleetSnapshotOffset( end );
+            end = layout.columnOffsets[i] + slotCount * stateSizes[i];
+        }
+
+        layout.fileSize = end;
+        return layout;
+    }
+
+
+
+    inline MappedFile::MappedFile() noexcept
+    {
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    inline MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+#if CHESTNUT_FSM_HAS_MMAP
+    inline bool MappedFile::open( const char *path )
+    {
+        close();
+
+        const int fd = ::open( path, O_RDONLY );
+        if( fd < 0 )
+        {
+            return false;
+        }
+
+        struct stat status;
+        if( ::fstat( fd, &status ) != 0 || status.st_size <= 0 )
+        {
+            ::close( fd );
+            return false;
+        }
+
+        void *data = ::mmap( nullptr, (std::size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        // the mapping stays valid after the descriptor is closed
+        ::close( fd );
+        if( data == MAP_FAILED )
+        {
+            return false;
+        }
+
+        // snapshots are read front to back once, so the kernel can read ahead aggressively and drop pages behind
+        ::madvise( data, (std::size_t)status.st_size, MADV_SEQUENTIAL );
+
+        m_data = static_cast<const unsigned char *>( data );
+        m_size = (std::size_t)status.st_size;
+        return true;
+    }
+
+    inline void MappedFile::close() noexcept
+    {
+        if( m_data )
+        {
+            ::munmap( const_cast<unsigned char *>( m_data ), m_size );
+        }
+
+        m_data = nullptr;
+        m_size = 0;
+    }
+#else
+    inline bool MappedFile::open( const char *path )
+    {
+        close();
+
+        std::FILE *file = std::fopen( path, "rb" );
+        if( !file )
+        {
+            return false;
+        }
+
+        bool isRead = std::fseek( file, 0, SEEK_END ) == 0;
+        const long size = isRead ? std::ftell( file ) : -1;
+        isRead = size > 0 && std::fseek( file, 0, SEEK_SET ) == 0;
+        if( isRead )
+        {
+            m_buffer.resize( (std::size_t)size );
+            isRead = std::fread( m_buffer.data(), 1, m_buffer.size(), file ) == m_buffer.size();
+        }
+        std::fclose( file );
+
+        if( !isRead )
+        {
+            m_buffer.clear();
+            return false;
+        }
+
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+        return true;
+    }
+
+    inline void MappedFile::close() noexcept
+    {
+        m_buffer.clear();
+        m_buffer.shrink_to_fit();
+        m_data = nullptr;
+        m_size = 0;
+    }
+#endif
+
+    inline const unsigned char *MappedFile::getData() const noexcept
+    {
+        return m_data;
+    }
+
+    inline std::size_t MappedFile::getSize() const noexcept
+    {
+        return m_size;
+    }
+
+} // namespace detail
+
+} // namespace chestnut::fsm
@@ -9,9 +9,30 @@
  * 
  */
 
+#include "config.hpp"
 #include "exceptions.hpp"
+#include "state_id.hpp"
 #include "state_transition.hpp"
+#include "state_allocator.hpp"
 #include "state_base.hpp"
+#include "state_stack.hpp"
 #include "state.hpp"
+#include "transition_table.hpp"
+#include "statemachine_observer.hpp"
 #include "statemachine_base.hpp"
 #include "statemachine.hpp"
+#include "state_traits.hpp"
+#include "static_statemachine.hpp"
+#include "hierarchical_statemachine.hpp"
+#include "orthogonal_statemachine.hpp"
+
+// Extensions aren't included here, so that code using only the statemachines doesn't pay for compiling them.
+// Include the ones you need explicitly:
+// - timed_statemachine.hpp, timer_service.hpp - delayed transitions
+// - snapshot.hpp - saving and restoring statemachines
+// - statemachine_fleet.hpp, fleet_snapshot.hpp - large populations of statemachines with data-only states
+// - transition_journal.hpp - durable record of transitions
+// - transition_tracer.hpp, transition_metrics.hpp, histogram.hpp - diagnostics
+// - mpsc_queue.hpp, concurrent_statemachine.hpp - statemachines driven by many threads
+// - work_stealing_deque.hpp, executor.hpp, executor_statemachine.hpp - statemachines run on a thread pool
+// - coroutine_state.hpp - states written as coroutines
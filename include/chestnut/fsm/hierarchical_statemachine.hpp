@@ -0,0 +1,415 @@
+/**
+ * @file hierarchical_statemachine.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with HierarchicalStatemachine, a statemachine with nested states known at compile time
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_HIERARCHICAL_STATEMACHINE_H__
+#define __CHESTNUT_STATEMACHINE_HIERARCHICAL_STATEMACHINE_H__
+
+#include "config.hpp"
+#include "state_transition.hpp"
+#include "state_traits.hpp"
+
+#if CHESTNUT_FSM_TRACE_TRANSITIONS
+    #include "transition_tracer.hpp"
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <tuple>
+
+namespace chestnut::fsm
+{
+
+namespace detail
+{
+    /**
+     * @brief Shape of a state hierarchy, computed at compile time from ParentState and InitialState declarations
+     *
+     * @details
+     * Index 0 stands for no state and is the root of the hierarchy. Top level states have depth 1.
+     */
+    template< std::size_t N >
+    struct HierarchyTables
+    {
+        /** Number of states from the root to the state, including the state */
+        std::uint8_t depths[N];
+        /** Ancestor of every state at every depth; paths[s][depths[s]] == s */
+        std::uint8_t paths[N][N];
+        /** State entered in the end when entering a state, following its InitialState chain */
+        std::uint8_t leaves[N];
+        /** Depth of the deepest state that stays active when going from the first state to the second one */
+        std::uint8_t lcaDepths[N][N];
+
+        bool hasCycle;
+        bool hasInitialStateOutsideOfParent;
+        bool hasNotDefaultConstructibleInnerState;
+    };
+
+    template< std::size_t N >
+    constexpr HierarchyTables<N> makeHierarchyTables( const std::array< std::uint8_t, N >& parents,
+                                                      const std::array< std::uint8_t, N >& initials,
+                                                      const std::array< bool, N >& defaultConstructibles );
+
+} // namespace detail
+
+
+/**
+ * @brief History pseudo-state - passed to HierarchicalStatemachine::gotoState() enters the nested state of StateType that was active when it was last left
+ *
+ * @details
+ * States nested in the restored state are entered by their InitialState declarations.
+ * If StateType was never left yet, it's entered normally.
+ *
+ * @tparam StateType state whose history should be restored
+ */
+template< class StateType >
+struct ShallowHistory {};
+
+/**
+ * @brief History pseudo-state - passed to HierarchicalStatemachine::gotoState() enters the whole configuration of nested states of StateType that was active when it was last left
+ *
+ * @details
+ * If StateType was never left yet, it's entered normally.
+ *
+ * @tparam StateType state whose history should be restored
+ */
+template< class StateType >
+struct DeepHistory {};
+
+
+namespace detail
+{
+    template< class T >
+    struct HistoryTraits
+    {
+        static constexpr bool IS_HISTORY = false;
+        static constexpr bool IS_DEEP = false;
+        typedef T StateType;
+    };
+
+    template< class S >
+    struct HistoryTraits< ShallowHistory<S> >
+    {
+        static constexpr bool IS_HISTORY = true;
+        static constexpr bool IS_DEEP = false;
+        typedef S StateType;
+    };
+
+    template< class S >
+    struct HistoryTraits< DeepHistory<S> >
+    {
+        static constexpr bool IS_HISTORY = true;
+        static constexpr bool IS_DEEP = true;
+        typedef S StateType;
+    };
+
+} // namespace detail
+
+
+/**
+ * @brief Statemachine with states nested in one another, with the set of states known at compile time
+ *
+ * @details
+ * A state declares the state it's nested in with a `ParentState` member type and optionally the nested state
+ * that should be entered right after it with an `InitialState` member type (see state_traits.hpp).
+ * When the statemachine is in some state, it's also in all of its ancestors - all of their objects exist and getState() can access them.
+ *
+ * A transition to another state leaves only the states up to the least common ancestor of the current and the target state,
+ * from the innermost one, and then enters the states down to the target and further down through InitialState declarations.
+ * Transition to an ancestor of the current state leaves and re-enters that ancestor.
+ * Which states have to be left and entered for every pair of source and target state is computed at compile time,
+ * so a transition doesn't walk the hierarchy, it only calls the callbacks of the states involved.
+ *
+ * States are plain classes like in StaticStatemachine. Every state of the statemachine has its own storage inside of it,
+ * so the statemachine occupies about as much as all of its states together and never allocates memory for states.
+ * The target state of a transition is constructed with arguments passed to gotoState(), all other states on the entry path
+ * are default constructed, so states that are parents or initial states need to be default constructible.
+ * States on the entry path are constructed only after the states on the exit path have been left, so only the static
+ * canEnterStateType guard can refuse to enter a state; states can't define canEnterState. canLeaveState is checked in every state that would be left.
+ * Every callback gets the same StateTransition, with the innermost current and the innermost target state.
+ *
+ * Every state remembers which of its nested states was active when it was last left. Going to ShallowHistory<StateType>
+ * or DeepHistory<StateType> instead of StateType resumes StateType in its last nested state or its whole last nested configuration.
+ * With persistent states enabled (see setPersistentStates()) the left state objects are also kept alive,
+ * so resuming doesn't construct them again and they keep their data.
+ *
+ * Events dispatched with dispatchEvent() are handled by the innermost active state that has onEvent for the event type,
+ * so a parent handles events in place of all of its children that don't handle them themselves.
+ * Which state handles an event type is also computed at compile time for every possible current state.
+ *
+ * A transition requested from a state callback is executed after the callback returns.
+ * Only one such transition can be pending at a time; further requests are rejected until it's done.
+ * Transition requests from inside of onLeaveState are ignored.
+ *
+ * All state types must be complete before the statemachine type is used, so callbacks that call the statemachine
+ * should be defined after all of the state classes.
+ * Exceptions thrown by state callbacks are not wrapped and propagate to the caller unchanged.
+ *
+ * @tparam States state types of the statemachine
+ */
+template< class ...States >
+class HierarchicalStatemachine
+{
+    static_assert( sizeof...(States) > 0, "HierarchicalStatemachine needs at least one state type!" );
+    static_assert( sizeof...(States) < 255, "HierarchicalStatemachine supports at most 254 state types!" );
+
+public:
+    /**
+     * @brief Constructor; the statemachine starts without any state
+     */
+    HierarchicalStatemachine() noexcept;
+
+    /**
+     * @brief Destructor; calls onLeaveState of all active states, from the innermost one, with STATE_TRANSITION_DESTROY
+     */
+    ~HierarchicalStatemachine();
+
+    HierarchicalStatemachine( const HierarchicalStatemachine& ) = delete;
+    HierarchicalStatemachine& operator=( const HierarchicalStatemachine& ) = delete;
+
+
+    /**
+     * @brief Get the pointer to a state object if the statemachine is in that state or in one of its nested states
+     *
+     * @tparam StateType type of the state
+     * @return pointer to the state or nullptr if the state is not active
+     */
+    template< class StateType >
+    StateType *getState() noexcept;
+    /**
+     * @brief Get the pointer to a state object if the statemachine is in that state or in one of its nested states
+     *
+     * @tparam StateType type of the state
+     * @return pointer to the state or nullptr if the state is not active
+     */
+    template< class StateType >
+    const StateType *getState() const noexcept;
+
+    /**
+     * @brief Get the type identifier of the innermost current state or NULL_STATE if statemachine was not initialized
+     */
+    StateId getCurrentStateType() const noexcept;
+
+    /**
+     * @brief Get the position of the innermost current state's type on the States list plus one or 0 if statemachine was not initialized
+     */
+    std::size_t getCurrentStateIndex() const noexcept;
+
+    /**
+     * @brief Get the value returned by getCurrentStateIndex() when statemachine is in given state
+     */
+    template< class StateType >
+    static constexpr std::size_t stateIndexOf() noexcept;
+
+    /**
+     * @brief Return whether the given state is the innermost current state
+     */
+    template< class StateType >
+    bool isCurrentlyInState() const noexcept;
+
+    /**
+     * @brief Return whether the statemachine is in the given state or in any of its nested states
+     */
+    template< class StateType >
+    bool isInState() const noexcept;
+
+    /**
+     * @brief Get the number of active states, i.e. the depth of the innermost current state
+     */
+    std::size_t getActiveStateCount() const noexcept;
+
+
+    /**
+     * @brief Explicitly initialize the statemachine
+     *
+     * @tparam StateType type of the initial state
+     * @tparam Args types of StateType constructor parameters
+     * @param args arguments that should be forwarded to StateType constructor
+     * @return whether statemachine was able to change the state
+     *
+     * @details
+     * If the statemachine is already in some state, it won't do anything.
+     * Ancestors of the state are entered before it.
+     */
+    template< class StateType, typename ...Args >
+    bool initState( Args&& ...args );
+
+    /**
+     * @brief Transitions to the specified state, leaving and entering only the states that differ
+     *
+     * @tparam StateType type of the state statemachine should transition to
+     * @tparam Args types of StateType constructor parameters
+     * @param args arguments that should be forwarded to StateType constructor
+     * @return whether statemachine was able to change the state or, if called from a state callback, whether the transition was scheduled
+     *
+     * @details
+     * If StateType is the innermost current state, method does nothing.
+     * If the statemachine was not initialized, the transition type is STATE_TRANSITION_INIT.
+     * StateType can also be ShallowHistory or DeepHistory of a state, which then takes no arguments.
+     *
+     * @see ShallowHistory, DeepHistory
+     */
+    template< class StateType, typename ...Args >
+    bool gotoState( Args&& ...args );
+
+    /**
+     * @brief Pass an event to the innermost active state handling it
+     *
+     * @param event event object
+     * @return whether any active state has an onEvent method for this event type
+     *
+     * @details
+     * Transitions requested by the state while handling the event are executed after the handler returns.
+     */
+    template< class EventType >
+    bool dispatchEvent( const EventType& event );
+
+
+    /**
+     * @brief Enable or disable persistent states
+     *
+     * @param enabled whether the mode should be enabled
+     *
+     * @details
+     * By default a state object is destroyed when the state is left. With persistent states, the object is kept in the statemachine
+     * and the next time the state is entered without constructor arguments - in particular through ShallowHistory or DeepHistory - it's reused.
+     * Its constructor isn't called again, onRearmState() is called instead, if the state has one, before onEnterState.
+     * A state kept this way can also be resumed by history even if it isn't default constructible.
+     *
+     * Disabling the mode destroys all kept state objects.
+     *
+     * @see StatemachineBase::setPersistentStates()
+     */
+    void setPersistentStates( bool enabled );
+
+    /**
+     * @brief Return whether persistent states are enabled
+     */
+    bool isPersistentStates() const noexcept;
+
+    /**
+     * @brief Forget the nested states remembered for history, so that history pseudo-states enter states normally
+     */
+    void clearHistory() noexcept;
+
+
+private:
+    static constexpr std::size_t INDEX_COUNT = sizeof...(States) + 1;
+
+    /**
+     * @brief Leaves the statemachine ready for next transitions once processing ends, even if a callback throws
+     */
+    struct ProcessingGuard
+    {
+        HierarchicalStatemachine& statemachine;
+
+        ~ProcessingGuard();
+    };
+
+    template< class StateType >
+    static constexpr std::size_t parentIndexOf() noexcept;
+    template< class StateType >
+    static constexpr std::size_t initialIndexOf() noexcept;
+
+    static const detail::HierarchyTables< INDEX_COUNT >& tables() noexcept;
+
+    /**
+     * @brief Index of the state handling the event type for every innermost current state, 0 if none does
+     */
+    template< class EventType >
+    static const std::array< std::uint8_t, INDEX_COUNT >& eventHandlers() noexcept;
+
+    static StateId stateIdOfIndex( std::size_t index ) noexcept;
+
+    template< class StateType >
+    std::optional<StateType>& slot() noexcept;
+    template< class StateType >
+    const std::optional<StateType>& slot() const noexcept;
+
+    /**
+     * @brief Call a function with the state object of given index
+     */
+    template< typename F >
+    void visitState( std::size_t index, F&& f );
+
+    bool canEnterStateType( std::size_t index, StateTransition transition ) const;
+    void resetState( std::size_t index ) noexcept;
+
+    /**
+     * @brief Make the state object ready to be entered - reuse the kept one if there's one and no arguments are given, otherwise construct it
+     */
+    template< class StateType, typename ...Args >
+    void prepareState( Args&& ...args );
+
+    /**
+     * @brief Make the state object of given index ready to be entered without constructor arguments
+     */
+    void prepareStateOfIndex( std::size_t index );
+
+    /**
+     * @brief Return whether the state of given index can be entered without constructor arguments
+     */
+    bool canPrepareStateOfIndex( std::size_t index ) const noexcept;
+
+    /**
+     * @brief Destroy the state object that was left, unless persistent states are enabled
+     */
+    void disposeState( std::size_t index ) noexcept;
+
+    /**
+     * @brief Find the state entered when going to the history of a state
+     */
+    std::size_t resolveHistory( std::size_t index, bool isDeep ) const noexcept;
+
+    /**
+     * @brief Resolve the target state and perform the transition
+     */
+    template< class StateType, typename ...Args >
+    bool transitionTo( Args&& ...args );
+
+    /**
+     * @brief Leave states up to the common ancestor and enter states down to the target
+     *
+     * @param target state that was requested
+     * @param to innermost state that will be entered
+     * @param prepareTarget function preparing the target state object
+     */
+    template< typename F >
+    bool performTransition( std::size_t target, std::size_t to, F&& prepareTarget );
+
+    /**
+     * @brief Execute the transition requested from a callback, and then the one it requested, and so on
+     */
+    void runPendingTransitions();
+
+
+private:
+    std::tuple< std::optional<States>... > m_states;
+    std::uint8_t m_currentState;
+    /**
+     * @brief Nested state that was active when the state was last left, for every state; 0 if none was yet
+     */
+    std::array< std::uint8_t, INDEX_COUNT > m_history;
+    bool m_isPersistentStates;
+    bool m_isProcessingTransition;
+    bool m_isCurrentlyLeavingAState;
+    std::function<void()> m_pendingTransition;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "hierarchical_statemachine.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_HIERARCHICAL_STATEMACHINE_H__
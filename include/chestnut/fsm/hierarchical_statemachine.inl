@@ -0,0 +1,639 @@
+#include <type_traits>
+#include <utility>
+
+namespace chestnut::fsm
+{
+
+namespace detail
+{
+    template< std::size_t N >
+    constexpr HierarchyTables<N> makeHierarchyTables( const std::array< std::uint8_t, N >& parents,
+                                                      const std::array< std::uint8_t, N >& initials,
+                                                      const std::array< bool, N >& defaultConstructibles )
+    {
+        HierarchyTables<N> tables {};
+
+        // ancestors of every state, gathered by walking up the parents
+        for( std::size_t state = 1; state < N; state++ )
+        {
+            std::uint8_t chain[N] = {};
+            std::size_t length = 0;
+            std::size_t current = state;
+            while( current != 0 && length < N - 1 )
+            {
+                chain[length++] = (std::uint8_t)current;
+                current = parents[current];
+            }
+
+            if( current != 0 )
+            {
+                tables.hasCycle = true;
+                continue;
+            }
+
+            tables.depths[state] = (std::uint8_t)length;
+            for( std::size_t depth = 1; depth <= length; depth++ )
+            {
+                tables.paths[state][depth] = chain[ length - depth ];
+            }
+        }
+
+        for( std::size_t state = 1; state < N; state++ )
+        {
+            std::size_t current = state;
+            while( initials[current] != 0 )
+            {
+                if( parents[ initials[current] ] != current )
+                {
+                    tables.hasInitialStateOutsideOfParent = true;
+                    break;
+                }
+                current = initials[current];
+            }
+            tables.leaves[state] = (std::uint8_t)current;
+
+            if( ( parents[state] != 0 && !defaultConstructibles[ parents[state] ] )
+             || ( initials[state] != 0 && !defaultConstructibles[ initials[state] ] ) )
+            {
+                tables.hasNotDefaultConstructibleInnerState = true;
+            }
+        }
+
+        for( std::size_t from = 0; from < N; from++ )
+        {
+            for( std::size_t to = 1; to < N; to++ )
+            {
+                const std::size_t fromDepth = tables.depths[from];
+                const std::size_t toDepth = tables.depths[to];
+
+                if( toDepth <= fromDepth && tables.paths[from][toDepth] == to )
+                {
+                    // going to the state itself or to its ancestor, which is then left and entered again
+                    tables.lcaDepths[from][to] = (std::uint8_t)( toDepth - 1 );
+                }
+                else
+                {
+                    std::size_t depth = 0;
+                    while( depth < fromDepth && depth < toDepth && tables.paths[from][depth + 1] == tables.paths[to][depth + 1] )
+                    {
+                        depth++;
+                    }
+                    tables.lcaDepths[from][to] = (std::uint8_t)depth;
+                }
+            }
+        }
+
+        return tables;
+    }
+
+    template< std::size_t N >
+    constexpr std::array< std::uint8_t, N > makeEventHandlers( const std::array< std::uint8_t, N >& parents, const std::array< bool, N >& hasHandlers )
+    {
+        std::array< std::uint8_t, N > handlers {};
+
+        for( std::size_t state = 1; state < N; state++ )
+        {
+            std::size_t current = state;
+            while( current != 0 && !hasHandlers[current] )
+            {
+                current = parents[current];
+            }
+            handlers[state] = (std::uint8_t)current;
+        }
+
+        return handlers;
+    }
+
+} // namespace detail
+
+
+
+template<class ...States>
+inline HierarchicalStatemachine<States...>::HierarchicalStatemachine() noexcept
+{
+    static_assert( ( !detail::isDetected<detail::CanEnterStateOp, States> && ... )
+                && ( !detail::isDetected<detail::CanEnterStateWithMachineOp, States, HierarchicalStatemachine> && ... ),
+        "States of HierarchicalStatemachine can't define canEnterState, use the static canEnterStateType guard instead!" );
+
+    m_currentState = 0;
+    m_history.fill(0);
+    m_isPersistentStates = false;
+    m_isProcessingTransition = false;
+    m_isCurrentlyLeavingAState = false;
+}
+
+template<class ...States>
+inline HierarchicalStatemachine<States...>::~HierarchicalStatemachine()
+{
+    m_isCurrentlyLeavingAState = true;
+
+    StateTransition transition;
+    transition.type = STATE_TRANSITION_DESTROY;
+    transition.prevState = getCurrentStateType();
+    transition.nextState = NULL_STATE;
+
+    if( m_currentState != 0 )
+    {
+        CHESTNUT_FSM_TRACE_TRANSITION( this, transition );
+    }
+
+    const detail::HierarchyTables< INDEX_COUNT >& t = tables();
+    while( m_currentState != 0 )
+    {
+        const std::size_t index = m_currentState;
+        m_currentState = t.paths[index][ t.depths[index] - 1 ];
+
+        visitState( index, [this, &transition]( auto& state ) {
+            detail::callOnLeaveState( state, *this, transition );
+        });
+        resetState( index );
+    }
+}
+
+template<class ...States>
+template<class StateType>
+inline StateType *HierarchicalStatemachine<States...>::getState() noexcept
+{
+    return isInState<StateType>() ? &*slot<StateType>() : nullptr;
+}
+
+template<class ...States>
+template<class StateType>
+inline const StateType *HierarchicalStatemachine<States...>::getState() const noexcept
+{
+    return isInState<StateType>() ? &*slot<StateType>() : nullptr;
+}
+
+template<class ...States>
+inline StateId HierarchicalStatemachine<States...>::getCurrentStateType() const noexcept
+{
+    return stateIdOfIndex( m_currentState );
+}
+
+template<class ...States>
+inline std::size_t HierarchicalStatemachine<States...>::getCurrentStateIndex() const noexcept
+{
+    return m_currentState;
+}
+
+template<class ...States>
+template<class StateType>
+inline constexpr std::size_t HierarchicalStatemachine<States...>::stateIndexOf() noexcept
+{
+    static_assert( detail::isOneOf<StateType, States...>, "StateType is not a state of this statemachine!" );
+
+    // index 0 means no state
+    return detail::IndexOf<StateType, States...>::value + 1;
+}
+
+template<class ...States>
+template<class StateType>
+inline bool HierarchicalStatemachine<States...>::isCurrentlyInState() const noexcept
+{
+    return m_currentState == stateIndexOf<StateType>();
+}
+
+template<class ...States>
+template<class StateType>
+inline bool HierarchicalStatemachine<States...>::isInState() const noexcept
+{
+    const detail::HierarchyTables< INDEX_COUNT >& t = tables();
+    const std::size_t depth = t.depths[ stateIndexOf<StateType>() ];
+
+    return depth <= t.depths[m_currentState] && t.paths[m_currentState][depth] == stateIndexOf<StateType>();
+}
+
+template<class ...States>
+inline std::size_t HierarchicalStatemachine<States...>::getActiveStateCount() const noexcept
+{
+    return tables().depths[m_currentState];
+}
+
+template<class ...States>
+template<class StateType, typename ...Args>
+inline bool HierarchicalStatemachine<States...>::initState( Args&& ...args )
+{
+    static_assert( detail::isOneOf<StateType, States...>, "StateType is not a state of this statemachine!" );
+
+    if( m_currentState != 0 || m_isProcessingTransition )
+    {
+        return false;
+    }
+
+    ProcessingGuard guard { *this };
+
+    m_isProcessingTransition = true;
+
+    bool result = transitionTo<StateType>( std::forward<Args>(args)... );
+    runPendingTransitions();
+
+    return result;
+}
+
+template<class ...States>
+template<class StateType, typename ...Args>
+inline bool HierarchicalStatemachine<States...>::gotoState( Args&& ...args )
+{
+    typedef detail::HistoryTraits<StateType> HistoryTraitsType;
+
+    static_assert( detail::isOneOf<typename HistoryTraitsType::StateType, States...>, "StateType is not a state of this statemachine!" );
+    static_assert( !HistoryTraitsType::IS_HISTORY || sizeof...(Args) == 0, "History pseudo-states don't take constructor arguments!" );
+
+    if( m_isCurrentlyLeavingAState )
+    {
+        return false;
+    }
+
+    if( m_isProcessingTransition )
+    {
+        // called from a state callback, the transition will happen after it returns
+        if( m_pendingTransition )
+        {
+            return false;
+        }
+
+        m_pendingTransition = [this, argsTuple = std::make_tuple( std::forward<Args>(args)... )]() mutable {
+            std::apply( [this]( auto& ...args ) {
+                transitionTo<StateType>( std::move(args)... );
+            }, argsTuple );
+        };
+        return true;
+    }
+
+    ProcessingGuard guard { *this };
+
+    m_isProcessingTransition = true;
+
+    bool result = transitionTo<StateType>( std::forward<Args>(args)... );
+    runPendingTransitions();
+
+    return result;
+}
+
+template<class ...States>
+template<class EventType>
+inline bool HierarchicalStatemachine<States...>::dispatchEvent( const EventType& event )
+{
+    const std::size_t handler = eventHandlers<EventType>()[m_currentState];
+    if( handler == 0 )
+    {
+        return false;
+    }
+
+    auto handleEvent = [this, handler, &event] {
+        visitState( handler, [this, &event]( auto& state ) {
+            detail::callOnEvent( state, *this, event );
+        });
+    };
+
+    if( m_isProcessingTransition )
+    {
+        // an event dispatched from a callback; any transition it requests gets picked up by the outer call
+        handleEvent();
+        return true;
+    }
+
+    ProcessingGuard guard { *this };
+
+    m_isProcessingTransition = true;
+
+    handleEvent();
+    runPendingTransitions();
+
+    return true;
+}
+
+template<class ...States>
+inline void HierarchicalStatemachine<States...>::setPersistentStates( bool enabled )
+{
+    m_isPersistentStates = enabled;
+
+    if( !enabled )
+    {
+        ( (void)( isInState<States>() || ( slot<States>().reset(), true ) ), ... );
+    }
+}
+
+template<class ...States>
+inline bool HierarchicalStatemachine<States...>::isPersistentStates() const noexcept
+{
+    return m_isPersistentStates;
+}
+
+template<class ...States>
+inline void HierarchicalStatemachine<States...>::clearHistory() noexcept
+{
+    m_history.fill(0);
+}
+
+
+
+template<class ...States>
+inline HierarchicalStatemachine<States...>::ProcessingGuard::~ProcessingGuard()
+{
+    statemachine.m_isProcessingTransition = false;
+    statemachine.m_isCurrentlyLeavingAState = false;
+    statemachine.m_pendingTransition = nullptr;
+}
+
+template<class ...States>
+template<class StateType>
+inline constexpr std::size_t HierarchicalStatemachine<States...>::parentIndexOf() noexcept
+{
+    if constexpr( detail::isDetected<detail::ParentStateOp, StateType> )
+    {
+        static_assert( detail::isOneOf<typename StateType::ParentState, States...>, "ParentState of a state is not a state of this statemachine!" );
+        return stateIndexOf<typename StateType::ParentState>();
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+template<class ...States>
+template<class StateType>
+inline constexpr std::size_t HierarchicalStatemachine<States...>::initialIndexOf() noexcept
+{
+    if constexpr( detail::isDetected<detail::InitialStateOp, StateType> )
+    {
+        static_assert( detail::isOneOf<typename StateType::InitialState, States...>, "InitialState of a state is not a state of this statemachine!" );
+        return stateIndexOf<typename StateType::InitialState>();
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+template<class ...States>
+inline const detail::HierarchyTables< HierarchicalStatemachine<States...>::INDEX_COUNT >& HierarchicalStatemachine<States...>::tables() noexcept
+{
+    static constexpr detail::HierarchyTables< INDEX_COUNT > TABLES = detail::makeHierarchyTables< INDEX_COUNT >(
+        { 0, (std::uint8_t)parentIndexOf<States>()... },
+        { 0, (std::uint8_t)initialIndexOf<States>()... },
+        { true, std::is_default_constructible<States>::value... }
+    );
+
+    static_assert( !TABLES.hasCycle, "ParentState declarations of states form a cycle!" );
+    static_assert( !TABLES.hasInitialStateOutsideOfParent, "InitialState of a state must have that state as its ParentState!" );
+    static_assert( !TABLES.hasNotDefaultConstructibleInnerState, "States that are a ParentState or an InitialState must be default constructible!" );
+
+    return TABLES;
+}
+
+template<class ...States>
+template<class EventType>
+inline const std::array< std::uint8_t, HierarchicalStatemachine<States...>::INDEX_COUNT >& HierarchicalStatemachine<States...>::eventHandlers() noexcept
+{
+    static constexpr std::array< std::uint8_t, INDEX_COUNT > HANDLERS = detail::makeEventHandlers< INDEX_COUNT >(
+        { 0, (std::uint8_t)parentIndexOf<States>()... },
+        { false, detail::hasOnEvent<States, HierarchicalStatemachine, EventType>... }
+    );
+
+    return HANDLERS;
+}
+
+template<class ...States>
+inline StateId HierarchicalStatemachine<States...>::stateIdOfIndex( std::size_t index ) noexcept
+{
+    static const StateId ids[] = { NULL_STATE, stateIdOf<States>()... };
+    return ids[index];
+}
+
+template<class ...States>
+template<class StateType>
+inline std::optional<StateType>& HierarchicalStatemachine<States...>::slot() noexcept
+{
+    return std::get< std::optional<StateType> >( m_states );
+}
+
+template<class ...States>
+template<class StateType>
+inline const std::optional<StateType>& HierarchicalStatemachine<States...>::slot() const noexcept
+{
+    return std::get< std::optional<StateType> >( m_states );
+}
+
+template<class ...States>
+template<typename F>
+inline void HierarchicalStatemachine<States...>::visitState( std::size_t index, F&& f )
+{
+    (void)( ( index == stateIndexOf<States>() ? ( f( *slot<States>() ), true ) : false ) || ... );
+}
+
+template<class ...States>
+inline bool HierarchicalStatemachine<States...>::canEnterStateType( std::size_t index, StateTransition transition ) const
+{
+    bool canEnter = true;
+    (void)( ( index == stateIndexOf<States>() ? ( canEnter = detail::callCanEnterStateType<States>( *this, transition ), true ) : false ) || ... );
+    return canEnter;
+}
+
+template<class ...States>
+template<class StateType, typename ...Args>
+inline void HierarchicalStatemachine<States...>::prepareState( Args&& ...args )
+{
+    if constexpr( sizeof...(Args) == 0 )
+    {
+        if( m_isPersistentStates && slot<StateType>().has_value() )
+        {
+            detail::callOnRearmState( *slot<StateType>(), *this );
+            return;
+        }
+    }
+
+    slot<StateType>().emplace( std::forward<Args>(args)... );
+}
+
+template<class ...States>
+inline void HierarchicalStatemachine<States...>::prepareStateOfIndex( std::size_t index )
+{
+    auto prepare = [this]( auto *typeTag ) {
+        using StateType = std::remove_pointer_t< decltype(typeTag) >;
+        if constexpr( std::is_default_constructible<StateType>::value )
+        {
+            prepareState<StateType>();
+        }
+        else
+        {
+            // only a kept object can get here, which is checked in canPrepareStateOfIndex()
+            detail::callOnRearmState( *slot<StateType>(), *this );
+        }
+    };
+
+    (void)( ( index == stateIndexOf<States>() ? ( prepare( (States *)nullptr ), true ) : false ) || ... );
+}
+
+template<class ...States>
+inline bool HierarchicalStatemachine<States...>::canPrepareStateOfIndex( std::size_t index ) const noexcept
+{
+    static constexpr bool defaultConstructibles[] = { true, std::is_default_constructible<States>::value... };
+    if( defaultConstructibles[index] )
+    {
+        return true;
+    }
+
+    bool isKept = false;
+    (void)( ( index == stateIndexOf<States>() ? ( isKept = slot<States>().has_value(), true ) : false ) || ... );
+    return m_isPersistentStates && isKept;
+}
+
+template<class ...States>
+inline void HierarchicalStatemachine<States...>::disposeState( std::size_t index ) noexcept
+{
+    if( !m_isPersistentStates )
+    {
+        resetState( index );
+    }
+}
+
+template<class ...States>
+inline std::size_t HierarchicalStatemachine<States...>::resolveHistory( std::size_t index, bool isDeep ) const noexcept
+{
+    std::size_t current = index;
+    do
+    {
+        const std::size_t child = m_history[current];
+        if( child == 0 || !canPrepareStateOfIndex( child ) )
+        {
+            break;
+        }
+
+        current = child;
+
+    } while( isDeep );
+
+    // whatever wasn't remembered is entered normally
+    return tables().leaves[current];
+}
+
+template<class ...States>
+template<class StateType, typename ...Args>
+inline bool HierarchicalStatemachine<States...>::transitionTo( Args&& ...args )
+{
+    typedef detail::HistoryTraits<StateType> HistoryTraitsType;
+    typedef typename HistoryTraitsType::StateType TargetStateType;
+
+    if constexpr( HistoryTraitsType::IS_HISTORY )
+    {
+        static_assert( std::is_default_constructible<TargetStateType>::value, "State whose history is restored must be default constructible!" );
+
+        const std::size_t to = resolveHistory( stateIndexOf<TargetStateType>(), HistoryTraitsType::IS_DEEP );
+        if( to == m_currentState )
+        {
+            return false;
+        }
+
+        // the restored state is the target, so that states on the way to it are entered normally
+        return performTransition( to, to, [this, to] {
+            prepareStateOfIndex( to );
+        });
+    }
+    else
+    {
+        if( isCurrentlyInState<TargetStateType>() )
+        {
+            return false;
+        }
+
+        constexpr std::size_t target = stateIndexOf<TargetStateType>();
+        return performTransition( target, tables().leaves[target], [&] {
+            prepareState<TargetStateType>( std::forward<Args>(args)... );
+        });
+    }
+}
+
+template<class ...States>
+inline void HierarchicalStatemachine<States...>::resetState( std::size_t index ) noexcept
+{
+    (void)( ( index == stateIndexOf<States>() ? ( slot<States>().reset(), true ) : false ) || ... );
+}
+
+template<class ...States>
+template<typename F>
+inline bool HierarchicalStatemachine<States...>::performTransition( std::size_t target, std::size_t to, F&& prepareTarget )
+{
+    const detail::HierarchyTables< INDEX_COUNT >& t = tables();
+
+    const std::size_t from = m_currentState;
+    const std::size_t lcaDepth = t.lcaDepths[from][target];
+
+    StateTransition transition;
+    transition.type = from != 0 ? STATE_TRANSITION_GOTO : STATE_TRANSITION_INIT;
+    transition.prevState = stateIdOfIndex( from );
+    transition.nextState = stateIdOfIndex( to );
+
+    for( std::size_t depth = t.depths[from]; depth > lcaDepth; depth-- )
+    {
+        bool canLeave = true;
+        visitState( t.paths[from][depth], [this, &transition, &canLeave]( auto& state ) {
+            canLeave = detail::callCanLeaveState( state, *this, transition );
+        });
+
+        if( !canLeave )
+        {
+            return false;
+        }
+    }
+
+    for( std::size_t depth = lcaDepth + 1; depth <= t.depths[to]; depth++ )
+    {
+        if( !canEnterStateType( t.paths[to][depth], transition ) )
+        {
+            return false;
+        }
+    }
+
+    CHESTNUT_FSM_TRACE_TRANSITION( this, transition );
+
+    m_isCurrentlyLeavingAState = true;
+    for( std::size_t depth = t.depths[from]; depth > lcaDepth; depth-- )
+    {
+        const std::size_t index = t.paths[from][depth];
+
+        visitState( index, [this, &transition]( auto& state ) {
+            detail::callOnLeaveState( state, *this, transition );
+        });
+        disposeState( index );
+
+        m_currentState = t.paths[from][depth - 1];
+        m_history[m_currentState] = (std::uint8_t)index;
+    }
+    m_isCurrentlyLeavingAState = false;
+
+    for( std::size_t depth = lcaDepth + 1; depth <= t.depths[to]; depth++ )
+    {
+        const std::size_t index = t.paths[to][depth];
+
+        if( index == target )
+        {
+            prepareTarget();
+        }
+        else
+        {
+            prepareStateOfIndex( index );
+        }
+
+        m_currentState = (std::uint8_t)index;
+
+        visitState( index, [this, &transition]( auto& state ) {
+            detail::callOnEnterState( state, *this, transition );
+        });
+    }
+
+    return true;
+}
+
+template<class ...States>
+inline void HierarchicalStatemachine<States...>::runPendingTransitions()
+{
+    while( m_pendingTransition )
+    {
+        std::function<void()> transition = std::move( m_pendingTransition );
+        m_pendingTransition = nullptr;
+        transition();
+    }
+}
+
+} // namespace chestnut::fsm
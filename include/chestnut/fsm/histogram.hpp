@@ -0,0 +1,137 @@
+/**
+ * @file histogram.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with Histogram, a log-linear histogram of durations in the style of HdrHistogram
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_HISTOGRAM_H__
+#define __CHESTNUT_STATEMACHINE_HISTOGRAM_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Histogram of non-negative integer values with a bounded relative error, covering the whole 64-bit range
+ *
+ * @details
+ * Like in HdrHistogram, every power of 2 is split into the same number of linear sub-buckets,
+ * so a value is stored with a relative error below 1 / SUB_BUCKET_COUNT (6.25%), whatever its magnitude.
+ * Values below SUB_BUCKET_COUNT get a bucket each. Recording is a few bit operations and an increment.
+ *
+ * Count, sum, minimum and maximum are kept exactly, percentiles are accurate to the bucket.
+ */
+class Histogram
+{
+public:
+    /**
+     * @brief Number of bits of a value after its highest set bit that select the sub-bucket
+     */
+    static constexpr std::size_t SUB_BUCKET_BITS = 4;
+    static constexpr std::size_t SUB_BUCKET_COUNT = std::size_t(1) << SUB_BUCKET_BITS;
+    static constexpr std::size_t BUCKET_COUNT = SUB_BUCKET_COUNT + ( 64 - SUB_BUCKET_BITS ) * SUB_BUCKET_COUNT;
+
+
+public:
+    /**
+     * @brief Constructor; creates an empty histogram
+     */
+    Histogram() noexcept;
+
+
+    /**
+     * @brief Get the index of the bucket the value falls into
+     */
+    static std::size_t bucketIndexOf( std::uint64_t value ) noexcept;
+
+    /**
+     * @brief Get the smallest value that falls into the bucket
+     */
+    static std::uint64_t bucketLowerBound( std::size_t bucketIndex ) noexcept;
+
+    /**
+     * @brief Get the largest value that falls into the bucket
+     */
+    static std::uint64_t bucketUpperBound( std::size_t bucketIndex ) noexcept;
+
+
+    /**
+     * @brief Record a value given number of times
+     */
+    void record( std::uint64_t value, std::uint64_t count = 1 ) noexcept;
+
+    /**
+     * @brief Add all values recorded by another histogram
+     */
+    void add( const Histogram& other ) noexcept;
+
+    /**
+     * @brief Remove all values
+     */
+    void clear() noexcept;
+
+
+    /**
+     * @brief Get the number of recorded values
+     */
+    std::uint64_t getTotalCount() const noexcept;
+
+    /**
+     * @brief Get the number of values recorded in the bucket
+     */
+    std::uint64_t getBucketCount( std::size_t bucketIndex ) const noexcept;
+
+    /**
+     * @brief Get the sum of all recorded values
+     */
+    std::uint64_t getSum() const noexcept;
+
+    /**
+     * @brief Get the smallest recorded value or 0 if the histogram is empty
+     */
+    std::uint64_t getMin() const noexcept;
+
+    /**
+     * @brief Get the largest recorded value or 0 if the histogram is empty
+     */
+    std::uint64_t getMax() const noexcept;
+
+    /**
+     * @brief Get the average of recorded values or 0 if the histogram is empty
+     */
+    double getMean() const noexcept;
+
+    /**
+     * @brief Get the value below or at which given percent of recorded values are
+     *
+     * @param percentile number between 0 and 100
+     * @return upper bound of the bucket the percentile falls into, but no more than the maximum; 0 if the histogram is empty
+     */
+    std::uint64_t getValueAtPercentile( double percentile ) const noexcept;
+
+
+private:
+    std::array< std::uint64_t, BUCKET_COUNT > m_buckets;
+    std::uint64_t m_totalCount;
+    std::uint64_t m_sum;
+    std::uint64_t m_min;
+    std::uint64_t m_max;
+
+    friend class TransitionMetrics;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "histogram.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_HISTOGRAM_H__
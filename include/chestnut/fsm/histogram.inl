@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace chestnut::fsm
+{
+
+namespace detail
+{
+    inline std::size_t highestBitIndex( std::uint64_t value ) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - (std::size_t)__builtin_clzll( value );
+#else
+        std::size_t index = 0;
+        while( value >>= 1 )
+        {
+            index++;
+        }
+        return index;
+#endif
+    }
+
+} // namespace detail
+
+
+
+inline Histogram::Histogram() noexcept
+{
+    clear();
+}
+
+inline std::size_t Histogram::bucketIndexOf( std::uint64_t value ) noexcept
+{
+    if( value < SUB_BUCKET_COUNT )
+    {
+        return (std::size_t)value;
+    }
+
+    const std::size_t exponent = detail::highestBitIndex( value );
+    const std::size_t subBucket = (std::size_t)( value >> ( exponent - SUB_BUCKET_BITS ) ) & ( SUB_BUCKET_COUNT - 1 );
+
+    return SUB_BUCKET_COUNT + ( exponent - SUB_BUCKET_BITS ) * SUB_BUCKET_COUNT + subBucket;
+}
+
+inline std::uint64_t Histogram::bucketLowerBound( std::size_t bucketIndex ) noexcept
+{
+    if( bucketIndex < SUB_BUCKET_COUNT )
+    {
+        return bucketIndex;
+    }
+
+    const std::size_t exponent = ( bucketIndex - SUB_BUCKET_COUNT ) / SUB_BUCKET_COUNT + SUB_BUCKET_BITS;
+    const std::uint64_t subBucket = ( bucketIndex - SUB_BUCKET_COUNT ) % SUB_BUCKET_COUNT;
+
+    return ( std::uint64_t(1) << exponent ) | ( subBucket << ( exponent - SUB_BUCKET_BITS ) );
+}
+
+inline std::uint64_t Histogram::bucketUpperBound( std::size_t bucketIndex ) noexcept
+{
+    if( bucketIndex + 1 >= BUCKET_COUNT )
+    {
+        return std::numeric_limits<std::uint64_t>::max();
+    }
+
+    return bucketLowerBound( bucketIndex + 1 ) - 1;
+}
+
+inline void Histogram::record( std::uint64_t value, std::uint64_t count ) noexcept
+{
+    if( count == 0 )
+    {
+        return;
+    }
+
+    m_buckets[ bucketIndexOf( value ) ] += count;
+    m_totalCount += count;
+    m_sum += value * count;
+    m_min = std::min( m_min, value );
+    m_max = std::max( m_max, value );
+}
+
+inline void Histogram::add( const Histogram& other ) noexcept
+{
+    for( std::size_t i = 0; i < BUCKET_COUNT; i++ )
+    {
+        m_buckets[i] += other.m_buckets[i];
+    }
+
+    m_totalCount += other.m_totalCount;
+    m_sum += other.m_sum;
+    m_min = std::min( m_min, other.m_min );
+    m_max = std::max( m_max, other.m_max );
+}
+
+inline void Histogram::clear() noexcept
+{
+    m_buckets.fill(0);
+    m_totalCount = 0;
+    m_sum = 0;
+    m_min = std::numeric_limits<std::uint64_t>::max();
+    m_max = 0;
+}
+
+inline std::uint64_t Histogram::getTotalCount() const noexcept
+{
+    return m_totalCount;
+}
+
+inline std::uint64_t Histogram::getBucketCount( std::size_t bucketIndex ) const noexcept
+{
+    return m_buckets[bucketIndex];
+}
+
+inline std::uint64_t Histogram::getSum() const noexcept
+{
+    return m_sum;
+}
+
+inline std::uint64_t Histogram::getMin() const noexcept
+{
+    return m_totalCount > 0 ? m_min : 0;
+}
+
+inline std::uint64_t Histogram::getMax() const noexcept
+{
+    return m_max;
+}
+
+inline double Histogram::getMean() const noexcept
+{
+    return m_totalCount > 0 ? double(m_sum) / double(m_totalCount) : 0.0;
+}
+
+inline std::uint64_t Histogram::getValueAtPercentile( double percentile ) const noexcept
+{
+    if( m_totalCount == 0 )
+    {
+        return 0;
+    }
+
+    // the rank of the value, counting from 1, rounded up so that the 100th percentile is the last value
+    const double clamped = std::min( std::max( percentile, 0.0 ), 100.0 );
+    std::uint64_t rank = (std::uint64_t)std::ceil( clamped / 100.0 * double(m_totalCount) );
+    rank = std::max<std::uint64_t>( rank, 1 );
+
+    std::uint64_t seen = 0;
+    for( std::size_t i = 0; i < BUCKET_COUNT; i++ )
+    {
+        seen += m_buckets[i];
+        if( seen >= rank )
+        {
+            return std::min( std::max( bucketUpperBound(i), m_min ), m_max );
+        }
+    }
+
+    return m_max;
+}
+
+} // namespace chestnut::fsm
@@ -0,0 +1,108 @@
+/**
+ * @file mpsc_queue.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with the lock-free multi-producer single-consumer queue used by ConcurrentStatemachine
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_MPSC_QUEUE_H__
+#define __CHESTNUT_STATEMACHINE_MPSC_QUEUE_H__
+
+#include <atomic>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Unbounded lock-free queue with any number of producer threads and a single consumer thread
+ *
+ * @details
+ * Elements are kept in a linked list of nodes (the algorithm by Dmitry Vyukov).
+ * Pushing an element is a single atomic exchange, so producers never wait for each other or for the consumer;
+ * apart from allocating the node, it's wait-free. Elements come out in the order in which the exchanges took place.
+ *
+ * Only one thread at a time can pop elements. A producer that has done its exchange, but didn't link its node yet,
+ * hides the elements behind it for that short moment - tryPop() then returns false even though isEmpty() doesn't.
+ *
+ * @tparam T type of the element, it has to be move constructible
+ */
+template< class T >
+class MpscQueue
+{
+public:
+    MpscQueue() noexcept;
+    /**
+     * @brief Destructor; destroys elements that were not popped. No other thread can use the queue anymore
+     */
+    ~MpscQueue();
+
+    MpscQueue( const MpscQueue& ) = delete;
+    MpscQueue& operator=( const MpscQueue& ) = delete;
+
+
+    /**
+     * @brief Construct an element at the back of the queue. Can be called from any thread
+     *
+     * @param args arguments forwarded to the constructor of T
+     *
+     * @throws std::bad_alloc if allocation of the node failed
+     */
+    template< typename ...Args >
+    void emplace( Args&& ...args );
+
+    /**
+     * @brief Take the element from the front of the queue. Only the consumer thread can call this
+     *
+     * @param out where the element should be moved to
+     * @return whether there was an element to take
+     */
+    bool tryPop( T& out );
+
+    /**
+     * @brief Return whether any element was pushed and not yet popped. Only the consumer thread can call this
+     *
+     * @details
+     * Unlike tryPop() this also sees elements of producers that are still in the middle of pushing them.
+     */
+    bool isEmpty() const noexcept;
+
+
+private:
+    struct NodeBase
+    {
+        std::atomic<NodeBase *> next;
+    };
+
+    struct Node : NodeBase
+    {
+        T value;
+
+        template< typename ...Args >
+        Node( Args&& ...args );
+    };
+
+    /**
+     * @brief Node that was pushed most recently; producers swap it
+     */
+    alignas(64) std::atomic<NodeBase *> m_head;
+    /**
+     * @brief Node before the front of the queue, its value was already taken (or it's the stub); owned by the consumer
+     */
+    alignas(64) NodeBase *m_tail;
+    /**
+     * @brief Node the queue starts with, so that the list is never empty
+     */
+    NodeBase m_stub;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "mpsc_queue.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_MPSC_QUEUE_H__
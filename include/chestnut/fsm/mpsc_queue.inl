@@ -0,0 +1,76 @@
+#include <utility>
+
+namespace chestnut::fsm
+{
+
+template<class T>
+template<typename ...Args>
+inline MpscQueue<T>::Node::Node( Args&& ...args )
+: value( std::forward<Args>(args)... )
+{
+    this->next.store( nullptr, std::memory_order_relaxed );
+}
+
+template<class T>
+inline MpscQueue<T>::MpscQueue() noexcept
+{
+    m_stub.next.store( nullptr, std::memory_order_relaxed );
+    m_head.store( &m_stub, std::memory_order_relaxed );
+    m_tail = &m_stub;
+}
+
+template<class T>
+inline MpscQueue<T>::~MpscQueue()
+{
+    NodeBase *node = m_tail;
+    while( node )
+    {
+        NodeBase *next = node->next.load( std::memory_order_relaxed );
+        if( node != &m_stub )
+        {
+            delete static_cast<Node *>( node );
+        }
+        node = next;
+    }
+}
+
+template<class T>
+template<typename ...Args>
+inline void MpscQueue<T>::emplace( Args&& ...args )
+{
+    NodeBase *node = new Node( std::forward<Args>(args)... );
+
+    // seq_cst so that a consumer going to sleep can reliably see the queue is not empty, see ConcurrentStatemachine
+    NodeBase *prev = m_head.exchange( node, std::memory_order_seq_cst );
+    prev->next.store( node, std::memory_order_release );
+}
+
+template<class T>
+inline bool MpscQueue<T>::tryPop( T& out )
+{
+    NodeBase *tail = m_tail;
+    NodeBase *next = tail->next.load( std::memory_order_acquire );
+    if( !next )
+    {
+        return false;
+    }
+
+    // next becomes the new tail, its value gets destroyed together with it on the next pop
+    out = std::move( static_cast<Node *>( next )->value );
+    m_tail = next;
+
+    if( tail != &m_stub )
+    {
+        delete static_cast<Node *>( tail );
+    }
+
+    return true;
+}
+
+template<class T>
+inline bool MpscQueue<T>::isEmpty() const noexcept
+{
+    return m_head.load( std::memory_order_seq_cst ) == m_tail;
+}
+
+} // namespace chestnut::fsm
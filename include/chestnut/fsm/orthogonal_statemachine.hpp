@@ -0,0 +1,302 @@
+/**
+ * @file orthogonal_statemachine.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with OrthogonalStatemachine, a statemachine with independent regions that are active at the same time
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_ORTHOGONAL_STATEMACHINE_H__
+#define __CHESTNUT_STATEMACHINE_ORTHOGONAL_STATEMACHINE_H__
+
+#include "config.hpp"
+#include "state_transition.hpp"
+#include "state_traits.hpp"
+
+#if CHESTNUT_FSM_TRACE_TRANSITIONS
+    #include "transition_tracer.hpp"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief List of states forming one region of an OrthogonalStatemachine
+ *
+ * @tparam States state types of the region
+ */
+template< class ...States >
+struct Region
+{
+    static_assert( sizeof...(States) > 0, "Region needs at least one state type!" );
+    static_assert( sizeof...(States) < 255, "Region supports at most 254 state types!" );
+};
+
+
+
+namespace detail
+{
+    template< class RegionType, class S >
+    struct RegionHasState;
+
+    template< class ...States, class S >
+    struct RegionHasState< Region<States...>, S > : std::integral_constant< bool, isOneOf<S, States...> > {};
+
+
+    /**
+     * @brief Storage for the current state of one region, big enough for any of its states
+     *
+     * @details
+     * The storage doesn't know which state it holds, the index of the state is kept by the statemachine.
+     */
+    template< class RegionType >
+    class RegionStorage;
+
+    template< class ...States >
+    class RegionStorage< Region<States...> >
+    {
+    public:
+        RegionStorage() noexcept = default;
+        RegionStorage( const RegionStorage& ) = delete;
+        RegionStorage& operator=( const RegionStorage& ) = delete;
+
+        template< class StateType >
+        static constexpr std::size_t stateIndexOf() noexcept;
+
+        static StateId stateIdOfIndex( std::size_t index ) noexcept;
+
+        template< class StateType, typename ...Args >
+        StateType& emplace( Args&& ...args );
+
+        template< class StateType >
+        StateType& get() noexcept;
+        template< class StateType >
+        const StateType& get() const noexcept;
+
+        /**
+         * @brief Call a function with the state of given index, unless the index is 0
+         */
+        template< typename F >
+        void visit( std::size_t index, F&& f );
+
+        void destroy( std::size_t index ) noexcept;
+
+    private:
+        alignas( States... ) unsigned char m_bytes[ std::max( { sizeof(States)... } ) ];
+    };
+
+} // namespace detail
+
+
+
+/**
+ * @brief Statemachine made of independent regions, each in its own state at the same time
+ *
+ * @details
+ * Concerns that change independently of each other, like the motion and the lock of a door,
+ * can be modelled as regions of one statemachine instead of separate statemachines. Each Region lists its own states
+ * and has its own current state; a state type can belong to only one region.
+ *
+ * Indices of the current states of all regions are packed together at the front of the statemachine, one byte per region,
+ * so the whole configuration is read from a single cache line. Every region stores its current state inline,
+ * in storage the size of its biggest state, so the statemachine never allocates memory for states.
+ *
+ * States are plain classes like in StaticStatemachine. Callbacks taking the statemachine get the whole OrthogonalStatemachine,
+ * so a state can check the state of other regions (e.g. a door can't open while it's locked) or change it.
+ * The region of a state change is determined by the state type. Since the next state is constructed in the same storage
+ * as the current one, only after the current one has been left, entering a state can be refused only with
+ * the static canEnterStateType guard; states can't define canEnterState.
+ *
+ * dispatchEvent() delivers an event to the current states of all regions in a single pass, in the order of the regions.
+ * Transitions requested by states, in any region, are executed only after the whole pass, in the order they were requested,
+ * so every region sees the configuration from before the event. Transition requests from inside of onLeaveState are ignored.
+ *
+ * All state types must be complete before the statemachine type is used, so callbacks that call the statemachine
+ * should be defined after all of the state classes.
+ * Exceptions thrown by state callbacks are not wrapped and propagate to the caller unchanged.
+ * If a state constructor throws, its region is left without a state.
+ *
+ * @tparam Regions Region types, each listing states of one region
+ */
+template< class ...Regions >
+class OrthogonalStatemachine
+{
+    static_assert( sizeof...(Regions) > 0, "OrthogonalStatemachine needs at least one region!" );
+
+public:
+    /**
+     * @brief Number of regions
+     */
+    static constexpr std::size_t REGION_COUNT = sizeof...(Regions);
+
+
+public:
+    /**
+     * @brief Constructor; regions start without any state
+     */
+    OrthogonalStatemachine() noexcept;
+
+    /**
+     * @brief Destructor; calls onLeaveState of current states of all regions, from the last region, with STATE_TRANSITION_DESTROY
+     */
+    ~OrthogonalStatemachine();
+
+    OrthogonalStatemachine( const OrthogonalStatemachine& ) = delete;
+    OrthogonalStatemachine& operator=( const OrthogonalStatemachine& ) = delete;
+
+
+    /**
+     * @brief Get the position of the region containing given state on the Regions list
+     */
+    template< class StateType >
+    static constexpr std::size_t regionIndexOf() noexcept;
+
+    /**
+     * @brief Get the position of the state on the state list of its region plus one; 0 means no state
+     */
+    template< class StateType >
+    static constexpr std::size_t stateIndexOf() noexcept;
+
+    /**
+     * @brief Get the indices of the current states of all regions
+     *
+     * @see stateIndexOf()
+     */
+    const std::array< std::uint8_t, REGION_COUNT >& getCurrentStateIndices() const noexcept;
+
+    /**
+     * @brief Get the index of the current state of a region or 0 if the region was not initialized
+     *
+     * @param regionIndex position of the region on the Regions list
+     */
+    std::size_t getCurrentStateIndex( std::size_t regionIndex ) const noexcept;
+
+    /**
+     * @brief Get the type identifier of the current state of a region or NULL_STATE if the region was not initialized
+     *
+     * @param regionIndex position of the region on the Regions list
+     */
+    StateId getCurrentStateType( std::size_t regionIndex ) const noexcept;
+
+    /**
+     * @brief Return whether the region of the given state is currently in that state
+     */
+    template< class StateType >
+    bool isCurrentlyInState() const noexcept;
+
+    /**
+     * @brief Get the pointer to the state object if its region is currently in that state
+     *
+     * @return pointer to the state or nullptr if the region is in another state
+     */
+    template< class StateType >
+    StateType *getCurrentState() noexcept;
+    /**
+     * @brief Get the pointer to the state object if its region is currently in that state
+     *
+     * @return pointer to the state or nullptr if the region is in another state
+     */
+    template< class StateType >
+    const StateType *getCurrentState() const noexcept;
+
+
+    /**
+     * @brief Initialize the region of the given state
+     *
+     * @tparam StateType type of the initial state
+     * @tparam Args types of StateType constructor parameters
+     * @param args arguments that should be forwarded to StateType constructor
+     * @return whether the region was able to change the state
+     *
+     * @details
+     * If the region is already in some state, it won't do anything.
+     */
+    template< class StateType, typename ...Args >
+    bool initState( Args&& ...args );
+
+    /**
+     * @brief Transitions the region of the given state to that state
+     *
+     * @tparam StateType type of the state the region should transition to
+     * @tparam Args types of StateType constructor parameters
+     * @param args arguments that should be forwarded to StateType constructor
+     * @return whether the region was able to change the state or, if called from a state callback, whether the transition was scheduled
+     *
+     * @details
+     * If the region is already in that state, method does nothing.
+     * If the region was not initialized, the transition type is STATE_TRANSITION_INIT.
+     */
+    template< class StateType, typename ...Args >
+    bool gotoState( Args&& ...args );
+
+    /**
+     * @brief Pass an event to the current states of all regions
+     *
+     * @param event event object
+     * @return whether the current state of any region has an onEvent method for this event type
+     */
+    template< class EventType >
+    bool dispatchEvent( const EventType& event );
+
+
+private:
+    /**
+     * @brief Leaves the statemachine ready for next transitions once processing ends, even if a callback throws
+     */
+    struct ProcessingGuard
+    {
+        OrthogonalStatemachine& statemachine;
+
+        ~ProcessingGuard();
+    };
+
+    template< class StateType >
+    auto& storageOf() noexcept;
+    template< class StateType >
+    const auto& storageOf() const noexcept;
+
+    template< class EventType, std::size_t ...RegionIndices >
+    bool dispatchToRegions( const EventType& event, std::index_sequence<RegionIndices...> );
+
+    template< std::size_t RegionIndex >
+    void leaveRegion();
+
+    template< std::size_t ...RegionIndices >
+    void leaveRegions( std::index_sequence<RegionIndices...> );
+
+    template< class StateType, typename ...Args >
+    bool performTransition( Args&& ...args );
+
+    /**
+     * @brief Execute transitions requested from callbacks, including ones requested by them in turn
+     */
+    void runPendingTransitions();
+
+
+private:
+    std::array< std::uint8_t, REGION_COUNT > m_currentStates;
+    bool m_isProcessingTransition;
+    bool m_isCurrentlyLeavingAState;
+    std::tuple< detail::RegionStorage<Regions>... > m_regions;
+    std::vector< std::function<void()> > m_pendingTransitions;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "orthogonal_statemachine.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_ORTHOGONAL_STATEMACHINE_H__
@@ -0,0 +1,354 @@
+#include <new>
+#include <type_traits>
+
+namespace chestnut::fsm
+{
+
+namespace detail
+{
+    template< class ...States >
+    template< class StateType >
+    inline constexpr std::size_t RegionStorage< Region<States...> >::stateIndexOf() noexcept
+    {
+        // index 0 means no state
+        return IndexOf<StateType, States...>::value + 1;
+    }
+
+    template< class ...States >
+    inline StateId RegionStorage< Region<States...> >::stateIdOfIndex( std::size_t index ) noexcept
+    {
+        static const StateId ids[] = { NULL_STATE, stateIdOf<States>()... };
+        return ids[index];
+    }
+
+    template< class ...States >
+    template< class StateType, typename ...Args >
+    inline StateType& RegionStorage< Region<States...> >::emplace( Args&& ...args )
+    {
+        return *new( m_bytes ) StateType( std::forward<Args>(args)... );
+    }
+
+    template< class ...States >
+    template< class StateType >
+    inline StateType& RegionStorage< Region<States...> >::get() noexcept
+    {
+        return *std::launder( reinterpret_cast<StateType *>( m_bytes ) );
+    }
+
+    template< class ...States >
+    template< class StateType >
+    inline const StateType& RegionStorage< Region<States...> >::get() const noexcept
+    {
+        return *std::launder( reinterpret_cast<const StateType *>( m_bytes ) );
+    }
+
+    template< class ...States >
+    template< typename F >
+    inline void RegionStorage< Region<States...> >::visit( std::size_t index, F&& f )
+    {
+        (void)( ( index == stateIndexOf<States>() ? ( f( get<States>() ), true ) : false ) || ... );
+    }
+
+    template< class ...States >
+    inline void RegionStorage< Region<States...> >::destroy( std::size_t index ) noexcept
+    {
+        (void)( ( index == stateIndexOf<States>() ? ( get<States>().~States(), true ) : false ) || ... );
+    }
+
+} // namespace detail
+
+
+
+template<class ...Regions>
+inline OrthogonalStatemachine<Regions...>::OrthogonalStatemachine() noexcept
+{
+    m_currentStates.fill(0);
+    m_isProcessingTransition = false;
+    m_isCurrentlyLeavingAState = false;
+}
+
+template<class ...Regions>
+inline OrthogonalStatemachine<Regions...>::~OrthogonalStatemachine()
+{
+    m_isCurrentlyLeavingAState = true;
+
+    leaveRegions( std::make_index_sequence< REGION_COUNT >() );
+}
+
+template<class ...Regions>
+template<class StateType>
+inline constexpr std::size_t OrthogonalStatemachine<Regions...>::regionIndexOf() noexcept
+{
+    static_assert( ( (std::size_t)detail::RegionHasState<Regions, StateType>::value + ... ) == 1, "StateType must belong to exactly one region of this statemachine!" );
+
+    constexpr bool hasState[] = { detail::RegionHasState<Regions, StateType>::value... };
+
+    std::size_t regionIndex = 0;
+    while( !hasState[regionIndex] )
+    {
+        regionIndex++;
+    }
+
+    return regionIndex;
+}
+
+template<class ...Regions>
+template<class StateType>
+inline constexpr std::size_t OrthogonalStatemachine<Regions...>::stateIndexOf() noexcept
+{
+    using StorageType = std::tuple_element_t< regionIndexOf<StateType>(), std::tuple< detail::RegionStorage<Regions>... > >;
+
+    return StorageType::template stateIndexOf<StateType>();
+}
+
+template<class ...Regions>
+inline const std::array< std::uint8_t, OrthogonalStatemachine<Regions...>::REGION_COUNT >& OrthogonalStatemachine<Regions...>::getCurrentStateIndices() const noexcept
+{
+    return m_currentStates;
+}
+
+template<class ...Regions>
+inline std::size_t OrthogonalStatemachine<Regions...>::getCurrentStateIndex( std::size_t regionIndex ) const noexcept
+{
+    return m_currentStates[regionIndex];
+}
+
+template<class ...Regions>
+inline StateId OrthogonalStatemachine<Regions...>::getCurrentStateType( std::size_t regionIndex ) const noexcept
+{
+    static StateId ( * const stateIdOfIndex[] )( std::size_t ) = { &detail::RegionStorage<Regions>::stateIdOfIndex... };
+
+    return stateIdOfIndex[regionIndex]( m_currentStates[regionIndex] );
+}
+
+template<class ...Regions>
+template<class StateType>
+inline bool OrthogonalStatemachine<Regions...>::isCurrentlyInState() const noexcept
+{
+    return m_currentStates[ regionIndexOf<StateType>() ] == stateIndexOf<StateType>();
+}
+
+template<class ...Regions>
+template<class StateType>
+inline StateType *OrthogonalStatemachine<Regions...>::getCurrentState() noexcept
+{
+    return isCurrentlyInState<StateType>() ? &storageOf<StateType>().template get<StateType>() : nullptr;
+}
+
+template<class ...Regions>
+template<class StateType>
+inline const StateType *OrthogonalStatemachine<Regions...>::getCurrentState() const noexcept
+{
+    return isCurrentlyInState<StateType>() ? &storageOf<StateType>().template get<StateType>() : nullptr;
+}
+
+template<class ...Regions>
+template<class StateType, typename ...Args>
+inline bool OrthogonalStatemachine<Regions...>::initState( Args&& ...args )
+{
+    if( m_currentStates[ regionIndexOf<StateType>() ] != 0 || m_isProcessingTransition )
+    {
+        return false;
+    }
+
+    ProcessingGuard guard { *this };
+
+    m_isProcessingTransition = true;
+
+    bool result = performTransition<StateType>( std::forward<Args>(args)... );
+    runPendingTransitions();
+
+    return result;
+}
+
+template<class ...Regions>
+template<class StateType, typename ...Args>
+inline bool OrthogonalStatemachine<Regions...>::gotoState( Args&& ...args )
+{
+    if( m_isCurrentlyLeavingAState )
+    {
+        return false;
+    }
+
+    if( m_isProcessingTransition )
+    {
+        // called from a state callback, the transition will happen after the callback and the rest of the event pass
+        m_pendingTransitions.emplace_back( [this, argsTuple = std::make_tuple( std::forward<Args>(args)... )]() mutable {
+            if( !isCurrentlyInState<StateType>() )
+            {
+                std::apply( [this]( auto& ...args ) {
+                    performTransition<StateType>( std::move(args)... );
+                }, argsTuple );
+            }
+        });
+        return true;
+    }
+
+    if( isCurrentlyInState<StateType>() )
+    {
+        return false;
+    }
+
+    ProcessingGuard guard { *this };
+
+    m_isProcessingTransition = true;
+
+    bool result = performTransition<StateType>( std::forward<Args>(args)... );
+    runPendingTransitions();
+
+    return result;
+}
+
+template<class ...Regions>
+template<class EventType>
+inline bool OrthogonalStatemachine<Regions...>::dispatchEvent( const EventType& event )
+{
+    if( m_isProcessingTransition )
+    {
+        // an event dispatched from a callback; any transition it requests gets picked up by the outer call
+        return dispatchToRegions( event, std::make_index_sequence< REGION_COUNT >() );
+    }
+
+    ProcessingGuard guard { *this };
+
+    m_isProcessingTransition = true;
+
+    bool handled = dispatchToRegions( event, std::make_index_sequence< REGION_COUNT >() );
+    runPendingTransitions();
+
+    return handled;
+}
+
+
+
+template<class ...Regions>
+inline OrthogonalStatemachine<Regions...>::ProcessingGuard::~ProcessingGuard()
+{
+    statemachine.m_isProcessingTransition = false;
+    statemachine.m_isCurrentlyLeavingAState = false;
+    statemachine.m_pendingTransitions.clear();
+}
+
+template<class ...Regions>
+template<class StateType>
+inline auto& OrthogonalStatemachine<Regions...>::storageOf() noexcept
+{
+    return std::get< regionIndexOf<StateType>() >( m_regions );
+}
+
+template<class ...Regions>
+template<class StateType>
+inline const auto& OrthogonalStatemachine<Regions...>::storageOf() const noexcept
+{
+    return std::get< regionIndexOf<StateType>() >( m_regions );
+}
+
+template<class ...Regions>
+template<class EventType, std::size_t ...RegionIndices>
+inline bool OrthogonalStatemachine<Regions...>::dispatchToRegions( const EventType& event, std::index_sequence<RegionIndices...> )
+{
+    bool handled = false;
+
+    ( std::get<RegionIndices>( m_regions ).visit( m_currentStates[RegionIndices], [this, &event, &handled]( auto& state ) {
+        handled |= detail::callOnEvent( state, *this, event );
+    }), ... );
+
+    return handled;
+}
+
+template<class ...Regions>
+template<std::size_t RegionIndex>
+inline void OrthogonalStatemachine<Regions...>::leaveRegion()
+{
+    auto& storage = std::get<RegionIndex>( m_regions );
+    const std::size_t index = m_currentStates[RegionIndex];
+
+    StateTransition transition;
+    transition.type = STATE_TRANSITION_DESTROY;
+    transition.prevState = storage.stateIdOfIndex( index );
+    transition.nextState = NULL_STATE;
+
+    if( index != 0 )
+    {
+        CHESTNUT_FSM_TRACE_TRANSITION( this, transition );
+    }
+
+    m_currentStates[RegionIndex] = 0;
+
+    storage.visit( index, [this, &transition]( auto& state ) {
+        detail::callOnLeaveState( state, *this, transition );
+    });
+    storage.destroy( index );
+}
+
+template<class ...Regions>
+template<std::size_t ...RegionIndices>
+inline void OrthogonalStatemachine<Regions...>::leaveRegions( std::index_sequence<RegionIndices...> )
+{
+    // from the last region to the first, in reverse of how they're usually initialized
+    ( leaveRegion< REGION_COUNT - 1 - RegionIndices >(), ... );
+}
+
+template<class ...Regions>
+template<class StateType, typename ...Args>
+inline bool OrthogonalStatemachine<Regions...>::performTransition( Args&& ...args )
+{
+    static_assert( !detail::isDetected<detail::CanEnterStateOp, StateType>
+                && !detail::isDetected<detail::CanEnterStateWithMachineOp, StateType, OrthogonalStatemachine>,
+        "States of OrthogonalStatemachine can't define canEnterState, use the static canEnterStateType guard instead!" );
+
+    constexpr std::size_t regionIndex = regionIndexOf<StateType>();
+    auto& storage = storageOf<StateType>();
+    const std::size_t currentIndex = m_currentStates[regionIndex];
+
+    StateTransition transition;
+    transition.type = currentIndex != 0 ? STATE_TRANSITION_GOTO : STATE_TRANSITION_INIT;
+    transition.prevState = storage.stateIdOfIndex( currentIndex );
+    transition.nextState = storage.stateIdOfIndex( stateIndexOf<StateType>() );
+
+    if( !detail::callCanEnterStateType<StateType>( *this, transition ) )
+    {
+        return false;
+    }
+
+    bool canLeave = true;
+    storage.visit( currentIndex, [this, &transition, &canLeave]( auto& state ) {
+        canLeave = detail::callCanLeaveState( state, *this, transition );
+    });
+
+    if( !canLeave )
+    {
+        return false;
+    }
+
+    CHESTNUT_FSM_TRACE_TRANSITION( this, transition );
+
+    m_isCurrentlyLeavingAState = true;
+    storage.visit( currentIndex, [this, &transition]( auto& state ) {
+        detail::callOnLeaveState( state, *this, transition );
+    });
+    m_isCurrentlyLeavingAState = false;
+
+    storage.destroy( currentIndex );
+    m_currentStates[regionIndex] = 0;
+
+    StateType& nextState = storage.template emplace<StateType>( std::forward<Args>(args)... );
+    m_currentStates[regionIndex] = (std::uint8_t)stateIndexOf<StateType>();
+
+    detail::callOnEnterState( nextState, *this, transition );
+
+    return true;
+}
+
+template<class ...Regions>
+inline void OrthogonalStatemachine<Regions...>::runPendingTransitions()
+{
+    // transitions can queue further transitions, so the size is checked every time
+    for( std::size_t i = 0; i < m_pendingTransitions.size(); i++ )
+    {
+        std::function<void()> pending = std::move( m_pendingTransitions[i] );
+        pending();
+    }
+}
+
+} // namespace chestnut::fsm
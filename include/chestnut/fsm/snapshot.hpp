@@ -0,0 +1,259 @@
+/**
+ * @file snapshot.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with SnapshotWriter and SnapshotReader, used to save statemachines into a binary buffer and restore them from it
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_SNAPSHOT_H__
+#define __CHESTNUT_STATEMACHINE_SNAPSHOT_H__
+
+#include "state_id.hpp"
+#include "statemachine_base.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Writer of a binary snapshot of any number of statemachines
+ *
+ * @details
+ * The buffer starts with a header (magic bytes and format version), after which every writeStatemachine()
+ * appends one statemachine: the size of its state stack and, for every state from the bottom, its type and its payload.
+ * A state type is written by name the first time it appears in the buffer and by a small index afterwards,
+ * so a snapshot of many statemachines of the same kind costs only a few bytes per state on top of the payloads.
+ *
+ * Payloads are written by states in StateBase::serializeState() with the write methods of this class.
+ * Numbers given to write() are stored in the byte order of the machine, so snapshots are meant to be restored
+ * on the same architecture.
+ */
+class SnapshotWriter
+{
+public:
+    /**
+     * @brief Constructor; writes the header
+     */
+    SnapshotWriter();
+
+
+    /**
+     * @brief Append the state stack of a statemachine
+     *
+     * @return false if the statemachine is in the middle of a transition, in which case nothing is written
+     *
+     * @details
+     * Every state on the stack writes its data in StateBase::serializeState().
+     * Only the state stack is saved - not the settings of the statemachine or anything of its subclasses.
+     */
+    bool writeStatemachine( const StatemachineBase& statemachine );
+
+
+    /**
+     * @brief Append raw bytes
+     */
+    void writeBytes( const void *data, std::size_t size );
+
+    /**
+     * @brief Append the bytes of a trivially copyable value
+     */
+    template< class T >
+    void write( const T& value );
+
+    /**
+     * @brief Append an unsigned integer in a variable length encoding, 1 byte for values below 128
+     */
+    void writeVarint( std::uint64_t value );
+
+    /**
+     * @brief Append a string prefixed with its length
+     */
+    void writeString( const std::string& value );
+
+
+    /**
+     * @brief Make room for given number of bytes in advance
+     */
+    void reserve( std::size_t size );
+
+    /**
+     * @brief Get the snapshot written so far
+     */
+    const std::vector< unsigned char >& getBuffer() const noexcept;
+
+
+private:
+    /**
+     * @brief Write the index of a state type, preceded by its name if the type appears for the first time
+     */
+    void writeStateType( StateId id );
+
+    /**
+     * @brief Reserve space for the size of a payload that's about to be written
+     *
+     * @return position of the reserved space, to be passed to endPayload()
+     */
+    std::size_t beginPayload();
+
+    /**
+     * @brief Fill the size of the payload written since beginPayload()
+     */
+    void endPayload( std::size_t position ) noexcept;
+
+
+private:
+    std::vector< unsigned char > m_buffer;
+    /**
+     * @brief Index of every state type already written plus one, indexed by state identifier
+     */
+    std::vector< std::uint32_t > m_typeIndices;
+    std::uint32_t m_typeCount;
+};
+
+
+/**
+ * @brief Reader of a binary snapshot written with SnapshotWriter
+ *
+ * @details
+ * Statemachines are restored from it with restoreStatemachine() in the order they were written.
+ * Payloads are read by states in StateBase::deserializeState() with the read methods of this class.
+ *
+ * Every read is checked against the end of the data, and a state can't read past its own payload.
+ * The first read that fails, because the data is truncated or malformed, puts the reader in the failed state,
+ * after which all reads fail.
+ */
+class SnapshotReader
+{
+public:
+    /**
+     * @brief Magic bytes at the start of every snapshot
+     */
+    static constexpr unsigned char MAGIC[4] = { 'C', 'F', 'S', 'N' };
+    /**
+     * @brief Version of the format written by SnapshotWriter
+     */
+    static constexpr std::uint16_t FORMAT_VERSION = 1;
+
+
+public:
+    /**
+     * @brief Constructor; checks the header of the snapshot
+     *
+     * @param data snapshot data, it's not copied and has to outlive the reader
+     * @param size size of the data in bytes
+     */
+    SnapshotReader( const void *data, std::size_t size ) noexcept;
+
+
+    /**
+     * @brief Restore the state stack of the next statemachine in the snapshot
+     *
+     * @tparam StateTypes state types that can appear in the snapshot; they are matched by name
+     * @param statemachine statemachine with no states
+     *
+     * @return whether the statemachine was restored; false also if it wasn't empty or a state type is not in StateTypes
+     *
+     * @details
+     * States are constructed with default constructors and read their data in StateBase::deserializeState().
+     * No transitions are made, so onEnterState isn't called and neither guards nor observers are consulted.
+     * On failure no states are left in the statemachine and the reader is in the failed state.
+     * If a state throws, the exception is propagated after the statemachine has been cleared.
+     */
+    template< class ...StateTypes >
+    bool restoreStatemachine( StatemachineBase& statemachine );
+
+
+    /**
+     * @brief Read raw bytes
+     *
+     * @return whether there were enough bytes
+     */
+    bool readBytes( void *data, std::size_t size ) noexcept;
+
+    /**
+     * @brief Read a trivially copyable value written with SnapshotWriter::write()
+     *
+     * @return whether there were enough bytes
+     */
+    template< class T >
+    bool read( T& value ) noexcept;
+
+    /**
+     * @brief Read an unsigned integer written with SnapshotWriter::writeVarint()
+     *
+     * @return whether the value was complete
+     */
+    bool readVarint( std::uint64_t& value ) noexcept;
+
+    /**
+     * @brief Read a string written with SnapshotWriter::writeString()
+     *
+     * @return whether the string was complete
+     */
+    bool readString( std::string& value );
+
+
+    /**
+     * @brief Return whether the header was wrong or any read has failed
+     */
+    bool hasFailed() const noexcept;
+
+    /**
+     * @brief Return whether all the data has been read
+     */
+    bool isAtEnd() const noexcept;
+
+
+private:
+    /**
+     * @brief Read the index of a state type, together with its name if the type appears for the first time
+     *
+     * @return index of the type or -1 on failure
+     */
+    std::int64_t readStateType();
+
+    /**
+     * @brief Read a single state of a snapshot and construct it
+     *
+     * @return restored state or nullptr on failure
+     */
+    template< class ...StateTypes >
+    StateBase *restoreState( StatemachineBase& statemachine );
+
+    bool fail() noexcept;
+
+
+private:
+    const unsigned char *m_position;
+    /**
+     * @brief End of the data available for reading; the end of the current payload while a state reads it
+     */
+    const unsigned char *m_end;
+    const unsigned char *m_dataEnd;
+    bool m_hasFailed;
+    /**
+     * @brief Names of state types in the order they appeared in the snapshot
+     */
+    std::vector< std::string > m_typeNames;
+    /**
+     * @brief Identifiers of the state types found by restoreStatemachine(), NULL_STATE if not yet looked up
+     */
+    std::vector< StateId > m_typeIds;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "snapshot.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_SNAPSHOT_H__
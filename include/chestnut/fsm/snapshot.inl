@@ -0,0 +1,331 @@
+#include <cstring>
+
+namespace chestnut::fsm
+{
+
+inline SnapshotWriter::SnapshotWriter()
+{
+    m_typeCount = 0;
+
+    writeBytes( SnapshotReader::MAGIC, sizeof( SnapshotReader::MAGIC ) );
+    write( SnapshotReader::FORMAT_VERSION );
+}
+
+inline bool SnapshotWriter::writeStatemachine( const StatemachineBase& statemachine )
+{
+    // states may be half way through a change
+    if( statemachine.m_isProcessingTransition )
+    {
+        return false;
+    }
+
+    writeVarint( statemachine.m_stackStates.size() );
+    for( std::size_t i = 0; i < statemachine.m_stackStates.size(); i++ )
+    {
+        const StateBase *state = statemachine.m_stackStates[i];
+
+        writeStateType( state->stateId );
+        const std::size_t payload = beginPayload();
+        state->serializeState( *this );
+        endPayload( payload );
+    }
+
+    return true;
+}
+
+inline void SnapshotWriter::writeBytes( const void *data, std::size_t size )
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>( data );
+    m_buffer.insert( m_buffer.end(), bytes, bytes + size );
+}
+
+template<class T>
+inline void SnapshotWriter::write( const T& value )
+{
+    static_assert( std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written as bytes!" );
+
+    const std::size_t position = m_buffer.size();
+    m_buffer.resize( position + sizeof(T) );
+    std::memcpy( m_buffer.data() + position, &value, sizeof(T) );
+}
+
+inline void SnapshotWriter::writeVarint( std::uint64_t value )
+{
+    while( value >= 0x80 )
+    {
+        m_buffer.push_back( (unsigned char)( value | 0x80 ) );
+        value >>= 7;
+    }
+    m_buffer.push_back( (unsigned char)value );
+}
+
+inline void SnapshotWriter::writeString( const std::string& value )
+{
+    writeVarint( value.size() );
+    writeBytes( value.data(), value.size() );
+}
+
+inline void SnapshotWriter::reserve( std::size_t size )
+{
+    m_buffer.reserve( m_buffer.size() + size );
+}
+
+inline const std::vector< unsigned char >& SnapshotWriter::getBuffer() const noexcept
+{
+    return m_buffer;
+}
+
+inline void SnapshotWriter::writeStateType( StateId id )
+{
+    if( id >= m_typeIndices.size() )
+    {
+        m_typeIndices.resize( id + 1, 0 );
+    }
+
+    if( m_typeIndices[id] == 0 )
+    {
+        // index equal to the number of known types introduces a new one
+        m_typeIndices[id] = ++m_typeCount;
+        writeVarint( m_typeCount - 1 );
+        writeString( getStateTypeName( id ) );
+    }
+    else
+    {
+        writeVarint( m_typeIndices[id] - 1 );
+    }
+}
+
+inline std::size_t SnapshotWriter::beginPayload()
+{
+    const std::size_t position = m_buffer.size();
+    write( std::uint32_t(0) );
+    return position;
+}
+
+inline void SnapshotWriter::endPayload( std::size_t position ) noexcept
+{
+    const std::uint32_t size = (std::uint32_t)( m_buffer.size() - position - sizeof(std::uint32_t) );
+    std::memcpy( m_buffer.data() + position, &size, sizeof(size) );
+}
+
+
+
+inline SnapshotReader::SnapshotReader( const void *data, std::size_t size ) noexcept
+{
+    m_position = static_cast<const unsigned char *>( data );
+    m_end = m_position + size;
+    m_dataEnd = m_end;
+    m_hasFailed = false;
+
+    unsigned char magic[ sizeof(MAGIC) ];
+    std::uint16_t version;
+    if( !readBytes( magic, sizeof(magic) ) || std::memcmp( magic, MAGIC, sizeof(MAGIC) ) != 0
+     || !read( version ) || version != FORMAT_VERSION )
+    {
+        fail();
+    }
+}
+
+template<class ...StateTypes>
+inline bool SnapshotReader::restoreStatemachine( StatemachineBase& statemachine ) 
+{
+    if( statemachine.m_isProcessingTransition || !statemachine.m_stackStates.empty() )
+    {
+        return false;
+    }
+
+    std::uint64_t stackSize;
+    if( !readVarint( stackSize ) )
+    {
+        return false;
+    }
+
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    try
+    {
+#endif
+        for( std::uint64_t i = 0; i < stackSize; i++ )
+        {
+            StateBase *state = restoreState<StateTypes...>( statemachine );
+            if( !state )
+            {
+                statemachine.discardStateStack();
+                return false;
+            }
+
+            statemachine.m_stackStates.push( state );
+        }
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    }
+    catch(...)
+    {
+        statemachine.discardStateStack();
+        throw;
+    }
+#endif
+
+#if CHESTNUT_FSM_COLLECT_METRICS
+    statemachine.m_currentStateEnteredAt = readTraceTimestamp();
+#endif
+
+    return true;
+}
+
+inline bool SnapshotReader::readBytes( void *data, std::size_t size ) noexcept
+{
+    if( m_hasFailed || (std::size_t)( m_end - m_position ) < size )
+    {
+        return fail();
+    }
+
+    std::memcpy( data, m_position, size );
+    m_position += size;
+    return true;
+}
+
+template<class T>
+inline bool SnapshotReader::read( T& value ) noexcept
+{
+    static_assert( std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read as bytes!" );
+
+    return readBytes( &value, sizeof(T) );
+}
+
+inline bool SnapshotReader::readVarint( std::uint64_t& value ) noexcept
+{
+    value = 0;
+    for( unsigned shift = 0; shift < 64; shift += 7 )
+    {
+        if( m_hasFailed || m_position == m_end )
+        {
+            return fail();
+        }
+
+        const unsigned char byte = *m_position++;
+        value |= (std::uint64_t)( byte & 0x7f ) << shift;
+        if( !( byte & 0x80 ) )
+        {
+            return true;
+        }
+    }
+
+    return fail();
+}
+
+inline bool SnapshotReader::readString( std::string& value )
+{
+    std::uint64_t size;
+    if( !readVarint( size ) || (std::uint64_t)( m_end - m_position ) < size )
+    {
+        return fail();
+    }
+
+    value.assign( reinterpret_cast<const char *>( m_position ), (std::size_t)size );
+    m_position += size;
+    return true;
+}
+
+inline bool SnapshotReader::hasFailed() const noexcept
+{
+    return m_hasFailed;
+}
+
+inline bool SnapshotReader::isAtEnd() const noexcept
+{
+    return m_position == m_dataEnd;
+}
+
+inline std::int64_t SnapshotReader::readStateType()
+{
+    std::uint64_t index;
+    if( !readVarint( index ) || index > m_typeNames.size() )
+    {
+        fail();
+        return -1;
+    }
+
+    if( index == m_typeNames.size() )
+    {
+        std::string name;
+        if( !readString( name ) )
+        {
+            return -1;
+        }
+
+        m_typeNames.push_back( std::move( name ) );
+        m_typeIds.push_back( NULL_STATE );
+    }
+
+    return (std::int64_t)index;
+}
+
+template<class ...StateTypes>
+inline StateBase* SnapshotReader::restoreState( StatemachineBase& statemachine ) 
+{
+    const std::int64_t typeIndex = readStateType();
+    if( typeIndex < 0 )
+    {
+        return nullptr;
+    }
+
+    // names are compared only the first time a type is seen in the reader
+    StateId& id = m_typeIds[typeIndex];
+    if( id == NULL_STATE )
+    {
+        const std::string& name = m_typeNames[typeIndex];
+        ( void )( ( name == getStateTypeName( stateIdOf<StateTypes>() ) && ( id = stateIdOf<StateTypes>(), true ) ) || ... );
+    }
+
+    std::uint32_t payloadSize;
+    if( id == NULL_STATE || !read( payloadSize ) || (std::size_t)( m_end - m_position ) < payloadSize )
+    {
+        fail();
+        return nullptr;
+    }
+
+    StateBase *state = statemachine.createStateOfType<StateTypes...>( id );
+    if( !state )
+    {
+        fail();
+        return nullptr;
+    }
+
+    // the state can only read its own payload and whatever it leaves unread is skipped
+    const unsigned char *payloadEnd = m_position + payloadSize;
+    m_end = payloadEnd;
+
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    try
+    {
+        state->deserializeState( *this );
+    }
+    catch(...)
+    {
+        m_end = m_dataEnd;
+        fail();
+        delete state;
+        throw;
+    }
+#else
+    state->deserializeState( *this );
+#endif
+
+    m_position = payloadEnd;
+    m_end = m_dataEnd;
+
+    if( hasFailed() )
+    {
+        delete state;
+        return nullptr;
+    }
+
+    return state;
+}
+
+inline bool SnapshotReader::fail() noexcept
+{
+    m_hasFailed = true;
+    return false;
+}
+
+} // namespace chestnut::fsm
@@ -69,6 +69,10 @@ private:
      * 
      * @param parent_ parent statemachine pointer
      * @return Returns whether this state type can be bound to a given statemachine type
+     * 
+     * @details
+     * The statemachine checks whether the state belongs to it before creating the state - at compile time in fsm::Statemachine
+     * transition methods and at runtime in StatemachineBase - so no cast is done here.
      */
     virtual bool setParent( StatemachineBase *parent_ ) noexcept override;
 };
@@ -1,5 +1,8 @@
+#include "config.hpp"
 #include "exceptions.hpp"
 
+#include <type_traits>
+
 namespace chestnut::fsm
 {
 
@@ -14,7 +17,7 @@ typename State<ParentStatemachineClass, BaseStateClass>::StatemachineType& State
     }
     else
     {
-        throw BadParentAccessException( "State parent access violation!");
+        detail::raiseBadParentAccess();
     }
 }
 
@@ -27,20 +30,21 @@ const typename State<ParentStatemachineClass, BaseStateClass>::StatemachineType&
     }
     else
     {
-        throw BadParentAccessException( "State parent access violation!");
+        detail::raiseBadParentAccess();
     }
 }
 
 template<class ParentStatemachineClass, class BaseStateClass>
 bool State<ParentStatemachineClass, BaseStateClass>::setParent( StatemachineBase *parent_ ) noexcept
 {
-    if( dynamic_cast<StatemachineType*>( parent_ ) )
-    {
-        this->parent = parent_;
-        return true;
-    }
+    static_assert( std::is_base_of<StatemachineBase, StatemachineType>::value, 
+        "ParentStatemachineClass has to be a child of StatemachineBase!" );
+
+    // The statemachine checks whether it is of StatemachineType before creating the state (see StatemachineBase::isStatemachineOfState),
+    // so the pointer can be stored as is and later statically downcasted in getParent
 
-    return false;
+    this->parent = parent_;
+    return true;
 }
 
 
@@ -53,7 +57,7 @@ typename State<ParentStatemachineClass, void>::StatemachineType& State<ParentSta
     }
     else
     {
-        throw BadParentAccessException( "State parent access violation!");
+        detail::raiseBadParentAccess();
     }
 }
 
@@ -66,20 +70,21 @@ const typename State<ParentStatemachineClass, void>::StatemachineType& State<Par
     }
     else
     {
-        throw BadParentAccessException( "State parent access violation!");
+        detail::raiseBadParentAccess();
     }
 }
 
 template<class ParentStatemachineClass>
 bool State<ParentStatemachineClass, void>::setParent( StatemachineBase *parent_ ) noexcept
 {
-    if( dynamic_cast<StatemachineType*>( parent_ ) )
-    {
-        this->parent = parent_;
-        return true;
-    }
+    static_assert( std::is_base_of<StatemachineBase, StatemachineType>::value, 
+        "ParentStatemachineClass has to be a child of StatemachineBase!" );
+
+    // The statemachine checks whether it is of StatemachineType before creating the state (see StatemachineBase::isStatemachineOfState),
+    // so the pointer can be stored as is and later statically downcasted in getParent
 
-    return false;
+    this->parent = parent_;
+    return true;
 }
 
 } // namespace chestnut::fsm
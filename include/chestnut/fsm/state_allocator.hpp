@@ -0,0 +1,160 @@
+/**
+ * @file state_allocator.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with the state allocation policy types
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_STATE_ALLOCATOR_H__
+#define __CHESTNUT_STATEMACHINE_STATE_ALLOCATOR_H__
+
+#include <cstddef>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Allocation counters of a state allocator
+ *
+ * @details
+ * Counters are gathered separately for every thread, so the values describe only the thread that queried them.
+ */
+struct StateAllocatorStats
+{
+    /** Number of state allocations requested from the allocator */
+    std::size_t allocations = 0;
+    /** Number of state deallocations requested from the allocator */
+    std::size_t deallocations = 0;
+    /** Number of allocations that had to reach the global heap */
+    std::size_t heapAllocations = 0;
+    /** Number of deallocations that returned memory to the global heap */
+    std::size_t heapDeallocations = 0;
+};
+
+
+/**
+ * @brief Abstract allocation policy used for all state objects
+ *
+ * @details
+ * Every state created by the statemachine goes through StateBase::operator new and StateBase::operator delete,
+ * which in turn forward to the allocator returned by getStateAllocator().
+ * Deallocation always receives the size of the most derived state type.
+ *
+ * @see setStateAllocator(), PoolStateAllocator, HeapStateAllocator
+ */
+class StateAllocator
+{
+public:
+    virtual ~StateAllocator() = default;
+
+    /**
+     * @brief Allocate storage for a state object
+     *
+     * @param size size of the state object in bytes
+     * @return pointer to storage aligned to at least alignof(std::max_align_t)
+     *
+     * @throws std::bad_alloc if memory couldn't be allocated
+     */
+    virtual void *allocate( std::size_t size ) = 0;
+
+    /**
+     * @brief Release storage previously obtained with allocate()
+     *
+     * @param ptr pointer returned from allocate()
+     * @param size the same size that was passed to allocate()
+     */
+    virtual void deallocate( void *ptr, std::size_t size ) noexcept = 0;
+
+    /**
+     * @brief Get allocation counters for the calling thread
+     *
+     * @return allocation counters
+     */
+    virtual StateAllocatorStats getStats() const noexcept = 0;
+};
+
+
+/**
+ * @brief State allocator that forwards directly to the global operator new and delete
+ *
+ * @details
+ * This reproduces the behaviour of the library from before allocation policies were introduced.
+ * Its counters are separate from the ones of PoolStateAllocator.
+ */
+class HeapStateAllocator : public StateAllocator
+{
+public:
+    void *allocate( std::size_t size ) override;
+    void deallocate( void *ptr, std::size_t size ) noexcept override;
+    StateAllocatorStats getStats() const noexcept override;
+};
+
+
+/**
+ * @brief Default state allocator recycling freed state storage in per-thread size class free-lists
+ *
+ * @details
+ * Sizes are rounded up to a multiple of SIZE_CLASS_GRANULARITY and every size class has its own free-list.
+ * Freed blocks are kept for later reuse instead of being returned to the heap,
+ * so once every state type used by a statemachine has been created at least once,
+ * a steady cycle of gotoState/pushState/popState doesn't allocate any memory.
+ *
+ * Free-lists are thread local, so no synchronization is involved. A block freed on a different thread than the one
+ * it was allocated on simply migrates to the free-list of the freeing thread.
+ * States bigger than MAX_POOLED_SIZE are always allocated on the heap.
+ * At most MAX_CACHED_BLOCKS blocks are retained per size class, any surplus is returned to the heap.
+ */
+class PoolStateAllocator : public StateAllocator
+{
+public:
+    /** Size class granularity in bytes */
+    static constexpr std::size_t SIZE_CLASS_GRANULARITY = 16;
+    /** Biggest state size in bytes that is still served from the pool */
+    static constexpr std::size_t MAX_POOLED_SIZE = 512;
+    /** Number of size classes */
+    static constexpr std::size_t SIZE_CLASS_COUNT = MAX_POOLED_SIZE / SIZE_CLASS_GRANULARITY;
+    /** Maximum number of free blocks retained by a single size class of one thread */
+    static constexpr std::size_t MAX_CACHED_BLOCKS = 4096;
+
+public:
+    void *allocate( std::size_t size ) override;
+    void deallocate( void *ptr, std::size_t size ) noexcept override;
+    StateAllocatorStats getStats() const noexcept override;
+
+    /**
+     * @brief Return all free blocks cached by the calling thread to the heap
+     */
+    void trim() noexcept;
+};
+
+
+/**
+ * @brief Get the allocator currently used for state objects
+ *
+ * @return state allocator; PoolStateAllocator by default
+ */
+StateAllocator& getStateAllocator() noexcept;
+
+/**
+ * @brief Set the allocator used for state objects
+ *
+ * @param allocator pointer to the allocator or nullptr to restore the default PoolStateAllocator
+ *
+ * @details
+ * The allocator must outlive every state created with it.
+ * It should be set before any statemachine is initialized, as states are freed with the allocator active at the time of their deletion.
+ * The allocator is shared by all threads; once this returns, states created on any thread use it.
+ */
+void setStateAllocator( StateAllocator *allocator ) noexcept;
+
+} // namespace chestnut::fsm
+
+
+#include "state_allocator.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_STATE_ALLOCATOR_H__
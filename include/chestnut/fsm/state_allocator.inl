@@ -0,0 +1,206 @@
+#include <atomic>
+#include <new>
+
+namespace chestnut::fsm
+{
+
+namespace detail
+{
+    struct PoolFreeBlock
+    {
+        PoolFreeBlock *next;
+    };
+
+    // Kept trivially destructible on purpose, so that it stays accessible in the thread even after thread local destructors have run.
+    // States can still be freed at that point, e.g. by statemachines with static storage duration.
+    struct PoolThreadCache
+    {
+        PoolFreeBlock *heads[PoolStateAllocator::SIZE_CLASS_COUNT];
+        std::size_t counts[PoolStateAllocator::SIZE_CLASS_COUNT];
+        StateAllocatorStats stats;
+        bool isReleaserRegistered;
+        bool isReleased;
+    };
+
+    inline thread_local PoolThreadCache poolThreadCache {};
+
+
+    inline void poolReleaseThreadCache( PoolThreadCache& cache ) noexcept
+    {
+        for( std::size_t i = 0; i < PoolStateAllocator::SIZE_CLASS_COUNT; i++ )
+        {
+            while( cache.heads[i] )
+            {
+                PoolFreeBlock *block = cache.heads[i];
+                cache.heads[i] = block->next;
+                ::operator delete( block );
+                cache.stats.heapDeallocations++;
+            }
+
+            cache.counts[i] = 0;
+        }
+    }
+
+    // Returns cached blocks to the heap when the thread exits
+    struct PoolThreadCacheReleaser
+    {
+        ~PoolThreadCacheReleaser()
+        {
+            poolReleaseThreadCache( poolThreadCache );
+            poolThreadCache.isReleased = true;
+        }
+    };
+
+    inline thread_local PoolThreadCacheReleaser poolThreadCacheReleaser;
+
+
+    inline void *poolAllocate( std::size_t size )
+    {
+        PoolThreadCache& cache = poolThreadCache;
+        cache.stats.allocations++;
+
+        if( size != 0 && size <= PoolStateAllocator::MAX_POOLED_SIZE )
+        {
+            const std::size_t sizeClass = ( size - 1 ) / PoolStateAllocator::SIZE_CLASS_GRANULARITY;
+
+            if( PoolFreeBlock *block = cache.heads[sizeClass] )
+            {
+                cache.heads[sizeClass] = block->next;
+                cache.counts[sizeClass]--;
+                return block;
+            }
+
+            // allocate the whole size class so that the block can be reused by any state of the same class later
+            size = ( sizeClass + 1 ) * PoolStateAllocator::SIZE_CLASS_GRANULARITY;
+        }
+
+        cache.stats.heapAllocations++;
+        return ::operator new( size );
+    }
+
+    inline void poolDeallocate( void *ptr, std::size_t size ) noexcept
+    {
+        PoolThreadCache& cache = poolThreadCache;
+        cache.stats.deallocations++;
+
+        if( size != 0 && size <= PoolStateAllocator::MAX_POOLED_SIZE && !cache.isReleased )
+        {
+            const std::size_t sizeClass = ( size - 1 ) / PoolStateAllocator::SIZE_CLASS_GRANULARITY;
+
+            if( cache.counts[sizeClass] < PoolStateAllocator::MAX_CACHED_BLOCKS )
+            {
+                if( !cache.isReleaserRegistered )
+                {
+                    // odr-use forces construction of the releaser, which registers its destructor for this thread
+                    (void)&poolThreadCacheReleaser;
+                    cache.isReleaserRegistered = true;
+                }
+
+                PoolFreeBlock *block = static_cast<PoolFreeBlock *>( ptr );
+                block->next = cache.heads[sizeClass];
+                cache.heads[sizeClass] = block;
+                cache.counts[sizeClass]++;
+                return;
+            }
+        }
+
+        cache.stats.heapDeallocations++;
+        ::operator delete( ptr );
+    }
+
+
+    // Counters of HeapStateAllocator, kept apart from the pool ones so that each allocator reports only its own allocations
+    inline thread_local StateAllocatorStats heapThreadStats {};
+
+
+    // nullptr means the default pool allocator, which is then called directly instead of through a virtual call;
+    // states are created on many threads, so the allocator set on one of them has to be published with release-acquire
+    inline std::atomic< StateAllocator * > stateAllocator { nullptr };
+
+    inline void *allocateState( std::size_t size )
+    {
+        if( StateAllocator *allocator = stateAllocator.load( std::memory_order_acquire ) )
+        {
+            return allocator->allocate( size );
+        }
+
+        return poolAllocate( size );
+    }
+
+    inline void deallocateState( void *ptr, std::size_t size ) noexcept
+    {
+        if( StateAllocator *allocator = stateAllocator.load( std::memory_order_acquire ) )
+        {
+            allocator->deallocate( ptr, size );
+        }
+        else
+        {
+            poolDeallocate( ptr, size );
+        }
+    }
+
+} // namespace detail
+
+
+
+inline void *HeapStateAllocator::allocate( std::size_t size )
+{
+    detail::heapThreadStats.allocations++;
+    detail::heapThreadStats.heapAllocations++;
+    return ::operator new( size );
+}
+
+inline void HeapStateAllocator::deallocate( void *ptr, std::size_t /*size*/ ) noexcept
+{
+    detail::heapThreadStats.deallocations++;
+    detail::heapThreadStats.heapDeallocations++;
+    ::operator delete( ptr );
+}
+
+inline StateAllocatorStats HeapStateAllocator::getStats() const noexcept
+{
+    return detail::heapThreadStats;
+}
+
+
+
+inline void *PoolStateAllocator::allocate( std::size_t size )
+{
+    return detail::poolAllocate( size );
+}
+
+inline void PoolStateAllocator::deallocate( void *ptr, std::size_t size ) noexcept
+{
+    detail::poolDeallocate( ptr, size );
+}
+
+inline StateAllocatorStats PoolStateAllocator::getStats() const noexcept
+{
+    return detail::poolThreadCache.stats;
+}
+
+inline void PoolStateAllocator::trim() noexcept
+{
+    detail::poolReleaseThreadCache( detail::poolThreadCache );
+}
+
+
+
+inline StateAllocator& getStateAllocator() noexcept
+{
+    if( StateAllocator *allocator = detail::stateAllocator.load( std::memory_order_acquire ) )
+    {
+        return *allocator;
+    }
+
+    // intentionally leaked so that it stays valid during static destruction
+    static PoolStateAllocator *defaultAllocator = new PoolStateAllocator();
+    return *defaultAllocator;
+}
+
+inline void setStateAllocator( StateAllocator *allocator ) noexcept
+{
+    detail::stateAllocator.store( allocator, std::memory_order_release );
+}
+
+} // namespace chestnut::fsm
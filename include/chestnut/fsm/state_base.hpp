@@ -13,12 +13,21 @@
 #define __CHESTNUT_STATEMACHINE_STATE_BASE_H__
 
 #include "state_transition.hpp"
+#include "state_allocator.hpp"
+
+#include <cstddef>
+#include <new>
 
 namespace chestnut::fsm
 {
 
 // forward declaration because of mutual dependence
 class StatemachineBase;
+class SnapshotWriter;
+class SnapshotReader;
+class TransitionJournalReader;
+template< class StateExtension, class BaseStatemachineClass >
+class Statemachine;
 
 
 /**
@@ -33,6 +42,41 @@ protected:
      */
     StatemachineBase *parent;
 
+private:
+    /**
+     * @brief Identifier of the most derived type of this state, set by the statemachine when the state is created
+     */
+    StateId stateId;
+    /**
+     * @brief Identifier of the base state type of the statemachine this state was created for (StateType::BaseStateType)
+     */
+    StateId baseStateTypeId;
+    /**
+     * @brief This state upcasted to the base state type of the statemachine it was created for, set by the statemachine when the state is created
+     * 
+     * @details
+     * The base state type is a virtual base of StateBase, so StateBase can't be downcasted to it with static_cast.
+     * The upcast is done once when the state is created, when its full type is still known.
+     */
+    void *baseStatePtr;
+    /**
+     * @brief This state as its most derived type, set by the statemachine when the state is created
+     * 
+     * @details
+     * Used to get back to the concrete state type once its identifier is checked (e.g. by transition tables).
+     */
+    void *statePtr;
+    /**
+     * @brief Upcasts statePtr to the base state type of any statemachine class in the hierarchy of the statemachine this state was created for
+     * 
+     * @return upcasted state or nullptr if the state doesn't derive from the base state type with given identifier
+     * 
+     * @details
+     * Set by the statemachine when the state is created. Used by fsm::Statemachine::getCurrentState() 
+     * when the state wasn't created for the statemachine class it's called on, so baseStatePtr doesn't fit.
+     */
+    void *( *castToBaseState )( void *statePtr, StateId baseStateTypeId ) noexcept;
+
 
 public:
     /**
@@ -41,6 +85,13 @@ public:
     typedef StatemachineBase StatemachineType;
     // Befriended fsm::Statemachine so that it can call setParent()
     friend StatemachineBase;
+    // Befriended so that it can access baseStatePtr and statePtr
+    template< class StateExtension, class BaseStatemachineClass >
+    friend class Statemachine;
+    // Befriended so that they can save and restore states outside of transitions
+    friend SnapshotWriter;
+    friend SnapshotReader;
+    friend TransitionJournalReader;
     /**
      * @brief Typedef of the base class (here it is this class itself)
      */
@@ -66,6 +117,15 @@ public:
      * 
      * @details
      * By default this always returns true
+     * 
+     * This guard is evaluated on the already constructed next state. If the decision doesn't need the state object,
+     * define a public static guard in the state class instead (or in addition), which the statemachine evaluates 
+     * before it constructs anything:
+     * @code
+     * static bool canEnterStateType( StateTransition transition );
+     * static bool canEnterStateType( const StatemachineType& machine, StateTransition transition );
+     * @endcode
+     * Transitions rejected this way cost only the guard call.
      */
     virtual bool canEnterState( StateTransition transition ) const noexcept;
 
@@ -79,6 +139,42 @@ public:
      * By default this always returns true
      */
     virtual bool canLeaveState( StateTransition transition ) const noexcept;
+
+    /**
+     * @brief Get the identifier of this state's type
+     * 
+     * @return state type identifier or NULL_STATE if the state hasn't been created by a statemachine
+     */
+    StateId getStateId() const noexcept;
+
+
+    /**
+     * @brief Allocation function for all state objects, forwards to the current state allocator
+     * 
+     * @param size size of the most derived state type
+     * @return pointer to the state storage
+     * 
+     * @details
+     * State classes can still define their own operator new and delete, which will then take precedence.
+     * 
+     * @see getStateAllocator(), setStateAllocator()
+     */
+    static void *operator new( std::size_t size );
+    /**
+     * @brief Deallocation function for all state objects, forwards to the current state allocator
+     * 
+     * @param ptr pointer to the state storage
+     * @param size size of the most derived state type
+     */
+    static void operator delete( void *ptr, std::size_t size ) noexcept;
+    /**
+     * @brief Allocation function for over-aligned state types, these bypass the state allocator
+     */
+    static void *operator new( std::size_t size, std::align_val_t alignment );
+    /**
+     * @brief Deallocation function for over-aligned state types, these bypass the state allocator
+     */
+    static void operator delete( void *ptr, std::size_t size, std::align_val_t alignment ) noexcept;
     
 
 
@@ -117,6 +213,54 @@ protected:
      */
     virtual void onLeaveState( StateTransition transition );
 
+    /**
+     * @brief A method called when a persistent state object is reused, before the statemachine checks canEnterState and enters it again
+     * 
+     * @details
+     * Only called for statemachines with persistent states enabled. 
+     * Use it to reset whatever the constructor would have otherwise set up. By default it does nothing.
+     * 
+     * @see StatemachineBase::setPersistentStates()
+     */
+    virtual void onRearmState();
+
+    /**
+     * @brief A method called when the statemachine is saved with SnapshotWriter::writeStatemachine(), to write the data of the state
+     * 
+     * @param writer snapshot being written
+     * 
+     * @details
+     * By default it writes nothing. States that need to be restored with more than their type write their members 
+     * with the write methods of the writer and read them back in the same order in deserializeState().
+     */
+    virtual void serializeState( SnapshotWriter& writer ) const;
+
+    /**
+     * @brief A method called when the statemachine is restored with SnapshotReader::restoreStatemachine(), to read the data written by serializeState()
+     * 
+     * @param reader snapshot being read
+     * 
+     * @details
+     * Called right after the state is constructed, instead of onEnterState. By default it reads nothing.
+     * If a read fails the whole restore fails, so the state doesn't need to check every read.
+     */
+    virtual void deserializeState( SnapshotReader& reader );
+
+    /**
+     * @brief Mark the onEnterState or onLeaveState call in progress as failed
+     * 
+     * @param errorCode user defined code describing the error, must not be 0
+     * 
+     * @details
+     * An alternative to throwing an exception from the callback, which also works when the library is built without exceptions.
+     * The callback should return right after calling it. The statemachine then handles the failure the same way it handles
+     * an exception, except it doesn't throw - the state change method returns false and 
+     * StatemachineBase::getLastTransitionResult() holds the error code.
+     * 
+     * @see StatemachineBase::getLastTransitionResult(), CHESTNUT_FSM_HAS_EXCEPTIONS
+     */
+    void failTransition( int errorCode ) noexcept;
+
 
 private:
     /**
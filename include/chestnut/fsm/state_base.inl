@@ -1,18 +1,24 @@
 #include "exceptions.hpp"
 
+#include <cassert>
+
 namespace chestnut::fsm
 {
 
-StateBase::StateBase() 
+inline StateBase::StateBase() 
 {
     // so that use of this pointer in a constructor can be detected reliably
     this->parent = nullptr;
+    this->stateId = NULL_STATE;
+    this->baseStateTypeId = NULL_STATE;
+    this->baseStatePtr = nullptr;
+    this->statePtr = nullptr;
+    this->castToBaseState = nullptr;
 }
 
-bool StateBase::setParent( StatemachineBase *parent_ ) noexcept
+inline bool StateBase::setParent( StatemachineBase *parent_ ) noexcept
 {
-    // children classes will simply do dynamic_cast on their desired statemachine type
-    this->parent = parent;
+    this->parent = parent_;
     return true;
 }
 
@@ -24,7 +30,7 @@ inline StatemachineBase& StateBase::getParent()
     }
     else
     {
-        throw BadParentAccessException( "State parent access violation!");
+        detail::raiseBadParentAccess();
     }
 }
 
@@ -36,26 +42,66 @@ inline const StatemachineBase& StateBase::getParent() const
     }
     else
     {
-        throw BadParentAccessException( "State parent access violation!");
+        detail::raiseBadParentAccess();
     }
 }
 
-inline bool StateBase::canEnterState( StateTransition transition ) const noexcept
+inline bool StateBase::canEnterState( StateTransition /*transition*/ ) const noexcept
 {
     return true;
 }
 
-inline bool StateBase::canLeaveState( StateTransition transition ) const noexcept
+inline bool StateBase::canLeaveState( StateTransition /*transition*/ ) const noexcept
 {
     return true;
 }
 
-inline void StateBase::onEnterState( StateTransition transition ) 
+inline StateId StateBase::getStateId() const noexcept
+{
+    return stateId;
+}
+
+inline void *StateBase::operator new( std::size_t size )
+{
+    return detail::allocateState( size );
+}
+
+inline void StateBase::operator delete( void *ptr, std::size_t size ) noexcept
+{
+    detail::deallocateState( ptr, size );
+}
+
+inline void *StateBase::operator new( std::size_t size, std::align_val_t alignment )
+{
+    return ::operator new( size, alignment );
+}
+
+inline void StateBase::operator delete( void *ptr, std::size_t size, std::align_val_t alignment ) noexcept
+{
+    ::operator delete( ptr, size, alignment );
+}
+
+inline void StateBase::onEnterState( StateTransition /*transition*/ ) 
+{
+    /*NOP*/
+}
+
+inline void StateBase::onLeaveState( StateTransition /*transition*/ ) 
+{
+    /*NOP*/
+}
+
+inline void StateBase::onRearmState() 
+{
+    /*NOP*/
+}
+
+inline void StateBase::serializeState( SnapshotWriter& /*writer*/ ) const
 {
     /*NOP*/
 }
 
-inline void StateBase::onLeaveState( StateTransition transition ) 
+inline void StateBase::deserializeState( SnapshotReader& /*reader*/ ) 
 {
     /*NOP*/
 }
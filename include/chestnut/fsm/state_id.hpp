@@ -0,0 +1,78 @@
+/**
+ * @file state_id.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with dense state type identifiers
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_STATE_ID_H__
+#define __CHESTNUT_STATEMACHINE_STATE_ID_H__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Integer identifier of a state type
+ *
+ * @details
+ * Identifiers are assigned to state types on their first use, starting from 1 and without any gaps,
+ * so they can be used to directly index arrays. Value 0 is reserved for NULL_STATE.
+ * Identifiers are not stable between different runs of a program, use getStateTypeName() if you need a persistent type representation.
+ *
+ * Identifiers are assigned at runtime and not at compile time, because a header-only library has no single place
+ * where every state type used by the program is known - types are spread across translation units and
+ * compile-time counters can't be shared between them. Assigning costs a lock once per type and afterwards
+ * stateIdOf() only reads a function-local static.
+ *
+ * Identifiers don't rely on RTTI, so the library can be used with RTTI disabled.
+ *
+ * @see stateIdOf(), NULL_STATE
+ */
+typedef std::uint32_t StateId;
+
+
+/**
+ * @brief Get the identifier of a state type
+ *
+ * @tparam StateType type of the state
+ * @return identifier of the type
+ */
+template< class StateType >
+StateId stateIdOf() noexcept;
+
+/**
+ * @brief Get the name of a state type with given identifier
+ *
+ * @param id state type identifier
+ * @return type name or an empty string if no type has such identifier; for NULL_STATE returns "NULL_STATE"
+ *
+ * @details
+ * The name is deduced from the compiler's function signature macro, so it's fully qualified and stable for a given build.
+ * Lookup doesn't lock, so it can be used on hot paths and concurrently with new types being registered.
+ */
+const char *getStateTypeName( StateId id ) noexcept;
+
+/**
+ * @brief Get the upper bound of identifiers assigned so far
+ *
+ * @return the biggest assigned identifier plus one (which accounts for NULL_STATE)
+ *
+ * @details
+ * This is the size an array indexed with state identifiers needs to have to fit every state type used so far.
+ */
+std::size_t getStateIdCount() noexcept;
+
+} // namespace chestnut::fsm
+
+
+#include "state_id.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_STATE_ID_H__
@@ -0,0 +1,147 @@
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace chestnut::fsm
+{
+
+namespace detail
+{
+    template< class T >
+    const char *functionSignatureOf() noexcept
+    {
+    #if defined(_MSC_VER) && !defined(__clang__)
+        return __FUNCSIG__;
+    #else
+        return __PRETTY_FUNCTION__;
+    #endif
+    }
+
+    // extracts the name of T out of the signature of functionSignatureOf<T>
+    template< class T >
+    std::string typeNameOf()
+    {
+        std::string signature = functionSignatureOf<T>();
+
+    #if defined(_MSC_VER) && !defined(__clang__)
+        // const char *__cdecl chestnut::fsm::detail::functionSignatureOf<class Type>(void) noexcept
+        std::size_t begin = signature.find( "functionSignatureOf<" ) + std::strlen( "functionSignatureOf<" );
+        std::size_t end = signature.rfind( ">(" );
+        std::string name = signature.substr( begin, end - begin );
+        for( const char *prefix : { "class ", "struct ", "enum " } )
+        {
+            if( name.compare( 0, std::strlen( prefix ), prefix ) == 0 )
+            {
+                name.erase( 0, std::strlen( prefix ) );
+                break;
+            }
+        }
+        return name;
+    #else
+        // GCC: const char* chestnut::fsm::detail::functionSignatureOf() [with T = Type]
+        // Clang: const char *chestnut::fsm::detail::functionSignatureOf() [T = Type]
+        std::size_t begin = signature.find( "T = " ) + std::strlen( "T = " );
+        std::size_t end = signature.find_first_of( ";]", begin );
+        return signature.substr( begin, end - begin );
+    #endif
+    }
+
+
+    // names are kept in chunks growing twice in size, chunk i holding STATE_NAME_CHUNK_BASE << i names,
+    // so that they can be looked up without locking while new types are being registered
+    constexpr std::size_t STATE_NAME_CHUNK_BASE_BITS = 4;
+    constexpr std::size_t STATE_NAME_CHUNK_BASE = (std::size_t)1 << STATE_NAME_CHUNK_BASE_BITS;
+    constexpr std::size_t STATE_NAME_CHUNK_COUNT = 28;
+
+    struct StateTypeRegistry
+    {
+        std::mutex mutex;
+        // deque doesn't move its elements when growing, so pointers to names stay valid
+        std::deque<std::string> names { "NULL_STATE" };
+        // chunks and names in them are written before count is increased and never change afterwards
+        const char **nameChunks[STATE_NAME_CHUNK_COUNT] = {};
+        std::atomic<std::size_t> count { 0 };
+    };
+
+    inline void locateStateName( std::size_t id, std::size_t& chunk, std::size_t& offset ) noexcept
+    {
+        const std::size_t biased = id + STATE_NAME_CHUNK_BASE;
+        std::size_t bit = 0;
+        while( ( biased >> ( bit + 1 ) ) != 0 )
+        {
+            bit++;
+        }
+
+        chunk = bit - STATE_NAME_CHUNK_BASE_BITS;
+        offset = biased - ( (std::size_t)1 << bit );
+    }
+
+    inline void publishStateName( StateTypeRegistry& registry, std::size_t id )
+    {
+        std::size_t chunk, offset;
+        locateStateName( id, chunk, offset );
+        if( !registry.nameChunks[chunk] )
+        {
+            registry.nameChunks[chunk] = new const char *[STATE_NAME_CHUNK_BASE << chunk];
+        }
+
+        registry.nameChunks[chunk][offset] = registry.names[id].c_str();
+        registry.count.store( id + 1, std::memory_order_release );
+    }
+
+    inline StateTypeRegistry& getStateTypeRegistry()
+    {
+        // intentionally leaked, so that it can be used during static destruction
+        static StateTypeRegistry *registry = [] {
+            StateTypeRegistry *created = new StateTypeRegistry();
+            publishStateName( *created, 0 );
+            return created;
+        }();
+        return *registry;
+    }
+
+    inline StateId registerStateType( std::string name )
+    {
+        StateTypeRegistry& registry = getStateTypeRegistry();
+        std::lock_guard<std::mutex> lock( registry.mutex );
+
+        registry.names.push_back( std::move( name ) );
+        const std::size_t id = registry.names.size() - 1;
+        publishStateName( registry, id );
+
+        return (StateId)id;
+    }
+
+} // namespace detail
+
+
+template<class StateType>
+inline StateId stateIdOf() noexcept
+{
+    // the registry is guarded by the static initialization, it's only accessed once per type
+    static const StateId id = detail::registerStateType( detail::typeNameOf<StateType>() );
+    return id;
+}
+
+inline const char *getStateTypeName( StateId id ) noexcept
+{
+    detail::StateTypeRegistry& registry = detail::getStateTypeRegistry();
+
+    if( id < registry.count.load( std::memory_order_acquire ) )
+    {
+        std::size_t chunk, offset;
+        detail::locateStateName( id, chunk, offset );
+        return registry.nameChunks[chunk][offset];
+    }
+
+    return "";
+}
+
+inline std::size_t getStateIdCount() noexcept
+{
+    return detail::getStateTypeRegistry().count.load( std::memory_order_acquire );
+}
+
+} // namespace chestnut::fsm
@@ -0,0 +1,129 @@
+/**
+ * @file state_stack.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with the contiguous stack container used for the statemachine's state stack
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_STATE_STACK_H__
+#define __CHESTNUT_STATEMACHINE_STATE_STACK_H__
+
+#include <cstddef>
+#include <type_traits>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Contiguous stack with a small inline buffer
+ *
+ * @details
+ * The first InlineCapacity elements are stored inside the object itself, so pushing and popping doesn't allocate
+ * as long as the stack doesn't grow beyond that. Past that point the content is moved to a heap buffer with doubled capacity,
+ * which is then kept until the stack is destroyed.
+ *
+ * Elements are stored in a single array, so accessing the top of the stack is a single indexed load.
+ *
+ * @tparam T type of the element, it has to be trivially copyable
+ * @tparam InlineCapacity number of elements that can be stored without heap allocation
+ */
+template< class T, std::size_t InlineCapacity >
+class StateStack
+{
+    static_assert( std::is_trivially_copyable<T>::value, "StateStack supports only trivially copyable element types!" );
+    static_assert( InlineCapacity > 0, "InlineCapacity has to be greater than zero!" );
+
+public:
+    StateStack() noexcept;
+    ~StateStack();
+
+    StateStack( const StateStack& ) = delete;
+    StateStack& operator=( const StateStack& ) = delete;
+
+
+    /**
+     * @brief Push an element onto the top of the stack
+     *
+     * @param value element to push
+     *
+     * @throws std::bad_alloc if the stack had to grow beyond its inline capacity and allocation failed
+     */
+    void push( const T& value );
+
+    /**
+     * @brief Remove the element on top of the stack. The stack must not be empty
+     */
+    void pop() noexcept;
+
+    /**
+     * @brief Get the element on top of the stack. The stack must not be empty
+     *
+     * @return top element
+     */
+    T& top() noexcept;
+    /**
+     * @brief Get the element on top of the stack. The stack must not be empty
+     *
+     * @return top element
+     */
+    const T& top() const noexcept;
+
+    /**
+     * @brief Access an element by its position counting from the bottom of the stack
+     *
+     * @param index position of the element
+     * @return element at that position
+     */
+    T& operator[]( std::size_t index ) noexcept;
+    /**
+     * @brief Access an element by its position counting from the bottom of the stack
+     *
+     * @param index position of the element
+     * @return element at that position
+     */
+    const T& operator[]( std::size_t index ) const noexcept;
+
+    /**
+     * @brief Get the number of elements on the stack
+     *
+     * @return stack size
+     */
+    std::size_t size() const noexcept;
+
+    /**
+     * @brief Check whether the stack is empty
+     *
+     * @return whether the stack is empty
+     */
+    bool empty() const noexcept;
+
+    /**
+     * @brief Get the number of elements the stack can hold before it has to reallocate
+     *
+     * @return stack capacity
+     */
+    std::size_t capacity() const noexcept;
+
+
+private:
+    void grow();
+
+
+private:
+    T *m_data;
+    std::size_t m_size;
+    std::size_t m_capacity;
+    T m_inline[InlineCapacity];
+};
+
+} // namespace chestnut::fsm
+
+
+#include "state_stack.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_STATE_STACK_H__
@@ -0,0 +1,100 @@
+#include <cstring>
+#include <new>
+
+namespace chestnut::fsm
+{
+
+template<class T, std::size_t InlineCapacity>
+inline StateStack<T, InlineCapacity>::StateStack() noexcept
+{
+    m_data = m_inline;
+    m_size = 0;
+    m_capacity = InlineCapacity;
+}
+
+template<class T, std::size_t InlineCapacity>
+inline StateStack<T, InlineCapacity>::~StateStack()
+{
+    if( m_data != m_inline )
+    {
+        ::operator delete( m_data );
+    }
+}
+
+template<class T, std::size_t InlineCapacity>
+inline void StateStack<T, InlineCapacity>::push( const T& value )
+{
+    if( m_size == m_capacity )
+    {
+        grow();
+    }
+
+    m_data[m_size++] = value;
+}
+
+template<class T, std::size_t InlineCapacity>
+inline void StateStack<T, InlineCapacity>::pop() noexcept
+{
+    m_size--;
+}
+
+template<class T, std::size_t InlineCapacity>
+inline T& StateStack<T, InlineCapacity>::top() noexcept
+{
+    return m_data[m_size - 1];
+}
+
+template<class T, std::size_t InlineCapacity>
+inline const T& StateStack<T, InlineCapacity>::top() const noexcept
+{
+    return m_data[m_size - 1];
+}
+
+template<class T, std::size_t InlineCapacity>
+inline T& StateStack<T, InlineCapacity>::operator[]( std::size_t index ) noexcept
+{
+    return m_data[index];
+}
+
+template<class T, std::size_t InlineCapacity>
+inline const T& StateStack<T, InlineCapacity>::operator[]( std::size_t index ) const noexcept
+{
+    return m_data[index];
+}
+
+template<class T, std::size_t InlineCapacity>
+inline std::size_t StateStack<T, InlineCapacity>::size() const noexcept
+{
+    return m_size;
+}
+
+template<class T, std::size_t InlineCapacity>
+inline bool StateStack<T, InlineCapacity>::empty() const noexcept
+{
+    return m_size == 0;
+}
+
+template<class T, std::size_t InlineCapacity>
+inline std::size_t StateStack<T, InlineCapacity>::capacity() const noexcept
+{
+    return m_capacity;
+}
+
+template<class T, std::size_t InlineCapacity>
+inline void StateStack<T, InlineCapacity>::grow()
+{
+    std::size_t newCapacity = m_capacity * 2;
+    T *newData = static_cast<T *>( ::operator new( newCapacity * sizeof(T) ) );
+
+    std::memcpy( newData, m_data, m_size * sizeof(T) );
+
+    if( m_data != m_inline )
+    {
+        ::operator delete( m_data );
+    }
+
+    m_data = newData;
+    m_capacity = newCapacity;
+}
+
+} // namespace chestnut::fsm
@@ -0,0 +1,242 @@
+/**
+ * @file state_traits.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with compile time detection of optional state callbacks
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ * @details
+ * Statemachines which don't use virtual dispatch (like StaticStatemachine) accept plain state classes
+ * which may or may not define any of the callbacks known from StateBase.
+ * Every callback can be declared either with or without the statemachine reference as its first parameter:
+ * @code
+ * bool canEnterState( StateTransition transition ) const;
+ * bool canEnterState( Machine& machine, StateTransition transition ) const;
+ * bool canLeaveState( StateTransition transition ) const;
+ * bool canLeaveState( Machine& machine, StateTransition transition ) const;
+ * void onEnterState( StateTransition transition );
+ * void onEnterState( Machine& machine, StateTransition transition );
+ * void onLeaveState( StateTransition transition );
+ * void onLeaveState( Machine& machine, StateTransition transition );
+ * void onEvent( const Event& event );
+ * void onEvent( Machine& machine, const Event& event );
+ * void onRearmState();
+ * void onRearmState( Machine& machine );
+ * @endcode
+ * Callbacks that are not defined are treated like the default ones from StateBase.
+ *
+ * Any state, including the ones deriving from StateBase, can also have a static entry guard.
+ * Statemachines evaluate it before the next state object is even constructed:
+ * @code
+ * static bool canEnterStateType( StateTransition transition );
+ * static bool canEnterStateType( const Machine& machine, StateTransition transition );
+ * @endcode
+ *
+ * States of HierarchicalStatemachine can also declare their place in the hierarchy with member types:
+ * @code
+ * typedef Parent ParentState;   // state this one is nested in
+ * typedef Child InitialState;   // nested state entered right after this one
+ * @endcode
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_STATE_TRAITS_H__
+#define __CHESTNUT_STATEMACHINE_STATE_TRAITS_H__
+
+#include "state_transition.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace chestnut::fsm
+{
+
+namespace detail
+{
+    template< class Void, template<class...> class Op, class ...Args >
+    struct Detector : std::false_type {};
+
+    template< template<class...> class Op, class ...Args >
+    struct Detector< std::void_t< Op<Args...> >, Op, Args... > : std::true_type {};
+
+    template< template<class...> class Op, class ...Args >
+    constexpr bool isDetected = Detector<void, Op, Args...>::value;
+
+
+    template< class S, class M >
+    using CanEnterStateWithMachineOp = decltype( std::declval<const S&>().canEnterState( std::declval<M&>(), std::declval<StateTransition>() ) );
+    template< class S >
+    using CanEnterStateOp = decltype( std::declval<const S&>().canEnterState( std::declval<StateTransition>() ) );
+
+    template< class S, class M >
+    using CanLeaveStateWithMachineOp = decltype( std::declval<const S&>().canLeaveState( std::declval<M&>(), std::declval<StateTransition>() ) );
+    template< class S >
+    using CanLeaveStateOp = decltype( std::declval<const S&>().canLeaveState( std::declval<StateTransition>() ) );
+
+    template< class S, class M >
+    using OnEnterStateWithMachineOp = decltype( std::declval<S&>().onEnterState( std::declval<M&>(), std::declval<StateTransition>() ) );
+    template< class S >
+    using OnEnterStateOp = decltype( std::declval<S&>().onEnterState( std::declval<StateTransition>() ) );
+
+    template< class S, class M >
+    using OnLeaveStateWithMachineOp = decltype( std::declval<S&>().onLeaveState( std::declval<M&>(), std::declval<StateTransition>() ) );
+    template< class S >
+    using OnLeaveStateOp = decltype( std::declval<S&>().onLeaveState( std::declval<StateTransition>() ) );
+
+    template< class S, class M >
+    using OnRearmStateWithMachineOp = decltype( std::declval<S&>().onRearmState( std::declval<M&>() ) );
+    template< class S >
+    using OnRearmStateOp = decltype( std::declval<S&>().onRearmState() );
+
+    template< class S, class M, class E >
+    using OnEventWithMachineOp = decltype( std::declval<S&>().onEvent( std::declval<M&>(), std::declval<const E&>() ) );
+    template< class S, class E >
+    using OnEventOp = decltype( std::declval<S&>().onEvent( std::declval<const E&>() ) );
+
+
+    template< class S, class M >
+    using CanEnterStateTypeWithMachineOp = decltype( S::canEnterStateType( std::declval<const M&>(), std::declval<StateTransition>() ) );
+    template< class S >
+    using CanEnterStateTypeOp = decltype( S::canEnterStateType( std::declval<StateTransition>() ) );
+
+
+    template< class S, class M >
+    inline bool callCanEnterStateType( const M& machine, StateTransition transition )
+    {
+        if constexpr( isDetected<CanEnterStateTypeWithMachineOp, S, M> )
+        {
+            return S::canEnterStateType( machine, transition );
+        }
+        else if constexpr( isDetected<CanEnterStateTypeOp, S> )
+        {
+            return S::canEnterStateType( transition );
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    template< class S, class M >
+    inline bool callCanEnterState( const S& state, M& machine, StateTransition transition )
+    {
+        if constexpr( isDetected<CanEnterStateWithMachineOp, S, M> )
+        {
+            return state.canEnterState( machine, transition );
+        }
+        else if constexpr( isDetected<CanEnterStateOp, S> )
+        {
+            return state.canEnterState( transition );
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    template< class S, class M >
+    inline bool callCanLeaveState( const S& state, M& machine, StateTransition transition )
+    {
+        if constexpr( isDetected<CanLeaveStateWithMachineOp, S, M> )
+        {
+            return state.canLeaveState( machine, transition );
+        }
+        else if constexpr( isDetected<CanLeaveStateOp, S> )
+        {
+            return state.canLeaveState( transition );
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    template< class S, class M >
+    inline void callOnEnterState( S& state, M& machine, StateTransition transition )
+    {
+        if constexpr( isDetected<OnEnterStateWithMachineOp, S, M> )
+        {
+            state.onEnterState( machine, transition );
+        }
+        else if constexpr( isDetected<OnEnterStateOp, S> )
+        {
+            state.onEnterState( transition );
+        }
+    }
+
+    template< class S, class M >
+    inline void callOnLeaveState( S& state, M& machine, StateTransition transition )
+    {
+        if constexpr( isDetected<OnLeaveStateWithMachineOp, S, M> )
+        {
+            state.onLeaveState( machine, transition );
+        }
+        else if constexpr( isDetected<OnLeaveStateOp, S> )
+        {
+            state.onLeaveState( transition );
+        }
+    }
+
+    template< class S, class M >
+    inline void callOnRearmState( S& state, M& machine )
+    {
+        if constexpr( isDetected<OnRearmStateWithMachineOp, S, M> )
+        {
+            state.onRearmState( machine );
+        }
+        else if constexpr( isDetected<OnRearmStateOp, S> )
+        {
+            state.onRearmState();
+        }
+    }
+
+    template< class S, class M, class E >
+    constexpr bool hasOnEvent = isDetected<OnEventWithMachineOp, S, M, E> || isDetected<OnEventOp, S, E>;
+
+    // returns whether the state has a handler for the event
+    template< class S, class M, class E >
+    inline bool callOnEvent( S& state, M& machine, const E& event )
+    {
+        if constexpr( isDetected<OnEventWithMachineOp, S, M, E> )
+        {
+            state.onEvent( machine, event );
+            return true;
+        }
+        else if constexpr( isDetected<OnEventOp, S, E> )
+        {
+            state.onEvent( event );
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+
+    template< class S >
+    using ParentStateOp = typename S::ParentState;
+    template< class S >
+    using InitialStateOp = typename S::InitialState;
+
+
+    template< class T, class ...Ts >
+    struct IndexOf;
+
+    template< class T, class ...Ts >
+    struct IndexOf<T, T, Ts...> : std::integral_constant<std::size_t, 0> {};
+
+    template< class T, class U, class ...Ts >
+    struct IndexOf<T, U, Ts...> : std::integral_constant<std::size_t, 1 + IndexOf<T, Ts...>::value> {};
+
+    template< class T, class ...Ts >
+    constexpr bool isOneOf = ( std::is_same<T, Ts>::value || ... );
+
+} // namespace detail
+
+} // namespace chestnut::fsm
+
+
+#endif // __CHESTNUT_STATEMACHINE_STATE_TRAITS_H__
@@ -12,13 +12,13 @@
 #ifndef __CHESTNUT_STATEMACHINE_STATE_TRANSITION_H__
 #define __CHESTNUT_STATEMACHINE_STATE_TRANSITION_H__
 
-#include <typeindex>
+#include "state_id.hpp"
 
 namespace chestnut::fsm
 {
 
 /**
- * @brief A constant type index meant to represent a lack of state
+ * @brief A constant state identifier meant to represent a lack of state
  * 
  * @details
  * There are currently 3 situations when NULL_STATE is used: \n 
@@ -26,7 +26,7 @@ namespace chestnut::fsm
  * 2. When statemachine is being initialized with its init state, then NULL_STATE is passed to onEnterState of that state \n
  * 3. When statemachine is being deleted, then NULL_STATE is passed to onLeaveState of every state on the state stack before deleting them
  */
-const std::type_index NULL_STATE = std::type_index( typeid(nullptr) );
+constexpr StateId NULL_STATE = 0;
 
 
 /**
@@ -55,9 +55,43 @@ struct StateTransition
     /** Type of the transition */
     EStateTransitionType type;
     /** State type before the transition */
-    std::type_index prevState = NULL_STATE;
+    StateId prevState = NULL_STATE;
     /** State type after the transition */
-    std::type_index nextState = NULL_STATE; 
+    StateId nextState = NULL_STATE; 
+};
+
+
+/**
+ * @brief Enum describing why a state transition has failed
+ */
+enum ETransitionError
+{
+    /** Transition went fine or was rejected by canEnterState or canLeaveState */
+    TRANSITION_ERROR_NONE,
+    /** onEnterState of the next state has failed */
+    TRANSITION_ERROR_ON_ENTER_STATE,
+    /** onLeaveState of the previous state has failed */
+    TRANSITION_ERROR_ON_LEAVE_STATE
+};
+
+/**
+ * @brief Struct describing the outcome of a transition, in particular of one in which a state callback failed
+ * 
+ * @see StatemachineBase::getLastTransitionResult(), StateBase::failTransition()
+ */
+struct TransitionResult
+{
+    /** Whether the statemachine changed the state, i.e. what the state change method returned or, for a transition executed from the run-to-completion queue, would have returned */
+    bool isAccepted = false;
+    /** Which callback has failed */
+    ETransitionError error = TRANSITION_ERROR_NONE;
+    /** Code passed to StateBase::failTransition() or 0 if the callback threw an exception */
+    int errorCode = 0;
+    /** The transition that failed */
+    StateTransition transition;
+
+    /** Return whether nothing has failed */
+    explicit operator bool() const noexcept { return error == TRANSITION_ERROR_NONE; }
 };
 
 } // namespace chestnut::fsm
@@ -73,9 +73,73 @@ public:
      * @return pointer to current state, upcasted to base statemachine state type
      * 
      * 
+     * @details
+     * The pointer is upcasted once when the state is created, so this is only an identifier comparison and a load.
+     * If the state was created for a statemachine class derived from this one, it's upcasted through the hierarchy of that class,
+     * which is known since the state was created. nullptr is returned if the state doesn't derive from BaseStateType.
+     * 
      * @see initState()
      */
     BaseStateType *getCurrentState() const noexcept;
+
+    // typed getCurrentState<StateType>() of the base class, otherwise hidden by the one above
+    using BaseStatemachineClass::getCurrentState;
+
+    /**
+     * @brief Explicitly initialize the statemachine
+     * 
+     * @details
+     * Works the same as StatemachineBase::initState(), but additionally checks at compile time
+     * whether StateType is a state of this statemachine or of a statemachine class related to it.
+     * 
+     * @see StatemachineBase::initState()
+     */
+    template< class StateType, typename ...Args >
+    bool initState( Args&& ...args );
+
+    /**
+     * @brief Transitions directly to specified state, forgetting its previous state afterwards (and deleting it)
+     * 
+     * @details
+     * Works the same as StatemachineBase::gotoState(), but additionally checks at compile time
+     * whether StateType is a state of this statemachine or of a statemachine class related to it.
+     * 
+     * @see StatemachineBase::gotoState()
+     */
+    template< class StateType, typename ...Args >
+    bool gotoState( Args&& ...args );
+
+    /**
+     * @brief Transitions to the specified state and rememebers its previous state afterwards
+     * 
+     * @details
+     * Works the same as StatemachineBase::pushState(), but additionally checks at compile time
+     * whether StateType is a state of this statemachine or of a statemachine class related to it.
+     * 
+     * @see StatemachineBase::pushState()
+     */
+    template< class StateType, typename ...Args >
+    bool pushState( Args&& ...args );
+
+    /**
+     * @brief Handles an event according to a declarative transition table
+     * 
+     * @details
+     * Works the same as StatemachineBase::processEvent(), but additionally checks at compile time
+     * whether all states in the table are states of this statemachine.
+     * 
+     * @see StatemachineBase::processEvent()
+     */
+    template< class Table, class EventType >
+    bool processEvent( const EventType& event );
+
+protected:
+    /**
+     * @brief Check whether this statemachine's state class hierarchy includes given base state type
+     * 
+     * @see StatemachineBase::hasBaseStateType()
+     */
+    virtual bool hasBaseStateType( StateId baseStateTypeId ) const noexcept override;
 };
 
 
@@ -1,4 +1,7 @@
+#include "config.hpp"
+
 #include <type_traits>
+#include <utility>
 
 namespace chestnut::fsm
 {
@@ -20,7 +23,74 @@ Statemachine<StateExtension, BaseStatemachineClass>::Statemachine()
 template<class StateExtension, class BaseStatemachineClass>
 typename Statemachine<StateExtension, BaseStatemachineClass>::BaseStateType* Statemachine<StateExtension, BaseStatemachineClass>::getCurrentState() const noexcept
 {
-    return dynamic_cast< BaseStateType* >( BaseStatemachineClass::getCurrentState() );   
+    StateBase *state = StatemachineBase::getCurrentState();
+    if( !state )
+    {
+        return nullptr;
+    }
+
+    if( state->baseStateTypeId == stateIdOf<BaseStateType>() )
+    {
+        return static_cast< BaseStateType* >( state->baseStatePtr );
+    }
+
+    // the state was created for a statemachine class derived from this one
+    return static_cast< BaseStateType* >( state->castToBaseState( state->statePtr, stateIdOf<BaseStateType>() ) );
+}
+
+template<class StateExtension, class BaseStatemachineClass>
+template<class StateType, typename ...Args>
+bool Statemachine<StateExtension, BaseStatemachineClass>::initState( Args&& ...args )
+{
+    static_assert( std::is_base_of<BaseStateType, StateType>::value, 
+        "StateType is not a state of this statemachine! It does not inherit from its BaseStateType!" );
+    static_assert( std::is_base_of<Statemachine, typename StateType::StatemachineType>::value 
+                || std::is_base_of<typename StateType::StatemachineType, Statemachine>::value, 
+        "StateType is a state of an unrelated statemachine class! Its StatemachineType is neither derived from nor a base of this statemachine!" );
+
+    return BaseStatemachineClass::template initState<StateType>( std::forward<Args>(args)... );
+}
+
+template<class StateExtension, class BaseStatemachineClass>
+template<class StateType, typename ...Args>
+bool Statemachine<StateExtension, BaseStatemachineClass>::gotoState( Args&& ...args )
+{
+    static_assert( std::is_base_of<BaseStateType, StateType>::value, 
+        "StateType is not a state of this statemachine! It does not inherit from its BaseStateType!" );
+    static_assert( std::is_base_of<Statemachine, typename StateType::StatemachineType>::value 
+                || std::is_base_of<typename StateType::StatemachineType, Statemachine>::value, 
+        "StateType is a state of an unrelated statemachine class! Its StatemachineType is neither derived from nor a base of this statemachine!" );
+
+    return BaseStatemachineClass::template gotoState<StateType>( std::forward<Args>(args)... );
+}
+
+template<class StateExtension, class BaseStatemachineClass>
+template<class StateType, typename ...Args>
+bool Statemachine<StateExtension, BaseStatemachineClass>::pushState( Args&& ...args )
+{
+    static_assert( std::is_base_of<BaseStateType, StateType>::value, 
+        "StateType is not a state of this statemachine! It does not inherit from its BaseStateType!" );
+    static_assert( std::is_base_of<Statemachine, typename StateType::StatemachineType>::value 
+                || std::is_base_of<typename StateType::StatemachineType, Statemachine>::value, 
+        "StateType is a state of an unrelated statemachine class! Its StatemachineType is neither derived from nor a base of this statemachine!" );
+
+    return BaseStatemachineClass::template pushState<StateType>( std::forward<Args>(args)... );
+}
+
+template<class StateExtension, class BaseStatemachineClass>
+template<class Table, class EventType>
+bool Statemachine<StateExtension, BaseStatemachineClass>::processEvent( const EventType& event )
+{
+    static_assert( detail::TableStatesDeriveFrom<Table, BaseStateType>::value, 
+        "Transition table contains states of another statemachine! They do not inherit from its BaseStateType!" );
+
+    return BaseStatemachineClass::template processEvent<Table>( event );
+}
+
+template<class StateExtension, class BaseStatemachineClass>
+bool Statemachine<StateExtension, BaseStatemachineClass>::hasBaseStateType( StateId baseStateTypeId ) const noexcept
+{
+    return baseStateTypeId == stateIdOf<BaseStateType>() || BaseStatemachineClass::hasBaseStateType( baseStateTypeId );
 }
 
 template<class BaseStatemachineClass>
@@ -13,16 +13,34 @@
 #ifndef __CHESTNUT_STATEMACHINE_STATEMACHINE_BASE_H__
 #define __CHESTNUT_STATEMACHINE_STATEMACHINE_BASE_H__
 
+#include "config.hpp"
 #include "state_base.hpp"
+#include "state_stack.hpp"
+#include "state_traits.hpp"
+#include "transition_table.hpp"
+#include "statemachine_observer.hpp"
 #include "exceptions.hpp"
 
-#include <list>
-#include <stack>
-#include <typeindex>
+#if CHESTNUT_FSM_TRACE_TRANSITIONS
+    #include "transition_tracer.hpp"
+#endif
+#if CHESTNUT_FSM_COLLECT_METRICS
+    #include "transition_metrics.hpp"
+#endif
+
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace chestnut::fsm
 {
 
+class SnapshotWriter;
+class SnapshotReader;
+class TransitionJournalReader;
+
 /**
  * @brief Base statemachine type. This class is used internally.
  */
@@ -48,12 +66,82 @@ public:
 private:
     /**
      * @brief A stack of state pointers
+     * 
+     * @details
+     * Its inline capacity can be configured with CHESTNUT_FSM_STATE_STACK_INLINE_CAPACITY
      */
-    std::stack< BaseStateType*, std::list<BaseStateType*> > m_stackStates;
+    StateStack< BaseStateType*, CHESTNUT_FSM_STATE_STACK_INLINE_CAPACITY > m_stackStates;
     /**
      * @brief A flag set to prevent onLeaveState from calling state change methods
      */
     bool m_isCurrentlyLeavingAState;
+    /**
+     * @brief Whether transitions requested from state callbacks are queued instead of being executed immediately
+     */
+    bool m_isRunToCompletion;
+    /**
+     * @brief A flag set while a transition (and in run-to-completion mode the following queue drain) is being executed
+     */
+    bool m_isProcessingTransition;
+    /**
+     * @brief A flag set while onEnterState is called, so that callAfterTransition() waits for it to return
+     */
+    bool m_isEnteringState;
+    /**
+     * @brief A flag set while a function passed to callAfterTransition() is called from the run-to-completion queue
+     */
+    bool m_isCallingAfterTransition;
+    /**
+     * @brief Whether state objects are kept after leaving them so they can be entered again
+     */
+    bool m_isPersistentStates;
+    /**
+     * @brief Data of the run-to-completion and persistent states modes
+     */
+    struct ModeData
+    {
+        /**
+         * @brief Transitions requested during another transition in run-to-completion mode
+         */
+        std::vector< std::function<void()> > deferredTransitions;
+        /**
+         * @brief Idle persistent state objects indexed by their StateId; nullptr where there's none
+         */
+        std::vector< BaseStateType* > persistentStates;
+        /**
+         * @brief Functions passed to callAfterTransition() from onEnterState outside of run-to-completion mode
+         */
+        std::vector< std::function<void()> > enteredStateCallbacks;
+    };
+    /**
+     * @brief Allocated the first time one of the modes needs it, so statemachines not using them don't carry the containers
+     */
+    std::unique_ptr< ModeData > m_modeData;
+    /**
+     * @brief Failure of a state callback during the last transition
+     */
+    TransitionResult m_lastTransitionResult;
+    /**
+     * @brief Code passed to StateBase::failTransition() during the state callback in progress or 0
+     */
+    int m_transitionErrorCode;
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    /**
+     * @brief Message of the exception thrown by a state callback, waiting to be rethrown as OnEnterStateException or OnLeaveStateException
+     */
+    std::string m_lastTransitionExceptionMessage;
+    bool m_hasLastTransitionException;
+#endif
+    /**
+     * @brief First of the attached observers, linked through StatemachineObserver::m_nextObserver; nullptr if there are none
+     */
+    StatemachineObserver *m_observers;
+#if CHESTNUT_FSM_COLLECT_METRICS
+    /**
+     * @brief Timestamp of the moment the current state became the current one, for its dwell time
+     */
+    std::uint64_t m_currentStateEnteredAt;
+#endif
 
 
 public:
@@ -85,14 +173,30 @@ public:
     BaseStateType *getCurrentState() const noexcept;
 
     /**
-     * @brief Get the type_index of the state object on top of the state stack or NULL_STATE if statemachine was not initialized
+     * @brief Get the pointer to a state object on top of the state stack if it's of the given type, otherwise nullptr
+     * 
+     * @tparam StateType exact type of the state
+     * @return pointer to current state or nullptr
      * 
-     * @return std::type_index of the state
      * 
+     * @details
+     * Compares state type identifiers and doesn't need RTTI, same as isCurrentlyInState().
+     * A state of a type derived from StateType is not returned.
      * 
-     * @see initState(), NULL_STATE
+     * @see isCurrentlyInState()
      */
-    std::type_index getCurrentStateType() const noexcept;
+    template< class StateType >
+    StateType *getCurrentState() const noexcept;
+
+    /**
+     * @brief Get the type identifier of the state object on top of the state stack or NULL_STATE if statemachine was not initialized
+     * 
+     * @return identifier of the state type
+     * 
+     * 
+     * @see initState(), stateIdOf(), NULL_STATE
+     */
+    StateId getCurrentStateType() const noexcept;
 
     /**
      * @brief Return whether the statemachine is currently in the given state
@@ -111,6 +215,120 @@ public:
     int getStateStackSize() const noexcept;
 
 
+    /**
+     * @brief Enable or disable the run-to-completion mode
+     * 
+     * @param enabled whether the mode should be enabled
+     * 
+     * 
+     * @details
+     * By default a state change method called from inside of onEnterState executes immediately, 
+     * nesting the next transition inside the previous one. A statemachine which keeps transitioning from its states
+     * this way grows the call stack without bound.
+     * 
+     * In run-to-completion mode gotoState, pushState and popState called while a transition is in progress
+     * don't execute immediately, but are put into a queue instead. After the transition finishes, the statemachine
+     * executes queued transitions one after the other in the order they were requested.
+     * Call stack depth then stays constant no matter how many transitions follow each other.
+     * 
+     * A state change method that queues its transition returns true, which then means only that the transition was queued.
+     * The outcome of every queued transition is recorded in getLastTransitionResult() once it's executed, replacing the previous one,
+     * so after the outermost state change method returns it describes the last transition executed.
+     * To act on the outcome of a particular transition, request it from a function passed to callAfterTransition() instead.
+     * 
+     * Arguments for deferred transitions are copied, so states constructed this way shouldn't expect to bind to non-const references.
+     * 
+     * @see isRunToCompletion()
+     */
+    void setRunToCompletion( bool enabled ) noexcept;
+
+    /**
+     * @brief Return whether the run-to-completion mode is enabled
+     * 
+     * @return whether the mode is enabled
+     * 
+     * @see setRunToCompletion()
+     */
+    bool isRunToCompletion() const noexcept;
+
+    /**
+     * @brief Return the number of transitions currently waiting in the run-to-completion queue
+     * 
+     * @return number of queued transitions
+     */
+    int getPendingTransitionCount() const noexcept;
+
+    /**
+     * @brief Call a function once the transition in progress is over, or right away if there is none
+     * 
+     * @tparam F type of the function
+     * @param callback function taking no arguments
+     * 
+     * 
+     * @details
+     * A state change method called from inside of a transition either nests the next transition inside the current one
+     * or, in run-to-completion mode, is queued and returns true without knowing whether the transition will succeed.
+     * State change methods called from the callback are executed immediately instead and return their actual result.
+     * 
+     * In run-to-completion mode the callback is queued together with deferred transitions and called in the order it was requested.
+     * Otherwise, if called from inside of onEnterState, the callback is called as soon as that onEnterState returns.
+     * The callback can't rely on the state that requested it still existing, as the transitions before it may have left it.
+     * 
+     * @see setRunToCompletion()
+     */
+    template< typename F >
+    void callAfterTransition( F&& callback );
+
+    /**
+     * @brief Enable or disable persistent states
+     * 
+     * @param enabled whether the mode should be enabled
+     * 
+     * 
+     * @details
+     * By default every transition constructs a new state object and the state that was left is deleted.
+     * With persistent states, a state object that was left is kept by the statemachine instead 
+     * and the next transition to a state of the same type reuses it. Its constructor isn't called again, 
+     * onRearmState() is called instead before the usual canEnterState and onEnterState. 
+     * Statemachines that keep cycling through the same set of states don't construct or allocate anything once all of them were visited.
+     * 
+     * Transitions that pass arguments for the state constructor always construct a new object.
+     * Only one idle object per state type is kept. If the state type is currently on the state stack, a new object is constructed.
+     * 
+     * Disabling the mode deletes all kept state objects.
+     * 
+     * @see isPersistentStates(), StateBase::onRearmState()
+     */
+    void setPersistentStates( bool enabled );
+
+    /**
+     * @brief Return whether persistent states are enabled
+     * 
+     * @return whether the mode is enabled
+     * 
+     * @see setPersistentStates()
+     */
+    bool isPersistentStates() const noexcept;
+
+    /**
+     * @brief Return the outcome of the last call to a state change method, including the failure of a state callback if any
+     * 
+     * @return result with TRANSITION_ERROR_NONE if no callback failed
+     * 
+     * 
+     * @details
+     * Failure of onEnterState or onLeaveState is reported by the state with StateBase::failTransition() 
+     * or, if exceptions are enabled, by throwing an exception. In both cases the state change method returns false 
+     * (or throws the wrapping exception) and the details are available here until the next state change method is called.
+     * Transitions executed later from the run-to-completion queue record their outcomes here as well, each one replacing the previous.
+     * 
+     * This is the only way to learn about callback failures when the library is built without exceptions.
+     * 
+     * @see StateBase::failTransition(), CHESTNUT_FSM_HAS_EXCEPTIONS
+     */
+    const TransitionResult& getLastTransitionResult() const noexcept;
+
+
     /**
      * @brief Explicitly initialize the statemachine
      * 
@@ -170,7 +388,10 @@ public:
      * If the next state throws an exception during onEnterState, this state is still pushed onto the state stack, 
      * but its condition remains undefined.
      * 
-     * @see pushState(), canLeaveState(), canEnterState(), initState(), OnLeaveStateException, OnEnterStateException
+     * In run-to-completion mode, if called while another transition is in progress, the transition is queued and the method returns true
+     * only to tell it was queued (see setRunToCompletion()).
+     * 
+     * @see pushState(), canLeaveState(), canEnterState(), initState(), OnLeaveStateException, OnEnterStateException, setRunToCompletion()
      */
     template< class StateType, typename ...Args >
     bool gotoState( Args&& ...args );
@@ -202,7 +423,10 @@ public:
      * If the next state throws an exception during onEnterState, this state is still pushed onto the state stack, 
      * but its condition remains undefined.
      * 
-     * @see canLeaveState(), canEnterState(), initState(), OnLeaveStateException, OnEnterStateException
+     * In run-to-completion mode, if called while another transition is in progress, the transition is queued and the method returns true
+     * only to tell it was queued (see setRunToCompletion()).
+     * 
+     * @see canLeaveState(), canEnterState(), initState(), OnLeaveStateException, OnEnterStateException, setRunToCompletion()
      */
     template< class StateType, typename ...Args >
     bool pushState( Args&& ...args );
@@ -225,9 +449,228 @@ public:
      * If the next state throws an exception during onEnterState, this state still stays on the state stack, 
      * but its condition remains undefined.
      * 
-     * @see canLeaveState(), canEnterState(), OnLeaveStateException, OnEnterStateException
+     * In run-to-completion mode, if called while another transition is in progress, the transition is queued and the method returns true
+     * only to tell it was queued (see setRunToCompletion()).
+     * 
+     * @see canLeaveState(), canEnterState(), OnLeaveStateException, OnEnterStateException, setRunToCompletion()
      */
     bool popState();
+
+    /**
+     * @brief Handles an event according to a declarative transition table
+     * 
+     * @tparam Table TransitionTable type listing the transitions
+     * @tparam EventType type of the event
+     * @param event event object, passed to guards, actions and constructor of the target state if it accepts one
+     * @return whether a transition was taken and statemachine changed the state
+     * 
+     * @throw OnEnterStateException or OnLeaveStateException if a state throws exception in a transition method
+     * 
+     * 
+     * @details
+     * The current state is looked up in an array of handlers generated at compile time for this table and event type,
+     * so the cost doesn't depend on the size of the table. If the current state has no row for the event, nothing happens.
+     * If guard of a row passes, the statemachine goes to the target state like with gotoState(). The action of the row is called
+     * on the current state only once the transition is accepted - after the state guards and onLeaveState, before onEnterState.
+     * 
+     * Using an event type which doesn't appear in the table is a compile error. With StrictTransitionTable an event
+     * processed in a state which isn't in the table is also asserted against, but only in debug builds, as the current state
+     * is known only at runtime.
+     * 
+     * In run to completion mode the whole event is deferred, so guards and actions see the state it is processed in.
+     * 
+     * @see TransitionTable, StrictTransitionTable, TransitionRow, gotoState()
+     */
+    template< class Table, class EventType >
+    bool processEvent( const EventType& event );
+
+
+    /**
+     * @brief Attach an observer, which is then notified about transitions of the statemachine
+     * 
+     * @param observer observer that is not attached to any statemachine
+     * 
+     * 
+     * @details
+     * Optional features, like the transition journal or state timers, are observers. See StatemachineObserver.
+     * Can't be called from inside of a transition.
+     * 
+     * @see detachObserver(), StatemachineObserver
+     */
+    void attachObserver( StatemachineObserver& observer ) noexcept;
+
+    /**
+     * @brief Detach an observer attached with attachObserver(); does nothing if it's attached to another statemachine or to none
+     * 
+     * @details
+     * Can't be called from inside of a transition.
+     */
+    void detachObserver( StatemachineObserver& observer ) noexcept;
+
+
+    // Befriended so that transition tables can run actions of their rows from inside the transition
+    friend struct detail::TableTransitionAccess;
+    // Befriended so that StateBase::failTransition() can report the error code
+    friend StateBase;
+    // Befriended so that they can save and restore the state stack without making transitions
+    friend SnapshotWriter;
+    friend SnapshotReader;
+    friend TransitionJournalReader;
+
+
+protected:
+    /**
+     * @brief Check whether this statemachine's state class hierarchy includes given base state type
+     * 
+     * @param baseStateTypeId identifier of the BaseStateType of some statemachine class
+     * 
+     * @details
+     * Overriden by fsm::Statemachine for every BaseStateClass it declares. It lets transitions reject states
+     * of a foreign statemachine type without RTTI.
+     */
+    virtual bool hasBaseStateType( StateId baseStateTypeId ) const noexcept;
+
+    /**
+     * @brief Leave and delete all states on the state stack, like the destructor does
+     * 
+     * @details
+     * The destructor of StatemachineBase runs after those of its subclasses. A subclass that has to stay usable
+     * while states are left at destruction (e.g. because states call it from onLeaveState) calls this from its own destructor.
+     */
+    void destroyStates() noexcept;
+
+
+private:
+    template< class StateType, typename ...Args >
+    bool initStateImpl( Args&& ...args );
+
+    /**
+     * @param action function called once the transition is accepted, after the current state is left
+     */
+    template< class StateType, class Action, typename ...Args >
+    bool gotoStateImpl( Action&& action, Args&& ...args );
+
+    template< class Table, class EventType >
+    bool processEventImpl( const EventType& event );
+
+    template< class StateType, typename ...Args >
+    bool pushStateImpl( Args&& ...args );
+
+    bool popStateImpl();
+
+    /**
+     * @brief Allocate a state object, assign its type identifiers and bind it to this statemachine
+     * 
+     * @return created state or nullptr if it couldn't be bound to this statemachine
+     */
+    template< class StateType, typename ...Args >
+    BaseStateType *createState( Args&& ...args );
+
+    /**
+     * @brief Evaluate the static entry guard of a state type, if it has one
+     * 
+     * @see StateBase::canEnterState()
+     */
+    template< class StateType >
+    bool canEnterStateType( StateTransition transition ) const;
+
+    /**
+     * @brief Check whether a state type can belong to this statemachine, i.e. whether this is its StatemachineType
+     * 
+     * @details
+     * Base state type identifiers are compared (see hasBaseStateType()), so a state of a statemachine with another
+     * state class hierarchy is rejected without RTTI. Transition methods of fsm::Statemachine additionally check at compile time
+     * that the StatemachineType of the state is related to them.
+     * 
+     * User classes derived from the same fsm::Statemachine share their base state types, so neither check tells them apart.
+     * A state has to be entered only into a statemachine of its StatemachineType - its getParent() downcasts the statemachine 
+     * without a check, so anything else is undefined behaviour.
+     */
+    template< class StateType >
+    bool isStatemachineOfState() const noexcept;
+
+    /**
+     * @brief Get a state object for a transition - reuse the persistent one if it's available or create a new one
+     * 
+     * @return state object or nullptr if it couldn't be bound to this statemachine
+     */
+    template< class StateType, typename ...Args >
+    BaseStateType *acquireState( Args&& ...args );
+
+    /**
+     * @brief Dispose of a state object that is no longer on the state stack - keep it if persistent states are enabled or delete it
+     */
+    void releaseState( BaseStateType *state ) noexcept;
+
+    /**
+     * @brief Delete all idle persistent state objects
+     */
+    void clearPersistentStates() noexcept;
+
+    /**
+     * @brief Call onEnterState of a state and record its failure in the last transition result
+     * 
+     * @return whether the callback succeeded
+     */
+    bool enterState( BaseStateType *state, const StateTransition& transition );
+
+    /**
+     * @brief Call onLeaveState of a state and record its failure in the last transition result
+     * 
+     * @return whether the callback succeeded
+     */
+    bool leaveState( BaseStateType *state, const StateTransition& transition );
+
+    /**
+     * @brief Report the failure recorded by enterState() or leaveState() to the caller once the statemachine is cleaned up
+     * 
+     * @return false, unless the callback threw an exception - then OnEnterStateException or OnLeaveStateException is thrown
+     */
+    bool raiseTransitionFailure();
+
+    /**
+     * @brief Record whether the transition that has just been executed changed the state
+     * 
+     * @return isAccepted
+     */
+    bool recordTransitionResult( bool isAccepted ) noexcept;
+
+    /**
+     * @brief Call functions passed to callAfterTransition() from onEnterState, starting from the given index
+     */
+    void callEnteredStateCallbacks( std::size_t first );
+
+    /**
+     * @brief Execute a transition request or queue it if run-to-completion mode requires so
+     * 
+     * @param request function performing the transition
+     * @return transition result, or true if the transition was queued
+     */
+    template< typename F >
+    bool runToCompletion( F&& request );
+
+    /**
+     * @brief Get the data of the run-to-completion and persistent states modes, allocating it if needed
+     */
+    ModeData& modeData();
+
+    /**
+     * @brief Notify observers about a transition that got past the guards
+     */
+    void notifyTransition( const StateTransition& transition );
+
+    /**
+     * @brief Create a default constructed state of the type with given identifier
+     * 
+     * @return created state or nullptr if StateTypes has no such type or the state couldn't be bound to this statemachine
+     */
+    template< class ...StateTypes >
+    BaseStateType *createStateOfType( StateId id );
+
+    /**
+     * @brief Delete all states on the state stack without leaving them
+     */
+    void discardStateStack() noexcept;
 };
 
 } // namespace chestnut::fsm
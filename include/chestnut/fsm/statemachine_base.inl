@@ -1,15 +1,80 @@
 #include <type_traits>
+#include <cassert>
 #include <cstdio>
+#include <tuple>
+#include <utility>
 
 namespace chestnut::fsm
 {  
 
+namespace detail
+{
+    /**
+     * @brief Upcast a state to the base state type with given identifier, looking through all statemachine classes 
+     * from StatemachineType down to StatemachineBase
+     * 
+     * @see StateBase::castToBaseState
+     */
+    template< class StateType, class StatemachineType >
+    void *castToBaseState( void *statePtr, StateId baseStateTypeId ) noexcept
+    {
+        using LevelBaseStateType = typename StatemachineType::BaseStateType;
+
+        if constexpr( std::is_base_of<LevelBaseStateType, StateType>::value )
+        {
+            if( baseStateTypeId == stateIdOf<LevelBaseStateType>() )
+            {
+                return static_cast<LevelBaseStateType *>( static_cast<StateType *>( statePtr ) );
+            }
+        }
+
+        if constexpr( std::is_same<StatemachineType, StatemachineBase>::value )
+        {
+            return nullptr;
+        }
+        else
+        {
+            return castToBaseState< StateType, typename StatemachineType::BaseStatemachineType >( statePtr, baseStateTypeId );
+        }
+    }
+
+} // namespace detail
+
 inline StatemachineBase::StatemachineBase() 
 {
     m_isCurrentlyLeavingAState = false;
+    m_isRunToCompletion = false;
+    m_isProcessingTransition = false;
+    m_isEnteringState = false;
+    m_isCallingAfterTransition = false;
+    m_isPersistentStates = false;
+    m_transitionErrorCode = 0;
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    m_hasLastTransitionException = false;
+#endif
+    m_observers = nullptr;
+#if CHESTNUT_FSM_COLLECT_METRICS
+    m_currentStateEnteredAt = 0;
+#endif
 }
 
 inline StatemachineBase::~StatemachineBase() noexcept
+{
+    destroyStates();
+
+    // observers can outlive the statemachine
+    while( m_observers )
+    {
+        StatemachineObserver *observer = m_observers;
+        m_observers = observer->m_nextObserver;
+        observer->m_statemachine = nullptr;
+        observer->m_nextObserver = nullptr;
+    }
+
+    clearPersistentStates();
+}
+
+inline void StatemachineBase::destroyStates() noexcept
 {
     m_isCurrentlyLeavingAState = true;
 
@@ -17,24 +82,49 @@ inline StatemachineBase::~StatemachineBase() noexcept
     transition.type = STATE_TRANSITION_DESTROY;
     transition.nextState = NULL_STATE;
 
+#if CHESTNUT_FSM_COLLECT_METRICS
+    // only the state on top of the stack was the current one
+    if( !m_stackStates.empty() )
+    {
+        TransitionMetrics::recordDwellTime( m_stackStates.top()->stateId, readTraceTimestamp() - m_currentStateEnteredAt );
+    }
+#endif
+
     while( !m_stackStates.empty() )
     {
         BaseStateType *state = m_stackStates.top();
         m_stackStates.pop();
 
-        transition.prevState = typeid( *state );
+        transition.prevState = state->stateId;
+        CHESTNUT_FSM_TRACE_TRANSITION( this, transition );
+#if CHESTNUT_FSM_COLLECT_METRICS
+        TransitionMetrics::recordTransition( transition );
+#endif
 
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
         try
         {
+            notifyTransition( transition );
             state->onLeaveState( transition );
         }
         catch(const std::exception& e)
         {
             fprintf( stderr, "%s\n", e.what() );
         }
+#else
+        notifyTransition( transition );
+        state->onLeaveState( transition );
+#endif
+
+        for( StatemachineObserver *observer = m_observers; observer; observer = observer->m_nextObserver )
+        {
+            observer->onStateLeft( state );
+        }
         
         delete state;
     }
+
+    m_isCurrentlyLeavingAState = false;
 }
 
 inline StatemachineBase::BaseStateType* StatemachineBase::getCurrentState() const noexcept
@@ -47,11 +137,22 @@ inline StatemachineBase::BaseStateType* StatemachineBase::getCurrentState() cons
     return nullptr;
 }
 
-inline std::type_index StatemachineBase::getCurrentStateType() const noexcept
+template<class StateType>
+inline StateType* StatemachineBase::getCurrentState() const noexcept
+{
+    if( !m_stackStates.empty() && m_stackStates.top()->stateId == stateIdOf<StateType>() )
+    {
+        return static_cast< StateType* >( m_stackStates.top()->statePtr );
+    }
+
+    return nullptr;
+}
+
+inline StateId StatemachineBase::getCurrentStateType() const noexcept
 {
     if( !m_stackStates.empty() )
     {
-        return std::type_index( typeid( *m_stackStates.top() ) );
+        return m_stackStates.top()->stateId;
     }
 
     return NULL_STATE;
@@ -62,7 +163,7 @@ inline bool StatemachineBase::isCurrentlyInState() const
 {
     if( !m_stackStates.empty() )
     {
-        return std::type_index( typeid( *m_stackStates.top() ) ) == std::type_index( typeid( StateType ) );
+        return m_stackStates.top()->stateId == stateIdOf<StateType>();
     }
 
     return false;
@@ -73,12 +174,69 @@ inline int StatemachineBase::getStateStackSize() const noexcept
     return (int)m_stackStates.size();
 }
 
+inline void StatemachineBase::setRunToCompletion( bool enabled ) noexcept
+{
+    m_isRunToCompletion = enabled;
+}
+
+inline bool StatemachineBase::isRunToCompletion() const noexcept
+{
+    return m_isRunToCompletion;
+}
+
+inline int StatemachineBase::getPendingTransitionCount() const noexcept
+{
+    return m_modeData ? (int)m_modeData->deferredTransitions.size() : 0;
+}
+
+inline void StatemachineBase::setPersistentStates( bool enabled ) 
+{
+    m_isPersistentStates = enabled;
+
+    if( enabled )
+    {
+        // so that also states created before enabling the mode can be kept
+        modeData().persistentStates.resize( getStateIdCount(), nullptr );
+    }
+    else
+    {
+        clearPersistentStates();
+    }
+}
+
+inline bool StatemachineBase::isPersistentStates() const noexcept
+{
+    return m_isPersistentStates;
+}
+
+inline const TransitionResult& StatemachineBase::getLastTransitionResult() const noexcept
+{
+    return m_lastTransitionResult;
+}
+
 template<class StateType, typename ...Args>
 inline bool StatemachineBase::initState( Args&& ...args ) 
 {
     static_assert( std::is_base_of<StateBase, StateType>::value, "StateType is not a valid state class! It does not inherit from chestnut::fsm::StateBase!" );
 
+    m_lastTransitionResult = TransitionResult();
+
+
+    if( !m_isRunToCompletion )
+    {
+        return recordTransitionResult( initStateImpl<StateType>( std::forward<Args>(args)... ) );
+    }
+
+    return runToCompletion( [this, argsTuple = std::make_tuple( std::forward<Args>(args)... )]() mutable {
+        return std::apply( [this]( auto&& ...argsUnpacked ) { 
+            return initStateImpl<StateType>( std::forward<decltype(argsUnpacked)>(argsUnpacked)... ); 
+        }, std::move( argsTuple ) );
+    });
+}
 
+template<class StateType, typename ...Args>
+inline bool StatemachineBase::initStateImpl( Args&& ...args ) 
+{
     if( !m_stackStates.empty() )
     {
 		return false;
@@ -87,14 +245,17 @@ inline bool StatemachineBase::initState( Args&& ...args )
 	StateTransition transition;
 	transition.type = STATE_TRANSITION_INIT;
 	transition.prevState = NULL_STATE;
-	transition.nextState = typeid( StateType );
+	transition.nextState = stateIdOf<StateType>();
+
+    if( !canEnterStateType<StateType>( transition ) )
+    {
+        return false;
+    }
 
     // this can throw BadParentAccessException, but the memory for pointer won't leak
-	BaseStateType *initialState = new StateType( std::forward<Args>(args)... );
-    if( !initialState->setParent( this ) )
+	BaseStateType *initialState = acquireState<StateType>( std::forward<Args>(args)... );
+    if( !initialState )
     {
-        // polymorphism is needed to check the condition, so this akward immediate deletion after failure is necessary unfortunatelly
-        delete initialState;
         return false;
     }
 
@@ -102,21 +263,17 @@ inline bool StatemachineBase::initState( Args&& ...args )
 	{
 		m_stackStates.push( initialState );
 
-		try
-		{
-			initialState->onEnterState( transition );
-		}
-		catch(const std::exception& e)
+		if( !enterState( initialState, transition ) )
 		{
             // the init state stays on the stack, but its condition is undefined
-			throw OnEnterStateException( transition, e.what() );   
+			return raiseTransitionFailure();
 		}
 
 		return true;
 	}
 	else
 	{
-		delete initialState;
+		releaseState( initialState );
 		return false;
 	}
 }
@@ -126,63 +283,83 @@ inline bool StatemachineBase::gotoState( Args&& ...args )
 {
     static_assert( std::is_base_of<StateBase, StateType>::value, "StateType is not a valid state class! It does not inherit from chestnut::fsm::StateBase!" );
 
+    m_lastTransitionResult = TransitionResult();
+
 
     if( m_isCurrentlyLeavingAState )
     {
         return false;
     }
 
+    if( !m_isRunToCompletion )
+    {
+        return recordTransitionResult( gotoStateImpl<StateType>( detail::NoTransitionAction(), std::forward<Args>(args)... ) );
+    }
+
+    return runToCompletion( [this, argsTuple = std::make_tuple( std::forward<Args>(args)... )]() mutable {
+        return std::apply( [this]( auto&& ...argsUnpacked ) { 
+            return gotoStateImpl<StateType>( detail::NoTransitionAction(), std::forward<decltype(argsUnpacked)>(argsUnpacked)... ); 
+        }, std::move( argsTuple ) );
+    });
+}
+
+template<class StateType, class Action, typename ...Args>
+inline bool StatemachineBase::gotoStateImpl( Action&& action, Args&& ...args ) 
+{
 	StateTransition transition;
 	transition.prevState = getCurrentStateType();
-	transition.nextState = typeid( StateType );
+	transition.nextState = stateIdOf<StateType>();
 	
     if( transition.prevState != transition.nextState )
     {
-        // this can throw BadParentAccessException, but the memory for pointer won't leak
-        BaseStateType *nextState = new StateType( std::forward<Args>(args)... );
-        if( !nextState->setParent( this ) )
+		transition.type = ( !m_stackStates.empty() ) ? STATE_TRANSITION_GOTO : STATE_TRANSITION_INIT;
+
+        // guards that don't need the next state object go first, so a rejected transition doesn't construct anything
+        if( !canEnterStateType<StateType>( transition ) )
         {
-            delete nextState;
             return false;
         }
 
-		transition.type = ( !m_stackStates.empty() ) ? STATE_TRANSITION_GOTO : STATE_TRANSITION_INIT;
+        BaseStateType *currentState = ( transition.type == STATE_TRANSITION_GOTO ) ? m_stackStates.top() : nullptr;
+
+        if( currentState && !currentState->canLeaveState( transition ) )
+        {
+            return false;
+        }
+
+        // this can throw BadParentAccessException, but the memory for pointer won't leak
+        BaseStateType *nextState = acquireState<StateType>( std::forward<Args>(args)... );
+        if( !nextState )
+        {
+            return false;
+        }
 
 		if( !nextState->canEnterState( transition ) )
 		{
-			delete nextState;
+			releaseState( nextState );
 			return false;
 		}
 
-        if( transition.type == STATE_TRANSITION_GOTO )
+        if( currentState )
         {
-            BaseStateType *currentState = m_stackStates.top();
-
-			if( !currentState->canLeaveState( transition ) )
-			{
-				delete nextState;
-				return false;
-			}
-
 
             m_isCurrentlyLeavingAState = true;
 
-            try
-            {
-                currentState->onLeaveState( transition );
-            }
-            catch(const std::exception& e)
+            if( !leaveState( currentState, transition ) )
             {
                 m_isCurrentlyLeavingAState = false;
-                delete nextState;
-                throw OnLeaveStateException( transition, e.what() );    
+                releaseState( nextState );
+                return raiseTransitionFailure();
             }
 
+            // the current state still exists here, so the action can use it
+            action();
+
 			// if not only the init state is on the stack
             if( m_stackStates.size() > 1 ) 
             {
                 m_stackStates.pop();
-                delete currentState;
+                releaseState( currentState );
             }
 
             m_isCurrentlyLeavingAState = false;
@@ -190,13 +367,9 @@ inline bool StatemachineBase::gotoState( Args&& ...args )
 
 		m_stackStates.push( nextState );
 
-		try
-		{
-			nextState->onEnterState( transition );
-		}
-		catch(const std::exception& e)
+		if( !enterState( nextState, transition ) )
 		{
-			throw OnEnterStateException( transition, e.what() );
+			return raiseTransitionFailure();
 		}
 
 		return true;
@@ -210,56 +383,73 @@ inline bool StatemachineBase::pushState( Args&& ...args )
 {
     static_assert( std::is_base_of<StateBase, StateType>::value, "StateType is not a valid state class! It does not inherit from chestnut::fsm::StateBase!" );
 
+    m_lastTransitionResult = TransitionResult();
+
 
     if( m_isCurrentlyLeavingAState )
     {
         return false;
     }
 
+    if( !m_isRunToCompletion )
+    {
+        return recordTransitionResult( pushStateImpl<StateType>( std::forward<Args>(args)... ) );
+    }
+
+    return runToCompletion( [this, argsTuple = std::make_tuple( std::forward<Args>(args)... )]() mutable {
+        return std::apply( [this]( auto&& ...argsUnpacked ) { 
+            return pushStateImpl<StateType>( std::forward<decltype(argsUnpacked)>(argsUnpacked)... ); 
+        }, std::move( argsTuple ) );
+    });
+}
+
+template<class StateType, typename ...Args>
+inline bool StatemachineBase::pushStateImpl( Args&& ...args ) 
+{
     StateTransition transition;
 	transition.prevState = getCurrentStateType();
-	transition.nextState = typeid( StateType );
+	transition.nextState = stateIdOf<StateType>();
 	
     if( transition.prevState != transition.nextState )
     {
-        // this can throw BadParentAccessException, but the memory for pointer won't leak
-        BaseStateType *nextState = new StateType( std::forward<Args>(args)... );
-        if( !nextState->setParent( this ) )
+		transition.type = ( !m_stackStates.empty() ) ? STATE_TRANSITION_PUSH : STATE_TRANSITION_INIT;
+
+        // guards that don't need the next state object go first, so a rejected transition doesn't construct anything
+        if( !canEnterStateType<StateType>( transition ) )
         {
-            delete nextState;
             return false;
         }
 
-		transition.type = ( !m_stackStates.empty() ) ? STATE_TRANSITION_PUSH : STATE_TRANSITION_INIT;
+        BaseStateType *currentState = ( transition.type == STATE_TRANSITION_PUSH ) ? m_stackStates.top() : nullptr;
+
+        if( currentState && !currentState->canLeaveState( transition ) )
+        {
+            return false;
+        }
+
+        // this can throw BadParentAccessException, but the memory for pointer won't leak
+        BaseStateType *nextState = acquireState<StateType>( std::forward<Args>(args)... );
+        if( !nextState )
+        {
+            return false;
+        }
 
 		if( !nextState->canEnterState( transition ) )
 		{
-			delete nextState;
+			releaseState( nextState );
 			return false;
 		}
 
-        if( transition.type == STATE_TRANSITION_PUSH )
+        if( currentState )
         {
-            BaseStateType *currentState = m_stackStates.top();
-
-			if( !currentState->canLeaveState( transition ) )
-			{
-				delete nextState;
-				return false;
-			}
-
 
             m_isCurrentlyLeavingAState = true;
 
-            try
-            {
-                currentState->onLeaveState( transition );
-            }
-            catch(const std::exception& e)
+            if( !leaveState( currentState, transition ) )
             {
                 m_isCurrentlyLeavingAState = false;
-                delete nextState;
-                throw OnLeaveStateException( transition, e.what() );    
+                releaseState( nextState );
+                return raiseTransitionFailure();
             }
 
             m_isCurrentlyLeavingAState = false;
@@ -267,13 +457,9 @@ inline bool StatemachineBase::pushState( Args&& ...args )
 
 		m_stackStates.push( nextState );
 
-		try
-		{
-			nextState->onEnterState( transition );
-		}
-		catch(const std::exception& e)
+		if( !enterState( nextState, transition ) )
 		{
-			throw OnEnterStateException( transition, e.what() );
+			return raiseTransitionFailure();
 		}
 
 		return true;
@@ -284,21 +470,35 @@ inline bool StatemachineBase::pushState( Args&& ...args )
 
 inline bool StatemachineBase::popState() 
 {
+    m_lastTransitionResult = TransitionResult();
+
     if( m_isCurrentlyLeavingAState )
     {
         return false;
     }
 
+    if( !m_isRunToCompletion )
+    {
+        return recordTransitionResult( popStateImpl() );
+    }
+
+    return runToCompletion( [this]() {
+        return popStateImpl();
+    });
+}
+
+inline bool StatemachineBase::popStateImpl() 
+{
     // we want to always retain the init state on the stack
     if( m_stackStates.size() > 1 )
     {
         BaseStateType *currentState = m_stackStates.top();
-        std::type_index currentStateType = typeid( *currentState );
+        StateId currentStateType = currentState->stateId;
 
         m_stackStates.pop();
 
         BaseStateType *nextState = m_stackStates.top();
-        std::type_index nextStateType = typeid( *nextState );
+        StateId nextStateType = nextState->stateId;
 
         StateTransition transition;
         transition.type = STATE_TRANSITION_POP;
@@ -315,36 +515,530 @@ inline bool StatemachineBase::popState()
 		
         m_isCurrentlyLeavingAState = true;
 
-        try
-        {
-            currentState->onLeaveState( transition );
-        }
-        catch(const std::exception& e)
+        if( !leaveState( currentState, transition ) )
         {
             m_isCurrentlyLeavingAState = false;
             // push this state back so that SM goes back to as it was before except now its condition is undefined
             m_stackStates.push( currentState );
-            throw OnLeaveStateException( transition, e.what() );
+            return raiseTransitionFailure();
         }
         
-        delete currentState;
+        releaseState( currentState );
 
         m_isCurrentlyLeavingAState = false;
 
 
-        try
+        if( !enterState( nextState, transition ) )
         {
-            nextState->onEnterState( transition );
+            return raiseTransitionFailure();
         }
-        catch(const std::exception& e)
+
+        return true;
+    }
+
+	return false;
+}
+
+template<class Table, class EventType>
+inline bool StatemachineBase::processEvent( const EventType& event ) 
+{
+    static_assert( Table::template handlesEvent<EventType>, "EventType is not handled by any transition in the table!" );
+    static_assert( detail::TableStatesDeriveFrom<Table, BaseStateType>::value, 
+        "All states in the transition table have to inherit from chestnut::fsm::StateBase!" );
+
+    m_lastTransitionResult = TransitionResult();
+
+
+    if( m_isCurrentlyLeavingAState )
+    {
+        return false;
+    }
+
+    if( !m_isRunToCompletion )
+    {
+        return recordTransitionResult( processEventImpl<Table>( event ) );
+    }
+
+    return runToCompletion( [this, eventCopy = event]() {
+        return processEventImpl<Table>( eventCopy );
+    });
+}
+
+template<class Table, class EventType>
+inline bool StatemachineBase::processEventImpl( const EventType& event ) 
+{
+    typedef typename detail::TableDispatcherOf<StatemachineBase, EventType, Table>::Type Dispatcher;
+
+    if( m_stackStates.empty() )
+    {
+        return false;
+    }
+
+    BaseStateType *state = m_stackStates.top();
+
+    assert( ( !Table::isStrict || Dispatcher::hasHandler( state->stateId ) ) && "Current state doesn't handle the event in a strict transition table!" );
+
+    return Dispatcher::dispatch( *this, state->stateId, state->statePtr, event );
+}
+
+inline void StatemachineBase::attachObserver( StatemachineObserver& observer ) noexcept
+{
+    assert( !observer.m_statemachine && "Observer is already attached to a statemachine!" );
+    assert( !m_isProcessingTransition && !m_isCurrentlyLeavingAState && "Observers can't be attached during a transition!" );
+
+    // appended, so that observers are called in the order they were attached
+    StatemachineObserver **last = &m_observers;
+    while( *last )
+    {
+        last = &( *last )->m_nextObserver;
+    }
+
+    *last = &observer;
+    observer.m_statemachine = this;
+    observer.m_nextObserver = nullptr;
+}
+
+inline void StatemachineBase::detachObserver( StatemachineObserver& observer ) noexcept
+{
+    if( observer.m_statemachine != this )
+    {
+        return;
+    }
+
+    StatemachineObserver **link = &m_observers;
+    while( *link != &observer )
+    {
+        link = &( *link )->m_nextObserver;
+    }
+
+    *link = observer.m_nextObserver;
+    observer.m_statemachine = nullptr;
+    observer.m_nextObserver = nullptr;
+}
+
+template<class StateType, typename ...Args>
+inline StatemachineBase::BaseStateType* StatemachineBase::createState( Args&& ...args ) 
+{
+    using StateBaseType = typename StateType::BaseStateType;
+
+    StateType *state = new StateType( std::forward<Args>(args)... );
+    state->stateId = stateIdOf<StateType>();
+    // the only point where the full state type is known, so upcasting to the statemachine's base state type is done here
+    state->baseStateTypeId = stateIdOf<StateBaseType>();
+    state->baseStatePtr = static_cast<StateBaseType *>( state );
+    state->statePtr = state;
+    state->castToBaseState = &detail::castToBaseState< StateType, typename StateType::StatemachineType >;
+
+    BaseStateType *baseState = state;
+    if( !baseState->setParent( this ) )
+    {
+        // polymorphism is needed to check the condition, so this akward immediate deletion after failure is necessary unfortunatelly
+        delete baseState;
+        return nullptr;
+    }
+
+    return baseState;
+}
+
+template<class StateType>
+inline bool StatemachineBase::canEnterStateType( StateTransition transition ) const
+{
+    if( !isStatemachineOfState<StateType>() )
+    {
+        return false;
+    }
+
+    using StatemachineType = typename StateType::StatemachineType;
+
+    return detail::callCanEnterStateType<StateType>( static_cast<const StatemachineType&>( *this ), transition );
+}
+
+template<class StateType>
+inline bool StatemachineBase::isStatemachineOfState() const noexcept
+{
+    using StatemachineType = typename StateType::StatemachineType;
+
+    return hasBaseStateType( stateIdOf<typename StatemachineType::BaseStateType>() );
+}
+
+inline bool StatemachineBase::hasBaseStateType( StateId baseStateTypeId ) const noexcept
+{
+    return baseStateTypeId == stateIdOf<BaseStateType>();
+}
+
+template<class StateType, typename ...Args>
+inline StatemachineBase::BaseStateType* StatemachineBase::acquireState( Args&& ...args ) 
+{
+    if( m_isPersistentStates )
+    {
+        const StateId id = stateIdOf<StateType>();
+        std::vector< BaseStateType* >& persistentStates = modeData().persistentStates;
+
+        // make room up front, so that releasing the state later doesn't need to allocate
+        if( id >= persistentStates.size() )
+        {
+            persistentStates.resize( id + 1, nullptr );
+        }
+
+        // arguments are meant for the constructor, so a new object is needed anyway
+        if( sizeof...(Args) == 0 && persistentStates[id] )
+        {
+            BaseStateType *state = persistentStates[id];
+            persistentStates[id] = nullptr;
+
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+            try
+            {
+                state->onRearmState();
+            }
+            catch(...)
+            {
+                delete state;
+                throw;
+            }
+#else
+            state->onRearmState();
+#endif
+
+            return state;
+        }
+    }
+
+    return createState<StateType>( std::forward<Args>(args)... );
+}
+
+inline void StatemachineBase::releaseState( BaseStateType *state ) noexcept
+{
+    // acquireState() has allocated the mode data
+    if( m_isPersistentStates && m_modeData )
+    {
+        const StateId id = state->stateId;
+        std::vector< BaseStateType* >& persistentStates = m_modeData->persistentStates;
+
+        if( id < persistentStates.size() && !persistentStates[id] )
+        {
+            persistentStates[id] = state;
+            return;
+        }
+    }
+
+    delete state;
+}
+
+inline void StatemachineBase::clearPersistentStates() noexcept
+{
+    if( !m_modeData )
+    {
+        return;
+    }
+
+    for( BaseStateType *state : m_modeData->persistentStates )
+    {
+        delete state;
+    }
+
+    m_modeData->persistentStates.clear();
+}
+
+inline StatemachineBase::ModeData& StatemachineBase::modeData() 
+{
+    if( !m_modeData )
+    {
+        m_modeData.reset( new ModeData() );
+    }
+
+    return *m_modeData;
+}
+
+inline void StatemachineBase::notifyTransition( const StateTransition& transition ) 
+{
+    for( StatemachineObserver *observer = m_observers; observer; observer = observer->m_nextObserver )
+    {
+        observer->onTransition( transition );
+    }
+}
+
+inline bool StatemachineBase::enterState( BaseStateType *state, const StateTransition& transition ) 
+{
+    // every transition that got past the guards ends up here
+    CHESTNUT_FSM_TRACE_TRANSITION( this, transition );
+#if CHESTNUT_FSM_COLLECT_METRICS
+    const std::uint64_t now = readTraceTimestamp();
+    TransitionMetrics::recordTransition( transition, now - m_currentStateEnteredAt );
+    m_currentStateEnteredAt = now;
+#endif
+
+    if( m_observers )
+    {
+        notifyTransition( transition );
+    }
+
+    // the callback can make a transition of its own, which has its own error code and may even delete the state,
+    // so the state isn't touched after the callback and the code of the outer callback is put back afterwards
+    const int outerErrorCode = m_transitionErrorCode;
+    m_transitionErrorCode = 0;
+    // the same goes for functions the callback passes to callAfterTransition(), which are called once it returns
+    const bool isOuterEnteringState = m_isEnteringState;
+    const std::size_t outerCallbackCount = m_modeData ? m_modeData->enteredStateCallbacks.size() : 0;
+    m_isEnteringState = true;
+
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    try
+    {
+        state->onEnterState( transition );
+    }
+    catch(const std::exception& e)
+    {
+        m_transitionErrorCode = outerErrorCode;
+        m_isEnteringState = isOuterEnteringState;
+        if( m_modeData )
+        {
+            m_modeData->enteredStateCallbacks.resize( outerCallbackCount );
+        }
+        m_lastTransitionResult.error = TRANSITION_ERROR_ON_ENTER_STATE;
+        m_lastTransitionResult.errorCode = 0;
+        m_lastTransitionResult.transition = transition;
+        m_lastTransitionExceptionMessage = e.what();
+        m_hasLastTransitionException = true;
+        return false;
+    }
+#else
+    state->onEnterState( transition );
+#endif
+
+    const int errorCode = m_transitionErrorCode;
+    m_transitionErrorCode = outerErrorCode;
+    m_isEnteringState = isOuterEnteringState;
+
+    if( m_modeData && m_modeData->enteredStateCallbacks.size() > outerCallbackCount )
+    {
+        callEnteredStateCallbacks( outerCallbackCount );
+    }
+
+    if( errorCode != 0 )
+    {
+        m_lastTransitionResult.error = TRANSITION_ERROR_ON_ENTER_STATE;
+        m_lastTransitionResult.errorCode = errorCode;
+        m_lastTransitionResult.transition = transition;
+        return false;
+    }
+
+    return true;
+}
+
+inline bool StatemachineBase::leaveState( BaseStateType *state, const StateTransition& transition ) 
+{
+    const int outerErrorCode = m_transitionErrorCode;
+    m_transitionErrorCode = 0;
+
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    try
+    {
+        state->onLeaveState( transition );
+    }
+    catch(const std::exception& e)
+    {
+        m_transitionErrorCode = outerErrorCode;
+        m_lastTransitionResult.error = TRANSITION_ERROR_ON_LEAVE_STATE;
+        m_lastTransitionResult.errorCode = 0;
+        m_lastTransitionResult.transition = transition;
+        m_lastTransitionExceptionMessage = e.what();
+        m_hasLastTransitionException = true;
+        return false;
+    }
+#else
+    state->onLeaveState( transition );
+#endif
+
+    const int errorCode = m_transitionErrorCode;
+    m_transitionErrorCode = outerErrorCode;
+
+    if( errorCode != 0 )
+    {
+        m_lastTransitionResult.error = TRANSITION_ERROR_ON_LEAVE_STATE;
+        m_lastTransitionResult.errorCode = errorCode;
+        m_lastTransitionResult.transition = transition;
+        return false;
+    }
+
+    for( StatemachineObserver *observer = m_observers; observer; observer = observer->m_nextObserver )
+    {
+        observer->onStateLeft( state );
+    }
+
+    return true;
+}
+
+inline bool StatemachineBase::raiseTransitionFailure() 
+{
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    if( m_hasLastTransitionException )
+    {
+        m_hasLastTransitionException = false;
+
+        if( m_lastTransitionResult.error == TRANSITION_ERROR_ON_ENTER_STATE )
+        {
+            throw OnEnterStateException( m_lastTransitionResult.transition, m_lastTransitionExceptionMessage.c_str() );
+        }
+        else
         {
-            throw OnEnterStateException( transition, e.what() );
+            throw OnLeaveStateException( m_lastTransitionResult.transition, m_lastTransitionExceptionMessage.c_str() );
         }
+    }
+#endif
+
+    return false;
+}
+
+inline bool StatemachineBase::recordTransitionResult( bool isAccepted ) noexcept
+{
+    m_lastTransitionResult.isAccepted = isAccepted;
+    return isAccepted;
+}
+
+inline void StatemachineBase::callEnteredStateCallbacks( std::size_t first ) 
+{
+    // taken out first, as the callbacks can enter states that queue callbacks of their own
+    std::vector< std::function<void()> >& enteredStateCallbacks = m_modeData->enteredStateCallbacks;
+    std::vector< std::function<void()> > callbacks( std::make_move_iterator( enteredStateCallbacks.begin() + first ), 
+                                                    std::make_move_iterator( enteredStateCallbacks.end() ) );
+    enteredStateCallbacks.resize( first );
 
+    for( std::function<void()>& callback : callbacks )
+    {
+        callback();
+    }
+}
+
+template<typename F>
+inline void StatemachineBase::callAfterTransition( F&& callback ) 
+{
+    if( m_isProcessingTransition )
+    {
+        modeData().deferredTransitions.emplace_back( [this, callback = std::forward<F>( callback )]() mutable {
+            // resets the flag even if the callback throws
+            struct CallingGuard
+            {
+                bool& isCallingAfterTransition;
+
+                ~CallingGuard()
+                {
+                    isCallingAfterTransition = false;
+                }
+            } guard { m_isCallingAfterTransition };
+
+            m_isCallingAfterTransition = true;
+            callback();
+        });
+    }
+    else if( m_isEnteringState )
+    {
+        modeData().enteredStateCallbacks.emplace_back( std::forward<F>( callback ) );
+    }
+    else
+    {
+        callback();
+    }
+}
+
+template<typename F>
+inline bool StatemachineBase::runToCompletion( F&& request ) 
+{
+    if( m_isProcessingTransition )
+    {
+        if( m_isCallingAfterTransition )
+        {
+            // requested by a function passed to callAfterTransition(), which gets the actual result;
+            // transitions requested from inside of this one are queued as usual
+            m_isCallingAfterTransition = false;
+            const bool result = recordTransitionResult( request() );
+            m_isCallingAfterTransition = true;
+            return result;
+        }
+
+        modeData().deferredTransitions.emplace_back( [this, request = std::forward<F>( request )]() mutable {
+            m_lastTransitionResult = TransitionResult();
+            recordTransitionResult( request() );
+        });
         return true;
     }
 
-	return false;
+    // leaves the statemachine ready for next transitions even if one of them throws
+    struct ProcessingGuard
+    {
+        StatemachineBase& statemachine;
+
+        ~ProcessingGuard()
+        {
+            if( statemachine.m_modeData )
+            {
+                statemachine.m_modeData->deferredTransitions.clear();
+            }
+            statemachine.m_isProcessingTransition = false;
+        }
+    } guard { *this };
+
+    m_isProcessingTransition = true;
+
+    bool result = recordTransitionResult( request() );
+
+    // new transitions can be queued while draining, so the size has to be checked on every iteration
+    std::size_t next = 0;
+    while( m_modeData && next < m_modeData->deferredTransitions.size() )
+    {
+        std::vector< std::function<void()> >& deferredTransitions = m_modeData->deferredTransitions;
+        std::function<void()> deferred = std::move( deferredTransitions[next++] );
+
+        // once everything queued so far has been taken, the queue starts over from the beginning
+        // capacity is retained, so a machine transitioning endlessly keeps a constant memory footprint
+        if( next == deferredTransitions.size() )
+        {
+            deferredTransitions.clear();
+            next = 0;
+        }
+
+        deferred();
+    }
+
+    return result;
+}
+
+template<class ...StateTypes>
+inline StatemachineBase::BaseStateType* StatemachineBase::createStateOfType( StateId id ) 
+{
+    // states restored this way don't go through canEnterStateType(), so the statemachine type is checked here
+    BaseStateType *state = nullptr;
+    ( void )( ( id == stateIdOf<StateTypes>() && isStatemachineOfState<StateTypes>() && ( state = createState<StateTypes>(), true ) ) || ... );
+
+    return state;
+}
+
+inline void StatemachineBase::discardStateStack() noexcept
+{
+    while( !m_stackStates.empty() )
+    {
+        delete m_stackStates.top();
+        m_stackStates.pop();
+    }
+}
+
+
+// defined here, because it needs the complete StatemachineBase
+inline void StateBase::failTransition( int errorCode ) noexcept
+{
+    assert( errorCode != 0 && "Transition error code can't be 0!" );
+    assert( parent && "Transition can only be failed from inside of onEnterState or onLeaveState!" );
+
+    // kept in the statemachine, as the state can be gone by the time the callback returns
+    parent->m_transitionErrorCode = errorCode;
+}
+
+inline StatemachineObserver::~StatemachineObserver() 
+{
+    if( m_statemachine )
+    {
+        m_statemachine->detachObserver( *this );
+    }
 }
 
 } // namespace chestnut::fsm
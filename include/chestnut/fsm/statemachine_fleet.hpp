@@ -0,0 +1,432 @@
+/**
+ * @file statemachine_fleet.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with StatemachineFleet, a container of many statemachines of the same type stored as structure of arrays
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_STATEMACHINE_FLEET_H__
+#define __CHESTNUT_STATEMACHINE_STATEMACHINE_FLEET_H__
+
+#include "state_transition.hpp"
+#include "state_traits.hpp"
+#include "fleet_snapshot.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Identifier of a statemachine in a StatemachineFleet
+ *
+ * @details
+ * Handles of destroyed statemachines stop being valid, even if their slot is reused by another statemachine.
+ */
+struct FleetHandle
+{
+    /** Position of the statemachine in the fleet's arrays */
+    std::uint32_t index = UINT32_MAX;
+    /** Incremented every time the slot is freed, so that stale handles can be told apart */
+    std::uint32_t generation = 0;
+
+    bool operator==( const FleetHandle& other ) const noexcept { return index == other.index && generation == other.generation; }
+    bool operator!=( const FleetHandle& other ) const noexcept { return !( *this == other ); }
+};
+
+
+/**
+ * @brief Container of many statemachines with the same set of states, stored as a structure of arrays
+ *
+ * @details
+ * Instead of every statemachine being a separate object with its own state stack and heap-allocated states,
+ * the fleet keeps each property of all its statemachines in one contiguous array: current state indices, stack depths,
+ * state stacks, and for every state type an array of its objects, one slot per statemachine.
+ * Statemachines are addressed by FleetHandle. Creating them doesn't allocate once the arrays have grown enough.
+ *
+ * Current states are kept in an array of bytes, so bulk queries like countInState() or countPerState()
+ * are linear scans over it, which compilers vectorize. Per-state data of machines in a given state
+ * can be visited with forEachInState() without touching any other memory.
+ *
+ * States are plain classes, the same as in StaticStatemachine - they can define canEnterState, canLeaveState,
+ * onEnterState, onLeaveState, onEvent and the static canEnterStateType guard (see state_traits.hpp). If callbacks take the statemachine
+ * as the first parameter, they get StatemachineFleet::Machine - a lightweight reference to the statemachine they belong to,
+ * which also offers state change methods. States have to be move constructible.
+ *
+ * Every statemachine has a state stack like StatemachineBase, but a state type can be on a statemachine's stack only once,
+ * so pushState() and gotoState() to a type that's already lower on the stack are refused.
+ *
+ * All state types must be complete before the fleet type is used, so callbacks that call the fleet
+ * should be defined after all of the state classes.
+ *
+ * Transitions and destruction requested from state callbacks are queued and executed in order once the current transition ends,
+ * so states are never destroyed while their own method runs. Transition requests from inside of onLeaveState are ignored.
+ *
+ * Creating statemachines can move state objects to larger arrays, so pointers to states are valid only until the next create().
+ * For the same reason state callbacks can create statemachines only if enough capacity has been reserved beforehand.
+ * Exceptions thrown by state callbacks are not wrapped and propagate to the caller unchanged.
+ *
+ * If all state types are trivially copyable, the whole fleet can be saved with writeSnapshotFile() and loaded back with bulkLoadSnapshotFile().
+ * Loading skips initialization and warm-up transitions, but still copies every statemachine into the fleet.
+ *
+ * @tparam States state types of the statemachines
+ */
+template< class ...States >
+class StatemachineFleet
+{
+    static_assert( sizeof...(States) > 0, "StatemachineFleet needs at least one state type!" );
+    static_assert( sizeof...(States) < 255, "StatemachineFleet supports at most 254 state types!" );
+
+public:
+    /**
+     * @brief Maximal depth of a state stack; every state type can be on it at most once
+     */
+    static constexpr std::size_t STACK_CAPACITY = sizeof...(States);
+
+    /**
+     * @brief Reference to one statemachine of the fleet, passed to state callbacks that take the statemachine
+     */
+    class Machine
+    {
+    public:
+        Machine( StatemachineFleet& fleet, FleetHandle handle ) noexcept;
+
+        StatemachineFleet& getFleet() const noexcept;
+        FleetHandle getHandle() const noexcept;
+
+        std::size_t getCurrentStateIndex() const noexcept;
+        template< class StateType >
+        bool isCurrentlyInState() const noexcept;
+
+        /** @see StatemachineFleet::gotoState() */
+        template< class StateType, typename ...Args >
+        bool gotoState( Args&& ...args ) const;
+        /** @see StatemachineFleet::pushState() */
+        template< class StateType, typename ...Args >
+        bool pushState( Args&& ...args ) const;
+        /** @see StatemachineFleet::popState() */
+        bool popState() const;
+
+    private:
+        StatemachineFleet *m_fleet;
+        FleetHandle m_handle;
+    };
+
+
+public:
+    StatemachineFleet() noexcept;
+
+    /**
+     * @brief Destructor; destroys all statemachines
+     */
+    ~StatemachineFleet();
+
+    StatemachineFleet( const StatemachineFleet& ) = delete;
+    StatemachineFleet& operator=( const StatemachineFleet& ) = delete;
+
+
+    /**
+     * @brief Create a new statemachine without any state
+     *
+     * @return handle of the statemachine
+     */
+    FleetHandle create();
+
+    /**
+     * @brief Destroy a statemachine; its states are left with STATE_TRANSITION_DESTROY from the top of the stack
+     *
+     * @param handle handle of the statemachine
+     * @return whether the handle was valid
+     *
+     * @details
+     * If called from a state callback, the statemachine is destroyed once the current transition ends.
+     */
+    bool destroy( FleetHandle handle );
+
+    /**
+     * @brief Return whether the handle refers to an existing statemachine
+     */
+    bool isValid( FleetHandle handle ) const noexcept;
+
+    /**
+     * @brief Get the number of existing statemachines
+     */
+    std::size_t getSize() const noexcept;
+
+    /**
+     * @brief Make room for a number of statemachines, so that creating them doesn't allocate
+     */
+    void reserve( std::size_t capacity );
+
+
+    /**
+     * @brief Get the position of the state type on the States list plus one; 0 means no state
+     */
+    template< class StateType >
+    static constexpr std::size_t stateIndexOf() noexcept;
+
+    /**
+     * @brief Get the index of the current state of a statemachine or 0 if it has no state
+     *
+     * @see stateIndexOf()
+     */
+    std::size_t getCurrentStateIndex( FleetHandle handle ) const noexcept;
+
+    /**
+     * @brief Get the type identifier of the current state of a statemachine or NULL_STATE if it has no state
+     */
+    StateId getCurrentStateType( FleetHandle handle ) const noexcept;
+
+    /**
+     * @brief Return whether the statemachine is currently in the given state
+     */
+    template< class StateType >
+    bool isCurrentlyInState( FleetHandle handle ) const noexcept;
+
+    /**
+     * @brief Get the pointer to the current state object of a statemachine if it's of given type
+     *
+     * @return pointer to the state or nullptr if statemachine isn't in this state
+     */
+    template< class StateType >
+    StateType *getCurrentState( FleetHandle handle ) noexcept;
+
+    /**
+     * @brief Get the size of the state stack of a statemachine
+     */
+    std::size_t getStateStackSize( FleetHandle handle ) const noexcept;
+
+
+    /**
+     * @brief Initialize a statemachine that has no state yet
+     *
+     * @return whether the statemachine was able to change the state
+     *
+     * @see StatemachineBase::initState()
+     */
+    template< class StateType, typename ...Args >
+    bool initState( FleetHandle handle, Args&& ...args );
+
+    /**
+     * @brief Replace the state on top of the stack of a statemachine
+     *
+     * @return whether the statemachine was able to change the state or, if called from a state callback, whether the transition was queued
+     *
+     * @details
+     * The init state at the bottom of the stack is never replaced - if it's the only state, the new one is put on top of it.
+     *
+     * @see StatemachineBase::gotoState()
+     */
+    template< class StateType, typename ...Args >
+    bool gotoState( FleetHandle handle, Args&& ...args );
+
+    /**
+     * @brief Push a state onto the stack of a statemachine
+     *
+     * @return whether the statemachine was able to change the state or, if called from a state callback, whether the transition was queued
+     *
+     * @see StatemachineBase::pushState()
+     */
+    template< class StateType, typename ...Args >
+    bool pushState( FleetHandle handle, Args&& ...args );
+
+    /**
+     * @brief Pop the state on top of the stack of a statemachine, unless it's the last one
+     *
+     * @return whether the statemachine was able to change the state or, if called from a state callback, whether the transition was queued
+     *
+     * @see StatemachineBase::popState()
+     */
+    bool popState( FleetHandle handle );
+
+    /**
+     * @brief Pass an event to the current state of a statemachine
+     *
+     * @return whether the current state has an onEvent method for this event type
+     */
+    template< class EventType >
+    bool dispatchEvent( FleetHandle handle, const EventType& event );
+
+
+    /**
+     * @brief Count statemachines currently in the given state
+     */
+    template< class StateType >
+    std::size_t countInState() const noexcept;
+
+    /**
+     * @brief Count statemachines in every state
+     *
+     * @return counts indexed by state index; the first element counts statemachines without any state
+     */
+    std::array< std::size_t, sizeof...(States) + 1 > countPerState() const noexcept;
+
+    /**
+     * @brief Append handles of all statemachines currently in the given state
+     *
+     * @param out vector to append to
+     * @return number of appended handles
+     */
+    template< class StateType >
+    std::size_t findInState( std::vector<FleetHandle>& out ) const;
+
+    /**
+     * @brief Call a function for every statemachine currently in the given state
+     *
+     * @param f function taking FleetHandle and StateType&
+     *
+     * @details
+     * The function shouldn't create or destroy statemachines. Transitions it requests are executed after the whole iteration.
+     */
+    template< class StateType, typename F >
+    void forEachInState( F&& f );
+
+
+    /**
+     * @brief Write all statemachines of the fleet into a snapshot file
+     *
+     * @param path path of the file, which is overwritten
+     * @return whether the file was written; it isn't while a transition is in progress
+     *
+     * @details
+     * The file holds the arrays of the fleet as they are in memory, see FleetSnapshotHeader.
+     * Only available if all state types are trivially copyable.
+     *
+     * @see bulkLoadSnapshotFile()
+     */
+    bool writeSnapshotFile( const char *path ) const;
+
+    /**
+     * @brief Load statemachines from a snapshot file written with writeSnapshotFile() with a bulk binary copy
+     *
+     * @param path path of the file
+     * @return whether the statemachines were loaded
+     *
+     * @throws std::bad_alloc if the arrays of the fleet couldn't be allocated
+     *
+     *
+     * @details
+     * The fleet must not have any statemachines. State callbacks are not called and no transitions take place.
+     * Handles of the saved statemachines are valid in the loaded fleet.
+     *
+     * The fleet doesn't use the file in place: the stack of every slot is validated, the arrays are copied 
+     * and every state on a stack is copied into its column. So loading takes time linear in the number of statemachines
+     * and reads the whole file - it replaces running initState() and warm-up transitions, at roughly the cost of a memcpy of the file.
+     * The fleet can't be backed by the file itself, because it grows its arrays in create() 
+     * and keeps states in std::optional columns, which are laid out differently than in the file.
+     *
+     * The file is rejected if its format version or byte order differ, or if its state table doesn't match the state types
+     * of this fleet by name, size and alignment - e.g. when it was written by a build with different states.
+     * Stacks of all statemachines are checked too, so a damaged file can't put the fleet in an invalid condition.
+     * The fleet stays empty if the file is rejected.
+     *
+     * @see writeSnapshotFile()
+     */
+    bool bulkLoadSnapshotFile( const char *path );
+
+
+private:
+    template< class StateType >
+    using ColumnType = std::vector< std::optional<StateType> >;
+
+    /**
+     * @brief Leaves the fleet ready for next transitions once processing ends, even if a callback throws
+     */
+    struct ProcessingGuard
+    {
+        StatemachineFleet& fleet;
+
+        ~ProcessingGuard();
+    };
+
+    template< class StateType >
+    ColumnType<StateType>& column() noexcept;
+    template< class StateType >
+    const ColumnType<StateType>& column() const noexcept;
+
+    static StateId stateIdOfIndex( std::size_t index ) noexcept;
+
+    std::uint8_t *stackOf( std::uint32_t index ) noexcept;
+
+    /**
+     * @brief Call a function with the state object of a statemachine given by the state index
+     */
+    template< typename F >
+    void visitState( std::size_t stateIndex, std::uint32_t index, F&& f );
+
+    /**
+     * @brief Destroy the state object of a statemachine given by the state index
+     */
+    void resetState( std::size_t stateIndex, std::uint32_t index ) noexcept;
+
+    bool isOnStack( std::uint32_t index, std::size_t stateIndex ) const noexcept;
+
+    /**
+     * @brief Execute a transition and then all transitions it queued
+     */
+    template< typename F >
+    bool runTransition( F&& transition );
+
+    void runPendingTransitions();
+
+    template< class StateType, typename ...Args >
+    bool enterNewState( FleetHandle handle, bool replaceTop, Args&& ...args );
+
+    bool leaveTopState( FleetHandle handle );
+
+    void leaveAllStates( std::uint32_t index );
+
+    void destroyNow( FleetHandle handle );
+
+    /**
+     * @brief Build the state table of snapshot files of this fleet type
+     */
+    static std::vector< unsigned char > makeSnapshotStateTable();
+
+    /**
+     * @brief Check whether state stacks and free slots of a snapshot describe valid statemachines
+     */
+    static bool isValidSnapshotData( const std::uint8_t *currentStates, const std::uint8_t *stackDepths, const std::uint8_t *stacks, 
+                                     const unsigned char *freeIndices, std::size_t slotCount, std::size_t freeCount );
+
+    /**
+     * @brief Construct a state from its bytes in a snapshot
+     */
+    template< class StateType >
+    static void loadSnapshotState( std::optional<StateType>& state, const unsigned char *bytes );
+
+
+private:
+    std::vector< std::uint8_t > m_currentStates;
+    std::vector< std::uint8_t > m_stackDepths;
+    /**
+     * @brief State stacks, STACK_CAPACITY state indices per statemachine
+     */
+    std::vector< std::uint8_t > m_stacks;
+    std::vector< std::uint32_t > m_generations;
+    std::vector< std::uint32_t > m_freeIndices;
+    std::tuple< ColumnType<States>... > m_columns;
+
+    std::size_t m_size;
+    bool m_isProcessingTransition;
+    bool m_isCurrentlyLeavingAState;
+    std::vector< std::function<void()> > m_pendingTransitions;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "statemachine_fleet.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_STATEMACHINE_FLEET_H__
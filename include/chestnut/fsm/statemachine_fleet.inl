@@ -0,0 +1,951 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace chestnut::fsm
+{
+
+template<class ...States>
+inline StatemachineFleet<States...>::Machine::Machine( StatemachineFleet& fleet, FleetHandle handle ) noexcept
+: m_fleet( &fleet ), m_handle( handle )
+{
+
+}
+
+template<class ...States>
+inline StatemachineFleet<States...>& StatemachineFleet<States...>::Machine::getFleet() const noexcept
+{
+    return *m_fleet;
+}
+
+template<class ...States>
+inline FleetHandle StatemachineFleet<States...>::Machine::getHandle() const noexcept
+{
+    return m_handle;
+}
+
+template<class ...States>
+inline std::size_t StatemachineFleet<States...>::Machine::getCurrentStateIndex() const noexcept
+{
+    return m_fleet->getCurrentStateIndex( m_handle );
+}
+
+template<class ...States>
+template<class StateType>
+inline bool StatemachineFleet<States...>::Machine::isCurrentlyInState() const noexcept
+{
+    return m_fleet->template isCurrentlyInState<StateType>( m_handle );
+}
+
+template<class ...States>
+template<class StateType, typename ...Args>
+inline bool StatemachineFleet<States...>::Machine::gotoState( Args&& ...args ) const
+{
+    return m_fleet->template gotoState<StateType>( m_handle, std::forward<Args>(args)... );
+}
+
+template<class ...States>
+template<class StateType, typename ...Args>
+inline bool StatemachineFleet<States...>::Machine::pushState( Args&& ...args ) const
+{
+    return m_fleet->template pushState<StateType>( m_handle, std::forward<Args>(args)... );
+}
+
+template<class ...States>
+inline bool StatemachineFleet<States...>::Machine::popState() const
+{
+    return m_fleet->popState( m_handle );
+}
+
+
+
+
+template<class ...States>
+inline StatemachineFleet<States...>::StatemachineFleet() noexcept
+{
+    m_size = 0;
+    m_isProcessingTransition = false;
+    m_isCurrentlyLeavingAState = false;
+}
+
+template<class ...States>
+inline StatemachineFleet<States...>::~StatemachineFleet()
+{
+    m_isProcessingTransition = true;
+
+    for( std::uint32_t i = 0; i < m_generations.size(); i++ )
+    {
+        leaveAllStates(i);
+    }
+}
+
+template<class ...States>
+inline FleetHandle StatemachineFleet<States...>::create()
+{
+    FleetHandle handle;
+
+    if( !m_freeIndices.empty() )
+    {
+        handle.index = m_freeIndices.back();
+        handle.generation = m_generations[ handle.index ];
+        m_freeIndices.pop_back();
+    }
+    else
+    {
+        if( m_generations.size() == m_generations.capacity() )
+        {
+            // grow all arrays up front, so that none of the push_backs below can throw
+            reserve( std::max< std::size_t >( 16, m_generations.size() * 2 ) );
+        }
+
+        handle.index = (std::uint32_t)m_generations.size();
+        handle.generation = 0;
+
+        m_currentStates.push_back(0);
+        m_stackDepths.push_back(0);
+        m_stacks.resize( m_stacks.size() + STACK_CAPACITY, 0 );
+        m_generations.push_back(0);
+        ( column<States>().emplace_back(), ... );
+    }
+
+    m_size++;
+    return handle;
+}
+
+template<class ...States>
+inline bool StatemachineFleet<States...>::destroy( FleetHandle handle )
+{
+    if( !isValid( handle ) || m_isCurrentlyLeavingAState )
+    {
+        return false;
+    }
+
+    if( m_isProcessingTransition )
+    {
+        m_pendingTransitions.emplace_back( [this, handle] {
+            if( isValid( handle ) )
+            {
+                destroyNow( handle );
+            }
+        });
+        return true;
+    }
+
+    return runTransition( [this, handle] {
+        destroyNow( handle );
+        return true;
+    });
+}
+
+template<class ...States>
+inline bool StatemachineFleet<States...>::isValid( FleetHandle handle ) const noexcept
+{
+    return handle.index < m_generations.size() && m_generations[ handle.index ] == handle.generation;
+}
+
+template<class ...States>
+inline std::size_t StatemachineFleet<States...>::getSize() const noexcept
+{
+    return m_size;
+}
+
+template<class ...States>
+inline void StatemachineFleet<States...>::reserve( std::size_t capacity )
+{
+    m_currentStates.reserve( capacity );
+    m_stackDepths.reserve( capacity );
+    m_stacks.reserve( capacity * STACK_CAPACITY );
+    m_generations.reserve( capacity );
+    m_freeIndices.reserve( capacity );
+    ( column<States>().reserve( capacity ), ... );
+}
+
+template<class ...States>
+template<class StateType>
+inline constexpr std::size_t StatemachineFleet<States...>::stateIndexOf() noexcept
+{
+    static_assert( detail::isOneOf<StateType, States...>, "StateType is not a state of this fleet!" );
+
+    // index 0 means no state
+    return detail::IndexOf<StateType, States...>::value + 1;
+}
+
+template<class ...States>
+inline std::size_t StatemachineFleet<States...>::getCurrentStateIndex( FleetHandle handle ) const noexcept
+{
+    return isValid( handle ) ? m_currentStates[ handle.index ] : 0;
+}
+
+template<class ...States>
+inline StateId StatemachineFleet<States...>::getCurrentStateType( FleetHandle handle ) const noexcept
+{
+    return stateIdOfIndex( getCurrentStateIndex( handle ) );
+}
+
+template<class ...States>
+template<class StateType>
+inline bool StatemachineFleet<States...>::isCurrentlyInState( FleetHandle handle ) const noexcept
+{
+    return getCurrentStateIndex( handle ) == stateIndexOf<StateType>();
+}
+
+template<class ...States>
+template<class StateType>
+inline StateType *StatemachineFleet<States...>::getCurrentState( FleetHandle handle ) noexcept
+{
+    if( !isCurrentlyInState<StateType>( handle ) )
+    {
+        return nullptr;
+    }
+
+    return &*column<StateType>()[ handle.index ];
+}
+
+template<class ...States>
+inline std::size_t StatemachineFleet<States...>::getStateStackSize( FleetHandle handle ) const noexcept
+{
+    return isValid( handle ) ? m_stackDepths[ handle.index ] : 0;
+}
+
+template<class ...States>
+template<class StateType, typename ...Args>
+inline bool StatemachineFleet<States...>::initState( FleetHandle handle, Args&& ...args )
+{
+    static_assert( detail::isOneOf<StateType, States...>, "StateType is not a state of this fleet!" );
+
+    if( !isValid( handle ) || m_stackDepths[ handle.index ] != 0 || m_isProcessingTransition )
+    {
+        return false;
+    }
+
+    return runTransition( [&] {
+        return enterNewState<StateType>( handle, false, std::forward<Args>(args)... );
+    });
+}
+
+template<class ...States>
+template<class StateType, typename ...Args>
+inline bool StatemachineFleet<States...>::gotoState( FleetHandle handle, Args&& ...args )
+{
+    static_assert( detail::isOneOf<StateType, States...>, "StateType is not a state of this fleet!" );
+
+    if( !isValid( handle ) || m_isCurrentlyLeavingAState )
+    {
+        return false;
+    }
+
+    if( m_isProcessingTransition )
+    {
+        // called from a state callback, the transition will happen after the current one ends
+        m_pendingTransitions.emplace_back( [this, handle, argsTuple = std::make_tuple( std::forward<Args>(args)... )]() mutable {
+            std::apply( [this, handle]( auto& ...args ) {
+                if( isValid( handle ) )
+                {
+                    enterNewState<StateType>( handle, true, std::move(args)... );
+                }
+            }, argsTuple );
+        });
+        return true;
+    }
+
+    return runTransition( [&] {
+        return enterNewState<StateType>( handle, true, std::forward<Args>(args)... );
+    });
+}
+
+template<class ...States>
+template<class StateType, typename ...Args>
+inline bool StatemachineFleet<States...>::pushState( FleetHandle handle, Args&& ...args )
+{
+    static_assert( detail::isOneOf<StateType, States...>, "StateType is not a state of this fleet!" );
+
+    if( !isValid( handle ) || m_isCurrentlyLeavingAState )
+    {
+        return false;
+    }
+
+    if( m_isProcessingTransition )
+    {
+        m_pendingTransitions.emplace_back( [this, handle, argsTuple = std::make_tuple( std::forward<Args>(args)... )]() mutable {
+            std::apply( [this, handle]( auto& ...args ) {
+                if( isValid( handle ) )
+                {
+                    enterNewState<StateType>( handle, false, std::move(args)... );
+                }
+            }, argsTuple );
+        });
+        return true;
+    }
+
+    return runTransition( [&] {
+        return enterNewState<StateType>( handle, false, std::forward<Args>(args)... );
+    });
+}
+
+template<class ...States>
+inline bool StatemachineFleet<States...>::popState( FleetHandle handle )
+{
+    if( !isValid( handle ) || m_isCurrentlyLeavingAState )
+    {
+        return false;
+    }
+
+    if( m_isProcessingTransition )
+    {
+        m_pendingTransitions.emplace_back( [this, handle] {
+            if( isValid( handle ) )
+            {
+                leaveTopState( handle );
+            }
+        });
+        return true;
+    }
+
+    return runTransition( [this, handle] {
+        return leaveTopState( handle );
+    });
+}
+
+template<class ...States>
+template<class EventType>
+inline bool StatemachineFleet<States...>::dispatchEvent( FleetHandle handle, const EventType& event )
+{
+    if( !isValid( handle ) || m_currentStates[ handle.index ] == 0 )
+    {
+        return false;
+    }
+
+    bool handled = false;
+    auto handleEvent = [this, handle, &event, &handled] {
+        Machine machine( *this, handle );
+        visitState( m_currentStates[ handle.index ], handle.index, [&machine, &event, &handled]( auto& state ) {
+            handled = detail::callOnEvent( state, machine, event );
+        });
+        return handled;
+    };
+
+    if( m_isProcessingTransition )
+    {
+        // an event dispatched from a callback; any transition it requests gets picked up by the outer call
+        return handleEvent();
+    }
+
+    return runTransition( handleEvent );
+}
+
+template<class ...States>
+template<class StateType>
+inline std::size_t StatemachineFleet<States...>::countInState() const noexcept
+{
+    const std::uint8_t stateIndex = (std::uint8_t)stateIndexOf<StateType>();
+    const std::uint8_t *currentStates = m_currentStates.data();
+    const std::size_t n = m_currentStates.size();
+
+    // branchless and counted in blocks short enough for byte-sized counters, so that the loop gets vectorized with full-width vectors
+    const std::size_t BLOCK_SIZE = 255;
+
+    std::size_t count = 0;
+    for( std::size_t blockStart = 0; blockStart < n; blockStart += BLOCK_SIZE )
+    {
+        const std::size_t blockEnd = std::min( n, blockStart + BLOCK_SIZE );
+
+        std::uint8_t blockCount = 0;
+        for( std::size_t i = blockStart; i < blockEnd; i++ )
+        {
+            blockCount += currentStates[i] == stateIndex;
+        }
+
+        count += blockCount;
+    }
+
+    return count;
+}
+
+template<class ...States>
+inline std::array< std::size_t, sizeof...(States) + 1 > StatemachineFleet<States...>::countPerState() const noexcept
+{
+    std::array< std::size_t, sizeof...(States) + 1 > counts {};
+
+    // one vectorized pass per state is faster than a single pass scattering into counters
+    std::size_t machinesInAnyState = 0;
+    ( ( machinesInAnyState += counts[ stateIndexOf<States>() ] = countInState<States>() ), ... );
+
+    counts[0] = m_size - machinesInAnyState;
+    return counts;
+}
+
+template<class ...States>
+template<class StateType>
+inline std::size_t StatemachineFleet<States...>::findInState( std::vector<FleetHandle>& out ) const
+{
+    const std::uint8_t stateIndex = (std::uint8_t)stateIndexOf<StateType>();
+    const std::size_t n = m_currentStates.size();
+    const std::size_t prevSize = out.size();
+
+    for( std::uint32_t i = 0; i < n; i++ )
+    {
+        if( m_currentStates[i] == stateIndex )
+        {
+            out.push_back( FleetHandle{ i, m_generations[i] } );
+        }
+    }
+
+    return out.size() - prevSize;
+}
+
+template<class ...States>
+template<class StateType, typename F>
+inline void StatemachineFleet<States...>::forEachInState( F&& f )
+{
+    auto visitMachines = [this, &f] {
+        const std::uint8_t stateIndex = (std::uint8_t)stateIndexOf<StateType>();
+        const std::size_t n = m_currentStates.size();
+        ColumnType<StateType>& states = column<StateType>();
+
+        for( std::uint32_t i = 0; i < n; i++ )
+        {
+            if( m_currentStates[i] == stateIndex )
+            {
+                f( FleetHandle{ i, m_generations[i] }, *states[i] );
+            }
+        }
+
+        return true;
+    };
+
+    if( m_isProcessingTransition )
+    {
+        visitMachines();
+    }
+    else
+    {
+        runTransition( visitMachines );
+    }
+}
+
+
+template<class ...States>
+inline bool StatemachineFleet<States...>::writeSnapshotFile( const char *path ) const
+{
+    static_assert( ( std::is_trivially_copyable<States>::value && ... ), "Only fleets of trivially copyable states can be written to snapshot files!" );
+
+    if( m_isProcessingTransition )
+    {
+        return false;
+    }
+
+    const std::vector< unsigned char > stateTable = makeSnapshotStateTable();
+    const std::size_t stateSizes[] = { sizeof(States)... };
+    const std::size_t slotCount = m_generations.size();
+    const detail::FleetSnapshotLayout layout = detail::computeFleetSnapshotLayout( stateTable.size(), slotCount, m_freeIndices.size(), stateSizes, sizeof...(States) );
+
+    FleetSnapshotHeader header;
+    std::memcpy( header.magic, FLEET_SNAPSHOT_MAGIC, sizeof(header.magic) );
+    header.formatVersion = FLEET_SNAPSHOT_FORMAT_VERSION;
+    header.headerSize = sizeof(FleetSnapshotHeader);
+    header.byteOrderMark = FLEET_SNAPSHOT_BYTE_ORDER_MARK;
+    header.stateCount = sizeof...(States);
+    header.slotCount = slotCount;
+    header.freeCount = m_freeIndices.size();
+    header.stateTableSize = stateTable.size();
+    header.fileSize = layout.fileSize;
+
+    std::FILE *file = std::fopen( path, "wb" );
+    if( !file )
+    {
+        return false;
+    }
+
+    std::uint64_t position = 0;
+    // pads the file with zeroes up to the offset first
+    auto writeAt = [file, &position]( std::uint64_t offset, const void *data, std::size_t size ) {
+        static const unsigned char zeroes[ FLEET_SNAPSHOT_SECTION_ALIGNMENT ] = {};
+        while( position < offset )
+        {
+            const std::size_t paddingSize = (std::size_t)std::min< std::uint64_t >( offset - position, sizeof(zeroes) );
+            if( std::fwrite( zeroes, 1, paddingSize, file ) != paddingSize )
+            {
+                return false;
+            }
+            position += paddingSize;
+        }
+
+        position += size;
+        return size == 0 || std::fwrite( data, 1, size, file ) == size;
+    };
+
+    // states are copied out of their optionals in chunks, empty slots are zeroed
+    std::vector< unsigned char > chunk;
+    auto writeColumn = [this, &writeAt, &chunk, slotCount]( auto *stateTag, std::uint64_t offset ) {
+        using StateType = std::remove_pointer_t< decltype( stateTag ) >;
+        const ColumnType<StateType>& states = column<StateType>();
+        const std::size_t CHUNK_SLOTS = std::max< std::size_t >( 1, 65536 / sizeof(StateType) );
+
+        if( !writeAt( offset, nullptr, 0 ) )
+        {
+            return false;
+        }
+
+        for( std::size_t chunkStart = 0; chunkStart < slotCount; chunkStart += CHUNK_SLOTS )
+        {
+            const std::size_t chunkEnd = std::min( slotCount, chunkStart + CHUNK_SLOTS );
+            chunk.assign( ( chunkEnd - chunkStart ) * sizeof(StateType), 0 );
+
+            for( std::size_t i = chunkStart; i < chunkEnd; i++ )
+            {
+                if( states[i] )
+                {
+                    std::memcpy( chunk.data() + ( i - chunkStart ) * sizeof(StateType), &*states[i], sizeof(StateType) );
+                }
+            }
+
+            if( !writeAt( offset + chunkStart * sizeof(StateType), chunk.data(), chunk.size() ) )
+            {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    bool isWritten = writeAt( 0, &header, sizeof(header) )
+                  && writeAt( sizeof(header), stateTable.data(), stateTable.size() )
+                  && writeAt( layout.currentStatesOffset, m_currentStates.data(), slotCount )
+                  && writeAt( layout.stackDepthsOffset, m_stackDepths.data(), slotCount )
+                  && writeAt( layout.stacksOffset, m_stacks.data(), slotCount * STACK_CAPACITY )
+                  && writeAt( layout.generationsOffset, m_generations.data(), slotCount * sizeof(std::uint32_t) )
+                  && writeAt( layout.freeIndicesOffset, m_freeIndices.data(), m_freeIndices.size() * sizeof(std::uint32_t) )
+                  && ( writeColumn( (States *)nullptr, layout.columnOffsets[ stateIndexOf<States>() - 1 ] ) && ... );
+
+    isWritten = std::fclose( file ) == 0 && isWritten;
+    if( !isWritten )
+    {
+        std::remove( path );
+    }
+
+    return isWritten;
+}
+
+template<class ...States>
+inline bool StatemachineFleet<States...>::bulkLoadSnapshotFile( const char *path )
+{
+    static_assert( ( std::is_trivially_copyable<States>::value && ... ), "Only fleets of trivially copyable states can be loaded from snapshot files!" );
+
+    if( m_isProcessingTransition || m_size != 0 )
+    {
+        return false;
+    }
+
+    detail::MappedFile file;
+    if( !file.open( path ) )
+    {
+        return false;
+    }
+
+    const unsigned char *data = file.getData();
+    const std::size_t size = file.getSize();
+
+    FleetSnapshotHeader header;
+    if( size < sizeof(header) )
+    {
+        return false;
+    }
+    std::memcpy( &header, data, sizeof(header) );
+
+    const std::vector< unsigned char > stateTable = makeSnapshotStateTable();
+    if( std::memcmp( header.magic, FLEET_SNAPSHOT_MAGIC, sizeof(header.magic) ) != 0
+     || header.formatVersion != FLEET_SNAPSHOT_FORMAT_VERSION
+     || header.headerSize != sizeof(FleetSnapshotHeader)
+     || header.byteOrderMark != FLEET_SNAPSHOT_BYTE_ORDER_MARK
+     || header.fileSize != size
+     || header.stateCount != sizeof...(States)
+     || header.stateTableSize != stateTable.size()
+     || sizeof(header) + stateTable.size() > size
+     // each slot takes at least a byte, which also keeps computing offsets below from overflowing
+     || header.slotCount > size || header.slotCount > UINT32_MAX || header.freeCount > header.slotCount )
+    {
+        return false;
+    }
+
+    // arrays are indexed by the position of the state type on the States list, so the types have to match exactly
+    if( std::memcmp( data + sizeof(header), stateTable.data(), stateTable.size() ) != 0 )
+    {
+        return false;
+    }
+
+    const std::size_t slotCount = (std::size_t)header.slotCount;
+    const std::size_t freeCount = (std::size_t)header.freeCount;
+    const std::size_t stateSizes[] = { sizeof(States)... };
+    const detail::FleetSnapshotLayout layout = detail::computeFleetSnapshotLayout( stateTable.size(), slotCount, freeCount, stateSizes, sizeof...(States) );
+    if( layout.fileSize != size )
+    {
+        return false;
+    }
+
+    const std::uint8_t *currentStates = data + layout.currentStatesOffset;
+    const std::uint8_t *stackDepths = data + layout.stackDepthsOffset;
+    const std::uint8_t *stacks = data + layout.stacksOffset;
+    const unsigned char *freeIndices = data + layout.freeIndicesOffset;
+    if( !isValidSnapshotData( currentStates, stackDepths, stacks, freeIndices, slotCount, freeCount ) )
+    {
+        return false;
+    }
+
+    // allocate everything first, so that nothing below can throw and leave the fleet half loaded
+    reserve( slotCount );
+
+    m_currentStates.assign( currentStates, currentStates + slotCount );
+    m_stackDepths.assign( stackDepths, stackDepths + slotCount );
+    m_stacks.assign( stacks, stacks + slotCount * STACK_CAPACITY );
+    m_generations.resize( slotCount );
+    std::memcpy( m_generations.data(), data + layout.generationsOffset, slotCount * sizeof(std::uint32_t) );
+    m_freeIndices.resize( freeCount );
+    std::memcpy( m_freeIndices.data(), freeIndices, freeCount * sizeof(std::uint32_t) );
+    ( ( column<States>().clear(), column<States>().resize( slotCount ) ), ... );
+
+    const unsigned char *columns[] = { data + layout.columnOffsets[ stateIndexOf<States>() - 1 ]... };
+    for( std::size_t i = 0; i < slotCount; i++ )
+    {
+        for( std::size_t j = 0; j < m_stackDepths[i]; j++ )
+        {
+            const std::size_t stateIndex = m_stacks[ i * STACK_CAPACITY + j ];
+            (void)( ( stateIndex == stateIndexOf<States>() 
+                    ? ( loadSnapshotState( column<States>()[i], columns[ stateIndex - 1 ] + i * sizeof(States) ), true ) 
+                    : false ) || ... );
+        }
+    }
+
+    m_size = slotCount - freeCount;
+    return true;
+}
+
+
+template<class ...States>
+inline StatemachineFleet<States...>::ProcessingGuard::~ProcessingGuard()
+{
+    fleet.m_isProcessingTransition = false;
+    fleet.m_isCurrentlyLeavingAState = false;
+    fleet.m_pendingTransitions.clear();
+}
+
+template<class ...States>
+template<class StateType>
+inline typename StatemachineFleet<States...>::template ColumnType<StateType>& StatemachineFleet<States...>::column() noexcept
+{
+    return std::get< ColumnType<StateType> >( m_columns );
+}
+
+template<class ...States>
+template<class StateType>
+inline const typename StatemachineFleet<States...>::template ColumnType<StateType>& StatemachineFleet<States...>::column() const noexcept
+{
+    return std::get< ColumnType<StateType> >( m_columns );
+}
+
+template<class ...States>
+inline StateId StatemachineFleet<States...>::stateIdOfIndex( std::size_t index ) noexcept
+{
+    static const StateId ids[] = { NULL_STATE, stateIdOf<States>()... };
+    return ids[index];
+}
+
+template<class ...States>
+inline std::uint8_t *StatemachineFleet<States...>::stackOf( std::uint32_t index ) noexcept
+{
+    return m_stacks.data() + (std::size_t)index * STACK_CAPACITY;
+}
+
+template<class ...States>
+template<typename F>
+inline void StatemachineFleet<States...>::visitState( std::size_t stateIndex, std::uint32_t index, F&& f )
+{
+    (void)( ( stateIndex == stateIndexOf<States>() ? ( f( *column<States>()[index] ), true ) : false ) || ... );
+}
+
+template<class ...States>
+inline void StatemachineFleet<States...>::resetState( std::size_t stateIndex, std::uint32_t index ) noexcept
+{
+    (void)( ( stateIndex == stateIndexOf<States>() ? ( column<States>()[index].reset(), true ) : false ) || ... );
+}
+
+template<class ...States>
+inline bool StatemachineFleet<States...>::isOnStack( std::uint32_t index, std::size_t stateIndex ) const noexcept
+{
+    const std::uint8_t *stack = m_stacks.data() + (std::size_t)index * STACK_CAPACITY;
+    return std::find( stack, stack + m_stackDepths[index], (std::uint8_t)stateIndex ) != stack + m_stackDepths[index];
+}
+
+template<class ...States>
+template<typename F>
+inline bool StatemachineFleet<States...>::runTransition( F&& transition )
+{
+    ProcessingGuard guard { *this };
+
+    m_isProcessingTransition = true;
+
+    bool result = transition();
+    runPendingTransitions();
+
+    return result;
+}
+
+template<class ...States>
+inline void StatemachineFleet<States...>::runPendingTransitions()
+{
+    // transitions can queue further transitions, so the size is checked every time
+    for( std::size_t i = 0; i < m_pendingTransitions.size(); i++ )
+    {
+        std::function<void()> pending = std::move( m_pendingTransitions[i] );
+        pending();
+    }
+}
+
+template<class ...States>
+template<class StateType, typename ...Args>
+inline bool StatemachineFleet<States...>::enterNewState( FleetHandle handle, bool replaceTop, Args&& ...args )
+{
+    const std::uint32_t index = handle.index;
+    const std::size_t nextStateIndex = stateIndexOf<StateType>();
+    const std::size_t currentStateIndex = m_currentStates[index];
+    std::size_t depth = m_stackDepths[index];
+
+    // every state type has only one slot per statemachine
+    if( isOnStack( index, nextStateIndex ) )
+    {
+        return false;
+    }
+
+    Machine machine( *this, handle );
+
+    StateTransition transition;
+    transition.type = depth == 0 ? STATE_TRANSITION_INIT : ( replaceTop ? STATE_TRANSITION_GOTO : STATE_TRANSITION_PUSH );
+    transition.prevState = stateIdOfIndex( currentStateIndex );
+    transition.nextState = stateIdOfIndex( nextStateIndex );
+
+    if( !detail::callCanEnterStateType<StateType>( std::as_const( machine ), transition ) )
+    {
+        return false;
+    }
+
+    std::optional<StateType>& nextState = column<StateType>()[index];
+    nextState.emplace( std::forward<Args>(args)... );
+
+    bool canTransition = detail::callCanEnterState( *nextState, machine, transition );
+
+    if( canTransition && currentStateIndex != 0 )
+    {
+        visitState( currentStateIndex, index, [&machine, &transition, &canTransition]( auto& state ) {
+            canTransition = detail::callCanLeaveState( state, machine, transition );
+        });
+    }
+
+    if( !canTransition )
+    {
+        nextState.reset();
+        return false;
+    }
+
+    if( currentStateIndex != 0 )
+    {
+        m_isCurrentlyLeavingAState = true;
+        visitState( currentStateIndex, index, [&machine, &transition]( auto& state ) {
+            detail::callOnLeaveState( state, machine, transition );
+        });
+        m_isCurrentlyLeavingAState = false;
+
+        // the same as in StatemachineBase::gotoState - the init state is never replaced
+        if( replaceTop && depth > 1 )
+        {
+            resetState( currentStateIndex, index );
+            depth--;
+        }
+    }
+
+    stackOf( index )[depth] = (std::uint8_t)nextStateIndex;
+    m_stackDepths[index] = (std::uint8_t)( depth + 1 );
+    m_currentStates[index] = (std::uint8_t)nextStateIndex;
+
+    detail::callOnEnterState( *nextState, machine, transition );
+
+    return true;
+}
+
+template<class ...States>
+inline bool StatemachineFleet<States...>::leaveTopState( FleetHandle handle )
+{
+    const std::uint32_t index = handle.index;
+    const std::size_t depth = m_stackDepths[index];
+
+    if( depth <= 1 )
+    {
+        return false;
+    }
+
+    const std::size_t currentStateIndex = stackOf( index )[ depth - 1 ];
+    const std::size_t nextStateIndex = stackOf( index )[ depth - 2 ];
+
+    Machine machine( *this, handle );
+
+    StateTransition transition;
+    transition.type = STATE_TRANSITION_POP;
+    transition.prevState = stateIdOfIndex( currentStateIndex );
+    transition.nextState = stateIdOfIndex( nextStateIndex );
+
+    bool canTransition = true;
+    visitState( nextStateIndex, index, [&machine, &transition, &canTransition]( auto& state ) {
+        canTransition = detail::callCanEnterState( state, machine, transition );
+    });
+
+    if( canTransition )
+    {
+        visitState( currentStateIndex, index, [&machine, &transition, &canTransition]( auto& state ) {
+            canTransition = detail::callCanLeaveState( state, machine, transition );
+        });
+    }
+
+    if( !canTransition )
+    {
+        return false;
+    }
+
+    m_isCurrentlyLeavingAState = true;
+    visitState( currentStateIndex, index, [&machine, &transition]( auto& state ) {
+        detail::callOnLeaveState( state, machine, transition );
+    });
+    m_isCurrentlyLeavingAState = false;
+
+    resetState( currentStateIndex, index );
+    m_stackDepths[index] = (std::uint8_t)( depth - 1 );
+    m_currentStates[index] = (std::uint8_t)nextStateIndex;
+
+    visitState( nextStateIndex, index, [&machine, &transition]( auto& state ) {
+        detail::callOnEnterState( state, machine, transition );
+    });
+
+    return true;
+}
+
+template<class ...States>
+inline void StatemachineFleet<States...>::leaveAllStates( std::uint32_t index )
+{
+    Machine machine( *this, FleetHandle{ index, m_generations[index] } );
+
+    m_isCurrentlyLeavingAState = true;
+
+    while( m_stackDepths[index] > 0 )
+    {
+        const std::size_t depth = m_stackDepths[index];
+        const std::size_t stateIndex = stackOf( index )[ depth - 1 ];
+
+        StateTransition transition;
+        transition.type = STATE_TRANSITION_DESTROY;
+        transition.prevState = stateIdOfIndex( stateIndex );
+        transition.nextState = NULL_STATE;
+
+        // the state is taken off the stack first, so an exception from onLeaveState doesn't leave it there twice
+        m_stackDepths[index] = (std::uint8_t)( depth - 1 );
+        m_currentStates[index] = depth > 1 ? stackOf( index )[ depth - 2 ] : 0;
+
+        visitState( stateIndex, index, [&machine, &transition]( auto& state ) {
+            detail::callOnLeaveState( state, machine, transition );
+        });
+        resetState( stateIndex, index );
+    }
+
+    m_isCurrentlyLeavingAState = false;
+}
+
+template<class ...States>
+inline void StatemachineFleet<States...>::destroyNow( FleetHandle handle )
+{
+    // invalidate the handle first, so that requests made by the states being left don't get queued for it
+    m_generations[ handle.index ]++;
+
+    leaveAllStates( handle.index );
+
+    m_freeIndices.push_back( handle.index );
+    m_size--;
+}
+
+
+template<class ...States>
+inline std::vector< unsigned char > StatemachineFleet<States...>::makeSnapshotStateTable()
+{
+    std::vector< unsigned char > table;
+
+    auto append = [&table]( std::uint32_t value ) {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>( &value );
+        table.insert( table.end(), bytes, bytes + sizeof(value) );
+    };
+
+    auto appendState = [&table, &append]( std::size_t size, std::size_t alignment, const char *name ) {
+        const std::size_t nameLength = std::strlen( name );
+        append( (std::uint32_t)size );
+        append( (std::uint32_t)alignment );
+        append( (std::uint32_t)nameLength );
+        table.insert( table.end(), name, name + nameLength );
+    };
+
+    ( appendState( sizeof(States), alignof(States), getStateTypeName( stateIdOf<States>() ) ), ... );
+
+    return table;
+}
+
+template<class ...States>
+inline bool StatemachineFleet<States...>::isValidSnapshotData( const std::uint8_t *currentStates, const std::uint8_t *stackDepths, const std::uint8_t *stacks, 
+                                                               const unsigned char *freeIndices, std::size_t slotCount, std::size_t freeCount )
+{
+    for( std::size_t i = 0; i < slotCount; i++ )
+    {
+        const std::size_t depth = stackDepths[i];
+        const std::uint8_t *stack = stacks + i * STACK_CAPACITY;
+
+        if( depth > STACK_CAPACITY || currentStates[i] != ( depth > 0 ? stack[ depth - 1 ] : 0 ) )
+        {
+            return false;
+        }
+
+        // every state type can be on a stack only once
+        bool isOnStack[ sizeof...(States) + 1 ] = {};
+        for( std::size_t j = 0; j < depth; j++ )
+        {
+            if( stack[j] == 0 || stack[j] > sizeof...(States) || isOnStack[ stack[j] ] )
+            {
+                return false;
+            }
+            isOnStack[ stack[j] ] = true;
+        }
+    }
+
+    std::vector< bool > isFree( slotCount, false );
+    for( std::size_t i = 0; i < freeCount; i++ )
+    {
+        std::uint32_t index;
+        std::memcpy( &index, freeIndices + i * sizeof(index), sizeof(index) );
+
+        if( index >= slotCount || isFree[index] || stackDepths[index] != 0 )
+        {
+            return false;
+        }
+        isFree[index] = true;
+    }
+
+    return true;
+}
+
+template<class ...States>
+template<class StateType>
+inline void StatemachineFleet<States...>::loadSnapshotState( std::optional<StateType>& state, const unsigned char *bytes )
+{
+    // the bytes in the file don't have to be aligned for StateType
+    alignas(StateType) unsigned char storage[ sizeof(StateType) ];
+    std::memcpy( storage, bytes, sizeof(StateType) );
+
+    state.emplace( *std::launder( reinterpret_cast<StateType *>( storage ) ) );
+}
+
+} // namespace chestnut::fsm
@@ -0,0 +1,85 @@
+/**
+ * @file statemachine_observer.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with StatemachineObserver, the hook through which optional features follow transitions of a statemachine
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_STATEMACHINE_OBSERVER_H__
+#define __CHESTNUT_STATEMACHINE_STATEMACHINE_OBSERVER_H__
+
+#include "state_transition.hpp"
+
+namespace chestnut::fsm
+{
+
+class StateBase;
+class StatemachineBase;
+
+/**
+ * @brief Object notified about transitions of the statemachine it's attached to
+ *
+ * @details
+ * Features that not every statemachine needs - e.g. TransitionJournalObserver and TimedStatemachine - are built on observers,
+ * so a statemachine only carries a single pointer for them and their data lives in the observers.
+ * A statemachine without observers doesn't call anything.
+ *
+ * An observer is attached to at most one statemachine at a time with StatemachineBase::attachObserver().
+ * It's detached when either of them is destroyed, so neither has to outlive the other.
+ * Observers are called on the thread making the transition, in the order they were attached.
+ */
+class StatemachineObserver
+{
+public:
+    StatemachineObserver() noexcept;
+
+    /**
+     * @brief Destructor; detaches the observer from its statemachine
+     */
+    virtual ~StatemachineObserver();
+
+    StatemachineObserver( const StatemachineObserver& ) = delete;
+    StatemachineObserver& operator=( const StatemachineObserver& ) = delete;
+
+
+    /**
+     * @brief Get the statemachine the observer is attached to or nullptr
+     */
+    StatemachineBase *getStatemachine() const noexcept;
+
+
+protected:
+    /**
+     * @brief Called for every transition that got past the guards, right before onEnterState of the next state
+     *
+     * @details
+     * Also called with STATE_TRANSITION_DESTROY for every state deleted when the statemachine is destroyed.
+     * An exception thrown here propagates out of the state change method.
+     */
+    virtual void onTransition( const StateTransition& transition );
+
+    /**
+     * @brief Called after onLeaveState of a state has succeeded, also when the state is only covered by a pushed state
+     */
+    virtual void onStateLeft( StateBase *state ) noexcept;
+
+
+private:
+    StatemachineBase *m_statemachine;
+    StatemachineObserver *m_nextObserver;
+
+    // Befriended so that it can link observers and call their hooks
+    friend StatemachineBase;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "statemachine_observer.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_STATEMACHINE_OBSERVER_H__
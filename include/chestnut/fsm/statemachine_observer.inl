@@ -0,0 +1,25 @@
+namespace chestnut::fsm
+{
+
+inline StatemachineObserver::StatemachineObserver() noexcept
+{
+    m_statemachine = nullptr;
+    m_nextObserver = nullptr;
+}
+
+inline StatemachineBase *StatemachineObserver::getStatemachine() const noexcept
+{
+    return m_statemachine;
+}
+
+inline void StatemachineObserver::onTransition( const StateTransition& /*transition*/ )
+{
+    // NOP
+}
+
+inline void StatemachineObserver::onStateLeft( StateBase * /*state*/ ) noexcept
+{
+    // NOP
+}
+
+} // namespace chestnut::fsm
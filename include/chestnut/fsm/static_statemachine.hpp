@@ -0,0 +1,253 @@
+/**
+ * @file static_statemachine.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with the heap-free StaticStatemachine class
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_STATIC_STATEMACHINE_H__
+#define __CHESTNUT_STATEMACHINE_STATIC_STATEMACHINE_H__
+
+#include "config.hpp"
+#include "state_transition.hpp"
+#include "state_traits.hpp"
+
+#if CHESTNUT_FSM_TRACE_TRANSITIONS
+    #include "transition_tracer.hpp"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <variant>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Statemachine with a set of states known at compile time, storing its current state inline
+ *
+ * @details
+ * An alternative to Statemachine for statemachines that need to be as small and fast as possible.
+ * The state object lives inside of the statemachine in a variant-like storage, so there are no heap allocations,
+ * no virtual calls and no RTTI involved. The statemachine occupies little more than the biggest of its states.
+ *
+ * States are plain classes; they don't need to inherit from anything. They can define any of the callbacks
+ * known from StateBase (canEnterState, canLeaveState, onEnterState and onLeaveState) taking the same StateTransition,
+ * optionally with the statemachine reference as the first parameter - see state_traits.hpp.
+ * A static canEnterStateType guard is evaluated before the next state is constructed.
+ * All state types must be complete before the statemachine type is used, so callbacks that call the statemachine
+ * should be defined after all of the state classes.
+ * A state may also define onEvent methods for events dispatched with dispatchEvent().
+ *
+ * There is no state stack, the statemachine is only ever in one state at a time, so only initState() and gotoState() are available.
+ *
+ * Transitions requested from a state callback (onEnterState or onEvent) are not executed immediately.
+ * The next state is constructed into a second storage slot and the transition happens once the callback returns,
+ * so a state is never destroyed while its own method is still running and the call stack doesn't grow.
+ * Only one such transition can be pending at a time; further requests are rejected until it's done.
+ * Like with StatemachineBase, transition requests from inside of onLeaveState are ignored.
+ *
+ * Exceptions thrown by state callbacks are not wrapped and propagate to the caller unchanged.
+ *
+ * @tparam States state types of the statemachine
+ */
+template< class ...States >
+class StaticStatemachine
+{
+    static_assert( sizeof...(States) > 0, "StaticStatemachine needs at least one state type!" );
+    static_assert( sizeof...(States) < 255, "StaticStatemachine supports at most 254 state types!" );
+
+public:
+    /**
+     * @brief Variant type that holds state objects
+     */
+    typedef std::variant< std::monostate, States... > StateVariantType;
+
+
+public:
+    /**
+     * @brief Constructor; the statemachine starts without any state
+     */
+    StaticStatemachine() noexcept;
+
+    /**
+     * @brief Destructor; calls onLeaveState of the current state with STATE_TRANSITION_DESTROY
+     */
+    ~StaticStatemachine();
+
+    StaticStatemachine( const StaticStatemachine& ) = delete;
+    StaticStatemachine& operator=( const StaticStatemachine& ) = delete;
+
+
+    /**
+     * @brief Get the pointer to the current state object if it's of given type
+     *
+     * @tparam StateType type of the state
+     * @return pointer to the state or nullptr if statemachine isn't in this state
+     */
+    template< class StateType >
+    StateType *getCurrentState() noexcept;
+    /**
+     * @brief Get the pointer to the current state object if it's of given type
+     *
+     * @tparam StateType type of the state
+     * @return pointer to the state or nullptr if statemachine isn't in this state
+     */
+    template< class StateType >
+    const StateType *getCurrentState() const noexcept;
+
+    /**
+     * @brief Get the type identifier of the current state or NULL_STATE if statemachine was not initialized
+     *
+     * @return identifier of the state type
+     */
+    StateId getCurrentStateType() const noexcept;
+
+    /**
+     * @brief Get the position of the current state's type on the States list plus one or 0 if statemachine was not initialized
+     *
+     * @return state index
+     *
+     * @details
+     * Unlike StateId this is known at compile time for every state, use stateIndexOf() to get one for a given type.
+     */
+    std::size_t getCurrentStateIndex() const noexcept;
+
+    /**
+     * @brief Get the value returned by getCurrentStateIndex() when statemachine is in given state
+     *
+     * @tparam StateType type of the state
+     * @return state index
+     */
+    template< class StateType >
+    static constexpr std::size_t stateIndexOf() noexcept;
+
+    /**
+     * @brief Return whether the statemachine is currently in the given state
+     *
+     * @tparam StateType type of the state
+     * @return if StateType is the type of the current state
+     */
+    template< class StateType >
+    bool isCurrentlyInState() const noexcept;
+
+    /**
+     * @brief Call a function with the current state object
+     *
+     * @param visitor function taking a reference to any of the state types
+     * @return whether the statemachine was in any state and the function got called
+     */
+    template< typename Visitor >
+    bool visitCurrentState( Visitor&& visitor );
+
+
+    /**
+     * @brief Explicitly initialize the statemachine
+     *
+     * @tparam StateType type of the initial state
+     * @tparam Args types of StateType constructor parameters
+     * @param args arguments that should be forwarded to StateType constructor
+     * @return whether statemachine was able to change the state
+     *
+     * @details
+     * If the statemachine is already in some state, it won't do anything.
+     */
+    template< class StateType, typename ...Args >
+    bool initState( Args&& ...args );
+
+    /**
+     * @brief Transitions directly to specified state
+     *
+     * @tparam StateType type of the state statemachine should transition to
+     * @tparam Args types of StateType constructor parameters
+     * @param args arguments that should be forwarded to StateType constructor
+     * @return whether statemachine was able to change the state or, if called from a state callback, whether the transition was scheduled
+     *
+     * @details
+     * If statemachine is currently in the same state as specified, method does nothing.
+     * If the statemachine was not initialized, the transition type is STATE_TRANSITION_INIT.
+     * canLeaveState() and canEnterState() are checked in subject states to test if the transition is possible.
+     */
+    template< class StateType, typename ...Args >
+    bool gotoState( Args&& ...args );
+
+    /**
+     * @brief Pass an event to the current state
+     *
+     * @param event event object
+     * @return whether the current state has an onEvent method for this event type
+     *
+     * @details
+     * Transitions requested by the state while handling the event are executed after the handler returns.
+     */
+    template< class EventType >
+    bool dispatchEvent( const EventType& event );
+
+
+private:
+    /**
+     * @brief Leaves the statemachine ready for next transitions once processing ends, even if a callback throws
+     */
+    struct ProcessingGuard
+    {
+        StaticStatemachine& statemachine;
+
+        ~ProcessingGuard();
+    };
+
+    StateVariantType& activeSlot() noexcept;
+    const StateVariantType& activeSlot() const noexcept;
+    StateVariantType& inactiveSlot() noexcept;
+
+    static StateId stateIdOfIndex( std::size_t index ) noexcept;
+
+    /**
+     * @brief Evaluate the static entry guard of a state type before it's constructed, if it has one
+     */
+    template< class StateType >
+    bool canEnterStateType( EStateTransitionType type ) const;
+
+    /**
+     * @brief Call a function with the state object in a slot, unless the slot is empty
+     */
+    template< class Slot, typename F >
+    static bool visitSlot( Slot& slot, F&& f );
+
+    /**
+     * @brief Transition from the active slot to the state constructed in the inactive slot
+     */
+    bool performTransition( EStateTransitionType type );
+
+    /**
+     * @brief Perform a transition and then all transitions requested from callbacks in the meantime
+     */
+    bool runTransition( EStateTransitionType type );
+
+    /**
+     * @brief Execute transitions requested from callbacks
+     */
+    void runPendingTransitions();
+
+
+private:
+    /**
+     * @brief Two storage slots - one for the current state and one for the state being transitioned to
+     */
+    StateVariantType m_slots[2];
+    std::uint8_t m_activeSlot;
+    bool m_isProcessingTransition;
+    bool m_isCurrentlyLeavingAState;
+    bool m_hasPendingTransition;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "static_statemachine.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_STATIC_STATEMACHINE_H__
@@ -0,0 +1,317 @@
+#include <type_traits>
+#include <utility>
+
+namespace chestnut::fsm
+{
+
+template<class ...States>
+inline StaticStatemachine<States...>::StaticStatemachine() noexcept
+{
+    m_activeSlot = 0;
+    m_isProcessingTransition = false;
+    m_isCurrentlyLeavingAState = false;
+    m_hasPendingTransition = false;
+}
+
+template<class ...States>
+inline StaticStatemachine<States...>::~StaticStatemachine()
+{
+    m_isCurrentlyLeavingAState = true;
+
+    StateTransition transition;
+    transition.type = STATE_TRANSITION_DESTROY;
+    transition.prevState = getCurrentStateType();
+    transition.nextState = NULL_STATE;
+
+    if( transition.prevState != NULL_STATE )
+    {
+        CHESTNUT_FSM_TRACE_TRANSITION( this, transition );
+    }
+
+    visitSlot( activeSlot(), [this, &transition]( auto& state ) {
+        detail::callOnLeaveState( state, *this, transition );
+    });
+}
+
+template<class ...States>
+template<class StateType>
+inline StateType *StaticStatemachine<States...>::getCurrentState() noexcept
+{
+    static_assert( detail::isOneOf<StateType, States...>, "StateType is not a state of this statemachine!" );
+
+    return std::get_if<StateType>( &activeSlot() );
+}
+
+template<class ...States>
+template<class StateType>
+inline const StateType *StaticStatemachine<States...>::getCurrentState() const noexcept
+{
+    static_assert( detail::isOneOf<StateType, States...>, "StateType is not a state of this statemachine!" );
+
+    return std::get_if<StateType>( &activeSlot() );
+}
+
+template<class ...States>
+inline StateId StaticStatemachine<States...>::getCurrentStateType() const noexcept
+{
+    return stateIdOfIndex( activeSlot().index() );
+}
+
+template<class ...States>
+inline std::size_t StaticStatemachine<States...>::getCurrentStateIndex() const noexcept
+{
+    return activeSlot().index();
+}
+
+template<class ...States>
+template<class StateType>
+inline constexpr std::size_t StaticStatemachine<States...>::stateIndexOf() noexcept
+{
+    static_assert( detail::isOneOf<StateType, States...>, "StateType is not a state of this statemachine!" );
+
+    // index 0 is taken by std::monostate
+    return detail::IndexOf<StateType, States...>::value + 1;
+}
+
+template<class ...States>
+template<class StateType>
+inline bool StaticStatemachine<States...>::isCurrentlyInState() const noexcept
+{
+    return activeSlot().index() == stateIndexOf<StateType>();
+}
+
+template<class ...States>
+template<typename Visitor>
+inline bool StaticStatemachine<States...>::visitCurrentState( Visitor&& visitor )
+{
+    return visitSlot( activeSlot(), std::forward<Visitor>( visitor ) );
+}
+
+template<class ...States>
+template<class StateType, typename ...Args>
+inline bool StaticStatemachine<States...>::initState( Args&& ...args )
+{
+    static_assert( detail::isOneOf<StateType, States...>, "StateType is not a state of this statemachine!" );
+
+    if( activeSlot().index() != 0 || m_isProcessingTransition )
+    {
+        return false;
+    }
+
+    if( !canEnterStateType<StateType>( STATE_TRANSITION_INIT ) )
+    {
+        return false;
+    }
+
+    inactiveSlot().template emplace<StateType>( std::forward<Args>(args)... );
+    return runTransition( STATE_TRANSITION_INIT );
+}
+
+template<class ...States>
+template<class StateType, typename ...Args>
+inline bool StaticStatemachine<States...>::gotoState( Args&& ...args )
+{
+    static_assert( detail::isOneOf<StateType, States...>, "StateType is not a state of this statemachine!" );
+
+    if( m_isCurrentlyLeavingAState )
+    {
+        return false;
+    }
+
+    if( m_isProcessingTransition )
+    {
+        // called from a state callback, the transition will happen after it returns
+        if( m_hasPendingTransition || !canEnterStateType<StateType>( STATE_TRANSITION_GOTO ) )
+        {
+            return false;
+        }
+
+        inactiveSlot().template emplace<StateType>( std::forward<Args>(args)... );
+        m_hasPendingTransition = true;
+        return true;
+    }
+
+    if( isCurrentlyInState<StateType>() )
+    {
+        return false;
+    }
+
+    const EStateTransitionType type = activeSlot().index() != 0 ? STATE_TRANSITION_GOTO : STATE_TRANSITION_INIT;
+
+    if( !canEnterStateType<StateType>( type ) )
+    {
+        return false;
+    }
+
+    inactiveSlot().template emplace<StateType>( std::forward<Args>(args)... );
+    return runTransition( type );
+}
+
+template<class ...States>
+template<class EventType>
+inline bool StaticStatemachine<States...>::dispatchEvent( const EventType& event )
+{
+    bool handled = false;
+    auto handleEvent = [this, &event, &handled]( auto& state ) {
+        handled = detail::callOnEvent( state, *this, event );
+    };
+
+    if( m_isProcessingTransition )
+    {
+        // an event dispatched from a callback; any transition it requests gets picked up by the outer call
+        visitSlot( activeSlot(), handleEvent );
+        return handled;
+    }
+
+    ProcessingGuard guard { *this };
+
+    m_isProcessingTransition = true;
+
+    visitSlot( activeSlot(), handleEvent );
+    runPendingTransitions();
+
+    return handled;
+}
+
+
+
+template<class ...States>
+inline StaticStatemachine<States...>::ProcessingGuard::~ProcessingGuard()
+{
+    statemachine.m_isProcessingTransition = false;
+    statemachine.m_isCurrentlyLeavingAState = false;
+    statemachine.m_hasPendingTransition = false;
+    statemachine.inactiveSlot().template emplace<0>();
+}
+
+template<class ...States>
+inline typename StaticStatemachine<States...>::StateVariantType& StaticStatemachine<States...>::activeSlot() noexcept
+{
+    return m_slots[m_activeSlot];
+}
+
+template<class ...States>
+inline const typename StaticStatemachine<States...>::StateVariantType& StaticStatemachine<States...>::activeSlot() const noexcept
+{
+    return m_slots[m_activeSlot];
+}
+
+template<class ...States>
+inline typename StaticStatemachine<States...>::StateVariantType& StaticStatemachine<States...>::inactiveSlot() noexcept
+{
+    return m_slots[m_activeSlot ^ 1];
+}
+
+template<class ...States>
+template<class StateType>
+inline bool StaticStatemachine<States...>::canEnterStateType( EStateTransitionType type ) const
+{
+    StateTransition transition;
+    transition.type = type;
+    transition.prevState = getCurrentStateType();
+    transition.nextState = stateIdOfIndex( stateIndexOf<StateType>() );
+
+    return detail::callCanEnterStateType<StateType>( *this, transition );
+}
+
+template<class ...States>
+inline StateId StaticStatemachine<States...>::stateIdOfIndex( std::size_t index ) noexcept
+{
+    static const StateId ids[] = { NULL_STATE, stateIdOf<States>()... };
+    return ids[index];
+}
+
+template<class ...States>
+template<class Slot, typename F>
+inline bool StaticStatemachine<States...>::visitSlot( Slot& slot, F&& f )
+{
+    if( slot.index() == 0 )
+    {
+        return false;
+    }
+
+    std::visit( [&f]( auto& state ) {
+        if constexpr( !std::is_same< std::decay_t<decltype(state)>, std::monostate >::value )
+        {
+            f( state );
+        }
+    }, slot );
+
+    return true;
+}
+
+template<class ...States>
+inline bool StaticStatemachine<States...>::performTransition( EStateTransitionType type )
+{
+    StateVariantType& nextSlot = inactiveSlot();
+    StateVariantType& currentSlot = activeSlot();
+
+    StateTransition transition;
+    transition.type = type;
+    transition.prevState = stateIdOfIndex( currentSlot.index() );
+    transition.nextState = stateIdOfIndex( nextSlot.index() );
+
+    bool canTransition = transition.prevState != transition.nextState;
+
+    if( canTransition )
+    {
+        visitSlot( nextSlot, [this, &transition, &canTransition]( auto& state ) {
+            canTransition = detail::callCanEnterState( state, *this, transition );
+        });
+    }
+
+    if( canTransition )
+    {
+        visitSlot( currentSlot, [this, &transition, &canTransition]( auto& state ) {
+            canTransition = detail::callCanLeaveState( state, *this, transition );
+        });
+    }
+
+    if( !canTransition )
+    {
+        nextSlot.template emplace<0>();
+        return false;
+    }
+
+    CHESTNUT_FSM_TRACE_TRANSITION( this, transition );
+
+    m_isCurrentlyLeavingAState = true;
+    visitSlot( currentSlot, [this, &transition]( auto& state ) {
+        detail::callOnLeaveState( state, *this, transition );
+    });
+    m_isCurrentlyLeavingAState = false;
+
+    currentSlot.template emplace<0>();
+    m_activeSlot ^= 1;
+
+    visitSlot( activeSlot(), [this, &transition]( auto& state ) {
+        detail::callOnEnterState( state, *this, transition );
+    });
+
+    return true;
+}
+
+template<class ...States>
+inline bool StaticStatemachine<States...>::runTransition( EStateTransitionType type )
+{
+    ProcessingGuard guard { *this };
+
+    m_isProcessingTransition = true;
+
+    bool result = performTransition( type );
+    runPendingTransitions();
+
+    return result;
+}
+
+template<class ...States>
+inline void StaticStatemachine<States...>::runPendingTransitions()
+{
+    while( m_hasPendingTransition )
+    {
+        m_hasPendingTransition = false;
+        performTransition( STATE_TRANSITION_GOTO );
+    }
+}
+
+} // namespace chestnut::fsm
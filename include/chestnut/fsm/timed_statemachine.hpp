@@ -0,0 +1,232 @@
+/**
+ * @file timed_statemachine.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with the template TimedStatemachine class, which adds delayed transitions to a statemachine
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+
+#ifndef __CHESTNUT_STATEMACHINE_TIMED_STATEMACHINE_H__
+#define __CHESTNUT_STATEMACHINE_TIMED_STATEMACHINE_H__
+
+#include "statemachine.hpp"
+#include "statemachine_observer.hpp"
+#include "timer_service.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Statemachine with delayed transitions executed by a TimerService. Inherit from this type instead of StatemachineClass
+ *
+ * @details
+ * Timers scheduled with it belong to the state that's current at the time, so they implement timeouts of states.
+ * They are kept by an observer of the statemachine (see StatemachineObserver), so only statemachines
+ * that need timers pay for them.
+ *
+ * @tparam StatemachineClass statemachine class to extend, e.g. Statemachine<StateExtension>
+ */
+template< class StatemachineClass = Statemachine<> >
+class TimedStatemachine : public StatemachineClass, private StatemachineObserver
+{
+public:
+    /**
+     * @brief Typedef of the state class of StatemachineClass
+     */
+    typedef typename StatemachineClass::BaseStateType BaseStateType;
+
+
+public:
+    /**
+     * @brief Constructor
+     *
+     */
+    TimedStatemachine();
+
+    /**
+     * @brief Destructor; states are destroyed before the timers, so that they can still use them when left
+     *
+     */
+    ~TimedStatemachine();
+
+
+    /**
+     * @brief Set the timer service used to execute delayed transitions
+     *
+     * @param timerService timer service or nullptr; it has to outlive the statemachine or be unset before it's destroyed
+     *
+     *
+     * @details
+     * Timers scheduled with the previous service are cancelled.
+     * Many statemachines can share one service, then a single thread calling TimerService::advance() drives timeouts of all of them.
+     * That thread has to be the one using these statemachines.
+     *
+     * @see gotoStateAfter(), TimerService
+     */
+    void setTimerService( TimerService *timerService ) noexcept;
+
+    /**
+     * @brief Get the timer service used to execute delayed transitions
+     *
+     * @return timer service or nullptr if none was set
+     */
+    TimerService *getTimerService() const noexcept;
+
+    /**
+     * @brief Schedule gotoState to be called after a delay
+     *
+     * @tparam StateType type of the state statemachine should transition to
+     * @tparam Args types of StateType constructor parameters
+     * @param delay time after which the transition should happen
+     * @param args arguments that should be forwarded to StateType constructor, they're copied
+     *
+     * @return handle of the timer for cancelTimer(), invalid if no timer service was set or the statemachine was not initialized
+     *
+     *
+     * @details
+     * The timer belongs to the current state. When that state is left in any way before the timer fires -
+     * including being covered by pushState - the timer is cancelled. Typically called from onEnterState
+     * to implement timeouts, e.g. a door that closes itself some time after being opened.
+     *
+     * The transition is executed by the thread that calls TimerService::advance().
+     *
+     * @see setTimerService(), gotoState(), cancelTimer()
+     */
+    template< class StateType, class Rep, class Period, typename ...Args >
+    TimerHandle gotoStateAfter( const std::chrono::duration<Rep, Period>& delay, Args&& ...args );
+
+    /**
+     * @brief Schedule pushState to be called after a delay
+     *
+     * @details
+     * The timer belongs to the current state and is cancelled when that state is left.
+     *
+     * @see gotoStateAfter(), pushState()
+     */
+    template< class StateType, class Rep, class Period, typename ...Args >
+    TimerHandle pushStateAfter( const std::chrono::duration<Rep, Period>& delay, Args&& ...args );
+
+    /**
+     * @brief Schedule popState to be called after a delay
+     *
+     * @details
+     * The timer belongs to the current state and is cancelled when that state is left.
+     *
+     * @see gotoStateAfter(), popState()
+     */
+    template< class Rep, class Period >
+    TimerHandle popStateAfter( const std::chrono::duration<Rep, Period>& delay );
+
+    /**
+     * @brief Schedule an event to be handled according to a transition table after a delay
+     *
+     * @details
+     * The timer belongs to the current state and is cancelled when that state is left. The event is copied.
+     *
+     * @see gotoStateAfter(), processEvent()
+     */
+    template< class Table, class Rep, class Period, class EventType >
+    TimerHandle processEventAfter( const std::chrono::duration<Rep, Period>& delay, EventType&& event );
+
+    /**
+     * @brief Schedule a function to be called after a delay, as long as the current state is not left
+     *
+     * @param delay time after which the function should be called
+     * @param callback function taking no arguments
+     *
+     * @return handle of the timer for cancelTimer(), invalid if no timer service was set or the statemachine was not initialized
+     *
+     * @see gotoStateAfter()
+     */
+    template< class Rep, class Period, typename F >
+    TimerHandle callAfter( const std::chrono::duration<Rep, Period>& delay, F&& callback );
+
+    /**
+     * @brief Cancel a timer scheduled by a state of this statemachine
+     *
+     * @param handle handle of the timer
+     * @return whether the timer was still scheduled
+     *
+     * @details
+     * Handles returned by this statemachine refer to its own timer entries, not directly to timers of the TimerService,
+     * so the timer is found in constant time. They shouldn't be passed to the TimerService itself.
+     */
+    bool cancelTimer( TimerHandle handle ) noexcept;
+
+
+private:
+    /**
+     * @brief Timeouts of a state make no sense once it's left, so its timers are cancelled
+     */
+    void onStateLeft( StateBase *state ) noexcept override;
+
+    /**
+     * @brief Schedule a timer owned by the current state
+     *
+     * @param callback function called with the statemachine; it's kept together with the entry position in one callback of the service,
+     * so that the usual callbacks capturing no more than the arguments of the transition fit into std::function without allocating
+     */
+    template< typename F >
+    TimerHandle scheduleStateTimer( TimerService::ClockType::duration delay, F&& callback );
+
+    /**
+     * @brief Cancel timers of a state
+     *
+     * @param owner state whose timers should be cancelled or nullptr to cancel all timers of the statemachine
+     */
+    void cancelStateTimers( StateBase *owner ) noexcept;
+
+    /**
+     * @brief Put the entry back on the free list
+     */
+    void releaseStateTimer( std::uint32_t index ) noexcept;
+
+
+private:
+    static constexpr std::uint32_t NULL_INDEX = UINT32_MAX;
+
+    /**
+     * @brief Timer of a state, which has to be cancelled when the state is left
+     */
+    struct StateTimer
+    {
+        /** State that scheduled the timer or nullptr if the entry is free */
+        StateBase *owner;
+        /** Timer of the service */
+        TimerHandle serviceHandle;
+        /** Incremented every time the entry is reused, so that stale handles can be told apart */
+        std::uint32_t generation;
+        /** Next free entry */
+        std::uint32_t nextFree;
+    };
+    /**
+     * @brief Service that executes delayed transitions; not owned by the statemachine
+     */
+    TimerService *m_timerService;
+    /**
+     * @brief Timers scheduled by states; entries are reused and handles returned to states are their positions
+     */
+    std::vector< StateTimer > m_stateTimers;
+    std::uint32_t m_firstFreeStateTimer;
+    /**
+     * @brief Number of entries in use, so that transitions of a statemachine without timers don't look through the entries
+     */
+    std::size_t m_stateTimerCount;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "timed_statemachine.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_TIMED_STATEMACHINE_H__
@@ -0,0 +1,220 @@
+#include "config.hpp"
+
+#include <cassert>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace chestnut::fsm
+{
+
+template<class StatemachineClass>
+TimedStatemachine<StatemachineClass>::TimedStatemachine()
+{
+    static_assert( std::is_base_of<StatemachineBase, StatemachineClass>::value,
+        "StatemachineClass has to be a child of StatemachineBase!" );
+
+    m_timerService = nullptr;
+    m_firstFreeStateTimer = NULL_INDEX;
+    m_stateTimerCount = 0;
+
+    this->attachObserver( *this );
+}
+
+template<class StatemachineClass>
+TimedStatemachine<StatemachineClass>::~TimedStatemachine()
+{
+    // states can still schedule and cancel timers when they're left
+    this->destroyStates();
+
+    // also timers scheduled while the states were being destroyed
+    cancelStateTimers( nullptr );
+
+    this->detachObserver( *this );
+}
+
+template<class StatemachineClass>
+void TimedStatemachine<StatemachineClass>::setTimerService( TimerService *timerService ) noexcept
+{
+    cancelStateTimers( nullptr );
+    m_timerService = timerService;
+}
+
+template<class StatemachineClass>
+TimerService *TimedStatemachine<StatemachineClass>::getTimerService() const noexcept
+{
+    return m_timerService;
+}
+
+template<class StatemachineClass>
+template<class StateType, class Rep, class Period, typename ...Args>
+TimerHandle TimedStatemachine<StatemachineClass>::gotoStateAfter( const std::chrono::duration<Rep, Period>& delay, Args&& ...args )
+{
+    static_assert( std::is_base_of<BaseStateType, StateType>::value,
+        "StateType is not a state of this statemachine! It does not inherit from its BaseStateType!" );
+
+    return scheduleStateTimer( std::chrono::ceil<TimerService::ClockType::duration>( delay ),
+        [argsTuple = std::make_tuple( std::forward<Args>(args)... )]( TimedStatemachine& machine ) mutable {
+            std::apply( [&machine]( auto&& ...argsUnpacked ) {
+                machine.template gotoState<StateType>( std::forward<decltype(argsUnpacked)>(argsUnpacked)... );
+            }, std::move( argsTuple ) );
+        });
+}
+
+template<class StatemachineClass>
+template<class StateType, class Rep, class Period, typename ...Args>
+TimerHandle TimedStatemachine<StatemachineClass>::pushStateAfter( const std::chrono::duration<Rep, Period>& delay, Args&& ...args )
+{
+    static_assert( std::is_base_of<BaseStateType, StateType>::value,
+        "StateType is not a state of this statemachine! It does not inherit from its BaseStateType!" );
+
+    return scheduleStateTimer( std::chrono::ceil<TimerService::ClockType::duration>( delay ),
+        [argsTuple = std::make_tuple( std::forward<Args>(args)... )]( TimedStatemachine& machine ) mutable {
+            std::apply( [&machine]( auto&& ...argsUnpacked ) {
+                machine.template pushState<StateType>( std::forward<decltype(argsUnpacked)>(argsUnpacked)... );
+            }, std::move( argsTuple ) );
+        });
+}
+
+template<class StatemachineClass>
+template<class Rep, class Period>
+TimerHandle TimedStatemachine<StatemachineClass>::popStateAfter( const std::chrono::duration<Rep, Period>& delay )
+{
+    return scheduleStateTimer( std::chrono::ceil<TimerService::ClockType::duration>( delay ), []( TimedStatemachine& machine ) {
+        machine.popState();
+    });
+}
+
+template<class StatemachineClass>
+template<class Table, class Rep, class Period, class EventType>
+TimerHandle TimedStatemachine<StatemachineClass>::processEventAfter( const std::chrono::duration<Rep, Period>& delay, EventType&& event )
+{
+    typedef typename std::decay<EventType>::type EventValueType;
+    static_assert( Table::template handlesEvent<EventValueType>, "EventType is not handled by any transition in the table!" );
+
+    return scheduleStateTimer( std::chrono::ceil<TimerService::ClockType::duration>( delay ),
+        [eventCopy = EventValueType( std::forward<EventType>( event ) )]( TimedStatemachine& machine ) {
+            machine.template processEvent<Table>( eventCopy );
+        });
+}
+
+template<class StatemachineClass>
+template<class Rep, class Period, typename F>
+TimerHandle TimedStatemachine<StatemachineClass>::callAfter( const std::chrono::duration<Rep, Period>& delay, F&& callback )
+{
+    return scheduleStateTimer( std::chrono::ceil<TimerService::ClockType::duration>( delay ),
+        [callback = std::forward<F>( callback )]( TimedStatemachine& ) mutable {
+            callback();
+        });
+}
+
+template<class StatemachineClass>
+bool TimedStatemachine<StatemachineClass>::cancelTimer( TimerHandle handle ) noexcept
+{
+    if( !handle.isValid() || handle.index >= m_stateTimers.size() )
+    {
+        return false;
+    }
+
+    StateTimer& timer = m_stateTimers[handle.index];
+    if( !timer.owner || timer.generation != handle.generation )
+    {
+        return false;
+    }
+
+    const bool wasScheduled = m_timerService->cancel( timer.serviceHandle );
+    releaseStateTimer( handle.index );
+    return wasScheduled;
+}
+
+template<class StatemachineClass>
+void TimedStatemachine<StatemachineClass>::onStateLeft( StateBase *state ) noexcept
+{
+    if( m_stateTimerCount != 0 )
+    {
+        cancelStateTimers( state );
+    }
+}
+
+template<class StatemachineClass>
+template<typename F>
+TimerHandle TimedStatemachine<StatemachineClass>::scheduleStateTimer( TimerService::ClockType::duration delay, F&& callback )
+{
+    assert( m_timerService && "Timer service was not set!" );
+
+    StateBase *owner = StatemachineBase::getCurrentState();
+    if( !m_timerService || !owner )
+    {
+        return TimerHandle();
+    }
+
+    // the entry is taken first, so that a timer is never left scheduled without it
+    std::uint32_t index = m_firstFreeStateTimer;
+    if( index != NULL_INDEX )
+    {
+        m_firstFreeStateTimer = m_stateTimers[index].nextFree;
+    }
+    else
+    {
+        index = (std::uint32_t)m_stateTimers.size();
+        m_stateTimers.emplace_back();
+        m_stateTimers[index].generation = 0;
+    }
+
+    StateTimer& timer = m_stateTimers[index];
+    timer.owner = owner;
+    m_stateTimerCount++;
+
+    // the entry is released before the call, as the callback can leave the state or schedule new timers
+    auto fire = [this, index, callback = std::forward<F>( callback )]() mutable {
+        releaseStateTimer( index );
+        callback( *this );
+    };
+
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    try
+    {
+        timer.serviceHandle = m_timerService->schedule( delay, std::move( fire ) );
+    }
+    catch(...)
+    {
+        releaseStateTimer( index );
+        throw;
+    }
+#else
+    timer.serviceHandle = m_timerService->schedule( delay, std::move( fire ) );
+#endif
+
+    TimerHandle handle;
+    handle.index = index;
+    handle.generation = timer.generation;
+    return handle;
+}
+
+template<class StatemachineClass>
+void TimedStatemachine<StatemachineClass>::cancelStateTimers( StateBase *owner ) noexcept
+{
+    for( std::uint32_t i = 0; m_stateTimerCount != 0 && i < m_stateTimers.size(); i++ )
+    {
+        StateTimer& timer = m_stateTimers[i];
+        if( timer.owner && ( !owner || timer.owner == owner ) )
+        {
+            m_timerService->cancel( timer.serviceHandle );
+            releaseStateTimer( i );
+        }
+    }
+}
+
+template<class StatemachineClass>
+void TimedStatemachine<StatemachineClass>::releaseStateTimer( std::uint32_t index ) noexcept
+{
+    StateTimer& timer = m_stateTimers[index];
+    timer.owner = nullptr;
+    timer.serviceHandle = TimerHandle();
+    timer.generation++;
+    timer.nextFree = m_firstFreeStateTimer;
+    m_firstFreeStateTimer = index;
+    m_stateTimerCount--;
+}
+
+} // namespace chestnut::fsm
@@ -0,0 +1,220 @@
+/**
+ * @file timer_service.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with the hierarchical timing wheel used for delayed transitions
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_TIMER_SERVICE_H__
+#define __CHESTNUT_STATEMACHINE_TIMER_SERVICE_H__
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Identifier of a timer scheduled with TimerService
+ *
+ * @details
+ * Handles stay safe to use after their timer fires or gets cancelled - they simply stop referring to any timer.
+ */
+struct TimerHandle
+{
+    /** Position of the timer in the service's timer pool */
+    std::uint32_t index = UINT32_MAX;
+    /** Incremented every time the pool slot is reused, so that stale handles can be told apart */
+    std::uint32_t generation = 0;
+
+    /** Return whether the handle was returned by a successful schedule call */
+    bool isValid() const noexcept { return index != UINT32_MAX; }
+};
+
+
+/**
+ * @brief Service executing callbacks after a given delay, shared by any number of statemachines
+ *
+ * @details
+ * Timers are kept in a hierarchical timing wheel: 4 levels of 256 slots, each level counting ticks 256 times slower than the one below.
+ * Scheduling and cancelling a timer take constant time regardless of how many timers there are.
+ * Advancing the time by one tick processes just one slot, timers from higher levels are moved down once their slot comes up.
+ * Delays longer than 2^32 ticks are supported, timers with them just get moved around a few more times.
+ *
+ * Timers are stored in a pool which grows when needed and is reused afterwards, so in a steady state scheduling doesn't allocate
+ * (unless the callback itself doesn't fit in std::function's inline storage).
+ *
+ * The service is not thread-safe. A single thread should drive it by calling advance() regularly and callbacks are executed
+ * on that thread. That thread should then also be the one using the statemachines which schedule timers.
+ * Statemachines owned by other threads can be reached through ConcurrentStatemachine::post().
+ *
+ * Callbacks can schedule and cancel timers, including other timers due in the same tick.
+ *
+ * @see TimedStatemachine::setTimerService()
+ */
+class TimerService
+{
+public:
+    typedef std::chrono::steady_clock ClockType;
+
+    /**
+     * @brief Type of timer callbacks
+     */
+    typedef std::function<void()> CallbackType;
+
+    /**
+     * @brief Number of levels of the wheel
+     */
+    static constexpr unsigned LEVEL_COUNT = 4;
+    /**
+     * @brief Number of bits of the tick counter handled by one level
+     */
+    static constexpr unsigned LEVEL_BITS = 8;
+    /**
+     * @brief Number of slots on one level
+     */
+    static constexpr unsigned SLOT_COUNT = 1u << LEVEL_BITS;
+
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param tickDuration resolution of the timers; delays are rounded up to whole ticks
+     * @param startTime point in time corresponding to tick 0
+     */
+    explicit TimerService( ClockType::duration tickDuration = std::chrono::milliseconds(1), ClockType::time_point startTime = ClockType::now() );
+
+    TimerService( const TimerService& ) = delete;
+    TimerService& operator=( const TimerService& ) = delete;
+
+
+    /**
+     * @brief Schedule a callback to be executed after a delay
+     *
+     * @param delay time after which the callback should be executed, counted from the last advance()
+     * @param callback function to execute
+     * @return handle of the timer
+     *
+     * @details
+     * The timer fires during the first advance() that gets past its expiry, but never during the tick in which it was scheduled.
+     */
+    TimerHandle schedule( ClockType::duration delay, CallbackType callback );
+
+    /**
+     * @brief Cancel a timer
+     *
+     * @param handle handle of the timer
+     * @return whether the timer was still scheduled
+     */
+    bool cancel( TimerHandle handle ) noexcept;
+
+    /**
+     * @brief Return whether the timer is still waiting to fire
+     *
+     * @param handle handle of the timer
+     */
+    bool isScheduled( TimerHandle handle ) const noexcept;
+
+    /**
+     * @brief Get the number of timers waiting to fire
+     */
+    std::size_t getScheduledCount() const noexcept;
+
+
+    /**
+     * @brief Advance the time of the service, executing callbacks of all timers that have expired up to this point
+     *
+     * @param now current time
+     * @return number of executed callbacks
+     */
+    std::size_t advance( ClockType::time_point now );
+
+    /**
+     * @brief Advance the time of the service by a number of ticks
+     *
+     * @param ticks number of ticks
+     * @return number of executed callbacks
+     */
+    std::size_t advanceTicks( std::uint64_t ticks );
+
+    /**
+     * @brief Get the number of ticks the service has processed so far
+     */
+    std::uint64_t getCurrentTick() const noexcept;
+
+    /**
+     * @brief Get the duration of a single tick
+     */
+    ClockType::duration getTickDuration() const noexcept;
+
+
+private:
+    static constexpr std::uint32_t NULL_INDEX = UINT32_MAX;
+
+    struct Timer
+    {
+        std::uint64_t expiryTick;
+        CallbackType callback;
+        // neighbours on the slot list or the next free timer
+        std::uint32_t prev;
+        std::uint32_t next;
+        std::uint32_t generation;
+        // position in m_slotHeads or NULL_INDEX if the timer is not scheduled
+        std::uint32_t slot;
+    };
+
+    std::uint32_t allocateTimer();
+    void freeTimer( std::uint32_t index ) noexcept;
+
+    /**
+     * @brief Put the timer on the slot list matching its expiry
+     */
+    void insertTimer( std::uint32_t index ) noexcept;
+    /**
+     * @brief Take the timer off the slot list it's on
+     */
+    void unlinkTimer( std::uint32_t index ) noexcept;
+
+    /**
+     * @brief Move timers from a slot of a higher level to lower levels
+     */
+    void cascade( unsigned level, unsigned slotIndex ) noexcept;
+
+    /**
+     * @brief Process the next tick
+     *
+     * @return number of executed callbacks
+     */
+    std::size_t tick();
+
+
+private:
+    ClockType::duration m_tickDuration;
+    ClockType::time_point m_startTime;
+    std::uint64_t m_currentTick;
+
+    std::vector< Timer > m_timers;
+    std::uint32_t m_firstFreeTimer;
+    std::size_t m_scheduledCount;
+
+    /**
+     * @brief First timer on each slot list; LEVEL_COUNT * SLOT_COUNT entries
+     */
+    std::vector< std::uint32_t > m_slotHeads;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "timer_service.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_TIMER_SERVICE_H__
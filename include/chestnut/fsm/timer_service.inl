@@ -0,0 +1,242 @@
+#include <cassert>
+#include <utility>
+
+namespace chestnut::fsm
+{
+
+inline TimerService::TimerService( ClockType::duration tickDuration, ClockType::time_point startTime )
+: m_tickDuration( tickDuration ), m_startTime( startTime ), m_currentTick( 0 ),
+  m_firstFreeTimer( NULL_INDEX ), m_scheduledCount( 0 ),
+  m_slotHeads( LEVEL_COUNT * SLOT_COUNT, NULL_INDEX )
+{
+    assert( tickDuration.count() > 0 && "Tick duration has to be positive" );
+}
+
+inline TimerHandle TimerService::schedule( ClockType::duration delay, CallbackType callback )
+{
+    std::uint64_t ticks = 1;
+    if( delay > m_tickDuration )
+    {
+        // round up, so that the timer never fires too early
+        ticks = static_cast<std::uint64_t>( ( delay + m_tickDuration - ClockType::duration(1) ) / m_tickDuration );
+    }
+
+    std::uint32_t index = allocateTimer();
+    Timer& timer = m_timers[index];
+    timer.expiryTick = m_currentTick + ticks;
+    timer.callback = std::move( callback );
+    insertTimer( index );
+    m_scheduledCount++;
+
+    TimerHandle handle;
+    handle.index = index;
+    handle.generation = timer.generation;
+    return handle;
+}
+
+inline bool TimerService::cancel( TimerHandle handle ) noexcept
+{
+    if( !isScheduled( handle ) )
+    {
+        return false;
+    }
+
+    unlinkTimer( handle.index );
+    freeTimer( handle.index );
+    m_scheduledCount--;
+    return true;
+}
+
+inline bool TimerService::isScheduled( TimerHandle handle ) const noexcept
+{
+    return handle.index < m_timers.size()
+        && m_timers[handle.index].generation == handle.generation
+        && m_timers[handle.index].slot != NULL_INDEX;
+}
+
+inline std::size_t TimerService::getScheduledCount() const noexcept
+{
+    return m_scheduledCount;
+}
+
+inline std::size_t TimerService::advance( ClockType::time_point now )
+{
+    if( now <= m_startTime )
+    {
+        return 0;
+    }
+
+    std::uint64_t targetTick = static_cast<std::uint64_t>( ( now - m_startTime ) / m_tickDuration );
+    if( targetTick <= m_currentTick )
+    {
+        return 0;
+    }
+
+    return advanceTicks( targetTick - m_currentTick );
+}
+
+inline std::size_t TimerService::advanceTicks( std::uint64_t ticks )
+{
+    std::size_t fired = 0;
+    for( std::uint64_t i = 0; i < ticks; i++ )
+    {
+        fired += tick();
+    }
+    return fired;
+}
+
+inline std::uint64_t TimerService::getCurrentTick() const noexcept
+{
+    return m_currentTick;
+}
+
+inline TimerService::ClockType::duration TimerService::getTickDuration() const noexcept
+{
+    return m_tickDuration;
+}
+
+inline std::uint32_t TimerService::allocateTimer()
+{
+    if( m_firstFreeTimer != NULL_INDEX )
+    {
+        std::uint32_t index = m_firstFreeTimer;
+        m_firstFreeTimer = m_timers[index].next;
+        return index;
+    }
+
+    assert( m_timers.size() < NULL_INDEX && "Too many timers" );
+
+    Timer timer;
+    timer.expiryTick = 0;
+    timer.prev = NULL_INDEX;
+    timer.next = NULL_INDEX;
+    timer.generation = 0;
+    timer.slot = NULL_INDEX;
+    m_timers.push_back( std::move( timer ) );
+
+    return static_cast<std::uint32_t>( m_timers.size() - 1 );
+}
+
+inline void TimerService::freeTimer( std::uint32_t index ) noexcept
+{
+    Timer& timer = m_timers[index];
+    timer.callback = nullptr;
+    timer.slot = NULL_INDEX;
+    timer.prev = NULL_INDEX;
+    // invalidates handles to this timer
+    timer.generation++;
+    timer.next = m_firstFreeTimer;
+    m_firstFreeTimer = index;
+}
+
+inline void TimerService::insertTimer( std::uint32_t index ) noexcept
+{
+    Timer& timer = m_timers[index];
+
+    // the top level can't tell apart expiries 2^32 ticks apart, 
+    // so a timer further away than that is put as far as possible and inserted again once it's cascaded
+    const std::uint64_t maxDelta = ( std::uint64_t(1) << ( LEVEL_BITS * LEVEL_COUNT ) ) - 1;
+    std::uint64_t delta = timer.expiryTick - m_currentTick;
+    std::uint64_t expiry = delta > maxDelta ? m_currentTick + maxDelta : timer.expiryTick;
+    if( delta > maxDelta )
+    {
+        delta = maxDelta;
+    }
+
+    unsigned level = 0;
+    while( level < LEVEL_COUNT - 1 && delta >= ( std::uint64_t(1) << ( LEVEL_BITS * ( level + 1 ) ) ) )
+    {
+        level++;
+    }
+
+    std::uint32_t slot = level * SLOT_COUNT + static_cast<std::uint32_t>( ( expiry >> ( LEVEL_BITS * level ) ) & ( SLOT_COUNT - 1 ) );
+
+    timer.slot = slot;
+    timer.prev = NULL_INDEX;
+    timer.next = m_slotHeads[slot];
+    if( timer.next != NULL_INDEX )
+    {
+        m_timers[timer.next].prev = index;
+    }
+    m_slotHeads[slot] = index;
+}
+
+inline void TimerService::unlinkTimer( std::uint32_t index ) noexcept
+{
+    Timer& timer = m_timers[index];
+
+    if( timer.prev != NULL_INDEX )
+    {
+        m_timers[timer.prev].next = timer.next;
+    }
+    else
+    {
+        m_slotHeads[timer.slot] = timer.next;
+    }
+
+    if( timer.next != NULL_INDEX )
+    {
+        m_timers[timer.next].prev = timer.prev;
+    }
+
+    timer.prev = NULL_INDEX;
+    timer.next = NULL_INDEX;
+}
+
+inline void TimerService::cascade( unsigned level, unsigned slotIndex ) noexcept
+{
+    std::uint32_t slot = level * SLOT_COUNT + slotIndex;
+
+    // timers from this slot always land on lower levels, so the loop ends
+    while( m_slotHeads[slot] != NULL_INDEX )
+    {
+        std::uint32_t index = m_slotHeads[slot];
+        unlinkTimer( index );
+        insertTimer( index );
+    }
+}
+
+inline std::size_t TimerService::tick()
+{
+    m_currentTick++;
+
+    unsigned slotIndex = static_cast<unsigned>( m_currentTick & ( SLOT_COUNT - 1 ) );
+
+    // when a level wraps around, timers from the next slot of the level above are moved down
+    if( slotIndex == 0 )
+    {
+        for( unsigned level = 1; level < LEVEL_COUNT; level++ )
+        {
+            unsigned upperSlotIndex = static_cast<unsigned>( ( m_currentTick >> ( LEVEL_BITS * level ) ) & ( SLOT_COUNT - 1 ) );
+            cascade( level, upperSlotIndex );
+            if( upperSlotIndex != 0 )
+            {
+                break;
+            }
+        }
+    }
+
+    // timers are taken one by one, because a callback can cancel other timers from this slot
+    std::size_t fired = 0;
+    while( m_slotHeads[slotIndex] != NULL_INDEX )
+    {
+        std::uint32_t index = m_slotHeads[slotIndex];
+        assert( m_timers[index].expiryTick == m_currentTick );
+
+        unlinkTimer( index );
+        CallbackType callback = std::move( m_timers[index].callback );
+        freeTimer( index );
+        m_scheduledCount--;
+        fired++;
+
+        // the pool can grow during the call, so the callback is no longer kept in it
+        if( callback )
+        {
+            callback();
+        }
+    }
+
+    return fired;
+}
+
+} // namespace chestnut::fsm
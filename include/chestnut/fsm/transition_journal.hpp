@@ -0,0 +1,360 @@
+/**
+ * @file transition_journal.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with TransitionJournal, an append-only file of state transitions written with group commit, and TransitionJournalReader used to replay it
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_TRANSITION_JOURNAL_H__
+#define __CHESTNUT_STATEMACHINE_TRANSITION_JOURNAL_H__
+
+#include "state_transition.hpp"
+#include "statemachine_base.hpp"
+#include "fleet_snapshot.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief How long TransitionJournal::append() waits for its record to be safely stored
+ */
+enum EJournalDurability
+{
+    /** Batches are written, but never synced; records survive a crash of the process, but not of the operating system */
+    JOURNAL_DURABILITY_NONE,
+    /** Batches are written and synced in the background; append() doesn't wait and a system crash loses at most the last flush interval */
+    JOURNAL_DURABILITY_ASYNC,
+    /** append() returns once its record is synced; records appended in the meantime are synced together with it */
+    JOURNAL_DURABILITY_SYNC
+};
+
+/**
+ * @brief Settings of a TransitionJournal
+ */
+struct TransitionJournalConfig
+{
+    EJournalDurability durability = JOURNAL_DURABILITY_ASYNC;
+    /** Longest time a record waits before its batch is written; not used with JOURNAL_DURABILITY_SYNC, where a batch is written as soon as the previous one is synced */
+    std::chrono::microseconds flushInterval = std::chrono::milliseconds(2);
+    /** Size of buffered records in bytes at which the batch is written without waiting for the interval */
+    std::size_t batchSize = 64 * 1024;
+};
+
+
+/**
+ * @brief Durable, append-only record of state transitions in a file
+ *
+ * @details
+ * A statemachine appends every transition it makes to the journal through a TransitionJournalObserver attached to it,
+ * along with the identifier the statemachine was given there and a sequence number.
+ * After a crash, statemachines are brought back by restoring their last snapshot (see SnapshotReader::restoreStatemachine())
+ * and replaying records that came after it with TransitionJournalReader::replay().
+ *
+ * Records are buffered in memory and written by a background thread in batches. Syncing a file to the disk
+ * is what makes durability expensive, so a single sync covers the whole batch - with JOURNAL_DURABILITY_SYNC
+ * every thread that appended to the batch waits for the same sync (group commit). The durability setting trades
+ * the latency of append() for how many recent transitions can be lost in a crash.
+ *
+ * Each batch in the file is checksummed, so a batch torn by a crash is detected and dropped. When an existing journal
+ * is opened, such a tail is cut off and numbering continues after the last complete batch.
+ * State types are stored by their names (see getStateTypeName()), each once per opening of the journal, so records stay
+ * meaningful after the program is restarted. All numbers are in the byte order of the machine writing the journal.
+ *
+ * All methods can be called from any thread.
+ */
+class TransitionJournal
+{
+public:
+    TransitionJournal();
+
+    /**
+     * @brief Destructor; writes and syncs the remaining records and closes the file
+     */
+    ~TransitionJournal();
+
+    TransitionJournal( const TransitionJournal& ) = delete;
+    TransitionJournal& operator=( const TransitionJournal& ) = delete;
+
+
+    /**
+     * @brief Open a journal file for appending, creating it if it doesn't exist
+     *
+     * @param path path of the file
+     * @param config durability settings
+     * @return whether the file could be opened; it can't if it isn't a journal or was written on a machine with a different byte order
+     */
+    bool open( const char *path, const TransitionJournalConfig& config = TransitionJournalConfig() );
+
+    /**
+     * @brief Write and sync the remaining records and close the file
+     */
+    void close();
+
+    bool isOpen() const;
+
+
+    /**
+     * @brief Append a transition record
+     *
+     * @param machineId identifier of the statemachine, meaningful to the user
+     * @param transition transition that took place
+     * @return sequence number of the record or 0 if the journal is not open or has failed
+     *
+     * @details
+     * With JOURNAL_DURABILITY_SYNC it returns once the record is synced.
+     */
+    std::uint64_t append( std::uint64_t machineId, const StateTransition& transition ) noexcept;
+
+    /**
+     * @brief Wait until all records appended so far are written and synced, no matter the durability setting
+     *
+     * @return whether they were; false if the journal is not open or writing has failed
+     */
+    bool sync();
+
+
+    /**
+     * @brief Get the sequence number of the last appended record or 0 if there's none
+     *
+     * @details
+     * Store it with a snapshot of statemachines, so that replaying the journal can start after it.
+     */
+    std::uint64_t getLastSequence() const;
+
+    /**
+     * @brief Get the sequence number of the last record known to be synced
+     */
+    std::uint64_t getDurableSequence() const;
+
+    /**
+     * @brief Get the number of syncs done so far; appended records divided by it tells how well syncs are shared
+     */
+    std::uint64_t getSyncCount() const;
+
+    /**
+     * @brief Return whether writing or syncing the file has failed; records appended after that are lost
+     */
+    bool hasFailed() const;
+
+
+private:
+    /**
+     * @brief Find the end of the last complete batch of an existing journal file
+     *
+     * @return whether the file is a journal (or is empty)
+     */
+    static bool scanExistingFile( const char *path, std::uint64_t& validSize, std::uint64_t& lastSequence );
+
+    /**
+     * @brief Get the index under which a state type is stored in the file, writing its name first if it wasn't written yet
+     */
+    std::uint16_t journalStateIndex( StateId id );
+
+    /**
+     * @brief Start a new batch in the pending buffer if it's empty
+     */
+    void beginBatch();
+
+    /**
+     * @brief Body of the background thread, which writes and syncs batches
+     */
+    void runFlusher();
+
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_flushCondition;
+    std::condition_variable m_durableCondition;
+    std::thread m_flusher;
+
+    std::FILE *m_file;
+    TransitionJournalConfig m_config;
+
+    /**
+     * @brief Batch being filled by append() and the one being written by the flusher
+     */
+    std::vector< unsigned char > m_pendingBatch;
+    std::vector< unsigned char > m_writtenBatch;
+    std::uint32_t m_pendingRecordCount;
+    std::uint64_t m_pendingFirstSequence;
+    std::chrono::steady_clock::time_point m_pendingSince;
+
+    /**
+     * @brief Index in the file of every state type already written or 0, indexed by state identifier
+     */
+    std::vector< std::uint16_t > m_stateIndices;
+    std::uint16_t m_stateIndexCount;
+
+    std::uint64_t m_lastSequence;
+    std::uint64_t m_durableSequence;
+    std::uint64_t m_syncCount;
+    bool m_isSyncRequested;
+    bool m_isStopping;
+    bool m_hasFailed;
+};
+
+
+/**
+ * @brief Observer appending every transition of the statemachine it's attached to to a TransitionJournal
+ *
+ * @details
+ * Attach it with StatemachineBase::attachObserver(). Only statemachines with such an observer pay for journaling.
+ * With JOURNAL_DURABILITY_SYNC the transition waits for the record to be synced before onEnterState is called.
+ */
+class TransitionJournalObserver : public StatemachineObserver
+{
+public:
+    /**
+     * @param journal journal to append to; it has to outlive the observer
+     * @param machineId identifier of the statemachine in the records
+     */
+    TransitionJournalObserver( TransitionJournal& journal, std::uint64_t machineId ) noexcept;
+
+    TransitionJournal& getJournal() const noexcept;
+    std::uint64_t getMachineId() const noexcept;
+
+
+protected:
+    void onTransition( const StateTransition& transition ) override;
+
+
+private:
+    TransitionJournal& m_journal;
+    std::uint64_t m_machineId;
+};
+
+
+/**
+ * @brief A transition read from a journal
+ */
+struct JournalRecord
+{
+    std::uint64_t sequence;
+    std::uint64_t machineId;
+    EStateTransitionType type;
+    /** Indices of the state types in the journal, 0 for NULL_STATE; see TransitionJournalReader::getStateTypeName() */
+    std::uint16_t prevStateIndex;
+    std::uint16_t nextStateIndex;
+};
+
+/**
+ * @brief Reader of a file written by TransitionJournal
+ *
+ * @details
+ * Records are read in order up to the end of the last complete batch. A batch torn by a crash ends the reading.
+ */
+class TransitionJournalReader
+{
+public:
+    TransitionJournalReader() noexcept;
+
+    /**
+     * @brief Open a journal file
+     *
+     * @return whether it's a journal file written on a machine with the same byte order
+     */
+    bool open( const char *path );
+
+    /**
+     * @brief Read the next record
+     *
+     * @return whether there was one
+     */
+    bool next( JournalRecord& record );
+
+    /**
+     * @brief Get the name of a state type of the record read last
+     *
+     * @param index index of the state type from JournalRecord
+     * @return name as given by getStateTypeName() when the journal was written; empty for index 0 or an unknown index
+     */
+    const std::string& getStateTypeName( std::uint16_t index ) const noexcept;
+
+    /**
+     * @brief Return whether reading stopped at a damaged or incomplete batch instead of the end of the file
+     */
+    bool isTruncated() const noexcept;
+
+    /**
+     * @brief Get the sequence number of the last record read, or of the last one replayed successfully
+     */
+    std::uint64_t getLastSequence() const noexcept;
+
+
+    /**
+     * @brief Apply records following a snapshot to the statemachines restored from it
+     *
+     * @tparam StateTypes all state types that can appear in the journal, they have to be default constructible
+     * @param afterSequence sequence number stored with the snapshot; earlier records and the one with this number are skipped
+     * @param getMachine function taking the machine identifier and returning StatemachineBase* to replay the record on,
+     *                   or nullptr if the record should be skipped; it can create statemachines that didn't exist at the time of the snapshot
+     * @return number of records replayed or -1 if a record didn't match the state of its statemachine or had a state type not listed in StateTypes
+     *
+     * @details
+     * Records are applied directly to the state stacks, so states are constructed and deleted without any of their callbacks
+     * and data of states is not recovered - only which states each statemachine is in. Neither guards nor observers are consulted.
+     * On failure getLastSequence() tells the sequence number of the last record that was applied.
+     */
+    template< class ...StateTypes, typename F >
+    std::int64_t replay( std::uint64_t afterSequence, F&& getMachine );
+
+
+private:
+    /**
+     * @brief Move to the next complete batch
+     *
+     * @return whether there was one
+     */
+    bool nextBatch();
+
+    /**
+     * @brief Apply a single transition to the state stack of a statemachine
+     *
+     * @return false if the transition doesn't start from the current state of the statemachine or is not possible in it
+     */
+    template< class ...StateTypes >
+    static bool replayTransition( StatemachineBase& statemachine, const StateTransition& transition );
+
+
+private:
+    detail::MappedFile m_file;
+    const unsigned char *m_position;
+    const unsigned char *m_batchEnd;
+    std::uint64_t m_fileOffset;
+    /**
+     * @brief Names of state types indexed by their index in the journal
+     */
+    std::vector< std::string > m_stateNames;
+    /**
+     * @brief Identifiers of the state types found by replay(), NULL_STATE if not yet looked up
+     */
+    std::vector< StateId > m_stateIds;
+    std::uint64_t m_batchLastSequence;
+    std::uint64_t m_lastSequence;
+    bool m_isTruncated;
+
+    // Befriended so that it can find the end of the last complete batch when opening a journal
+    friend TransitionJournal;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "transition_journal.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_TRANSITION_JOURNAL_H__
@@ -0,0 +1,811 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#if defined(_WIN32)
+    #include <io.h>
+#elif defined(__unix__) || defined(__APPLE__)
+    #include <unistd.h>
+#endif
+
+namespace chestnut::fsm
+{
+
+namespace detail
+{
+    /**
+     * @brief Header at the start of a journal file
+     */
+    struct JournalFileHeader
+    {
+        char magic[4];
+        std::uint16_t formatVersion;
+        std::uint16_t headerSize;
+        std::uint32_t byteOrderMark;
+        std::uint32_t reserved;
+    };
+
+    /**
+     * @brief Header of a batch of entries, written at once
+     */
+    struct JournalBatchHeader
+    {
+        std::uint32_t magic;
+        /** Size of the entries following the header */
+        std::uint32_t size;
+        /** CRC-32 of everything after this field up to the end of the batch */
+        std::uint32_t checksum;
+        std::uint32_t recordCount;
+        std::uint64_t firstSequence;
+    };
+
+    enum EJournalEntryTag : std::uint8_t
+    {
+        JOURNAL_ENTRY_TRANSITION = 1,
+        JOURNAL_ENTRY_STATE_TYPE = 2
+    };
+
+    struct JournalTransitionEntry
+    {
+        std::uint8_t tag;
+        std::uint8_t type;
+        std::uint16_t prevState;
+        std::uint16_t nextState;
+        std::uint16_t reserved;
+        std::uint64_t machineId;
+        std::uint64_t sequence;
+    };
+
+    /**
+     * @brief Definition of a state type index, followed by the name of the type
+     */
+    struct JournalStateTypeEntry
+    {
+        std::uint8_t tag;
+        std::uint8_t reserved;
+        std::uint16_t index;
+        std::uint16_t nameLength;
+        std::uint16_t reserved2;
+    };
+
+    static_assert( sizeof(JournalFileHeader) == 16, "JournalFileHeader must not have padding!" );
+    static_assert( sizeof(JournalBatchHeader) == 24, "JournalBatchHeader must not have padding!" );
+    static_assert( sizeof(JournalTransitionEntry) == 24, "JournalTransitionEntry must not have padding!" );
+    static_assert( sizeof(JournalStateTypeEntry) == 8, "JournalStateTypeEntry must not have padding!" );
+
+    constexpr char JOURNAL_FILE_MAGIC[4] = { 'C', 'F', 'J', 'L' };
+    constexpr std::uint16_t JOURNAL_FORMAT_VERSION = 1;
+    constexpr std::uint32_t JOURNAL_BYTE_ORDER_MARK = 0x01020304;
+    constexpr std::uint32_t JOURNAL_BATCH_MAGIC = 0x424a4643; // "CFJB"
+    /** Offset of the first byte covered by the checksum of a batch */
+    constexpr std::size_t JOURNAL_BATCH_CHECKSUM_START = offsetof( JournalBatchHeader, recordCount );
+
+
+    struct Crc32Table
+    {
+        std::uint32_t values[256];
+    };
+
+    constexpr Crc32Table makeCrc32Table() noexcept
+    {
+        Crc32Table table {};
+        for( std::uint32_t i = 0; i < 256; i++ )
+        {
+            std::uint32_t value = i;
+            for( int bit = 0; bit < 8; bit++ )
+            {
+                value = ( value & 1 ) ? ( value >> 1 ) ^ 0xedb88320u : ( value >> 1 );
+            }
+            table.values[i] = value;
+        }
+        return table;
+    }
+
+    inline constexpr Crc32Table CRC32_TABLE = makeCrc32Table();
+
+    inline std::uint32_t crc32( const unsigned char *data, std::size_t size ) noexcept
+    {
+        std::uint32_t crc = 0xffffffffu;
+        for( std::size_t i = 0; i < size; i++ )
+        {
+            crc = CRC32_TABLE.values[ ( crc ^ data[i] ) & 0xff ] ^ ( crc >> 8 );
+        }
+        return crc ^ 0xffffffffu;
+    }
+
+    /**
+     * @brief Write the buffered data of a file and make it durable, without its metadata where the system allows that
+     */
+    inline bool syncJournalFile( std::FILE *file ) noexcept
+    {
+        if( std::fflush( file ) != 0 )
+        {
+            return false;
+        }
+
+#if defined(_WIN32)
+        return _commit( _fileno( file ) ) == 0;
+#elif defined(__linux__)
+        return ::fdatasync( fileno( file ) ) == 0;
+#elif defined(__unix__) || defined(__APPLE__)
+        return ::fsync( fileno( file ) ) == 0;
+#else
+        return true;
+#endif
+    }
+
+} // namespace detail
+
+
+
+inline TransitionJournal::TransitionJournal()
+{
+    m_file = nullptr;
+    m_pendingRecordCount = 0;
+    m_pendingFirstSequence = 0;
+    m_stateIndexCount = 0;
+    m_lastSequence = 0;
+    m_durableSequence = 0;
+    m_syncCount = 0;
+    m_isSyncRequested = false;
+    m_isStopping = false;
+    m_hasFailed = false;
+}
+
+inline TransitionJournal::~TransitionJournal()
+{
+    close();
+}
+
+inline bool TransitionJournal::open( const char *path, const TransitionJournalConfig& config )
+{
+    close();
+
+    std::uint64_t validSize;
+    std::uint64_t lastSequence;
+    if( !scanExistingFile( path, validSize, lastSequence ) )
+    {
+        return false;
+    }
+
+    // cut off a batch torn by a crash, so that new batches follow the last complete one
+    std::error_code error;
+    if( std::filesystem::exists( path, error ) && std::filesystem::file_size( path, error ) != validSize )
+    {
+        std::filesystem::resize_file( path, validSize, error );
+        if( error )
+        {
+            return false;
+        }
+    }
+
+    std::FILE *file = std::fopen( path, "ab" );
+    if( !file )
+    {
+        return false;
+    }
+    // batches are written whole, buffering would only copy them once more
+    std::setvbuf( file, nullptr, _IONBF, 0 );
+
+    if( validSize == 0 )
+    {
+        detail::JournalFileHeader header;
+        std::memcpy( header.magic, detail::JOURNAL_FILE_MAGIC, sizeof(header.magic) );
+        header.formatVersion = detail::JOURNAL_FORMAT_VERSION;
+        header.headerSize = sizeof(detail::JournalFileHeader);
+        header.byteOrderMark = detail::JOURNAL_BYTE_ORDER_MARK;
+        header.reserved = 0;
+
+        if( std::fwrite( &header, sizeof(header), 1, file ) != 1 || !detail::syncJournalFile( file ) )
+        {
+            std::fclose( file );
+            return false;
+        }
+    }
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    m_file = file;
+    m_config = config;
+    m_pendingBatch.clear();
+    m_stateIndices.clear();
+    m_stateIndexCount = 0;
+    m_lastSequence = lastSequence;
+    m_durableSequence = lastSequence;
+    m_syncCount = 0;
+    m_isSyncRequested = false;
+    m_isStopping = false;
+    m_hasFailed = false;
+
+    m_flusher = std::thread( [this] { runFlusher(); } );
+
+    return true;
+}
+
+inline void TransitionJournal::close()
+{
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        if( !m_file )
+        {
+            return;
+        }
+
+        m_isStopping = true;
+    }
+
+    m_flushCondition.notify_one();
+    m_flusher.join();
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+    std::fclose( m_file );
+    m_file = nullptr;
+    m_isStopping = false;
+}
+
+inline bool TransitionJournal::isOpen() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_file != nullptr;
+}
+
+inline std::uint64_t TransitionJournal::append( std::uint64_t machineId, const StateTransition& transition ) noexcept
+{
+    std::unique_lock< std::mutex > lock( m_mutex );
+
+    if( !m_file || m_hasFailed || m_isStopping )
+    {
+        return 0;
+    }
+
+    const bool isFirstInBatch = m_pendingBatch.empty();
+    std::uint64_t sequence;
+
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    try
+    {
+#endif
+        beginBatch();
+
+        detail::JournalTransitionEntry entry;
+        entry.tag = detail::JOURNAL_ENTRY_TRANSITION;
+        entry.type = (std::uint8_t)transition.type;
+        entry.prevState = journalStateIndex( transition.prevState );
+        entry.nextState = journalStateIndex( transition.nextState );
+        entry.reserved = 0;
+        entry.machineId = machineId;
+        entry.sequence = sequence = m_lastSequence + 1;
+
+        const std::size_t position = m_pendingBatch.size();
+        m_pendingBatch.resize( position + sizeof(entry) );
+        std::memcpy( m_pendingBatch.data() + position, &entry, sizeof(entry) );
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    }
+    catch(...)
+    {
+        m_hasFailed = true;
+        m_durableCondition.notify_all();
+        return 0;
+    }
+#endif
+
+    m_lastSequence = sequence;
+    m_pendingRecordCount++;
+
+    if( m_config.durability == JOURNAL_DURABILITY_SYNC )
+    {
+        m_flushCondition.notify_one();
+        m_durableCondition.wait( lock, [this, sequence] { return m_durableSequence >= sequence || m_hasFailed; } );
+        return m_durableSequence >= sequence ? sequence : 0;
+    }
+
+    // the flusher only needs to know when a batch starts its interval or fills up
+    if( isFirstInBatch || m_pendingBatch.size() >= m_config.batchSize )
+    {
+        m_flushCondition.notify_one();
+    }
+
+    return sequence;
+}
+
+inline bool TransitionJournal::sync()
+{
+    std::unique_lock< std::mutex > lock( m_mutex );
+
+    if( !m_file || m_hasFailed )
+    {
+        return false;
+    }
+
+    const std::uint64_t target = m_lastSequence;
+    if( m_durableSequence >= target )
+    {
+        return true;
+    }
+
+    m_isSyncRequested = true;
+    m_flushCondition.notify_one();
+    m_durableCondition.wait( lock, [this, target] { return m_durableSequence >= target || m_hasFailed; } );
+
+    return m_durableSequence >= target;
+}
+
+inline std::uint64_t TransitionJournal::getLastSequence() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_lastSequence;
+}
+
+inline std::uint64_t TransitionJournal::getDurableSequence() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_durableSequence;
+}
+
+inline std::uint64_t TransitionJournal::getSyncCount() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_syncCount;
+}
+
+inline bool TransitionJournal::hasFailed() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_hasFailed;
+}
+
+inline bool TransitionJournal::scanExistingFile( const char *path, std::uint64_t& validSize, std::uint64_t& lastSequence )
+{
+    validSize = 0;
+    lastSequence = 0;
+
+    // a file that doesn't exist or was cut short before its header was complete is started anew
+    std::error_code error;
+    const std::uintmax_t size = std::filesystem::file_size( path, error );
+    if( error || size < sizeof(detail::JournalFileHeader) )
+    {
+        return true;
+    }
+
+    TransitionJournalReader reader;
+    if( !reader.open( path ) )
+    {
+        return false;
+    }
+
+    while( reader.nextBatch() )
+    {
+        lastSequence = std::max( lastSequence, reader.m_batchLastSequence );
+    }
+
+    validSize = reader.m_fileOffset;
+    return true;
+}
+
+inline std::uint16_t TransitionJournal::journalStateIndex( StateId id )
+{
+    if( id == NULL_STATE )
+    {
+        return 0;
+    }
+
+    if( id >= m_stateIndices.size() )
+    {
+        m_stateIndices.resize( id + 1, 0 );
+    }
+
+    if( m_stateIndices[id] == 0 )
+    {
+        assert( m_stateIndexCount < UINT16_MAX && "Too many state types for a journal!" );
+
+        const char *name = getStateTypeName( id );
+
+        detail::JournalStateTypeEntry entry;
+        entry.tag = detail::JOURNAL_ENTRY_STATE_TYPE;
+        entry.reserved = 0;
+        entry.index = ++m_stateIndexCount;
+        entry.nameLength = (std::uint16_t)std::min< std::size_t >( std::strlen( name ), UINT16_MAX );
+        entry.reserved2 = 0;
+
+        const std::size_t position = m_pendingBatch.size();
+        m_pendingBatch.resize( position + sizeof(entry) + entry.nameLength );
+        std::memcpy( m_pendingBatch.data() + position, &entry, sizeof(entry) );
+        std::memcpy( m_pendingBatch.data() + position + sizeof(entry), name, entry.nameLength );
+
+        m_stateIndices[id] = entry.index;
+    }
+
+    return m_stateIndices[id];
+}
+
+inline void TransitionJournal::beginBatch()
+{
+    if( m_pendingBatch.empty() )
+    {
+        // the header is filled in when the batch is written
+        m_pendingBatch.resize( sizeof(detail::JournalBatchHeader) );
+        m_pendingRecordCount = 0;
+        m_pendingFirstSequence = m_lastSequence + 1;
+        m_pendingSince = std::chrono::steady_clock::now();
+    }
+}
+
+inline void TransitionJournal::runFlusher()
+{
+    std::unique_lock< std::mutex > lock( m_mutex );
+
+    while( true )
+    {
+        m_flushCondition.wait( lock, [this] { return m_isStopping || m_isSyncRequested || !m_pendingBatch.empty(); } );
+
+        // give the batch time to fill, unless someone is waiting for it
+        if( !m_isStopping && !m_isSyncRequested && m_config.durability != JOURNAL_DURABILITY_SYNC && m_pendingBatch.size() < m_config.batchSize )
+        {
+            m_flushCondition.wait_until( lock, m_pendingSince + m_config.flushInterval, [this] {
+                return m_isStopping || m_isSyncRequested || m_pendingBatch.size() >= m_config.batchSize;
+            });
+        }
+
+        if( m_pendingBatch.empty() && !m_isSyncRequested )
+        {
+            if( m_isStopping )
+            {
+                break;
+            }
+            continue;
+        }
+
+        const bool shouldSync = m_config.durability != JOURNAL_DURABILITY_NONE || m_isSyncRequested;
+        const std::uint32_t recordCount = m_pendingRecordCount;
+        const std::uint64_t firstSequence = m_pendingFirstSequence;
+        const std::uint64_t lastSequence = m_lastSequence;
+        m_isSyncRequested = false;
+        // appends continue into the other buffer while this one is written
+        std::swap( m_pendingBatch, m_writtenBatch );
+
+        lock.unlock();
+
+        bool isWritten = true;
+        if( !m_writtenBatch.empty() )
+        {
+            detail::JournalBatchHeader header;
+            header.magic = detail::JOURNAL_BATCH_MAGIC;
+            header.size = (std::uint32_t)( m_writtenBatch.size() - sizeof(header) );
+            header.checksum = 0;
+            header.recordCount = recordCount;
+            header.firstSequence = firstSequence;
+            std::memcpy( m_writtenBatch.data(), &header, sizeof(header) );
+
+            header.checksum = detail::crc32( m_writtenBatch.data() + detail::JOURNAL_BATCH_CHECKSUM_START, m_writtenBatch.size() - detail::JOURNAL_BATCH_CHECKSUM_START );
+            std::memcpy( m_writtenBatch.data() + offsetof( detail::JournalBatchHeader, checksum ), &header.checksum, sizeof(header.checksum) );
+
+            isWritten = std::fwrite( m_writtenBatch.data(), 1, m_writtenBatch.size(), m_file ) == m_writtenBatch.size();
+            m_writtenBatch.clear();
+        }
+        isWritten = isWritten && ( shouldSync ? detail::syncJournalFile( m_file ) : std::fflush( m_file ) == 0 );
+
+        lock.lock();
+
+        if( !isWritten )
+        {
+            m_hasFailed = true;
+        }
+        else if( shouldSync )
+        {
+            m_durableSequence = lastSequence;
+            m_syncCount++;
+        }
+
+        m_durableCondition.notify_all();
+    }
+}
+
+
+
+inline TransitionJournalObserver::TransitionJournalObserver( TransitionJournal& journal, std::uint64_t machineId ) noexcept
+    : m_journal( journal )
+{
+    m_machineId = machineId;
+}
+
+inline TransitionJournal& TransitionJournalObserver::getJournal() const noexcept
+{
+    return m_journal;
+}
+
+inline std::uint64_t TransitionJournalObserver::getMachineId() const noexcept
+{
+    return m_machineId;
+}
+
+inline void TransitionJournalObserver::onTransition( const StateTransition& transition ) 
+{
+    m_journal.append( m_machineId, transition );
+}
+
+
+
+inline TransitionJournalReader::TransitionJournalReader() noexcept
+{
+    m_position = nullptr;
+    m_batchEnd = nullptr;
+    m_fileOffset = 0;
+    m_batchLastSequence = 0;
+    m_lastSequence = 0;
+    m_isTruncated = false;
+}
+
+inline bool TransitionJournalReader::open( const char *path )
+{
+    m_position = nullptr;
+    m_batchEnd = nullptr;
+    m_fileOffset = 0;
+    m_stateNames.clear();
+    m_stateIds.clear();
+    m_batchLastSequence = 0;
+    m_lastSequence = 0;
+    m_isTruncated = false;
+
+    if( !m_file.open( path ) || m_file.getSize() < sizeof(detail::JournalFileHeader) )
+    {
+        m_file.close();
+        return false;
+    }
+
+    detail::JournalFileHeader header;
+    std::memcpy( &header, m_file.getData(), sizeof(header) );
+    if( std::memcmp( header.magic, detail::JOURNAL_FILE_MAGIC, sizeof(header.magic) ) != 0
+     || header.formatVersion != detail::JOURNAL_FORMAT_VERSION
+     || header.headerSize != sizeof(detail::JournalFileHeader)
+     || header.byteOrderMark != detail::JOURNAL_BYTE_ORDER_MARK )
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_fileOffset = sizeof(header);
+    return true;
+}
+
+inline bool TransitionJournalReader::next( JournalRecord& record )
+{
+    while( true )
+    {
+        if( m_position == m_batchEnd && !nextBatch() )
+        {
+            return false;
+        }
+
+        const std::size_t remaining = (std::size_t)( m_batchEnd - m_position );
+        if( remaining == 0 )
+        {
+            continue;
+        }
+
+        if( *m_position == detail::JOURNAL_ENTRY_TRANSITION && remaining >= sizeof(detail::JournalTransitionEntry) )
+        {
+            detail::JournalTransitionEntry entry;
+            std::memcpy( &entry, m_position, sizeof(entry) );
+
+            if( entry.type <= STATE_TRANSITION_DESTROY )
+            {
+                m_position += sizeof(entry);
+
+                record.sequence = entry.sequence;
+                record.machineId = entry.machineId;
+                record.type = (EStateTransitionType)entry.type;
+                record.prevStateIndex = entry.prevState;
+                record.nextStateIndex = entry.nextState;
+
+                m_lastSequence = entry.sequence;
+                return true;
+            }
+        }
+        else if( *m_position == detail::JOURNAL_ENTRY_STATE_TYPE && remaining >= sizeof(detail::JournalStateTypeEntry) )
+        {
+            detail::JournalStateTypeEntry entry;
+            std::memcpy( &entry, m_position, sizeof(entry) );
+
+            if( entry.index != 0 && remaining - sizeof(entry) >= entry.nameLength )
+            {
+                if( entry.index >= m_stateNames.size() )
+                {
+                    m_stateNames.resize( entry.index + 1 );
+                    m_stateIds.resize( entry.index + 1, NULL_STATE );
+                }
+
+                // indices start over every time the journal is opened for appending
+                m_stateNames[ entry.index ].assign( reinterpret_cast<const char *>( m_position + sizeof(entry) ), entry.nameLength );
+                m_stateIds[ entry.index ] = NULL_STATE;
+
+                m_position += sizeof(entry) + entry.nameLength;
+                continue;
+            }
+        }
+
+        // the checksum matched, so this can only be a bug or a deliberately damaged file; nothing after it can be trusted
+        m_isTruncated = true;
+        m_position = m_batchEnd = nullptr;
+        return false;
+    }
+}
+
+inline const std::string& TransitionJournalReader::getStateTypeName( std::uint16_t index ) const noexcept
+{
+    static const std::string emptyName;
+
+    return index < m_stateNames.size() ? m_stateNames[index] : emptyName;
+}
+
+inline bool TransitionJournalReader::isTruncated() const noexcept
+{
+    return m_isTruncated;
+}
+
+inline std::uint64_t TransitionJournalReader::getLastSequence() const noexcept
+{
+    return m_lastSequence;
+}
+
+template<class ...StateTypes, typename F>
+inline std::int64_t TransitionJournalReader::replay( std::uint64_t afterSequence, F&& getMachine )
+{
+    // identifiers resolved with a different list of state types could be wrong
+    std::fill( m_stateIds.begin(), m_stateIds.end(), NULL_STATE );
+
+    auto resolveState = [this]( std::uint16_t index, StateId& id ) {
+        if( index == 0 )
+        {
+            id = NULL_STATE;
+            return true;
+        }
+
+        if( index >= m_stateNames.size() )
+        {
+            return false;
+        }
+
+        // names are compared only the first time an index is seen
+        StateId& resolvedId = m_stateIds[index];
+        if( resolvedId == NULL_STATE )
+        {
+            const std::string& name = m_stateNames[index];
+            ( void )( ( name == chestnut::fsm::getStateTypeName( stateIdOf<StateTypes>() ) && ( resolvedId = stateIdOf<StateTypes>(), true ) ) || ... );
+        }
+
+        id = resolvedId;
+        return id != NULL_STATE;
+    };
+
+    std::int64_t replayedCount = 0;
+    std::uint64_t lastAppliedSequence = afterSequence;
+
+    JournalRecord record;
+    while( next( record ) )
+    {
+        if( record.sequence <= afterSequence )
+        {
+            continue;
+        }
+
+        StateTransition transition;
+        transition.type = record.type;
+        if( !resolveState( record.prevStateIndex, transition.prevState ) || !resolveState( record.nextStateIndex, transition.nextState ) )
+        {
+            m_lastSequence = lastAppliedSequence;
+            return -1;
+        }
+
+        StatemachineBase *machine = getMachine( record.machineId );
+        if( machine )
+        {
+            if( !replayTransition<StateTypes...>( *machine, transition ) )
+            {
+                m_lastSequence = lastAppliedSequence;
+                return -1;
+            }
+
+            replayedCount++;
+        }
+
+        lastAppliedSequence = record.sequence;
+    }
+
+    return replayedCount;
+}
+
+template<class ...StateTypes>
+inline bool TransitionJournalReader::replayTransition( StatemachineBase& statemachine, const StateTransition& transition ) 
+{
+    if( statemachine.m_isProcessingTransition || transition.prevState != statemachine.getCurrentStateType() )
+    {
+        return false;
+    }
+
+    switch( transition.type )
+    {
+    case STATE_TRANSITION_INIT:
+    case STATE_TRANSITION_GOTO:
+    case STATE_TRANSITION_PUSH:
+    {
+        if( ( transition.type == STATE_TRANSITION_INIT ) != statemachine.m_stackStates.empty() )
+        {
+            return false;
+        }
+
+        StateBase *nextState = statemachine.createStateOfType<StateTypes...>( transition.nextState );
+        if( !nextState )
+        {
+            return false;
+        }
+
+        // the same as gotoState - the init state is never replaced
+        if( transition.type == STATE_TRANSITION_GOTO && statemachine.m_stackStates.size() > 1 )
+        {
+            delete statemachine.m_stackStates.top();
+            statemachine.m_stackStates.pop();
+        }
+
+        statemachine.m_stackStates.push( nextState );
+        return true;
+    }
+
+    case STATE_TRANSITION_POP:
+        if( statemachine.m_stackStates.size() <= 1 || statemachine.m_stackStates[ statemachine.m_stackStates.size() - 2 ]->stateId != transition.nextState )
+        {
+            return false;
+        }
+
+        delete statemachine.m_stackStates.top();
+        statemachine.m_stackStates.pop();
+        return true;
+
+    case STATE_TRANSITION_DESTROY:
+        if( statemachine.m_stackStates.empty() )
+        {
+            return false;
+        }
+
+        delete statemachine.m_stackStates.top();
+        statemachine.m_stackStates.pop();
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+inline bool TransitionJournalReader::nextBatch()
+{
+    const std::size_t size = m_file.getSize();
+    if( m_isTruncated || m_fileOffset >= size )
+    {
+        return false;
+    }
+
+    detail::JournalBatchHeader header;
+    const unsigned char *batch = m_file.getData() + m_fileOffset;
+    if( size - m_fileOffset < sizeof(header) )
+    {
+        m_isTruncated = true;
+        return false;
+    }
+    std::memcpy( &header, batch, sizeof(header) );
+
+    if( header.magic != detail::JOURNAL_BATCH_MAGIC || header.size > size - m_fileOffset - sizeof(header)
+     || header.checksum != detail::crc32( batch + detail::JOURNAL_BATCH_CHECKSUM_START, sizeof(header) + header.size - detail::JOURNAL_BATCH_CHECKSUM_START ) )
+    {
+        m_isTruncated = true;
+        return false;
+    }
+
+    m_position = batch + sizeof(header);
+    m_batchEnd = m_position + header.size;
+    m_fileOffset += sizeof(header) + header.size;
+    m_batchLastSequence = header.recordCount > 0 ? header.firstSequence + header.recordCount - 1 : 0;
+    return true;
+}
+
+} // namespace chestnut::fsm
@@ -0,0 +1,219 @@
+/**
+ * @file transition_metrics.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with TransitionMetrics, collecting state dwell times and transition counts in per-thread shards
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_TRANSITION_METRICS_H__
+#define __CHESTNUT_STATEMACHINE_TRANSITION_METRICS_H__
+
+#include "config.hpp"
+#include "state_transition.hpp"
+#include "histogram.hpp"
+#include "transition_tracer.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Dwell times of one state type
+ */
+struct StateDwellMetrics
+{
+    StateId state;
+    /** Times between entering the state and leaving it, in timestamp ticks; see MetricsSnapshot::ticksPerNanosecond */
+    Histogram dwellTime;
+};
+
+/**
+ * @brief Number of transitions between two state types
+ */
+struct TransitionCountMetrics
+{
+    /** NULL_STATE for initialization */
+    StateId prevState;
+    /** NULL_STATE for destruction */
+    StateId nextState;
+    std::uint64_t count;
+};
+
+/**
+ * @brief Metrics of all threads added together
+ */
+struct MetricsSnapshot
+{
+    /** States that were left at least once, ordered by identifier */
+    std::vector< StateDwellMetrics > states;
+    /** Pairs of states with at least one transition, ordered by identifiers */
+    std::vector< TransitionCountMetrics > transitions;
+    /** Transitions of states with identifiers over CHESTNUT_FSM_METRICS_MAX_STATE_ID */
+    std::uint64_t droppedCount;
+    /** Frequency of timestamps from readTraceTimestamp(), measured against the steady clock since the metrics were first used */
+    double ticksPerNanosecond;
+};
+
+
+/**
+ * @brief Global collector of state dwell times and transition counts
+ *
+ * @details
+ * Statemachine reports to it on every transition when CHESTNUT_FSM_COLLECT_METRICS is 1: the time the previous state
+ * was the current one and the pair of states of the transition. When the macro is 0 (the default) statemachines
+ * don't reference it at all. StaticStatemachine and the other statemachines don't report, but can be measured by
+ * calling recordTransition() and recordDwellTime() manually.
+ *
+ * Each thread writes to its own shard, with counters only that thread writes to, so recording doesn't contend
+ * with other threads or with readers. Counters of a state live on their own cache lines and are allocated the first time
+ * the state is seen. snapshot() adds the shards together and can be called from any thread while others keep recording.
+ * When a thread exits its counts are added to a shard shared by exited threads and its own shard is freed,
+ * so the totals keep them while memory doesn't grow with the number of threads that have ever recorded.
+ */
+class TransitionMetrics
+{
+public:
+    static constexpr std::size_t MAX_STATE_ID = CHESTNUT_FSM_METRICS_MAX_STATE_ID;
+
+
+public:
+    /**
+     * @brief Count the transition in the shard of the calling thread
+     *
+     * @throws std::bad_alloc if the counters couldn't be allocated
+     */
+    static void recordTransition( const StateTransition& transition );
+
+    /**
+     * @brief Count the transition and record the time its previous state was the current state, in the shard of the calling thread
+     *
+     * @param transition transition that took place; dwell time is not recorded if its prevState is NULL_STATE
+     * @param prevStateTicks duration in timestamp ticks from readTraceTimestamp()
+     *
+     * @throws std::bad_alloc if the counters couldn't be allocated
+     */
+    static void recordTransition( const StateTransition& transition, std::uint64_t prevStateTicks );
+
+    /**
+     * @brief Record the time the state was the current state in the shard of the calling thread
+     *
+     * @param state identifier of the state
+     * @param ticks duration in timestamp ticks from readTraceTimestamp()
+     *
+     * @throws std::bad_alloc if the histogram couldn't be allocated
+     */
+    static void recordDwellTime( StateId state, std::uint64_t ticks );
+
+    /**
+     * @brief Add metrics of all threads together
+     */
+    static MetricsSnapshot snapshot();
+
+
+private:
+    /**
+     * @brief Dwell time histogram of a state in a shard; only its owner thread writes to it
+     */
+    struct alignas(64) DwellCounters
+    {
+        std::atomic<std::uint64_t> buckets[ Histogram::BUCKET_COUNT ];
+        std::atomic<std::uint64_t> sum;
+        std::atomic<std::uint64_t> min;
+        std::atomic<std::uint64_t> max;
+
+        DwellCounters() noexcept;
+    };
+
+    /**
+     * @brief Counts of transitions from a state in a shard, indexed by the identifier of the next state
+     */
+    struct alignas(64) TransitionCounters
+    {
+        std::atomic<std::uint64_t> counts[ MAX_STATE_ID + 1 ];
+
+        TransitionCounters() noexcept;
+    };
+
+    /**
+     * @brief Counters of one thread
+     */
+    struct alignas(64) Shard
+    {
+        std::atomic<DwellCounters *> dwellCounters[ MAX_STATE_ID + 1 ];
+        std::atomic<TransitionCounters *> transitionCounters[ MAX_STATE_ID + 1 ];
+        std::atomic<std::uint64_t> droppedCount;
+
+        Shard() noexcept;
+        ~Shard();
+    };
+
+    /**
+     * @brief Owner of the shard of a thread; adds it to the retired shard when the thread exits
+     */
+    struct ThreadShard
+    {
+        Shard *shard;
+
+        ThreadShard();
+        ~ThreadShard();
+    };
+
+    /**
+     * @brief Plain pointer to the shard of a thread, cleared when the ThreadShard retires it
+     */
+    struct ThreadShardCache
+    {
+        Shard *shard;
+        bool isRetired;
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector< std::unique_ptr<Shard> > shards;
+        // counts of exited threads and of recording after a thread's shard was retired; written with the mutex locked
+        Shard retiredShard;
+        std::uint64_t createdTimestamp;
+        std::uint64_t createdNanoseconds;
+
+        Registry();
+    };
+
+    static Registry& registry();
+    static ThreadShardCache& threadShardCache() noexcept;
+    static Shard *threadShard();
+
+    /**
+     * @brief Call f with the shard of the calling thread, or with the retired shard if the thread's shard is already gone
+     */
+    template< typename F >
+    static void recordInThreadShard( F&& f );
+
+    static void retireShard( Shard& retired, const Shard& shard );
+
+    static void countTransition( Shard& shard, const StateTransition& transition );
+    static void addDwellTime( Shard& shard, StateId state, std::uint64_t ticks );
+
+    /**
+     * @brief Add one to a counter only the calling thread writes to, without a locked instruction
+     */
+    static void increment( std::atomic<std::uint64_t>& counter, std::uint64_t value = 1 ) noexcept;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "transition_metrics.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_TRANSITION_METRICS_H__
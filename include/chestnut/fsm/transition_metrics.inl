@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace chestnut::fsm
+{
+
+namespace detail
+{
+    inline std::uint64_t steadyNanoseconds() noexcept
+    {
+        return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+} // namespace detail
+
+
+
+inline void TransitionMetrics::recordTransition( const StateTransition& transition )
+{
+    recordInThreadShard( [&transition]( Shard& shard ) {
+        countTransition( shard, transition );
+    });
+}
+
+inline void TransitionMetrics::recordTransition( const StateTransition& transition, std::uint64_t prevStateTicks )
+{
+    recordInThreadShard( [&transition, prevStateTicks]( Shard& shard ) {
+        if( transition.prevState != NULL_STATE )
+        {
+            addDwellTime( shard, transition.prevState, prevStateTicks );
+        }
+        countTransition( shard, transition );
+    });
+}
+
+inline void TransitionMetrics::recordDwellTime( StateId state, std::uint64_t ticks )
+{
+    recordInThreadShard( [state, ticks]( Shard& shard ) {
+        addDwellTime( shard, state, ticks );
+    });
+}
+
+inline MetricsSnapshot TransitionMetrics::snapshot()
+{
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock( reg.mutex );
+
+    MetricsSnapshot result;
+    result.droppedCount = 0;
+
+    const std::uint64_t elapsedNanoseconds = detail::steadyNanoseconds() - reg.createdNanoseconds;
+    const std::uint64_t elapsedTicks = readTraceTimestamp() - reg.createdTimestamp;
+    result.ticksPerNanosecond = elapsedNanoseconds > 0 ? double(elapsedTicks) / double(elapsedNanoseconds) : 1.0;
+
+    std::vector< const Shard * > shards;
+    shards.reserve( reg.shards.size() + 1 );
+    shards.push_back( &reg.retiredShard );
+    for( const std::unique_ptr<Shard>& shard : reg.shards )
+    {
+        shards.push_back( shard.get() );
+    }
+
+    for( std::size_t state = 0; state <= MAX_STATE_ID; state++ )
+    {
+        StateDwellMetrics dwellMetrics;
+        dwellMetrics.state = (StateId)state;
+
+        for( const Shard *shard : shards )
+        {
+            const DwellCounters *counters = shard->dwellCounters[state].load( std::memory_order_acquire );
+            if( !counters )
+            {
+                continue;
+            }
+
+            Histogram& histogram = dwellMetrics.dwellTime;
+            for( std::size_t i = 0; i < Histogram::BUCKET_COUNT; i++ )
+            {
+                const std::uint64_t count = counters->buckets[i].load( std::memory_order_relaxed );
+                histogram.m_buckets[i] += count;
+                histogram.m_totalCount += count;
+            }
+            histogram.m_sum += counters->sum.load( std::memory_order_relaxed );
+            histogram.m_min = std::min( histogram.m_min, counters->min.load( std::memory_order_relaxed ) );
+            histogram.m_max = std::max( histogram.m_max, counters->max.load( std::memory_order_relaxed ) );
+        }
+
+        if( dwellMetrics.dwellTime.getTotalCount() > 0 )
+        {
+            result.states.push_back( dwellMetrics );
+        }
+    }
+
+    std::vector< std::uint64_t > counts( MAX_STATE_ID + 1 );
+    for( std::size_t prevState = 0; prevState <= MAX_STATE_ID; prevState++ )
+    {
+        std::fill( counts.begin(), counts.end(), 0 );
+
+        bool hasAny = false;
+        for( const Shard *shard : shards )
+        {
+            const TransitionCounters *counters = shard->transitionCounters[prevState].load( std::memory_order_acquire );
+            if( counters )
+            {
+                hasAny = true;
+                for( std::size_t nextState = 0; nextState <= MAX_STATE_ID; nextState++ )
+                {
+                    counts[nextState] += counters->counts[nextState].load( std::memory_order_relaxed );
+                }
+            }
+        }
+
+        for( std::size_t nextState = 0; hasAny && nextState <= MAX_STATE_ID; nextState++ )
+        {
+            if( counts[nextState] > 0 )
+            {
+                result.transitions.push_back( TransitionCountMetrics { (StateId)prevState, (StateId)nextState, counts[nextState] } );
+            }
+        }
+    }
+
+    for( const Shard *shard : shards )
+    {
+        result.droppedCount += shard->droppedCount.load( std::memory_order_relaxed );
+    }
+
+    return result;
+}
+
+
+
+inline TransitionMetrics::DwellCounters::DwellCounters() noexcept
+{
+    for( std::atomic<std::uint64_t>& bucket : buckets )
+    {
+        bucket.store( 0, std::memory_order_relaxed );
+    }
+    sum.store( 0, std::memory_order_relaxed );
+    min.store( std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed );
+    max.store( 0, std::memory_order_relaxed );
+}
+
+inline TransitionMetrics::TransitionCounters::TransitionCounters() noexcept
+{
+    for( std::atomic<std::uint64_t>& count : counts )
+    {
+        count.store( 0, std::memory_order_relaxed );
+    }
+}
+
+inline TransitionMetrics::Shard::Shard() noexcept
+{
+    for( std::size_t i = 0; i <= MAX_STATE_ID; i++ )
+    {
+        dwellCounters[i].store( nullptr, std::memory_order_relaxed );
+        transitionCounters[i].store( nullptr, std::memory_order_relaxed );
+    }
+    droppedCount.store( 0, std::memory_order_relaxed );
+}
+
+inline TransitionMetrics::Shard::~Shard()
+{
+    for( std::size_t i = 0; i <= MAX_STATE_ID; i++ )
+    {
+        delete dwellCounters[i].load( std::memory_order_relaxed );
+        delete transitionCounters[i].load( std::memory_order_relaxed );
+    }
+}
+
+inline TransitionMetrics::ThreadShard::ThreadShard()
+{
+    std::unique_ptr<Shard> newShard( new Shard() );
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock( reg.mutex );
+    reg.shards.push_back( std::move( newShard ) );
+    shard = reg.shards.back().get();
+}
+
+inline TransitionMetrics::ThreadShard::~ThreadShard()
+{
+    ThreadShardCache& cache = threadShardCache();
+    cache.shard = nullptr;
+    cache.isRetired = true;
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock( reg.mutex );
+
+    retireShard( reg.retiredShard, *shard );
+
+    auto it = std::find_if( reg.shards.begin(), reg.shards.end(), [this]( const std::unique_ptr<Shard>& registered ) {
+        return registered.get() == shard;
+    });
+    reg.shards.erase( it );
+}
+
+inline TransitionMetrics::Registry::Registry()
+{
+    createdTimestamp = readTraceTimestamp();
+    createdNanoseconds = detail::steadyNanoseconds();
+}
+
+inline TransitionMetrics::Registry& TransitionMetrics::registry()
+{
+    static Registry reg;
+    return reg;
+}
+
+inline TransitionMetrics::ThreadShardCache& TransitionMetrics::threadShardCache() noexcept
+{
+    // trivial, so it's accessed without the initialization check of a thread_local object and it outlives ThreadShard
+    thread_local ThreadShardCache cache { nullptr, false };
+    return cache;
+}
+
+inline TransitionMetrics::Shard *TransitionMetrics::threadShard()
+{
+    ThreadShardCache& cache = threadShardCache();
+    if( !cache.shard && !cache.isRetired )
+    {
+        // a destroyed thread_local can't be constructed again, so it's only done before the shard was retired
+        thread_local ThreadShard threadShard;
+        cache.shard = threadShard.shard;
+    }
+
+    return cache.shard;
+}
+
+template<typename F>
+inline void TransitionMetrics::recordInThreadShard( F&& f )
+{
+    Shard *shard = threadShard();
+    if( shard )
+    {
+        f( *shard );
+    }
+    else
+    {
+        // e.g. a statemachine destroyed in a destructor of another thread_local object
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock( reg.mutex );
+        f( reg.retiredShard );
+    }
+}
+
+inline void TransitionMetrics::retireShard( Shard& retired, const Shard& shard )
+{
+    for( std::size_t i = 0; i <= MAX_STATE_ID; i++ )
+    {
+        if( const DwellCounters *counters = shard.dwellCounters[i].load( std::memory_order_relaxed ) )
+        {
+            DwellCounters *retiredCounters = retired.dwellCounters[i].load( std::memory_order_relaxed );
+            if( !retiredCounters )
+            {
+                retiredCounters = new DwellCounters();
+                retired.dwellCounters[i].store( retiredCounters, std::memory_order_release );
+            }
+
+            for( std::size_t j = 0; j < Histogram::BUCKET_COUNT; j++ )
+            {
+                increment( retiredCounters->buckets[j], counters->buckets[j].load( std::memory_order_relaxed ) );
+            }
+            increment( retiredCounters->sum, counters->sum.load( std::memory_order_relaxed ) );
+            retiredCounters->min.store( std::min( retiredCounters->min.load( std::memory_order_relaxed ), counters->min.load( std::memory_order_relaxed ) ), std::memory_order_relaxed );
+            retiredCounters->max.store( std::max( retiredCounters->max.load( std::memory_order_relaxed ), counters->max.load( std::memory_order_relaxed ) ), std::memory_order_relaxed );
+        }
+
+        if( const TransitionCounters *counters = shard.transitionCounters[i].load( std::memory_order_relaxed ) )
+        {
+            TransitionCounters *retiredCounters = retired.transitionCounters[i].load( std::memory_order_relaxed );
+            if( !retiredCounters )
+            {
+                retiredCounters = new TransitionCounters();
+                retired.transitionCounters[i].store( retiredCounters, std::memory_order_release );
+            }
+
+            for( std::size_t j = 0; j <= MAX_STATE_ID; j++ )
+            {
+                increment( retiredCounters->counts[j], counters->counts[j].load( std::memory_order_relaxed ) );
+            }
+        }
+    }
+
+    increment( retired.droppedCount, shard.droppedCount.load( std::memory_order_relaxed ) );
+}
+
+inline void TransitionMetrics::countTransition( Shard& shard, const StateTransition& transition )
+{
+    if( transition.prevState > MAX_STATE_ID || transition.nextState > MAX_STATE_ID )
+    {
+        increment( shard.droppedCount );
+        return;
+    }
+
+    TransitionCounters *counters = shard.transitionCounters[ transition.prevState ].load( std::memory_order_relaxed );
+    if( !counters )
+    {
+        counters = new TransitionCounters();
+        shard.transitionCounters[ transition.prevState ].store( counters, std::memory_order_release );
+    }
+
+    increment( counters->counts[ transition.nextState ] );
+}
+
+inline void TransitionMetrics::addDwellTime( Shard& shard, StateId state, std::uint64_t ticks )
+{
+    if( state > MAX_STATE_ID )
+    {
+        increment( shard.droppedCount );
+        return;
+    }
+
+    DwellCounters *counters = shard.dwellCounters[state].load( std::memory_order_relaxed );
+    if( !counters )
+    {
+        counters = new DwellCounters();
+        shard.dwellCounters[state].store( counters, std::memory_order_release );
+    }
+
+    increment( counters->buckets[ Histogram::bucketIndexOf( ticks ) ] );
+    increment( counters->sum, ticks );
+    if( ticks < counters->min.load( std::memory_order_relaxed ) )
+    {
+        counters->min.store( ticks, std::memory_order_relaxed );
+    }
+    if( ticks > counters->max.load( std::memory_order_relaxed ) )
+    {
+        counters->max.store( ticks, std::memory_order_relaxed );
+    }
+}
+
+inline void TransitionMetrics::increment( std::atomic<std::uint64_t>& counter, std::uint64_t value ) noexcept
+{
+    counter.store( counter.load( std::memory_order_relaxed ) + value, std::memory_order_relaxed );
+}
+
+} // namespace chestnut::fsm
@@ -0,0 +1,358 @@
+/**
+ * @file transition_table.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with declarative compile time transition tables
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ * @details
+ * A transition table lists every (source state, event) -> (target state, guard, action) transition of a statemachine:
+ * @code
+ * using DoorTable = TransitionTable<
+ *     TransitionRow< CDoorStateClosed, EventOpen,  CDoorStateOpened >,
+ *     TransitionRow< CDoorStateOpened, EventClose, CDoorStateClosed >,
+ *     TransitionRow< CDoorStateClosed, EventLock,  CDoorStateLocked, HasKeyGuard, PlayLockSoundAction >
+ * >;
+ *
+ * door.processEvent<DoorTable>( EventOpen{} );
+ * @endcode
+ * Guards and actions are optional default constructible function objects:
+ * @code
+ * bool operator()( const Source& state, const Event& event ) const; // guard
+ * void operator()( Source& state, const Event& event ) const;       // action
+ * @endcode
+ * If several rows share the same source state and event, the first one whose guard passes is taken.
+ * The action runs once the transition is certain to happen - after the guards of the states have passed
+ * and the source state has been left, but before the target state is entered.
+ *
+ * A state with no row for an event ignores it. StrictTransitionTable instead requires every source state
+ * to have a row for every event type of the table.
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_TRANSITION_TABLE_H__
+#define __CHESTNUT_STATEMACHINE_TRANSITION_TABLE_H__
+
+#include "state_id.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Single entry of a TransitionTable
+ *
+ * @tparam Source state in which the event is handled
+ * @tparam Event type of the event
+ * @tparam Target state the statemachine goes to; constructed from the event if it has such constructor, default constructed otherwise
+ * @tparam Guard function object deciding whether the transition can happen or void if it always can
+ * @tparam Action function object called on the source state once the transition is accepted or void if there's none
+ */
+template< class Source, class Event, class Target, class Guard = void, class Action = void >
+struct TransitionRow
+{
+    typedef Source SourceType;
+    typedef Event EventType;
+    typedef Target TargetType;
+    typedef Guard GuardType;
+    typedef Action ActionType;
+};
+
+/**
+ * @brief Compile time list of transitions to be used with StatemachineBase::processEvent()
+ *
+ * @tparam Rows TransitionRow types
+ */
+template< class ...Rows >
+struct TransitionTable
+{
+    static_assert( sizeof...(Rows) > 0, "TransitionTable needs at least one row!" );
+
+    /**
+     * @brief Whether states without a row for an event are an error
+     */
+    static constexpr bool isStrict = false;
+
+    /**
+     * @brief Whether any of the rows is triggered by the event type
+     */
+    template< class Event >
+    static constexpr bool handlesEvent = ( std::is_same<typename Rows::EventType, Event>::value || ... );
+};
+
+template< class ...Rows >
+struct StrictTransitionTable;
+
+
+namespace detail
+{
+    // type list of unique source states of a table, in order of their first appearance
+
+    template< class ...Ts >
+    struct TypeList {};
+
+    template< class List, class T, bool IsPresent >
+    struct AppendUniqueImpl;
+
+    template< class ...Ts, class T >
+    struct AppendUniqueImpl< TypeList<Ts...>, T, true > { typedef TypeList<Ts...> Type; };
+
+    template< class ...Ts, class T >
+    struct AppendUniqueImpl< TypeList<Ts...>, T, false > { typedef TypeList<Ts..., T> Type; };
+
+    template< class List, class ...Rows >
+    struct UniqueSources { typedef List Type; };
+
+    template< class ...Ts, class Row, class ...Rows >
+    struct UniqueSources< TypeList<Ts...>, Row, Rows... >
+    {
+        typedef typename UniqueSources<
+            typename AppendUniqueImpl< TypeList<Ts...>, typename Row::SourceType, ( std::is_same<Ts, typename Row::SourceType>::value || ... ) >::Type,
+            Rows...
+        >::Type Type;
+    };
+
+
+    constexpr std::uint16_t NO_TABLE_STATE_INDEX = std::numeric_limits<std::uint16_t>::max();
+
+    /**
+     * @brief Maps global state identifiers onto positions of states in a table
+     *
+     * @details
+     * StateIds are assigned at runtime, so the map is built on first use. They are dense, so a plain array does the job.
+     */
+    template< class ...Sources >
+    inline const std::vector<std::uint16_t>& tableStateIndexMap()
+    {
+        static const std::vector<std::uint16_t> map = [] {
+            const StateId ids[] = { stateIdOf<Sources>()... };
+
+            StateId maxId = 0;
+            for( StateId id : ids )
+            {
+                maxId = id > maxId ? id : maxId;
+            }
+
+            std::vector<std::uint16_t> result( maxId + 1, NO_TABLE_STATE_INDEX );
+            for( std::uint16_t i = 0; i < sizeof...(Sources); i++ )
+            {
+                result[ ids[i] ] = i;
+            }
+
+            return result;
+        }();
+
+        return map;
+    }
+
+    template< class ...Sources >
+    inline std::uint16_t tableStateIndexOf( StateId id ) noexcept
+    {
+        const std::vector<std::uint16_t>& map = tableStateIndexMap<Sources...>();
+        return id < map.size() ? map[id] : NO_TABLE_STATE_INDEX;
+    }
+
+
+    template< class Row, class Source, class Event >
+    constexpr bool rowMatches = std::is_same<typename Row::SourceType, Source>::value && std::is_same<typename Row::EventType, Event>::value;
+
+    template< class Source, class Event, class ...Rows >
+    constexpr bool sourceHandlesEvent = ( rowMatches<Rows, Source, Event> || ... );
+
+    // instantiated per source state of a StrictTransitionTable, so that the compiler error points at the state
+    template< class Source, class ...Rows >
+    struct CheckSourceHandlesAllEvents
+    {
+        static constexpr bool value = ( sourceHandlesEvent<Source, typename Rows::EventType, Rows...> && ... );
+
+        static_assert( value, "A source state in StrictTransitionTable doesn't have a row for one of the event types of the table!" );
+    };
+
+
+    /**
+     * @brief Does nothing; action of transitions that aren't taken from a table
+     */
+    struct NoTransitionAction
+    {
+        void operator()() const noexcept {}
+    };
+
+    /**
+     * @brief Gives table handlers access to the transition of StatemachineBase that runs the action of a row
+     */
+    struct TableTransitionAccess
+    {
+        template< class Target, class Machine, class Action, typename ...Args >
+        static bool gotoState( Machine& machine, Action&& action, Args&& ...args )
+        {
+            return machine.template gotoStateImpl<Target>( std::forward<Action>( action ), std::forward<Args>( args )... );
+        }
+    };
+
+    /**
+     * @brief Checks the guard of a row and performs its transition
+     *
+     * @return whether the row matches the state and event and its guard has passed (the row was taken)
+     */
+    template< class Row, class Machine, class Source, class Event >
+    inline bool takeTransitionRow( Machine& machine, Source& state, const Event& event, bool& transitioned )
+    {
+        typedef typename Row::TargetType Target;
+        typedef typename Row::GuardType Guard;
+        typedef typename Row::ActionType Action;
+
+        if constexpr( !rowMatches<Row, Source, Event> )
+        {
+            return false;
+        }
+        else
+        {
+            if constexpr( !std::is_void<Guard>::value )
+            {
+                if( !Guard{}( static_cast<const Source&>( state ), event ) )
+                {
+                    return false;
+                }
+            }
+
+            // the transition can still be refused by the states, so the action is run by the statemachine once it's accepted
+            auto action = [&state, &event]() {
+                if constexpr( !std::is_void<Action>::value )
+                {
+                    Action{}( state, event );
+                }
+            };
+
+            if constexpr( std::is_constructible<Target, const Event&>::value )
+            {
+                transitioned = TableTransitionAccess::gotoState<Target>( machine, action, event );
+            }
+            else
+            {
+                transitioned = TableTransitionAccess::gotoState<Target>( machine, action );
+            }
+
+            return true;
+        }
+    }
+
+    /**
+     * @brief Handler of an event in a single source state - goes through rows of that state and event
+     */
+    template< class Machine, class Source, class Event, class ...Rows >
+    inline bool handleTableEvent( Machine& machine, void *state, const Event& event )
+    {
+        Source& source = *static_cast<Source *>( state );
+        bool transitioned = false;
+
+        // rows not matching this source and event compile down to nothing
+        ( takeTransitionRow<Rows>( machine, source, event, transitioned ) || ... );
+
+        return transitioned;
+    }
+
+    // state is passed as its most derived type, which is known to be Source by the time the handler is picked
+    template< class Machine, class Event >
+    using TableEventHandler = bool (*)( Machine&, void *, const Event& );
+
+    template< class Machine, class Source, class Event, class ...Rows >
+    constexpr TableEventHandler<Machine, Event> tableEventHandlerOf() noexcept
+    {
+        if constexpr( ( rowMatches<Rows, Source, Event> || ... ) )
+        {
+            return &handleTableEvent<Machine, Source, Event, Rows...>;
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+    /**
+     * @brief Dispatches one event type using a table of handlers indexed by table-local state index
+     */
+    template< class Machine, class Event, class SourceList, class ...Rows >
+    struct TableDispatcher;
+
+    template< class Machine, class Event, class ...Sources, class ...Rows >
+    struct TableDispatcher< Machine, Event, TypeList<Sources...>, Rows... >
+    {
+        static constexpr TableEventHandler<Machine, Event> handlers[] = {
+            tableEventHandlerOf<Machine, Sources, Event, Rows...>()...
+        };
+
+        static bool hasHandler( StateId stateId ) noexcept
+        {
+            const std::uint16_t index = tableStateIndexOf<Sources...>( stateId );
+            return index != NO_TABLE_STATE_INDEX && handlers[index];
+        }
+
+        static bool dispatch( Machine& machine, StateId stateId, void *state, const Event& event )
+        {
+            const std::uint16_t index = tableStateIndexOf<Sources...>( stateId );
+            if( index == NO_TABLE_STATE_INDEX || !handlers[index] )
+            {
+                return false;
+            }
+
+            return handlers[index]( machine, state, event );
+        }
+    };
+
+    template< class Machine, class Event, class Table >
+    struct TableDispatcherOf;
+
+    template< class Machine, class Event, class ...Rows >
+    struct TableDispatcherOf< Machine, Event, TransitionTable<Rows...> >
+    {
+        typedef TableDispatcher< Machine, Event, typename UniqueSources< TypeList<>, Rows... >::Type, Rows... > Type;
+    };
+
+    template< class Machine, class Event, class ...Rows >
+    struct TableDispatcherOf< Machine, Event, StrictTransitionTable<Rows...> > : TableDispatcherOf< Machine, Event, TransitionTable<Rows...> > {};
+
+
+    template< class Table, class BaseState >
+    struct TableStatesDeriveFrom;
+
+    template< class ...Rows, class BaseState >
+    struct TableStatesDeriveFrom< TransitionTable<Rows...>, BaseState >
+        : std::bool_constant< ( ( std::is_base_of<BaseState, typename Rows::SourceType>::value
+                               && std::is_base_of<BaseState, typename Rows::TargetType>::value ) && ... ) > {};
+
+    template< class ...Rows, class BaseState >
+    struct TableStatesDeriveFrom< StrictTransitionTable<Rows...>, BaseState > : TableStatesDeriveFrom< TransitionTable<Rows...>, BaseState > {};
+
+} // namespace detail
+
+
+/**
+ * @brief TransitionTable in which every source state has to handle every event type of the table
+ *
+ * @details
+ * A missing (source state, event) row is a compile error, just like processing an event type that has no row at all.
+ * Which state the statemachine is in is known only at runtime though, so the table can't reject at compile time
+ * processing an event in a state that isn't a source state of the table (e.g. a final state).
+ * That is only asserted against in debug builds; with NDEBUG such an event is ignored like with TransitionTable.
+ *
+ * @tparam Rows TransitionRow types
+ */
+template< class ...Rows >
+struct StrictTransitionTable : TransitionTable<Rows...>
+{
+    static constexpr bool isStrict = true;
+
+    static_assert( ( detail::CheckSourceHandlesAllEvents<typename Rows::SourceType, Rows...>::value && ... ) );
+};
+
+} // namespace chestnut::fsm
+
+
+#endif // __CHESTNUT_STATEMACHINE_TRANSITION_TABLE_H__
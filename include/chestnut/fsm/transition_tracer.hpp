@@ -0,0 +1,214 @@
+/**
+ * @file transition_tracer.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with TransitionTracer, recording state transitions into lock-free per-thread ring buffers
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_TRANSITION_TRACER_H__
+#define __CHESTNUT_STATEMACHINE_TRANSITION_TRACER_H__
+
+#include "config.hpp"
+#include "state_transition.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Record of one state transition made by a statemachine
+ */
+struct TransitionRecord
+{
+    /** Time of the transition from readTraceTimestamp() */
+    std::uint64_t timestamp;
+    /** Identifier of the statemachine, its address */
+    std::uint64_t machineId;
+    /** Transition type and states */
+    StateTransition transition;
+};
+
+
+/**
+ * @brief Read the timestamp counter of the CPU, or a steady clock in nanoseconds where there's none
+ *
+ * @details
+ * On x86 this is the TSC, on AArch64 the virtual counter. Timestamps are only comparable with each other,
+ * their frequency depends on the CPU.
+ */
+std::uint64_t readTraceTimestamp() noexcept;
+
+
+/**
+ * @brief Fixed-size ring buffer of transition records written by one thread and read by one thread at a time
+ *
+ * @details
+ * Writing never waits and never allocates: when the buffer is full, the record is dropped and counted instead,
+ * so a reader that doesn't keep up loses the newest records, not the ones it hasn't read yet.
+ */
+class TransitionTraceBuffer
+{
+public:
+    static constexpr std::size_t CAPACITY = CHESTNUT_FSM_TRACE_BUFFER_CAPACITY;
+    static_assert( CAPACITY > 0 && ( CAPACITY & ( CAPACITY - 1 ) ) == 0, "CHESTNUT_FSM_TRACE_BUFFER_CAPACITY has to be a power of 2!" );
+
+
+public:
+    TransitionTraceBuffer() noexcept;
+
+    TransitionTraceBuffer( const TransitionTraceBuffer& ) = delete;
+    TransitionTraceBuffer& operator=( const TransitionTraceBuffer& ) = delete;
+
+
+    /**
+     * @brief Append a record. Only the thread owning the buffer can call this
+     *
+     * @return whether there was space for the record
+     */
+    bool push( const TransitionRecord& record ) noexcept;
+
+    /**
+     * @brief Pass records to the function in the order they were written and remove them from the buffer
+     *
+     * @param f function taking const TransitionRecord&
+     * @return number of records passed
+     *
+     * @details
+     * Only one thread at a time can drain the buffer, it can be a different thread than the writer.
+     * Records written while draining may or may not be included.
+     */
+    template< typename F >
+    std::size_t drain( F&& f );
+
+    /**
+     * @brief Return the number of records that were dropped because the buffer was full
+     */
+    std::uint64_t getDroppedCount() const noexcept;
+
+    /**
+     * @brief Return whether there's no record to drain
+     */
+    bool isEmpty() const noexcept;
+
+
+private:
+    /**
+     * @brief Number of records ever written; written by the owner
+     */
+    alignas(64) std::atomic<std::uint64_t> m_head;
+    /**
+     * @brief Value of m_tail seen by the owner, so it doesn't have to read the reader's cache line on every push
+     */
+    std::uint64_t m_cachedTail;
+    std::atomic<std::uint64_t> m_droppedCount;
+    /**
+     * @brief Number of records ever drained; written by the reader
+     */
+    alignas(64) std::atomic<std::uint64_t> m_tail;
+    alignas(64) TransitionRecord m_records[CAPACITY];
+};
+
+
+/**
+ * @brief Global recorder of state transitions, with a separate ring buffer for every thread
+ *
+ * @details
+ * Statemachines record their transitions here when CHESTNUT_FSM_TRACE_TRANSITIONS is 1. When it's 0 (the default)
+ * they don't reference the tracer at all. Records can also be added manually with record().
+ *
+ * Each thread writes to its own TransitionTraceBuffer, created the first time the thread records anything,
+ * so recording is a timestamp read and a few stores without any synchronization between writers.
+ * drain() can be called from any thread concurrently with recording; readers are serialized with each other.
+ * Records are ordered per thread, records of different threads can be put in order by their timestamps.
+ * Buffers of threads that have exited are kept until they're drained.
+ * Transitions recorded by a thread after its buffer was released, e.g. by statemachines destroyed
+ * in destructors of other thread_local objects, are only counted as dropped.
+ */
+class TransitionTracer
+{
+public:
+    /**
+     * @brief Record a transition in the buffer of the calling thread
+     *
+     * @param machine address of the statemachine, used as its identifier
+     * @param transition transition that took place
+     *
+     * @throws std::bad_alloc if the buffer couldn't be allocated the first time the thread records a transition
+     */
+    static void record( const void *machine, const StateTransition& transition );
+
+    /**
+     * @brief Pass records of all threads to the function and remove them from the buffers
+     *
+     * @param f function taking const TransitionRecord&
+     * @return number of records passed
+     *
+     * @details
+     * Records are passed buffer by buffer, so they are not ordered by timestamps across threads.
+     */
+    template< typename F >
+    static std::size_t drain( F&& f );
+
+    /**
+     * @brief Return the number of records dropped by all threads because their buffers were full
+     */
+    static std::uint64_t getDroppedCount();
+
+
+private:
+    /**
+     * @brief Buffer of a thread, registered when the thread records for the first time
+     */
+    struct ThreadBuffer
+    {
+        std::shared_ptr<TransitionTraceBuffer> buffer;
+
+        ThreadBuffer();
+        ~ThreadBuffer();
+    };
+
+    /**
+     * @brief Plain pointer to the buffer of a thread, cleared when the ThreadBuffer releases it
+     *
+     * @details
+     * Trivial, so it's accessed without the initialization check of a thread_local object and it outlives ThreadBuffer.
+     */
+    struct ThreadBufferCache
+    {
+        TransitionTraceBuffer *buffer;
+        bool isReleased;
+    };
+
+    /**
+     * @brief Buffers of all threads; a buffer only referenced from here belongs to a thread that has exited
+     */
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector< std::shared_ptr<TransitionTraceBuffer> > buffers;
+        // dropped by removed buffers and by threads recording after their buffer was released
+        std::uint64_t removedDroppedCount = 0;
+    };
+
+    static Registry& registry();
+    static ThreadBufferCache& threadBufferCache() noexcept;
+    static TransitionTraceBuffer *threadBuffer();
+};
+
+} // namespace chestnut::fsm
+
+
+#include "transition_tracer.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_TRANSITION_TRACER_H__
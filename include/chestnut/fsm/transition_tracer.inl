@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <chrono>
+
+#if defined(_MSC_VER) && ( defined(_M_X64) || defined(_M_IX86) )
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+namespace chestnut::fsm
+{
+
+inline std::uint64_t readTraceTimestamp() noexcept
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    std::uint64_t ticks;
+    asm volatile( "mrs %0, cntvct_el0" : "=r"(ticks) );
+    return ticks;
+#else
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+#endif
+}
+
+
+
+inline TransitionTraceBuffer::TransitionTraceBuffer() noexcept
+{
+    m_head.store( 0, std::memory_order_relaxed );
+    m_cachedTail = 0;
+    m_droppedCount.store( 0, std::memory_order_relaxed );
+    m_tail.store( 0, std::memory_order_relaxed );
+}
+
+inline bool TransitionTraceBuffer::push( const TransitionRecord& record ) noexcept
+{
+    const std::uint64_t head = m_head.load( std::memory_order_relaxed );
+
+    if( head - m_cachedTail >= CAPACITY )
+    {
+        m_cachedTail = m_tail.load( std::memory_order_acquire );
+        if( head - m_cachedTail >= CAPACITY )
+        {
+            m_droppedCount.store( m_droppedCount.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+            return false;
+        }
+    }
+
+    m_records[ head & ( CAPACITY - 1 ) ] = record;
+    m_head.store( head + 1, std::memory_order_release );
+
+    return true;
+}
+
+template<typename F>
+inline std::size_t TransitionTraceBuffer::drain( F&& f )
+{
+    const std::uint64_t tail = m_tail.load( std::memory_order_relaxed );
+    const std::uint64_t head = m_head.load( std::memory_order_acquire );
+
+    for( std::uint64_t i = tail; i != head; i++ )
+    {
+        f( m_records[ i & ( CAPACITY - 1 ) ] );
+    }
+
+    // only now the writer can reuse the slots
+    m_tail.store( head, std::memory_order_release );
+
+    return (std::size_t)( head - tail );
+}
+
+inline std::uint64_t TransitionTraceBuffer::getDroppedCount() const noexcept
+{
+    return m_droppedCount.load( std::memory_order_relaxed );
+}
+
+inline bool TransitionTraceBuffer::isEmpty() const noexcept
+{
+    return m_head.load( std::memory_order_acquire ) == m_tail.load( std::memory_order_relaxed );
+}
+
+
+
+inline void TransitionTracer::record( const void *machine, const StateTransition& transition )
+{
+    TransitionRecord record;
+    record.timestamp = readTraceTimestamp();
+    record.machineId = (std::uint64_t)(std::uintptr_t)machine;
+    record.transition = transition;
+
+    TransitionTraceBuffer *buffer = threadBuffer();
+    if( buffer )
+    {
+        buffer->push( record );
+    }
+    else
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock( reg.mutex );
+        reg.removedDroppedCount++;
+    }
+}
+
+template<typename F>
+inline std::size_t TransitionTracer::drain( F&& f )
+{
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock( reg.mutex );
+
+    std::size_t count = 0;
+    for( const std::shared_ptr<TransitionTraceBuffer>& buffer : reg.buffers )
+    {
+        count += buffer->drain( f );
+    }
+
+    // buffers of exited threads are gone once everything was read from them
+    reg.buffers.erase( std::remove_if( reg.buffers.begin(), reg.buffers.end(), [&reg]( const std::shared_ptr<TransitionTraceBuffer>& buffer ) {
+        if( buffer.use_count() == 1 && buffer->isEmpty() )
+        {
+            reg.removedDroppedCount += buffer->getDroppedCount();
+            return true;
+        }
+        return false;
+    }), reg.buffers.end() );
+
+    return count;
+}
+
+inline std::uint64_t TransitionTracer::getDroppedCount()
+{
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock( reg.mutex );
+
+    std::uint64_t count = reg.removedDroppedCount;
+    for( const std::shared_ptr<TransitionTraceBuffer>& buffer : reg.buffers )
+    {
+        count += buffer->getDroppedCount();
+    }
+
+    return count;
+}
+
+inline TransitionTracer::ThreadBuffer::ThreadBuffer()
+{
+    buffer = std::make_shared<TransitionTraceBuffer>();
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock( reg.mutex );
+    reg.buffers.push_back( buffer );
+}
+
+inline TransitionTracer::ThreadBuffer::~ThreadBuffer()
+{
+    // after this the registry may hold the only reference and remove the buffer on the next drain
+    ThreadBufferCache& cache = threadBufferCache();
+    cache.buffer = nullptr;
+    cache.isReleased = true;
+}
+
+inline TransitionTracer::Registry& TransitionTracer::registry()
+{
+    static Registry reg;
+    return reg;
+}
+
+inline TransitionTracer::ThreadBufferCache& TransitionTracer::threadBufferCache() noexcept
+{
+    thread_local ThreadBufferCache cache { nullptr, false };
+    return cache;
+}
+
+inline TransitionTraceBuffer *TransitionTracer::threadBuffer()
+{
+    ThreadBufferCache& cache = threadBufferCache();
+    if( !cache.buffer && !cache.isReleased )
+    {
+        // a destroyed thread_local can't be constructed again, so it's only done before it's been released
+        thread_local ThreadBuffer threadBuffer;
+        cache.buffer = threadBuffer.buffer.get();
+    }
+
+    return cache.buffer;
+}
+
+} // namespace chestnut::fsm
@@ -0,0 +1,97 @@
+/**
+ * @file work_stealing_deque.hpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Header file with the lock-free work-stealing deque used by Executor
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#ifndef __CHESTNUT_STATEMACHINE_WORK_STEALING_DEQUE_H__
+#define __CHESTNUT_STATEMACHINE_WORK_STEALING_DEQUE_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace chestnut::fsm
+{
+
+/**
+ * @brief Bounded lock-free deque of pointers with a single owner thread and any number of thief threads
+ *
+ * @details
+ * The algorithm by Chase and Lev. The owner pushes and pops at the bottom, so it keeps working on what it added last,
+ * while thieves take from the top - the oldest elements. Neither side ever waits for the other,
+ * only a thief racing with the owner or with another thief for the last element may fail and has to try again.
+ *
+ * The capacity is fixed, push() fails if the deque is full.
+ *
+ * @tparam T type of pointed elements
+ */
+template< class T >
+class WorkStealingDeque
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param capacity maximal number of elements, rounded up to a power of two
+     */
+    explicit WorkStealingDeque( std::size_t capacity );
+
+    WorkStealingDeque( const WorkStealingDeque& ) = delete;
+    WorkStealingDeque& operator=( const WorkStealingDeque& ) = delete;
+
+
+    /**
+     * @brief Add an element at the bottom. Only the owner thread can call this
+     *
+     * @return false if the deque is full
+     */
+    bool push( T *element ) noexcept;
+
+    /**
+     * @brief Take the element from the bottom. Only the owner thread can call this
+     *
+     * @return element or nullptr if the deque is empty
+     */
+    T *pop() noexcept;
+
+    /**
+     * @brief Take the element from the top. Can be called from any thread
+     *
+     * @return element or nullptr if the deque is empty or another thread took the element first
+     */
+    T *steal() noexcept;
+
+    /**
+     * @brief Get the approximate number of elements, exact only when no other thread uses the deque
+     */
+    std::size_t getSizeApprox() const noexcept;
+
+
+private:
+    std::size_t m_mask;
+    std::unique_ptr< std::atomic<T *>[] > m_buffer;
+
+    /**
+     * @brief Index of the oldest element; advanced by thieves and by the owner taking the last element
+     */
+    alignas(64) std::atomic<std::int64_t> m_top;
+    /**
+     * @brief Index one past the newest element; written only by the owner
+     */
+    alignas(64) std::atomic<std::int64_t> m_bottom;
+};
+
+} // namespace chestnut::fsm
+
+
+#include "work_stealing_deque.inl"
+
+
+#endif // __CHESTNUT_STATEMACHINE_WORK_STEALING_DEQUE_H__
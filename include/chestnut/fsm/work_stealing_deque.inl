@@ -0,0 +1,101 @@
+namespace chestnut::fsm
+{
+
+template<class T>
+inline WorkStealingDeque<T>::WorkStealingDeque( std::size_t capacity )
+{
+    std::size_t roundedCapacity = 1;
+    while( roundedCapacity < capacity )
+    {
+        roundedCapacity <<= 1;
+    }
+
+    m_mask = roundedCapacity - 1;
+    m_buffer.reset( new std::atomic<T *>[ roundedCapacity ] );
+    for( std::size_t i = 0; i < roundedCapacity; i++ )
+    {
+        m_buffer[i].store( nullptr, std::memory_order_relaxed );
+    }
+
+    m_top.store( 0, std::memory_order_relaxed );
+    m_bottom.store( 0, std::memory_order_relaxed );
+}
+
+template<class T>
+inline bool WorkStealingDeque<T>::push( T *element ) noexcept
+{
+    std::int64_t bottom = m_bottom.load( std::memory_order_relaxed );
+    std::int64_t top = m_top.load( std::memory_order_acquire );
+
+    if( bottom - top > static_cast<std::int64_t>( m_mask ) )
+    {
+        return false;
+    }
+
+    m_buffer[ static_cast<std::size_t>( bottom ) & m_mask ].store( element, std::memory_order_relaxed );
+    // publishes the element to thieves that see the new bottom
+    m_bottom.store( bottom + 1, std::memory_order_release );
+    return true;
+}
+
+template<class T>
+inline T *WorkStealingDeque<T>::pop() noexcept
+{
+    std::int64_t bottom = m_bottom.load( std::memory_order_relaxed ) - 1;
+
+    // reserving the bottom element has to be visible to thieves before the top is read,
+    // otherwise the owner and a thief could both take the same last element
+    m_bottom.store( bottom, std::memory_order_seq_cst );
+    std::int64_t top = m_top.load( std::memory_order_seq_cst );
+
+    if( top > bottom )
+    {
+        // empty
+        m_bottom.store( bottom + 1, std::memory_order_relaxed );
+        return nullptr;
+    }
+
+    T *element = m_buffer[ static_cast<std::size_t>( bottom ) & m_mask ].load( std::memory_order_relaxed );
+
+    if( top == bottom )
+    {
+        // last element - race the thieves for it
+        if( !m_top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+        {
+            element = nullptr;
+        }
+        m_bottom.store( bottom + 1, std::memory_order_relaxed );
+    }
+
+    return element;
+}
+
+template<class T>
+inline T *WorkStealingDeque<T>::steal() noexcept
+{
+    std::int64_t top = m_top.load( std::memory_order_seq_cst );
+    std::int64_t bottom = m_bottom.load( std::memory_order_seq_cst );
+
+    if( top >= bottom )
+    {
+        return nullptr;
+    }
+
+    T *element = m_buffer[ static_cast<std::size_t>( top ) & m_mask ].load( std::memory_order_relaxed );
+
+    if( !m_top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+    {
+        return nullptr;
+    }
+
+    return element;
+}
+
+template<class T>
+inline std::size_t WorkStealingDeque<T>::getSizeApprox() const noexcept
+{
+    std::int64_t size = m_bottom.load( std::memory_order_relaxed ) - m_top.load( std::memory_order_relaxed );
+    return size > 0 ? static_cast<std::size_t>( size ) : 0;
+}
+
+} // namespace chestnut::fsm
@@ -0,0 +1,223 @@
+/**
+ * @file concurrent_statemachine.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of ConcurrentStatemachine - order of posted requests, requests of many producers and waking up the owner thread
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/concurrent_statemachine.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+class TestStatemachine : public Statemachine<>
+{
+public:
+    std::vector<int> log;
+};
+
+class StateIdle : public State<TestStatemachine> {};
+class StateWalking : public State<TestStatemachine> {};
+class StateRunning : public State<TestStatemachine>
+{
+public:
+    int speed;
+
+    StateRunning(int speed_ = 0) : speed(speed_) {}
+
+    void onEnterState(StateTransition) override
+    {
+        getParent().log.push_back(speed);
+    }
+};
+
+struct EventRun {};
+
+using TestTable = TransitionTable<
+    TransitionRow<StateIdle, EventRun, StateRunning>,
+    TransitionRow<StateWalking, EventRun, StateRunning>
+>;
+
+
+int main()
+{
+    runTest("requests are executed in the order they were posted", [] {
+        ConcurrentStatemachine<TestStatemachine> concurrent;
+        TestStatemachine& machine = concurrent.getStatemachine();
+        machine.initState<StateIdle>();
+
+        // goto keeps the init state at the bottom of the stack
+        concurrent.postGotoState<StateWalking>();
+        concurrent.postPushState<StateRunning>(5);
+        concurrent.post([](TestStatemachine& sm) { sm.log.push_back((int)sm.getStateStackSize()); });
+        concurrent.postPopState();
+        concurrent.post([](TestStatemachine& sm) { sm.log.push_back((int)sm.getStateStackSize()); });
+
+        CHECK(!concurrent.isInboxEmpty());
+        CHECK(machine.isCurrentlyInState<StateIdle>());
+
+        CHECK(concurrent.processInbox() == 5);
+        CHECK(concurrent.isInboxEmpty());
+        CHECK(machine.isCurrentlyInState<StateWalking>());
+        CHECK((machine.log == std::vector<int> { 5, 3, 2 }));
+    });
+
+    runTest("processInbox executes at most maxRequests", [] {
+        ConcurrentStatemachine<TestStatemachine> concurrent;
+        for(int i = 0; i < 10; i++)
+        {
+            concurrent.post([i](TestStatemachine& sm) { sm.log.push_back(i); });
+        }
+
+        CHECK(concurrent.processInbox(4) == 4);
+        CHECK(concurrent.getStatemachine().log.size() == 4);
+        CHECK(concurrent.processInbox() == 6);
+        CHECK(concurrent.processInbox() == 0);
+        CHECK(concurrent.getStatemachine().log.back() == 9);
+    });
+
+    runTest("posted events go through the transition table", [] {
+        ConcurrentStatemachine<TestStatemachine> concurrent;
+        concurrent.getStatemachine().initState<StateWalking>();
+
+        concurrent.postEvent<TestTable>(EventRun {});
+        concurrent.processInbox();
+
+        CHECK(concurrent.getStatemachine().isCurrentlyInState<StateRunning>());
+    });
+
+#if CHESTNUT_FSM_HAS_EXCEPTIONS
+    runTest("requests after a throwing one stay in the inbox", [] {
+        ConcurrentStatemachine<TestStatemachine> concurrent;
+        concurrent.post([](TestStatemachine& sm) { sm.log.push_back(1); });
+        concurrent.post([](TestStatemachine&) { throw std::runtime_error("request failed"); });
+        concurrent.post([](TestStatemachine& sm) { sm.log.push_back(3); });
+
+        bool isThrown = false;
+        try
+        {
+            concurrent.processInbox();
+        }
+        catch(const std::runtime_error&)
+        {
+            isThrown = true;
+        }
+
+        CHECK(isThrown);
+        CHECK(concurrent.getStatemachine().log.size() == 1);
+        CHECK(concurrent.processInbox() == 1);
+        CHECK(concurrent.getStatemachine().log.back() == 3);
+    });
+#endif
+
+    runTest("waitAndProcessInbox returns after the timeout when nothing is posted", [] {
+        ConcurrentStatemachine<TestStatemachine> concurrent;
+
+        auto start = std::chrono::steady_clock::now();
+        CHECK(concurrent.waitAndProcessInbox(std::chrono::milliseconds(20)) == 0);
+        CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+    });
+
+    runTest("all requests of many producers are executed, each producer's in order", [] {
+        const int producerCount = 4;
+        const int requestsPerProducer = 50000;
+
+        ConcurrentStatemachine<TestStatemachine> concurrent;
+        concurrent.getStatemachine().initState<StateIdle>();
+
+        std::vector<int> nextExpected(producerCount, 0);
+        bool isOrdered = true;
+
+        std::vector<std::thread> producers;
+        for(int p = 0; p < producerCount; p++)
+        {
+            producers.emplace_back([&concurrent, &nextExpected, &isOrdered, p] {
+                for(int i = 0; i < requestsPerProducer; i++)
+                {
+                    // executed on the owner thread, so the captured vectors aren't shared between threads
+                    concurrent.post([&nextExpected, &isOrdered, p, i](TestStatemachine& sm) {
+                        isOrdered = isOrdered && nextExpected[p] == i;
+                        nextExpected[p] = i + 1;
+                        if(i % 2 == 0)
+                        {
+                            sm.gotoState<StateWalking>();
+                        }
+                        else
+                        {
+                            sm.gotoState<StateIdle>();
+                        }
+                    });
+                }
+            });
+        }
+
+        std::size_t processed = 0;
+        while(processed < std::size_t(producerCount * requestsPerProducer))
+        {
+            processed += concurrent.waitAndProcessInbox(std::chrono::seconds(5));
+        }
+
+        for(std::thread& producer : producers)
+        {
+            producer.join();
+        }
+
+        CHECK(processed == std::size_t(producerCount * requestsPerProducer));
+        CHECK(isOrdered);
+        for(int p = 0; p < producerCount; p++)
+        {
+            CHECK(nextExpected[p] == requestsPerProducer);
+        }
+        CHECK(concurrent.isInboxEmpty());
+    });
+
+    runTest("a sleeping owner is woken up by every post (ping-pong)", [] {
+        const int rounds = 20000;
+
+        ConcurrentStatemachine<TestStatemachine> concurrent;
+        std::atomic<int> acknowledged { 0 };
+
+        // the producer posts only after the previous request was executed, so the owner goes to sleep before most posts;
+        // a lost wakeup would leave the owner asleep until the long timeout and return 0
+        std::thread producer([&concurrent, &acknowledged] {
+            for(int i = 0; i < rounds; i++)
+            {
+                while(acknowledged.load() < i)
+                {
+                    std::this_thread::yield();
+                }
+                concurrent.post([&acknowledged](TestStatemachine&) { acknowledged.fetch_add(1); });
+            }
+        });
+
+        int timedOutCount = 0;
+        auto start = std::chrono::steady_clock::now();
+        while(acknowledged.load() < rounds && std::chrono::steady_clock::now() - start < std::chrono::seconds(60))
+        {
+            if(concurrent.waitAndProcessInbox(std::chrono::seconds(2)) == 0)
+            {
+                timedOutCount++;
+            }
+        }
+
+        producer.join();
+
+        CHECK(acknowledged.load() == rounds);
+        CHECK(timedOutCount == 0);
+    });
+
+    return testResult();
+}
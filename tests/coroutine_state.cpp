@@ -0,0 +1,119 @@
+/**
+ * @file coroutine_state.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of CoroutineState - when transitions requested by the body are executed and what the body learns about them. Requires C++20
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/coroutine_state.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+class TestStatemachine : public Statemachine<> {};
+
+std::vector<std::string> events;
+
+class StateI : public State<TestStatemachine> {};
+
+class StateB : public State<TestStatemachine>
+{
+public:
+    void onEnterState(StateTransition) override
+    {
+        events.push_back("enter B");
+    }
+};
+
+class StateRefusing : public State<TestStatemachine>
+{
+public:
+    bool canEnterState(StateTransition) const noexcept override
+    {
+        return false;
+    }
+};
+
+// Goes to B straight away and logs when its own onEnterState returns
+class StateGoingToB : public CoroutineState<TestStatemachine>
+{
+public:
+    void onEnterState(StateTransition transition) override
+    {
+        CoroutineState::onEnterState(transition);
+        events.push_back("entered");
+    }
+
+protected:
+    StateTask body(StateTransition) override
+    {
+        co_await awaitGotoState<StateB>();
+    }
+};
+
+// Tries a state which refuses to be entered and goes to B instead
+class StateRetrying : public CoroutineState<TestStatemachine>
+{
+protected:
+    StateTask body(StateTransition) override
+    {
+        const bool result = co_await awaitGotoState<StateRefusing>();
+        events.push_back(result ? "accepted" : "refused");
+        co_await awaitGotoState<StateB>();
+    }
+};
+
+
+int main()
+{
+    runTest("transition of the body starts after onEnterState returns", [] {
+        events.clear();
+        TestStatemachine sm;
+        CHECK(sm.initState<StateI>());
+        CHECK(sm.gotoState<StateGoingToB>());
+        CHECK(sm.getCurrentStateType() == stateIdOf<StateB>());
+        CHECK(events == std::vector<std::string>({"entered", "enter B"}));
+    });
+
+    runTest("transition of the body starts after onEnterState returns in run-to-completion mode", [] {
+        events.clear();
+        TestStatemachine sm;
+        sm.setRunToCompletion(true);
+        CHECK(sm.initState<StateI>());
+        CHECK(sm.gotoState<StateGoingToB>());
+        CHECK(sm.getCurrentStateType() == stateIdOf<StateB>());
+        CHECK(events == std::vector<std::string>({"entered", "enter B"}));
+    });
+
+    runTest("body learns that its transition was refused", [] {
+        events.clear();
+        TestStatemachine sm;
+        CHECK(sm.initState<StateI>());
+        CHECK(sm.gotoState<StateRetrying>());
+        CHECK(sm.getCurrentStateType() == stateIdOf<StateB>());
+        CHECK(events == std::vector<std::string>({"refused", "enter B"}));
+    });
+
+    runTest("body learns that its transition was refused in run-to-completion mode", [] {
+        events.clear();
+        TestStatemachine sm;
+        sm.setRunToCompletion(true);
+        CHECK(sm.initState<StateI>());
+        CHECK(sm.gotoState<StateRetrying>());
+        CHECK(sm.getCurrentStateType() == stateIdOf<StateB>());
+        CHECK(events == std::vector<std::string>({"refused", "enter B"}));
+        CHECK(sm.getPendingTransitionCount() == 0);
+    });
+
+    return testResult();
+}
@@ -0,0 +1,279 @@
+/**
+ * @file executor.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of Executor and ExecutorStatemachine - running every task once, overflow of local deques,
+ * stealing, waking up sleeping workers and running queued tasks on destruction
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/executor.hpp>
+#include <chestnut/fsm/executor_statemachine.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+class CountingTask : public ExecutorTask
+{
+public:
+    std::atomic<int> runCount { 0 };
+
+    void runTask() override
+    {
+        runCount.fetch_add(1);
+    }
+};
+
+// Schedules childCount children from a worker thread, so they go to the worker's own deque
+class SpawningTask : public ExecutorTask
+{
+public:
+    Executor *executor = nullptr;
+    std::vector<ExecutorTask *> children;
+
+    void runTask() override
+    {
+        for(ExecutorTask *child : children)
+        {
+            executor->schedule(child);
+        }
+    }
+};
+
+// Remembers which threads it was run on and takes a while, so that other workers have time to steal
+class SlowTask : public ExecutorTask
+{
+public:
+    std::mutex *mutex = nullptr;
+    std::set<std::thread::id> *threadIds = nullptr;
+    std::atomic<int> *runCount = nullptr;
+
+    void runTask() override
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        std::lock_guard<std::mutex> lock(*mutex);
+        threadIds->insert(std::this_thread::get_id());
+        runCount->fetch_add(1);
+    }
+};
+
+// Schedules itself again until it has run the given number of times
+class RepeatingTask : public ExecutorTask
+{
+public:
+    Executor *executor = nullptr;
+    int remainingRuns = 0;
+    std::atomic<int> runCount { 0 };
+
+    void runTask() override
+    {
+        runCount.fetch_add(1);
+        if(--remainingRuns > 0)
+        {
+            executor->schedule(this);
+        }
+    }
+};
+
+
+class TestStatemachine : public Statemachine<>
+{
+public:
+    int transitionCount = 0;
+};
+
+class StateIdle : public State<TestStatemachine>
+{
+public:
+    void onEnterState(StateTransition) override { getParent().transitionCount++; }
+};
+
+class StateWorking : public State<TestStatemachine>
+{
+public:
+    void onEnterState(StateTransition) override { getParent().transitionCount++; }
+};
+
+
+int main()
+{
+    runTest("every task scheduled from outside runs once", [] {
+        Executor executor(4);
+        std::vector<CountingTask> tasks(10000);
+
+        for(CountingTask& task : tasks)
+        {
+            executor.schedule(&task);
+        }
+        executor.waitUntilIdle();
+
+        int wrongCount = 0;
+        for(CountingTask& task : tasks)
+        {
+            wrongCount += task.runCount.load() != 1;
+        }
+        CHECK(wrongCount == 0);
+    });
+
+    runTest("tasks overflowing a worker's own deque go to the injection queue", [] {
+        Executor executor(2);
+
+        std::vector<CountingTask> children(3 * Executor::LOCAL_QUEUE_CAPACITY);
+
+        SpawningTask spawner;
+        spawner.executor = &executor;
+        for(CountingTask& child : children)
+        {
+            spawner.children.push_back(&child);
+        }
+
+        executor.schedule(&spawner);
+        executor.waitUntilIdle();
+
+        int wrongCount = 0;
+        for(CountingTask& child : children)
+        {
+            wrongCount += child.runCount.load() != 1;
+        }
+        CHECK(wrongCount == 0);
+    });
+
+    runTest("tasks scheduled by one worker are stolen by others", [] {
+        Executor executor(4);
+
+        std::mutex mutex;
+        std::set<std::thread::id> threadIds;
+        std::atomic<int> runCount { 0 };
+
+        std::vector<SlowTask> children(400);
+
+        SpawningTask spawner;
+        spawner.executor = &executor;
+        for(SlowTask& child : children)
+        {
+            child.mutex = &mutex;
+            child.threadIds = &threadIds;
+            child.runCount = &runCount;
+            spawner.children.push_back(&child);
+        }
+
+        executor.schedule(&spawner);
+        executor.waitUntilIdle();
+
+        CHECK(runCount.load() == 400);
+        CHECK(threadIds.size() > 1);
+    });
+
+    runTest("sleeping workers wake up for every newly scheduled task", [] {
+        Executor executor(2);
+        int lateCount = 0;
+
+        for(int round = 0; round < 50; round++)
+        {
+            // long enough for the workers to stop spinning and go to sleep
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+            CountingTask task;
+            executor.schedule(&task);
+
+            auto start = std::chrono::steady_clock::now();
+            while(task.runCount.load() == 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(2))
+            {
+                std::this_thread::yield();
+            }
+            lateCount += task.runCount.load() == 0;
+
+            // the task can't be destroyed while the executor might still touch it
+            executor.waitUntilIdle();
+        }
+
+        CHECK(lateCount == 0);
+    });
+
+    runTest("destroying the executor runs the tasks still queued", [] {
+        std::vector<CountingTask> tasks(20000);
+        RepeatingTask repeating;
+        repeating.remainingRuns = 1000;
+
+        {
+            Executor executor(2);
+            repeating.executor = &executor;
+
+            for(CountingTask& task : tasks)
+            {
+                executor.schedule(&task);
+            }
+            executor.schedule(&repeating);
+        }
+
+        int wrongCount = 0;
+        for(CountingTask& task : tasks)
+        {
+            wrongCount += task.runCount.load() != 1;
+        }
+        CHECK(wrongCount == 0);
+        CHECK(repeating.runCount.load() == 1000);
+    });
+
+    runTest("transitions posted to ExecutorStatemachines are executed before the executor is gone", [] {
+        const int machineCount = 16;
+        const int requestsPerMachine = 500;
+
+        std::vector<std::unique_ptr<ExecutorStatemachine<TestStatemachine>>> machines;
+        {
+            Executor executor(4);
+            for(int i = 0; i < machineCount; i++)
+            {
+                machines.emplace_back(new ExecutorStatemachine<TestStatemachine>(executor));
+                machines.back()->getStatemachine().initState<StateIdle>();
+            }
+
+            std::vector<std::thread> producers;
+            for(int p = 0; p < 2; p++)
+            {
+                producers.emplace_back([&machines] {
+                    for(int r = 0; r < requestsPerMachine / 2; r++)
+                    {
+                        // push and pop in one request, the requests of the two producers interleave
+                        for(auto& machine : machines)
+                        {
+                            machine->post([](TestStatemachine& sm) {
+                                sm.pushState<StateWorking>();
+                                sm.popState();
+                            });
+                        }
+                    }
+                });
+            }
+            for(std::thread& producer : producers)
+            {
+                producer.join();
+            }
+        }
+
+        // init plus one enter for every push and every pop
+        int wrongCount = 0;
+        for(auto& machine : machines)
+        {
+            wrongCount += machine->getPendingRequestCount() != 0;
+            wrongCount += machine->getStatemachine().transitionCount != 1 + 2 * requestsPerMachine;
+        }
+        CHECK(wrongCount == 0);
+    });
+
+    return testResult();
+}
@@ -0,0 +1,274 @@
+/**
+ * @file hierarchical_statemachine.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of HierarchicalStatemachine - order of exits and entries, history, event bubbling and transitions requested from callbacks
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+// Root
+// +-- A
+// |   +-- A1 (initial)
+// |   +-- A2
+// |       +-- A2x (initial)
+// |       +-- A2y
+// +-- B
+// +-- C
+
+struct Root;
+struct A;
+struct A1;
+struct A2;
+struct A2x;
+struct A2y;
+struct B;
+struct C;
+
+using TestStatemachine = HierarchicalStatemachine<Root, A, A1, A2, A2x, A2y, B, C>;
+
+std::vector<std::string> events;
+bool isSecondRequestAccepted = false;
+int a2yConstructionCount = 0;
+int a2yRearmCount = 0;
+
+struct Ping {};
+struct Kick {};
+
+#define LOGGING_CALLBACKS(name) \
+    void onEnterState(StateTransition) { events.push_back("enter " #name); } \
+    void onLeaveState(StateTransition) { events.push_back("leave " #name); }
+
+struct Root
+{
+    LOGGING_CALLBACKS(Root)
+};
+
+struct A
+{
+    typedef Root ParentState;
+    typedef A1 InitialState;
+    LOGGING_CALLBACKS(A)
+
+    void onEvent(const Ping&) { events.push_back("A handles Ping"); }
+    void onEvent(const Kick&) { events.push_back("A handles Kick"); }
+};
+
+struct A1
+{
+    typedef A ParentState;
+    LOGGING_CALLBACKS(A1)
+
+    void onEvent(const Kick&) { events.push_back("A1 handles Kick"); }
+};
+
+struct A2
+{
+    typedef A ParentState;
+    typedef A2x InitialState;
+    LOGGING_CALLBACKS(A2)
+};
+
+struct A2x
+{
+    typedef A2 ParentState;
+    LOGGING_CALLBACKS(A2x)
+};
+
+// Counts its constructions and entries, to tell a kept state object from a new one
+struct A2y
+{
+    typedef A2 ParentState;
+
+    int enterCount = 0;
+
+    A2y() { a2yConstructionCount++; }
+
+    void onRearmState() { a2yRearmCount++; }
+    void onEnterState(StateTransition) { enterCount++; events.push_back("enter A2y"); }
+    void onLeaveState(StateTransition) { events.push_back("leave A2y"); }
+};
+
+// Goes back to A1 as soon as it is entered
+struct B
+{
+    typedef Root ParentState;
+
+    void onEnterState(TestStatemachine& machine, StateTransition);
+    void onLeaveState(StateTransition) { events.push_back("leave B"); }
+};
+
+struct C
+{
+    typedef Root ParentState;
+    LOGGING_CALLBACKS(C)
+};
+
+void B::onEnterState(TestStatemachine& machine, StateTransition)
+{
+    events.push_back("enter B");
+    CHECK(machine.gotoState<A1>());
+    isSecondRequestAccepted = machine.gotoState<A2>();
+    // the requested transition didn't happen yet
+    CHECK(machine.isCurrentlyInState<B>());
+    events.push_back("entered B");
+}
+
+
+int main()
+{
+    runTest("initState enters ancestors first and then initial states", [] {
+        events.clear();
+        TestStatemachine sm;
+        CHECK(sm.initState<A>());
+        CHECK(sm.isCurrentlyInState<A1>());
+        CHECK(sm.isInState<A>() && sm.isInState<Root>());
+        CHECK(sm.getActiveStateCount() == 3);
+        CHECK(events == std::vector<std::string>({"enter Root", "enter A", "enter A1"}));
+    });
+
+    runTest("gotoState leaves and enters only states below the least common ancestor", [] {
+        TestStatemachine sm;
+        CHECK(sm.initState<A1>());
+
+        events.clear();
+        CHECK(sm.gotoState<A2>());
+        CHECK(sm.isCurrentlyInState<A2x>());
+        CHECK(events == std::vector<std::string>({"leave A1", "enter A2", "enter A2x"}));
+
+        events.clear();
+        CHECK(sm.gotoState<A2y>());
+        CHECK(events == std::vector<std::string>({"leave A2x", "enter A2y"}));
+
+        events.clear();
+        CHECK(sm.gotoState<A1>());
+        CHECK(events == std::vector<std::string>({"leave A2y", "leave A2", "enter A1"}));
+    });
+
+    runTest("gotoState to an ancestor leaves and re-enters it", [] {
+        TestStatemachine sm;
+        CHECK(sm.initState<A2y>());
+
+        events.clear();
+        CHECK(sm.gotoState<A>());
+        CHECK(sm.isCurrentlyInState<A1>());
+        CHECK(events == std::vector<std::string>({"leave A2y", "leave A2", "leave A", "enter A", "enter A1"}));
+
+        events.clear();
+        CHECK(!sm.gotoState<A1>());
+        CHECK(events.empty());
+    });
+
+    runTest("ShallowHistory enters the last nested state and then initial states", [] {
+        TestStatemachine sm;
+        CHECK(sm.initState<A2y>());
+        CHECK(sm.gotoState<C>());
+
+        events.clear();
+        CHECK(sm.gotoState<ShallowHistory<A>>());
+        CHECK(sm.isCurrentlyInState<A2x>());
+        CHECK(events == std::vector<std::string>({"leave C", "enter A", "enter A2", "enter A2x"}));
+    });
+
+    runTest("DeepHistory enters the whole last nested configuration", [] {
+        TestStatemachine sm;
+        CHECK(sm.initState<A2y>());
+        CHECK(sm.gotoState<C>());
+
+        events.clear();
+        CHECK(sm.gotoState<DeepHistory<A>>());
+        CHECK(sm.isCurrentlyInState<A2y>());
+        CHECK(events == std::vector<std::string>({"leave C", "enter A", "enter A2", "enter A2y"}));
+    });
+
+    runTest("history of a state that was never left enters it normally", [] {
+        TestStatemachine sm;
+        CHECK(sm.initState<C>());
+        CHECK(sm.gotoState<DeepHistory<A>>());
+        CHECK(sm.isCurrentlyInState<A1>());
+
+        CHECK(sm.gotoState<A2y>());
+        CHECK(sm.gotoState<C>());
+        sm.clearHistory();
+        CHECK(sm.gotoState<ShallowHistory<A>>());
+        CHECK(sm.isCurrentlyInState<A1>());
+    });
+
+    runTest("history constructs states again unless persistent states are enabled", [] {
+        TestStatemachine sm;
+        a2yConstructionCount = 0;
+        a2yRearmCount = 0;
+        CHECK(sm.initState<A2y>());
+        CHECK(sm.gotoState<C>());
+        CHECK(sm.gotoState<DeepHistory<A>>());
+        CHECK(a2yConstructionCount == 2);
+        CHECK(a2yRearmCount == 0);
+        CHECK(sm.getState<A2y>()->enterCount == 1);
+
+        sm.setPersistentStates(true);
+        CHECK(sm.gotoState<C>());
+        CHECK(sm.gotoState<DeepHistory<A>>());
+        CHECK(sm.gotoState<C>());
+        CHECK(sm.gotoState<DeepHistory<A>>());
+        CHECK(a2yConstructionCount == 2);
+        CHECK(a2yRearmCount == 2);
+        CHECK(sm.getState<A2y>()->enterCount == 3);
+
+        // disabling the mode drops the kept object
+        CHECK(sm.gotoState<C>());
+        sm.setPersistentStates(false);
+        CHECK(sm.gotoState<DeepHistory<A>>());
+        CHECK(a2yConstructionCount == 3);
+        CHECK(sm.getState<A2y>()->enterCount == 1);
+    });
+
+    runTest("events bubble up to the innermost ancestor handling them", [] {
+        TestStatemachine sm;
+        CHECK(sm.initState<A1>());
+
+        events.clear();
+        CHECK(sm.dispatchEvent(Ping{}));
+        CHECK(sm.dispatchEvent(Kick{}));
+        CHECK(events == std::vector<std::string>({"A handles Ping", "A1 handles Kick"}));
+
+        CHECK(sm.gotoState<A2y>());
+        events.clear();
+        CHECK(sm.dispatchEvent(Kick{}));
+        CHECK(events == std::vector<std::string>({"A handles Kick"}));
+    });
+
+    runTest("transition requested from a callback runs after the callback and only one can be pending", [] {
+        TestStatemachine sm;
+        CHECK(sm.initState<A1>());
+
+        events.clear();
+        isSecondRequestAccepted = true;
+        CHECK(sm.gotoState<B>());
+        CHECK(!isSecondRequestAccepted);
+        CHECK(sm.isCurrentlyInState<A1>());
+        CHECK(events == std::vector<std::string>({"leave A1", "leave A", "enter B", "entered B", "leave B", "enter A", "enter A1"}));
+    });
+
+    runTest("destructor leaves active states from the innermost one", [] {
+        {
+            TestStatemachine sm;
+            CHECK(sm.initState<A2y>());
+            events.clear();
+        }
+        CHECK(events == std::vector<std::string>({"leave A2y", "leave A2", "leave A", "leave Root"}));
+    });
+
+    return testResult();
+}
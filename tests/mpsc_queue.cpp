@@ -0,0 +1,165 @@
+/**
+ * @file mpsc_queue.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of MpscQueue - ordering, completeness with many producers and cleanup of elements left in the queue
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/mpsc_queue.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+struct CountedElement
+{
+    static inline int aliveCount = 0;
+
+    int value;
+
+    CountedElement(int value_ = 0) : value(value_) { aliveCount++; }
+    CountedElement(const CountedElement& other) : value(other.value) { aliveCount++; }
+    CountedElement& operator=(const CountedElement& other) = default;
+    ~CountedElement() { aliveCount--; }
+};
+
+
+int main()
+{
+    runTest("single producer elements come out in order", [] {
+        MpscQueue<int> queue;
+        int value = -1;
+
+        CHECK(queue.isEmpty());
+        CHECK(!queue.tryPop(value));
+
+        for(int i = 0; i < 1000; i++)
+        {
+            queue.emplace(i);
+        }
+        CHECK(!queue.isEmpty());
+
+        for(int i = 0; i < 1000; i++)
+        {
+            CHECK(queue.tryPop(value));
+            CHECK(value == i);
+        }
+
+        CHECK(queue.isEmpty());
+        CHECK(!queue.tryPop(value));
+    });
+
+    runTest("pushing and popping interleaved keeps the order", [] {
+        MpscQueue<int> queue;
+        int next = 0;
+        int value = -1;
+
+        for(int i = 0; i < 100; i++)
+        {
+            queue.emplace(2 * i);
+            queue.emplace(2 * i + 1);
+            CHECK(queue.tryPop(value));
+            CHECK(value == next++);
+        }
+        while(queue.tryPop(value))
+        {
+            CHECK(value == next++);
+        }
+
+        CHECK(next == 200);
+    });
+
+    runTest("move-only elements", [] {
+        MpscQueue<std::unique_ptr<int>> queue;
+        queue.emplace(new int(7));
+        queue.emplace(std::make_unique<int>(8));
+
+        std::unique_ptr<int> value;
+        CHECK(queue.tryPop(value) && value && *value == 7);
+        CHECK(queue.tryPop(value) && value && *value == 8);
+    });
+
+    runTest("elements left in the queue are destroyed with it", [] {
+        {
+            MpscQueue<CountedElement> queue;
+            for(int i = 0; i < 10; i++)
+            {
+                queue.emplace(i);
+            }
+
+            CountedElement value;
+            CHECK(queue.tryPop(value) && value.value == 0);
+        }
+
+        CHECK(CountedElement::aliveCount == 0);
+    });
+
+    runTest("every element of many producers is popped once, in producer order", [] {
+        const int producerCount = 4;
+        const int elementsPerProducer = 100000;
+
+        MpscQueue<std::pair<int, int>> queue;
+        std::atomic<bool> isStarted { false };
+
+        std::vector<std::thread> producers;
+        for(int p = 0; p < producerCount; p++)
+        {
+            producers.emplace_back([&queue, &isStarted, p] {
+                while(!isStarted.load())
+                {
+                    std::this_thread::yield();
+                }
+
+                for(int i = 0; i < elementsPerProducer; i++)
+                {
+                    queue.emplace(p, i);
+                }
+            });
+        }
+
+        isStarted.store(true);
+
+        std::vector<int> nextExpected(producerCount, 0);
+        int popped = 0;
+        bool isOrdered = true;
+        std::pair<int, int> value;
+        while(popped < producerCount * elementsPerProducer)
+        {
+            if(queue.tryPop(value))
+            {
+                isOrdered = isOrdered && value.first >= 0 && value.first < producerCount && value.second == nextExpected[value.first];
+                if(value.first >= 0 && value.first < producerCount)
+                {
+                    nextExpected[value.first] = value.second + 1;
+                }
+                popped++;
+            }
+        }
+
+        for(std::thread& producer : producers)
+        {
+            producer.join();
+        }
+
+        CHECK(isOrdered);
+        for(int p = 0; p < producerCount; p++)
+        {
+            CHECK(nextExpected[p] == elementsPerProducer);
+        }
+        CHECK(!queue.tryPop(value));
+        CHECK(queue.isEmpty());
+    });
+
+    return testResult();
+}
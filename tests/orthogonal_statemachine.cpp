@@ -0,0 +1,149 @@
+/**
+ * @file orthogonal_statemachine.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of OrthogonalStatemachine - isolation of regions, event passes over all regions and the order of pending transitions
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+struct Closed;
+struct Open;
+struct Unlocked;
+struct Locked;
+struct Dark;
+struct Lit;
+
+using TestStatemachine = OrthogonalStatemachine<Region<Closed, Open>, Region<Unlocked, Locked>, Region<Dark, Lit>>;
+
+std::vector<std::string> events;
+
+struct Toggle {};
+
+#define LOGGING_CALLBACKS(name) \
+    void onEnterState(StateTransition) { events.push_back("enter " #name); } \
+    void onLeaveState(StateTransition) { events.push_back("leave " #name); }
+
+struct Closed
+{
+    LOGGING_CALLBACKS(Closed)
+    void onEvent(TestStatemachine& machine, const Toggle&);
+};
+
+// Turns the light on as soon as it is entered
+struct Open
+{
+    void onEnterState(TestStatemachine& machine, StateTransition);
+    void onLeaveState(StateTransition) { events.push_back("leave Open"); }
+};
+
+struct Unlocked
+{
+    LOGGING_CALLBACKS(Unlocked)
+    void onEvent(TestStatemachine& machine, const Toggle&);
+};
+
+struct Locked
+{
+    LOGGING_CALLBACKS(Locked)
+};
+
+struct Dark
+{
+    LOGGING_CALLBACKS(Dark)
+};
+
+struct Lit
+{
+    LOGGING_CALLBACKS(Lit)
+};
+
+void Closed::onEvent(TestStatemachine& machine, const Toggle&)
+{
+    events.push_back("Closed handles Toggle");
+    CHECK(machine.gotoState<Open>());
+}
+
+void Open::onEnterState(TestStatemachine& machine, StateTransition)
+{
+    events.push_back("enter Open");
+    CHECK(machine.gotoState<Lit>());
+}
+
+void Unlocked::onEvent(TestStatemachine& machine, const Toggle&)
+{
+    // the transition requested by the first region waits until the whole pass is over
+    events.push_back(machine.isCurrentlyInState<Closed>() ? "Unlocked handles Toggle while Closed" : "Unlocked handles Toggle while Open");
+    CHECK(machine.gotoState<Locked>());
+    // requesting the same transition again doesn't do it twice
+    CHECK(machine.gotoState<Locked>());
+}
+
+
+int main()
+{
+    runTest("transitions in one region don't affect the others", [] {
+        TestStatemachine sm;
+        CHECK(sm.initState<Closed>());
+        CHECK(sm.initState<Locked>());
+        CHECK(!sm.initState<Unlocked>());
+        CHECK(sm.getCurrentStateIndex(2) == 0);
+
+        events.clear();
+        CHECK(sm.gotoState<Unlocked>());
+        CHECK(events == std::vector<std::string>({"leave Locked", "enter Unlocked"}));
+        CHECK(sm.isCurrentlyInState<Closed>());
+        CHECK(sm.getCurrentState<Closed>() != nullptr);
+        CHECK(sm.getCurrentState<Open>() == nullptr);
+        CHECK(sm.getCurrentStateIndex(0) == TestStatemachine::stateIndexOf<Closed>());
+        CHECK(sm.getCurrentStateIndex(1) == TestStatemachine::stateIndexOf<Unlocked>());
+        CHECK(sm.getCurrentStateType(2) == NULL_STATE);
+
+        CHECK(!sm.gotoState<Unlocked>());
+    });
+
+    runTest("event reaches all regions before any transition it causes", [] {
+        TestStatemachine sm;
+        CHECK(sm.initState<Closed>());
+        CHECK(sm.initState<Unlocked>());
+        CHECK(sm.initState<Dark>());
+
+        events.clear();
+        CHECK(sm.dispatchEvent(Toggle{}));
+        CHECK(events == std::vector<std::string>({
+            "Closed handles Toggle", "Unlocked handles Toggle while Closed",
+            "leave Closed", "enter Open",
+            "leave Unlocked", "enter Locked",
+            // requested by Open while entered, so after the transitions requested before it
+            "leave Dark", "enter Lit"
+        }));
+        CHECK(sm.isCurrentlyInState<Open>() && sm.isCurrentlyInState<Locked>() && sm.isCurrentlyInState<Lit>());
+
+        CHECK(!sm.dispatchEvent(Toggle{}));
+    });
+
+    runTest("destructor leaves regions from the last one", [] {
+        {
+            TestStatemachine sm;
+            CHECK(sm.initState<Closed>());
+            CHECK(sm.initState<Unlocked>());
+            CHECK(sm.initState<Dark>());
+            events.clear();
+        }
+        CHECK(events == std::vector<std::string>({"leave Dark", "leave Unlocked", "leave Closed"}));
+    });
+
+    return testResult();
+}
@@ -0,0 +1,205 @@
+/**
+ * @file statemachine.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of the core Statemachine - transitions made from inside of state callbacks or after them, their failures and statemachine class hierarchies
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+
+using namespace chestnut::fsm;
+
+
+class TestStatemachine : public Statemachine<> {};
+
+class StateI : public State<TestStatemachine> {};
+
+class StateB : public State<TestStatemachine> {};
+
+// Goes further to B as soon as it is entered
+class StateA : public State<TestStatemachine>
+{
+public:
+    void onEnterState(StateTransition) override
+    {
+        getParent().gotoState<StateB>();
+    }
+};
+
+class StateFailingToEnter : public State<TestStatemachine>
+{
+public:
+    void onEnterState(StateTransition) override
+    {
+        failTransition(7);
+    }
+};
+
+// Fails its own entry and then goes further to B, which replaces it
+class StateFailingBeforeNested : public State<TestStatemachine>
+{
+public:
+    void onEnterState(StateTransition) override
+    {
+        failTransition(3);
+        getParent().gotoState<StateB>();
+    }
+};
+
+class StateRefusing : public State<TestStatemachine>
+{
+public:
+    bool canEnterState(StateTransition) const noexcept override
+    {
+        return false;
+    }
+};
+
+// Requests a transition the statemachine refuses
+class StateGoingToRefusing : public State<TestStatemachine>
+{
+public:
+    void onEnterState(StateTransition) override
+    {
+        getParent().gotoState<StateRefusing>();
+    }
+};
+
+// Tries a refusing state once the transition into it is over, then goes to B
+class StateRetryingAfterTransition : public State<TestStatemachine>
+{
+public:
+    bool *refused;
+
+    StateRetryingAfterTransition(bool *refused) : refused(refused) {}
+
+    void onEnterState(StateTransition) override
+    {
+        TestStatemachine *parent = &getParent();
+        bool *refusedFlag = refused;
+        parent->callAfterTransition([parent, refusedFlag] {
+            *refusedFlag = !parent->gotoState<StateRefusing>();
+            parent->gotoState<StateB>();
+        });
+    }
+};
+
+
+// Two levels of statemachine classes, each with its own state extension
+
+struct BasicExtension
+{
+    virtual ~BasicExtension() = default;
+};
+
+struct ExtendedExtension : BasicExtension {};
+
+class BasicStatemachine : public Statemachine<BasicExtension> {};
+
+class ExtendedStatemachine : public Statemachine<ExtendedExtension, BasicStatemachine> {};
+
+class BasicState : public State<BasicStatemachine> {};
+
+// A state of the derived statemachine, which can also be seen as a state of the base one
+class ExtendedState : public State<ExtendedStatemachine, BasicState> {};
+
+struct OtherExtension
+{
+    virtual ~OtherExtension() = default;
+};
+
+class OtherStatemachine : public Statemachine<OtherExtension> {};
+
+class OtherState : public State<OtherStatemachine> {};
+
+
+int main()
+{
+    runTest("gotoState from onEnterState replaces the state being entered", [] {
+        TestStatemachine sm;
+        CHECK(sm.initState<StateI>());
+        CHECK(sm.gotoState<StateA>());
+        CHECK(sm.getCurrentStateType() == stateIdOf<StateB>());
+        CHECK(sm.getStateStackSize() == 2);
+        CHECK(sm.getLastTransitionResult().error == TRANSITION_ERROR_NONE);
+    });
+
+    runTest("failTransition from onEnterState is reported by the transition", [] {
+        TestStatemachine sm;
+        CHECK(sm.initState<StateI>());
+        CHECK(!sm.gotoState<StateFailingToEnter>());
+        CHECK(sm.getLastTransitionResult().error == TRANSITION_ERROR_ON_ENTER_STATE);
+        CHECK(sm.getLastTransitionResult().errorCode == 7);
+    });
+
+    runTest("failure reported before a nested transition survives it", [] {
+        TestStatemachine sm;
+        CHECK(sm.initState<StateI>());
+        CHECK(!sm.gotoState<StateFailingBeforeNested>());
+        CHECK(sm.getLastTransitionResult().errorCode == 3);
+        CHECK(sm.getCurrentStateType() == stateIdOf<StateB>());
+    });
+
+    runTest("outcome of a queued transition is recorded once it's executed", [] {
+        TestStatemachine sm;
+        sm.setRunToCompletion(true);
+        CHECK(sm.initState<StateI>());
+        CHECK(sm.getLastTransitionResult().isAccepted);
+
+        CHECK(sm.gotoState<StateA>());
+        CHECK(sm.getCurrentStateType() == stateIdOf<StateB>());
+        CHECK(sm.getLastTransitionResult().isAccepted);
+
+        // the transition into the state succeeds, the one it queued is refused
+        CHECK(sm.gotoState<StateGoingToRefusing>());
+        CHECK(sm.getCurrentStateType() == stateIdOf<StateGoingToRefusing>());
+        CHECK(!sm.getLastTransitionResult().isAccepted);
+        CHECK(sm.getLastTransitionResult().error == TRANSITION_ERROR_NONE);
+
+        CHECK(!sm.gotoState<StateRefusing>());
+        CHECK(!sm.getLastTransitionResult().isAccepted);
+    });
+
+    runTest("callAfterTransition gets actual results of transitions in both modes", [] {
+        for (bool runToCompletion : {false, true}) {
+            TestStatemachine sm;
+            sm.setRunToCompletion(runToCompletion);
+            bool refused = false;
+            CHECK(sm.initState<StateI>());
+            CHECK(sm.gotoState<StateRetryingAfterTransition>(&refused));
+            CHECK(refused);
+            CHECK(sm.getCurrentStateType() == stateIdOf<StateB>());
+        }
+    });
+
+    runTest("getCurrentState of a base statemachine class finds the state created for a derived one", [] {
+        ExtendedStatemachine sm;
+        CHECK(sm.initState<ExtendedState>());
+        CHECK(sm.getCurrentState() != nullptr);
+
+        BasicStatemachine& base = sm;
+        CHECK(base.getCurrentState() != nullptr);
+        CHECK(base.getCurrentState() == static_cast<BasicStatemachine::BaseStateType *>(sm.getCurrentState<ExtendedState>()));
+    });
+
+    runTest("state of another statemachine class hierarchy is rejected", [] {
+        OtherStatemachine other;
+        StatemachineBase& base = other;
+        CHECK(!base.initState<BasicState>());
+        CHECK(base.getCurrentState() == nullptr);
+
+        // both statemachine classes entered one after the other, which must not make either of them accept the other's states
+        BasicStatemachine basic;
+        CHECK(basic.initState<BasicState>());
+        CHECK(other.initState<OtherState>());
+        CHECK(!base.gotoState<BasicState>());
+    });
+
+    return testResult();
+}
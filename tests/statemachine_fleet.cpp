@@ -0,0 +1,53 @@
+/**
+ * @file statemachine_fleet.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of StatemachineFleet - state stacks of the statemachines in the fleet
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/statemachine_fleet.hpp>
+
+using namespace chestnut::fsm;
+
+
+struct StateI {};
+struct StateA {};
+struct StateB {};
+
+using TestFleet = StatemachineFleet<StateI, StateA, StateB>;
+
+
+int main()
+{
+    runTest("gotoState keeps the init state, like StatemachineBase", [] {
+        TestFleet fleet;
+        FleetHandle handle = fleet.create();
+        CHECK(fleet.initState<StateI>(handle));
+        CHECK(fleet.gotoState<StateA>(handle));
+        CHECK(fleet.isCurrentlyInState<StateA>(handle));
+        CHECK(fleet.getStateStackSize(handle) == 2);
+        CHECK(fleet.popState(handle));
+        CHECK(fleet.isCurrentlyInState<StateI>(handle));
+    });
+
+    runTest("gotoState replaces the state on top of the init state", [] {
+        TestFleet fleet;
+        FleetHandle handle = fleet.create();
+        CHECK(fleet.initState<StateI>(handle));
+        CHECK(fleet.pushState<StateA>(handle));
+        CHECK(fleet.gotoState<StateB>(handle));
+        CHECK(fleet.isCurrentlyInState<StateB>(handle));
+        CHECK(fleet.getStateStackSize(handle) == 2);
+        CHECK(fleet.popState(handle));
+        CHECK(fleet.isCurrentlyInState<StateI>(handle));
+    });
+
+    return testResult();
+}
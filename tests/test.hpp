@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdio>
+
+
+// Number of failed checks in the whole test program
+inline int& failedCheckCount()
+{
+    static int count = 0;
+    return count;
+}
+
+// Checks a condition and reports it if it doesn't hold, the test case keeps going
+#define CHECK(condition) \
+    do \
+    { \
+        if(!(condition)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failedCheckCount()++; \
+        } \
+    } while(false)
+
+// Runs a single test case and prints whether all of its checks passed
+template<typename F>
+void runTest(const char *name, F&& f)
+{
+    const int failedBefore = failedCheckCount();
+    f();
+    printf("%-64s %s\n", name, failedCheckCount() == failedBefore ? "passed" : "FAILED");
+}
+
+// Exit code of the test program
+inline int testResult()
+{
+    return failedCheckCount() == 0 ? 0 : 1;
+}
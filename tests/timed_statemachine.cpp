@@ -0,0 +1,92 @@
+/**
+ * @file timed_statemachine.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of TimedStatemachine - firing, cancelling and ownership of state timers
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/timed_statemachine.hpp>
+
+using namespace chestnut::fsm;
+
+
+class TestStatemachine : public TimedStatemachine<> {};
+
+class StateI : public State<TestStatemachine> {};
+
+class StateA : public State<TestStatemachine> {};
+
+class StateB : public State<TestStatemachine> {};
+
+
+int main()
+{
+    runTest("timer fires once and its handle goes stale", [] {
+        TimerService timers;
+        TestStatemachine sm;
+        sm.setTimerService(&timers);
+        CHECK(sm.initState<StateI>());
+
+        TimerHandle handle = sm.gotoStateAfter<StateA>(std::chrono::milliseconds(5));
+        CHECK(handle.isValid());
+        CHECK(timers.advanceTicks(10) == 1);
+        CHECK(sm.getCurrentStateType() == stateIdOf<StateA>());
+        CHECK(!sm.cancelTimer(handle));
+    });
+
+    runTest("cancelled timer doesn't fire and can't be cancelled again", [] {
+        TimerService timers;
+        TestStatemachine sm;
+        sm.setTimerService(&timers);
+        CHECK(sm.initState<StateI>());
+
+        TimerHandle first = sm.gotoStateAfter<StateA>(std::chrono::milliseconds(5));
+        TimerHandle second = sm.gotoStateAfter<StateB>(std::chrono::milliseconds(10));
+        CHECK(sm.cancelTimer(first));
+        CHECK(!sm.cancelTimer(first));
+
+        // the entry of the cancelled timer is reused, its old handle must not reach the new timer
+        TimerHandle third = sm.callAfter(std::chrono::milliseconds(20), [] {});
+        CHECK(third.index == first.index);
+        CHECK(!sm.cancelTimer(first));
+
+        CHECK(timers.advanceTicks(10) == 1);
+        CHECK(sm.getCurrentStateType() == stateIdOf<StateB>());
+        CHECK(!sm.cancelTimer(second));
+    });
+
+    runTest("leaving a state cancels its timers", [] {
+        TimerService timers;
+        TestStatemachine sm;
+        sm.setTimerService(&timers);
+        CHECK(sm.initState<StateI>());
+        CHECK(sm.pushState<StateA>());
+
+        TimerHandle handle = sm.popStateAfter(std::chrono::milliseconds(5));
+        CHECK(sm.gotoState<StateB>());
+        CHECK(timers.getScheduledCount() == 0);
+        CHECK(!sm.cancelTimer(handle));
+    });
+
+    runTest("handles of another statemachine are rejected", [] {
+        TimerService timers;
+        TestStatemachine sm, other;
+        sm.setTimerService(&timers);
+        other.setTimerService(&timers);
+        CHECK(sm.initState<StateI>());
+        CHECK(other.initState<StateI>());
+
+        TimerHandle handle = sm.gotoStateAfter<StateA>(std::chrono::milliseconds(5));
+        CHECK(!other.cancelTimer(handle));
+        CHECK(timers.getScheduledCount() == 1);
+    });
+
+    return testResult();
+}
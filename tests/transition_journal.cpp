@@ -0,0 +1,322 @@
+/**
+ * @file transition_journal.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of TransitionJournal - recovery of torn files, state type indices, group commit and replaying
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/transition_journal.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+class TestStatemachine : public Statemachine<> {};
+
+class StateIdle : public State<TestStatemachine> {};
+class StateWalking : public State<TestStatemachine> {};
+class StateRunning : public State<TestStatemachine> {};
+
+
+const char *journalPath = "transition_journal_test.bin";
+
+// batches are only written by sync() and close(), so the tests know where they end
+TransitionJournalConfig manualFlushConfig()
+{
+    TransitionJournalConfig config;
+    config.durability = JOURNAL_DURABILITY_ASYNC;
+    config.flushInterval = std::chrono::seconds(60);
+    return config;
+}
+
+StateTransition makeTransition(EStateTransitionType type, StateId prevState, StateId nextState)
+{
+    StateTransition transition;
+    transition.type = type;
+    transition.prevState = prevState;
+    transition.nextState = nextState;
+    return transition;
+}
+
+std::uintmax_t journalSize()
+{
+    return std::filesystem::file_size(journalPath);
+}
+
+void truncateJournal(std::uintmax_t size)
+{
+    std::filesystem::resize_file(journalPath, size);
+}
+
+std::vector<std::uint64_t> readSequences()
+{
+    std::vector<std::uint64_t> sequences;
+
+    TransitionJournalReader reader;
+    if(reader.open(journalPath))
+    {
+        JournalRecord record;
+        while(reader.next(record))
+        {
+            sequences.push_back(record.sequence);
+        }
+    }
+
+    return sequences;
+}
+
+
+int main()
+{
+    runTest("a torn tail is cut off on reopen and numbering continues after it", [] {
+        std::remove(journalPath);
+
+        std::uintmax_t completeSize;
+        {
+            TransitionJournal journal;
+            CHECK(journal.open(journalPath, manualFlushConfig()));
+            journal.append(1, makeTransition(STATE_TRANSITION_INIT, NULL_STATE, stateIdOf<StateIdle>()));
+            journal.append(1, makeTransition(STATE_TRANSITION_GOTO, stateIdOf<StateIdle>(), stateIdOf<StateWalking>()));
+            CHECK(journal.sync());
+            completeSize = journalSize();
+
+            journal.append(1, makeTransition(STATE_TRANSITION_PUSH, stateIdOf<StateWalking>(), stateIdOf<StateRunning>()));
+            journal.append(1, makeTransition(STATE_TRANSITION_POP, stateIdOf<StateRunning>(), stateIdOf<StateWalking>()));
+        }
+
+        // as if the process crashed in the middle of writing the second batch
+        truncateJournal(journalSize() - 5);
+        {
+            TransitionJournalReader reader;
+            CHECK(reader.open(journalPath));
+            JournalRecord record;
+            while(reader.next(record)) {}
+            CHECK(reader.isTruncated());
+            CHECK(reader.getLastSequence() == 2);
+        }
+
+        {
+            TransitionJournal journal;
+            CHECK(journal.open(journalPath, manualFlushConfig()));
+            CHECK(journalSize() == completeSize);
+            CHECK(journal.getLastSequence() == 2);
+            CHECK(journal.append(1, makeTransition(STATE_TRANSITION_GOTO, stateIdOf<StateWalking>(), stateIdOf<StateIdle>())) == 3);
+        }
+
+        CHECK(readSequences() == std::vector<std::uint64_t>({1, 2, 3}));
+    });
+
+    runTest("state type indices start over in every session", [] {
+        std::remove(journalPath);
+
+        {
+            TransitionJournal journal;
+            CHECK(journal.open(journalPath, manualFlushConfig()));
+            journal.append(1, makeTransition(STATE_TRANSITION_INIT, NULL_STATE, stateIdOf<StateIdle>()));
+            journal.append(1, makeTransition(STATE_TRANSITION_GOTO, stateIdOf<StateIdle>(), stateIdOf<StateWalking>()));
+        }
+        {
+            // the first state type of this session gets the index StateIdle had in the previous one
+            TransitionJournal journal;
+            CHECK(journal.open(journalPath, manualFlushConfig()));
+            journal.append(2, makeTransition(STATE_TRANSITION_INIT, NULL_STATE, stateIdOf<StateRunning>()));
+            journal.append(1, makeTransition(STATE_TRANSITION_GOTO, stateIdOf<StateWalking>(), stateIdOf<StateIdle>()));
+        }
+
+        const std::string expectedNextStates[] = {
+            getStateTypeName(stateIdOf<StateIdle>()),
+            getStateTypeName(stateIdOf<StateWalking>()),
+            getStateTypeName(stateIdOf<StateRunning>()),
+            getStateTypeName(stateIdOf<StateIdle>()),
+        };
+
+        TransitionJournalReader reader;
+        CHECK(reader.open(journalPath));
+        JournalRecord record;
+        int recordCount = 0;
+        while(reader.next(record) && recordCount < 4)
+        {
+            CHECK(reader.getStateTypeName(record.nextStateIndex) == expectedNextStates[recordCount]);
+            recordCount++;
+        }
+        CHECK(recordCount == 4);
+        CHECK(!reader.isTruncated());
+
+        // both sessions resolve to the right states when replayed
+        TestStatemachine first;
+        TestStatemachine second;
+        TransitionJournalReader replayReader;
+        CHECK(replayReader.open(journalPath));
+        CHECK((replayReader.replay<StateIdle, StateWalking, StateRunning>(0, [&](std::uint64_t machineId) {
+            return machineId == 1 ? &first : &second;
+        })) == 4);
+        CHECK(first.isCurrentlyInState<StateIdle>());
+        CHECK(second.isCurrentlyInState<StateRunning>());
+    });
+
+    runTest("SYNC appends of many threads share syncs (group commit)", [] {
+        std::remove(journalPath);
+
+        const int threadCount = 8;
+        const int recordsPerThread = 50;
+
+        TransitionJournalConfig config;
+        config.durability = JOURNAL_DURABILITY_SYNC;
+
+        TransitionJournal journal;
+        CHECK(journal.open(journalPath, config));
+
+        std::atomic<int> startedCount {0};
+        std::atomic<int> notDurableCount {0};
+        std::vector<std::thread> threads;
+        for(int t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&journal, &startedCount, &notDurableCount, t] {
+                startedCount++;
+                while(startedCount.load() < threadCount)
+                {
+                    std::this_thread::yield();
+                }
+
+                for(int i = 0; i < recordsPerThread; i++)
+                {
+                    // with SYNC the record is durable by the time append() returns
+                    const std::uint64_t sequence = journal.append(t, makeTransition(STATE_TRANSITION_GOTO, stateIdOf<StateIdle>(), stateIdOf<StateWalking>()));
+                    if(sequence == 0 || journal.getDurableSequence() < sequence)
+                    {
+                        notDurableCount++;
+                    }
+                }
+            });
+        }
+        for(std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        const std::uint64_t recordCount = threadCount * recordsPerThread;
+        CHECK(notDurableCount == 0);
+        CHECK(journal.getLastSequence() == recordCount);
+        CHECK(journal.getDurableSequence() == recordCount);
+        CHECK(journal.getSyncCount() > 0);
+        CHECK(journal.getSyncCount() < recordCount);
+        CHECK(!journal.hasFailed());
+
+        journal.close();
+        CHECK(readSequences().size() == recordCount);
+    });
+
+    runTest("replay stops at a record that doesn't match its statemachine", [] {
+        std::remove(journalPath);
+
+        {
+            TransitionJournal journal;
+            CHECK(journal.open(journalPath, manualFlushConfig()));
+
+            TestStatemachine machine;
+            TransitionJournalObserver observer(journal, 1);
+            machine.attachObserver(observer);
+
+            machine.initState<StateIdle>();
+            machine.gotoState<StateWalking>();
+            machine.pushState<StateRunning>();
+            machine.popState();
+
+            // the machine is in StateWalking, not in StateRunning
+            journal.append(1, makeTransition(STATE_TRANSITION_GOTO, stateIdOf<StateRunning>(), stateIdOf<StateIdle>()));
+            journal.append(1, makeTransition(STATE_TRANSITION_GOTO, stateIdOf<StateWalking>(), stateIdOf<StateIdle>()));
+
+            machine.detachObserver(observer);
+        }
+
+        TestStatemachine restored;
+        TransitionJournalReader reader;
+        CHECK(reader.open(journalPath));
+        CHECK((reader.replay<StateIdle, StateWalking, StateRunning>(0, [&restored](std::uint64_t) { return &restored; })) == -1);
+        CHECK(reader.getLastSequence() == 4);
+        CHECK(restored.isCurrentlyInState<StateWalking>());
+        CHECK(restored.getStateStackSize() == 2);
+
+        // a state type that isn't listed can't be replayed either
+        TestStatemachine other;
+        TransitionJournalReader otherReader;
+        CHECK(otherReader.open(journalPath));
+        CHECK((otherReader.replay<StateIdle, StateWalking>(0, [&other](std::uint64_t) { return &other; })) == -1);
+        CHECK(otherReader.getLastSequence() == 2);
+    });
+
+    runTest("a journal cut mid-batch is replayed up to the last complete batch and resumed", [] {
+        std::remove(journalPath);
+
+        std::uintmax_t completeSize;
+        {
+            TransitionJournal journal;
+            CHECK(journal.open(journalPath, manualFlushConfig()));
+
+            TestStatemachine machine;
+            TransitionJournalObserver observer(journal, 1);
+            machine.attachObserver(observer);
+
+            machine.initState<StateIdle>();
+            machine.gotoState<StateWalking>();
+            CHECK(journal.sync());
+            completeSize = journalSize();
+
+            machine.pushState<StateRunning>();
+            machine.popState();
+            machine.gotoState<StateIdle>();
+
+            machine.detachObserver(observer);
+        }
+
+        truncateJournal(completeSize + (journalSize() - completeSize) / 2);
+
+        TransitionJournal journal;
+        CHECK(journal.open(journalPath, manualFlushConfig()));
+        CHECK(journal.getLastSequence() == 2);
+
+        TestStatemachine restored;
+        {
+            TransitionJournalReader reader;
+            CHECK(reader.open(journalPath));
+            CHECK((reader.replay<StateIdle, StateWalking, StateRunning>(0, [&restored](std::uint64_t) { return &restored; })) == 2);
+            CHECK(!reader.isTruncated());
+            CHECK(reader.getLastSequence() == 2);
+        }
+        CHECK(restored.isCurrentlyInState<StateWalking>());
+        CHECK(restored.getStateStackSize() == 2);
+
+        // the restored machine carries on journaling where the complete part of the file ends
+        {
+            TransitionJournalObserver observer(journal, 1);
+            restored.attachObserver(observer);
+            restored.pushState<StateRunning>();
+        }
+        journal.close();
+
+        CHECK(readSequences() == std::vector<std::uint64_t>({1, 2, 3}));
+
+        TestStatemachine replayed;
+        TransitionJournalReader reader;
+        CHECK(reader.open(journalPath));
+        CHECK((reader.replay<StateIdle, StateWalking, StateRunning>(0, [&replayed](std::uint64_t) { return &replayed; })) == 3);
+        CHECK(replayed.isCurrentlyInState<StateRunning>());
+        CHECK(replayed.getStateStackSize() == 3);
+    });
+
+    std::remove(journalPath);
+
+    return testResult();
+}
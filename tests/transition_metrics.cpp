@@ -0,0 +1,124 @@
+/**
+ * @file transition_metrics.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of TransitionMetrics - totals of running and exited threads and recording from thread_local destructors
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/transition_metrics.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+// Records a transition when the thread that owns it exits, like a statemachine kept in a thread_local
+struct RecordingOnThreadExit
+{
+    ~RecordingOnThreadExit()
+    {
+        StateTransition transition;
+        transition.prevState = 1;
+        transition.nextState = 3;
+        TransitionMetrics::recordTransition(transition, 100);
+    }
+};
+
+std::uint64_t transitionCountOf(const MetricsSnapshot& snapshot, StateId prevState, StateId nextState)
+{
+    for(const TransitionCountMetrics& metrics : snapshot.transitions)
+    {
+        if(metrics.prevState == prevState && metrics.nextState == nextState)
+        {
+            return metrics.count;
+        }
+    }
+    return 0;
+}
+
+std::uint64_t dwellCountOf(const MetricsSnapshot& snapshot, StateId state)
+{
+    for(const StateDwellMetrics& metrics : snapshot.states)
+    {
+        if(metrics.state == state)
+        {
+            return metrics.dwellTime.getTotalCount();
+        }
+    }
+    return 0;
+}
+
+
+int main()
+{
+    runTest("counts of exited threads stay in the totals", [] {
+        const int threadCount = 8;
+        const int rounds = 3;
+        const int transitionsPerThread = 1000;
+
+        // threads exit between rounds, so their shards are retired while the others are still there
+        for(int round = 0; round < rounds; round++)
+        {
+            std::vector<std::thread> threads;
+            for(int t = 0; t < threadCount; t++)
+            {
+                threads.emplace_back([t] {
+                    StateTransition transition;
+                    transition.prevState = 1;
+                    transition.nextState = 2;
+                    for(int i = 0; i < transitionsPerThread; i++)
+                    {
+                        TransitionMetrics::recordTransition(transition, 10 + t);
+                    }
+                    TransitionMetrics::recordDwellTime(2, 1000 + t);
+                });
+            }
+            for(std::thread& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        MetricsSnapshot snapshot = TransitionMetrics::snapshot();
+        CHECK(transitionCountOf(snapshot, 1, 2) == rounds * threadCount * transitionsPerThread);
+        CHECK(dwellCountOf(snapshot, 1) == rounds * threadCount * transitionsPerThread);
+        CHECK(dwellCountOf(snapshot, 2) == rounds * threadCount);
+
+        for(const StateDwellMetrics& metrics : snapshot.states)
+        {
+            if(metrics.state == 1)
+            {
+                CHECK(metrics.dwellTime.getMin() == 10);
+                CHECK(metrics.dwellTime.getMax() == 10 + threadCount - 1);
+            }
+        }
+    });
+
+    runTest("recording after the thread's shard was retired is still counted", [] {
+        const std::uint64_t countBefore = transitionCountOf(TransitionMetrics::snapshot(), 1, 3);
+
+        std::thread thread([] {
+            // constructed before the shard, so destroyed after it
+            thread_local RecordingOnThreadExit recordingOnExit;
+            (void)recordingOnExit;
+
+            StateTransition transition;
+            transition.prevState = 1;
+            transition.nextState = 3;
+            TransitionMetrics::recordTransition(transition);
+        });
+        thread.join();
+
+        CHECK(transitionCountOf(TransitionMetrics::snapshot(), 1, 3) == countBefore + 2);
+    });
+
+    return testResult();
+}
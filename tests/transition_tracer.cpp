@@ -0,0 +1,89 @@
+/**
+ * @file transition_tracer.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of TransitionTracer - draining records of many threads and recording from thread_local destructors
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/fsm.hpp>
+#include <chestnut/fsm/transition_tracer.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+// Records a transition when the thread that owns it exits, like a statemachine kept in a thread_local
+struct RecordingOnThreadExit
+{
+    StateTransition transition;
+
+    ~RecordingOnThreadExit()
+    {
+        TransitionTracer::record(this, transition);
+    }
+};
+
+
+int main()
+{
+    runTest("records of all threads are drained, also of threads that have exited", [] {
+        const int threadCount = 4;
+        const int recordsPerThread = 100;
+
+        TransitionTracer::drain([](const TransitionRecord&) {});
+
+        std::vector<std::thread> threads;
+        for(int t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([] {
+                StateTransition transition;
+                for(int i = 0; i < recordsPerThread; i++)
+                {
+                    TransitionTracer::record(&transition, transition);
+                }
+            });
+        }
+        for(std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        std::size_t drainedCount = 0;
+        CHECK(TransitionTracer::drain([&drainedCount](const TransitionRecord&) { drainedCount++; }) == threadCount * recordsPerThread);
+        CHECK(drainedCount == threadCount * recordsPerThread);
+        CHECK(TransitionTracer::drain([](const TransitionRecord&) {}) == 0);
+    });
+
+    runTest("recording after the thread's buffer was released is only counted as dropped", [] {
+        TransitionTracer::drain([](const TransitionRecord&) {});
+        const std::uint64_t droppedBefore = TransitionTracer::getDroppedCount();
+
+        std::thread thread([] {
+            // constructed before the buffer, so destroyed after it
+            thread_local RecordingOnThreadExit recordingOnExit;
+            (void)recordingOnExit;
+
+            StateTransition transition;
+            TransitionTracer::record(&transition, transition);
+        });
+        thread.join();
+
+        // the buffer of the exited thread is removed here, the late record must not have gone into it
+        CHECK(TransitionTracer::drain([](const TransitionRecord&) {}) == 1);
+        CHECK(TransitionTracer::getDroppedCount() == droppedBefore + 1);
+
+        StateTransition transition;
+        TransitionTracer::record(&transition, transition);
+        CHECK(TransitionTracer::drain([](const TransitionRecord&) {}) == 1);
+    });
+
+    return testResult();
+}
@@ -0,0 +1,153 @@
+/**
+ * @file work_stealing_deque.cpp
+ * @author Przemysław Cedro (SpontanCombust)
+ * @brief Tests of WorkStealingDeque - order on both ends, capacity and races between the owner and thieves
+ * @version 3.0.0
+ * @date 2026-10-16
+ *
+ * @copyright MIT License (c) 2021-2022
+ *
+ */
+
+#include "test.hpp"
+
+#include <chestnut/fsm/work_stealing_deque.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace chestnut::fsm;
+
+
+int main()
+{
+    runTest("owner pops the newest elements, thieves steal the oldest", [] {
+        std::vector<int> elements(4);
+        WorkStealingDeque<int> deque(8);
+
+        CHECK(deque.pop() == nullptr);
+        CHECK(deque.steal() == nullptr);
+
+        for(int& element : elements)
+        {
+            CHECK(deque.push(&element));
+        }
+        CHECK(deque.getSizeApprox() == 4);
+
+        CHECK(deque.pop() == &elements[3]);
+        CHECK(deque.steal() == &elements[0]);
+        CHECK(deque.steal() == &elements[1]);
+        CHECK(deque.pop() == &elements[2]);
+        CHECK(deque.pop() == nullptr);
+        CHECK(deque.steal() == nullptr);
+        CHECK(deque.getSizeApprox() == 0);
+    });
+
+    runTest("push fails when full, capacity is rounded up to a power of two", [] {
+        std::vector<int> elements(9);
+        WorkStealingDeque<int> deque(5);
+
+        for(int i = 0; i < 8; i++)
+        {
+            CHECK(deque.push(&elements[i]));
+        }
+        CHECK(!deque.push(&elements[8]));
+
+        // space freed on either end can be reused, the buffer wraps around
+        CHECK(deque.steal() == &elements[0]);
+        CHECK(deque.push(&elements[8]));
+        CHECK(!deque.push(&elements[0]));
+
+        for(int i = 8; i >= 1; i--)
+        {
+            CHECK(deque.pop() == &elements[i]);
+        }
+        CHECK(deque.pop() == nullptr);
+    });
+
+    runTest("each element is taken once when owner and thieves race", [] {
+        const int elementCount = 200000;
+        const int thiefCount = 3;
+
+        std::vector<int> elements(elementCount);
+        std::vector<std::atomic<int>> takenCounts(elementCount);
+        for(std::atomic<int>& count : takenCounts)
+        {
+            count.store(0);
+        }
+
+        WorkStealingDeque<int> deque(64);
+        std::atomic<bool> isDone { false };
+        std::atomic<int> stolenCount { 0 };
+        std::atomic<int> startedThiefCount { 0 };
+
+        std::vector<std::thread> thieves;
+        for(int t = 0; t < thiefCount; t++)
+        {
+            thieves.emplace_back([&] {
+                startedThiefCount.fetch_add(1);
+                while(!isDone.load())
+                {
+                    if(int *element = deque.steal())
+                    {
+                        takenCounts[element - elements.data()].fetch_add(1);
+                        stolenCount.fetch_add(1);
+                    }
+                }
+            });
+        }
+
+        while(startedThiefCount.load() < thiefCount)
+        {
+            std::this_thread::yield();
+        }
+
+        // the owner keeps the deque short, so most pops fight the thieves for the last element
+        int pushed = 0;
+        while(pushed < elementCount)
+        {
+            while(pushed < elementCount && deque.push(&elements[pushed]))
+            {
+                pushed++;
+                if(pushed % 3 == 0)
+                {
+                    break;
+                }
+            }
+
+            if(int *element = deque.pop())
+            {
+                takenCounts[element - elements.data()].fetch_add(1);
+            }
+        }
+
+        // whatever is left goes to the thieves, unless they are too slow
+        auto start = std::chrono::steady_clock::now();
+        while(deque.getSizeApprox() > 0 && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100))
+        {
+            std::this_thread::yield();
+        }
+        while(int *element = deque.pop())
+        {
+            takenCounts[element - elements.data()].fetch_add(1);
+        }
+
+        isDone.store(true);
+        for(std::thread& thief : thieves)
+        {
+            thief.join();
+        }
+
+        int wrongCount = 0;
+        for(std::atomic<int>& count : takenCounts)
+        {
+            wrongCount += count.load() != 1;
+        }
+        CHECK(wrongCount == 0);
+        CHECK(stolenCount.load() > 0);
+    });
+
+    return testResult();
+}